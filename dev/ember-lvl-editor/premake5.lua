@@ -36,7 +36,7 @@ project("ember-lvl-editor")
         libdirs    {"%{lib_dirs.vulkan_win32}"}
         links      {"vulkan-1"}
     filter{"system:linux"}
-        links      {"vulkan"}
+        links      {"vulkan", "pthread"}
 
     filter("configurations:Debug")
         defines({"DEBUG", "_DEBUG" })
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ember {
+
+	enum class JsonType {
+		NUL,
+		BOOLEAN,
+		NUMBER,
+		STRING,
+		ARRAY,
+		OBJECT,
+	};
+
+	// A parsed JSON document (RFC 8259), just enough for the asset formats that use it (e.g. glTF).
+	// The lookups never fail: a missing member, an out of range element or a value of a different type
+	// gives a null value (or the provided default), so optional fields can be read without any checks.
+	class JsonValue {
+	public:
+		JsonType GetType() const;
+		bool IsNull() const;
+		bool IsNumber() const;
+		bool IsString() const;
+		bool IsArray() const;
+		bool IsObject() const;
+
+		// The number of the elements of an array, or of the members of an object. 0 otherwise.
+		size_t GetSize() const;
+		const JsonValue& operator[](size_t idx) const;
+		// Objects only. Duplicate keys aren't merged, the first one wins.
+		const JsonValue& operator[](const std::string& key) const;
+		bool HasMember(const std::string& key) const;
+		// Objects only, the member 'idx' in the document order.
+		const std::string& GetMemberKey(size_t idx) const;
+
+		bool AsBool(bool defaultValue = false) const;
+		double AsDouble(double defaultValue = 0.0) const;
+		// The default is returned for the numbers that aren't non-negative integers that fit.
+		uint32_t AsUint(uint32_t defaultValue = 0) const;
+		int32_t AsInt(int32_t defaultValue = 0) const;
+		// An empty string for the other types.
+		const std::string& AsString() const;
+
+	private:
+		friend class JsonParser;
+
+		JsonType type{JsonType::NUL};
+		bool boolean{false};
+		double number{0.0};
+		std::string string;
+		// The array elements, or the object member values ('keys' has the keys of the object members).
+		std::vector<JsonValue> elements;
+		std::vector<std::string> keys;
+	};
+
+	// The text doesn't have to be null terminated. On failure, 'error' (if provided) describes
+	// the problem and where it is, and 'root' is left null.
+	bool ParseJson(JsonValue& root, const char* text, size_t length, std::string* error = nullptr);
+
+}
\ No newline at end of file
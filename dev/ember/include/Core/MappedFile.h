@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Core/Util.h"
+
+#include <cstddef>
+#include <string>
+
+namespace ember {
+
+	// A read-only view of a whole file, mapped into the address space. The pages are loaded by the OS
+	// on first access and shared with the file cache, so opening a file costs nothing until it's read.
+	// The data is page aligned.
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile();
+		CLASS_NO_COPY(MappedFile);
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		// Closes the previous file first. Returns 'false' if the file can't be opened or is empty.
+		bool Open(const std::string& path);
+		void Close();
+		bool IsOpen() const;
+
+		const char* GetData() const;
+		size_t GetSizeInBytes() const;
+
+	private:
+		const char* data{nullptr};
+		size_t sizeInBytes{0};
+#ifdef EMBER_PLATFORM_WIN32
+		// HANDLEs of the file and of its mapping object.
+		void* fileHandle{nullptr};
+		void* mappingHandle{nullptr};
+#endif
+	};
+
+}
\ No newline at end of file
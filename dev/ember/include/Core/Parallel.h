@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace ember {
+
+	// The number of threads 'ParallelFor()' uses at most (including the calling one).
+	uint32_t GetParallelWorkerCount();
+
+	// The number of chunks 'ParallelFor()' splits 'count' items into.
+	// Chunks have roughly 'minChunkSize' items at least, there's no point in a thread for a handful of items.
+	size_t GetParallelChunkCount(size_t count, size_t minChunkSize);
+
+	// Splits [0, count) into 'GetParallelChunkCount()' contiguous chunks and calls 'func(chunkIdx, begin, end)'
+	// for each one of them, every chunk on its own thread. The calling thread processes the first chunk
+	// and then waits for the rest. The chunks are deterministic (they only depend on 'count', 'minChunkSize'
+	// and the number of workers), so per-chunk results can be merged in a deterministic order.
+	// 
+	// 'func' must not throw, there's nobody to catch the exception on the worker threads.
+	template <typename Func>
+	void ParallelFor(size_t count, size_t minChunkSize, Func&& func) {
+		size_t chunkCount = GetParallelChunkCount(count, minChunkSize);
+		if (chunkCount <= 1) {
+			if (count > 0) {
+				func(size_t{0}, size_t{0}, count);
+			}
+			return;
+		}
+		// Chunk 'i' is [i * count / chunkCount, (i + 1) * count / chunkCount), the sizes differ by 1 at most.
+		std::vector<std::thread> workers;
+		workers.reserve(chunkCount - 1);
+		for (size_t chunkIdx = 1; chunkIdx < chunkCount; chunkIdx++) {
+			size_t begin = chunkIdx * count / chunkCount;
+			size_t end = (chunkIdx + 1) * count / chunkCount;
+			workers.emplace_back([&func, chunkIdx, begin, end]() {
+				func(chunkIdx, begin, end);
+			});
+		}
+		func(size_t{0}, size_t{0}, count / chunkCount);
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+// Compile-time SIMD capability detection.
+//
+// The instruction sets are picked by the build ('--simd' premake option), not at runtime.
+// Every kernel that uses the macros below must also provide a scalar path, so that
+// the engine still builds for targets where none of them are defined.
+//
+// Only include this header from translation units. Inline functions whose body depends
+// on these macros must not end up in public headers, otherwise translation units compiled
+// with different flags would see different definitions of the same function.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define EMBER_SIMD_SSE2 1
+#endif
+
+#if defined(__SSE4_1__) || defined(__AVX__)
+	#define EMBER_SIMD_SSE41 1
+#endif
+
+#if defined(__AVX2__)
+	#define EMBER_SIMD_AVX2 1
+#endif
+
+// MSVC doesn't have a separate F16C switch, it's implied by /arch:AVX2.
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+	#define EMBER_SIMD_F16C 1
+#endif
+
+// Same for FMA. FMA results can differ from separate multiply/add in the last bit, so kernels whose
+// results must match the scalar path exactly shouldn't use it.
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+	#define EMBER_SIMD_FMA 1
+#endif
+
+#if defined(EMBER_SIMD_SSE2)
+	#include <immintrin.h>
+#endif
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace ember {
+
+	// A non-owning view of a contiguous array, the C++17 stand-in for 'std::span' (dynamic extent only).
+	// Converts implicitly from 'std::vector' and C arrays, so it works as a parameter type for both.
+	template <typename T>
+	class Span {
+	public:
+		Span() = default;
+		Span(T* data, size_t size) : ptr{data}, count{size} {}
+		template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+		Span(std::vector<U>& vector) : ptr{vector.data()}, count{vector.size()} {}
+		template <typename U, typename = std::enable_if_t<std::is_convertible_v<const U (*)[], T (*)[]>>>
+		Span(const std::vector<U>& vector) : ptr{vector.data()}, count{vector.size()} {}
+		template <size_t N>
+		Span(T (&array)[N]) : ptr{array}, count{N} {}
+		template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+		Span(const Span<U>& other) : ptr{other.data()}, count{other.size()} {}
+
+		T* data() const { return ptr; }
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+
+		T* begin() const { return ptr; }
+		T* end() const { return ptr + count; }
+		T& operator[](size_t idx) const { return ptr[idx]; }
+
+		Span subspan(size_t offset, size_t subCount) const { return Span{ptr + offset, subCount}; }
+
+	private:
+		T* ptr{nullptr};
+		size_t count{0};
+	};
+
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <stack>
 #include <vector>
@@ -81,7 +82,7 @@ namespace ember {
 			freeIds.push(id);
 		}
 		bool IsIdValid(IdType id) const {
-			return (id > 0) && (id < idCounter)
+			return (id > 0) && (id < idCounter);
 		}
 
 	private:
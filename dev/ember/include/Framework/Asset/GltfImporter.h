@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Core/MappedFile.h"
+#include "Core/Span.h"
+#include "Core/Util.h"
+#include "Framework/Asset/Mesh.h"
+
+#include "Vec.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ember {
+
+	class JsonValue;
+
+	struct GltfImportSettings {
+		// The primitives are split between the worker threads (see 'ParallelFor()'),
+		// a thread gets at least this many of them.
+		size_t minPrimitivesPerThread{1};
+		// Generated with 'Mesh::GenerateNormals()' (smooth, while glTF asks for flat normals, so a primitive that
+		// should look faceted needs its vertices unwelded), and with 'Mesh::GenerateTangents()' (needs normals and uvs).
+		bool generateMissingNormals{false};
+		bool generateMissingTangents{false};
+	};
+
+	// A glTF primitive is a mesh of its own here, a glTF mesh with several primitives gives several meshes.
+	struct GltfImportedMesh {
+		std::unique_ptr<Mesh> mesh;
+		// "<glTF mesh name>" or "<glTF mesh name>#<primitive index>" if the mesh has more than one primitive.
+		std::string name;
+		uint32_t gltfMeshIdx{0};
+		uint32_t gltfPrimitiveIdx{0};
+		// -1 if the primitive has no material.
+		int32_t gltfMaterialIdx{-1};
+	};
+
+	// Imports the meshes of a glTF 2.0 file (.gltf with external or embedded buffers, or .glb).
+	// The nodes, the materials and the animations aren't imported (yet).
+	//
+	// The buffers are memory-mapped, and the meshes view them directly (see 'Mesh::SetDataView()')
+	// whenever an accessor already has the layout of the 'Mesh' array: 32-bit float positions/normals (VEC3),
+	// tangents (VEC4), uvs (VEC2) and 32-bit indices, tightly packed. Everything else (interleaved buffer views,
+	// the integer and normalized formats, 4 component colors, 8/16-bit indices) is decoded into a copy owned by
+	// the importer. So the importer has to outlive the meshes, or at least their first modifications
+	// (a mesh copies a view once it's modified).
+	//
+	// The primitives are decoded in parallel, the meshes are created and finished on the calling thread
+	// (that's where the GPU API context is).
+	class GltfImporter {
+	public:
+		GltfImporter() = default;
+		~GltfImporter() = default;
+		CLASS_NO_COPY(GltfImporter);
+		CLASS_NO_MOVE(GltfImporter);
+
+		// Returns 'false' if the file (or one of its buffers) can't be read or isn't valid glTF 2.0.
+		// A primitive that can't be imported (e.g. an unsupported topology) is skipped,
+		// the rest of the file is still imported, see 'GetWarnings()'.
+		bool Import(const std::string& path, const GltfImportSettings& settings = GltfImportSettings{});
+
+		std::vector<GltfImportedMesh>& GetMeshes();
+		const std::string& GetError() const;
+		const std::vector<std::string>& GetWarnings() const;
+
+	private:
+		// Converted copies of the accessors of a primitive, the empty ones are views of the buffers.
+		struct DecodedPrimitive {
+			std::vector<numa::Vec3> positions;
+			std::vector<numa::Vec3> normals;
+			std::vector<numa::Vec4> tangents;
+			std::vector<numa::Vec3> colors;
+			std::vector<numa::Vec2> uvs;
+			std::vector<uint32_t> indices;
+		};
+
+		void Reset();
+		// 'glbBinChunk' is the buffer without a URI, if the file is a .glb.
+		bool LoadBuffers(const JsonValue& document, const std::string& path, Span<const char> glbBinChunk);
+
+		std::vector<GltfImportedMesh> meshes;
+		std::vector<DecodedPrimitive> decodedPrimitives;
+
+		// The .gltf/.glb file itself and the external buffers.
+		std::vector<MappedFile> mappedFiles;
+		// The base64 buffers embedded in data URIs.
+		std::vector<std::vector<char>> embeddedBuffers;
+		// Indexed by the glTF buffer index.
+		std::vector<Span<const char>> buffers;
+
+		std::string error;
+		std::vector<std::string> warnings;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Framework/Asset/Vertex.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ember {
+
+	struct IndexStreamStat {
+		uint32_t maxIndex{0};
+		// The number of indices that form complete primitives. The rest of the stream (if any) is incomplete.
+		size_t completeIndexCount{0};
+	};
+
+	// A single vectorized pass over the index stream. 'multiplicity' is the number of indices
+	// per primitive (see 'GetIndexMultiplicity()'), 0 means that any index count is complete.
+	IndexStreamStat ScanIndices(const uint32_t* indices, size_t indexCount, uint32_t multiplicity);
+
+	// The smallest format that can store 'maxIndex'.
+	// UINT8 is only picked if allowed, since not every API supports it (Vulkan needs 'VK_EXT_index_type_uint8').
+	IndexFormat PickNarrowestIndexFormat(uint32_t maxIndex, bool allowUint8);
+
+	// Writes 'indexCount' indices to 'dst' in the given format.
+	// Every index must fit into the destination format, nothing is clamped.
+	void PackIndices(const uint32_t* indices, size_t indexCount, IndexFormat dstFormat, char* dst);
+
+}
\ No newline at end of file
@@ -1,15 +1,27 @@
 #pragma once
 
+#include "Core/Span.h"
 #include "Core/Util.h"
+#include "Framework/Asset/IndexKernels.h"
+#include "Framework/Asset/MeshAttribArray.h"
+#include "Framework/Asset/MeshAttribBlock.h"
+#include "Framework/Asset/MeshBvh.h"
+#include "Framework/Asset/MeshOptimizer.h"
+#include "Framework/Asset/MeshSimplifier.h"
+#include "Framework/Asset/MeshTangentSpace.h"
+#include "Framework/Asset/MeshWelder.h"
+#include "Framework/Asset/MeshletBuilder.h"
 #include "Framework/Asset/Vertex.h"
+#include "Framework/Asset/VertexKernels.h"
 
 #include "Vec.hpp"
 #include "Shape.h"
 
+#include <array>
 #include <cstdint>
 #include <functional>
 #include <string>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace ember {
@@ -28,6 +40,8 @@ namespace ember {
 
 		VertexBufferInfo vbInfo{};
 		IndexBufferInfo ibInfo{};
+		// Empty if the mesh wasn't split into clusters (see 'Mesh::BuildMeshlets()').
+		std::vector<Meshlet> meshlets;
 
 		MeshTopology meshTopology{};
 
@@ -42,6 +56,30 @@ namespace ember {
 
 	uint32_t GetIndexMultiplicity(MeshTopology meshTopology);
 
+	// The vertices (indices) [begin, end) that changed since the GPU data was last updated.
+	// Separate changes are merged into the smallest range that covers all of them.
+	struct MeshDirtyRange {
+		void Add(uint32_t first, uint32_t count);
+		void Add(const MeshDirtyRange& other);
+		bool IsEmpty() const;
+		uint32_t GetCount() const;
+
+		uint32_t begin{0};
+		uint32_t end{0};
+	};
+
+	// Mesh data that lives outside of the mesh, see 'Mesh::SetDataView()'.
+	// The empty spans are the channels that aren't used, the positions are required.
+	struct MeshDataView {
+		Span<const numa::Vec3> positions;
+		Span<const numa::Vec3> normals;
+		// 'w' is the handedness, the bitangent is 'w * cross(normal, tangent)'.
+		Span<const numa::Vec4> tangents;
+		Span<const numa::Vec3> colors;
+		Span<const numa::Vec2> uvs;
+		Span<const uint32_t> indices;
+	};
+
 	class MeshEventNotifier {
 	public:
 		virtual void OnVertexBufferUpdate() = 0;
@@ -56,36 +94,177 @@ namespace ember {
 		CLASS_NO_COPY(Mesh);
 		CLASS_DEFAULT_MOVE(Mesh);
 
-		void SetPositions(const std::vector<numa::Vec3>& positions);
-
-		void SetNormals(const std::vector<numa::Vec3>& normals);
+		// Between 'BeginEdit()' and 'EndEdit()' the mesh only remembers what has to be updated: the object AABB,
+		// the GPU settings/vertex/index data, and the change notification. 'EndEdit()' then does each one of
+		// them once, no matter how many setters were called. Edits can be nested, the outermost 'EndEdit()'
+		// does the updates. 'GetObjectAABB()' (and everything that depends on it) is stale until then.
+		// See 'MeshEditScope' as well.
+		void BeginEdit();
+		void EndEdit();
+		bool IsBeingEdited() const;
+
+		// The 'Span' versions copy (a 'std::vector' converts implicitly). The 'std::vector&&' versions take
+		// the vector over instead, the array becomes exactly that vector (resized to the vertex count for the
+		// optional channels). The positions set the vertex count in that case, even if it gets smaller.
+		void SetPositions(Span<const numa::Vec3> positions);
+		void SetPositions(std::vector<numa::Vec3>&& positions);
+
+		void SetNormals(Span<const numa::Vec3> normals);
+		void SetNormals(std::vector<numa::Vec3>&& normals);
 		void ResetNormals();
 		bool HasNormals() const;
 
-		void SetTangents(const std::vector<numa::Vec3>& tangents);
+		// 'w' is the handedness (1 or -1), the bitangent is 'w * cross(normal, tangent)'. A vertex layout with
+		// 3 component tangents (see 'SetVertices()') gets a 'w' of 1.
+		void SetTangents(Span<const numa::Vec4> tangents);
+		void SetTangents(std::vector<numa::Vec4>&& tangents);
 		void ResetTangents();
 		bool HasTangents() const;
 
-		void SetColors(const std::vector<numa::Vec3>& colors);
+		void SetColors(Span<const numa::Vec3> colors);
+		void SetColors(std::vector<numa::Vec3>&& colors);
 		void ResetColors();
 		bool HasColors() const;
 
-		void SetUvs(const std::vector<numa::Vec2>& uvs);
+		void SetUvs(Span<const numa::Vec2> uvs);
+		void SetUvs(std::vector<numa::Vec2>&& uvs);
 		void ResetUvs();
 		bool HasUvs() const;
 
+		// 'Vertex::layout' is known at compile time, so the vertices are split by a copy specialized for it
+		// instead of going through the per-attribute conversion kernels.
+		template <typename Vertex>
+		void SetVertices(Span<const Vertex> vertices) {
+			uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+			BeginSetVertices({Vertex::layout.attributes.data(), Vertex::layout.attributes.size()}, vertexCount);
+			SetStaticVertexAttribArrayData(vertices.data(), vertexCount, std::make_index_sequence<Vertex::layout.attributes.size()>{});
+			EndSetVertices();
+		}
 		template <typename Vertex>
 		void SetVertices(const std::vector<Vertex>& vertices) {
-			SetVertices(vertices.data(), static_cast<uint32_t>(vertices.size()), Vertex::attributes);
+			SetVertices(Span<const Vertex>{vertices});
 		}
 		void SetVertices(const void* src, uint32_t vertexCount, const std::vector<VertexAttribDescriptor>& layout);
 
-		void SetIndices(const std::vector<uint32_t>& indices);
+		void SetIndices(Span<const uint32_t> indices);
+		void SetIndices(std::vector<uint32_t>&& indices);
 		void ResetIndices();
 		bool HasIndices() const;
 
+		// Replaces all of the mesh data with views of the external memory, nothing is copied.
+		// The memory has to stay valid and unchanged for as long as the mesh reads it: until the mesh is destroyed,
+		// or until the array is modified (the first modification copies it, the external memory is never written).
+		// The optional channels must have as many elements as the positions, or be empty.
+		void SetDataView(const MeshDataView& dataView);
+		// The same, with the object AABB (padded) and the largest index known up front (e.g. from a cooked mesh),
+		// so neither the positions nor the indices are scanned. They have to match the data.
+		void SetDataView(const MeshDataView& dataView, const numa::AABB& objectAABB, uint32_t maxIndex);
+		// 'true' while any of the arrays still references external memory.
+		bool IsDataView() const;
+		// The arrays as they are (the optional ones are empty if not in use). Valid until the mesh changes.
+		MeshDataView GetDataView() const;
+
+		// Partial updates, for the dynamic meshes that change a few vertices (indices) at a time.
+		// Only the changed range is sent to the GPU (see 'GetDirtyVertexRange()'). The channel must already be
+		// in use and the range must fit the current vertex (index) count, the 'Set*()' methods handle the rest.
+		// The object AABB only grows here, it's recomputed from scratch by the 'Set*()' methods only.
+		void UpdatePositions(uint32_t firstVertex, const numa::Vec3* positions, uint32_t count);
+		void UpdateNormals(uint32_t firstVertex, const numa::Vec3* normals, uint32_t count);
+		void UpdateTangents(uint32_t firstVertex, const numa::Vec4* tangents, uint32_t count);
+		void UpdateColors(uint32_t firstVertex, const numa::Vec3* colors, uint32_t count);
+		void UpdateUvs(uint32_t firstVertex, const numa::Vec2* uvs, uint32_t count);
+		void UpdateIndices(uint32_t firstIndex, const uint32_t* indices, uint32_t count);
+
+		// What the partial updates changed and the GPU doesn't have yet. Meant for the GPU API
+		// context, which gets the union of the channels in 'OnMeshVertexBufferRangeUpdate()'.
+		// Empty again once the GPU data is updated (partially or fully).
+		MeshDirtyRange GetDirtyVertexRange(VertexAttribChannel channel) const;
+		MeshDirtyRange GetDirtyVertexRange() const;
+		MeshDirtyRange GetDirtyIndexRange() const;
+
+		// Collapses the vertices whose attributes (of every channel in 'GetAttributesMask()') are the same,
+		// and rewrites the indices accordingly. A non-indexed mesh becomes an indexed one.
+		// Positions closer than 'positionEpsilon' are welded as well (approximately, see 'VertexWeldStream').
+		// Returns the number of vertices left. Does nothing if an index is out of bounds.
+		uint32_t WeldVertices(float positionEpsilon = 0.0f);
+
+		// Computes smooth normals (MikkTSpace tangents, see 'GenerateVertexTangents()') from the triangles,
+		// straight into the normal (tangent) array, the channel is added if it isn't in use yet.
+		// Works with the TRIANGLES topology only, the tangents need the normals and the uvs.
+		// Returns 'false' if they can't be generated, the mesh isn't modified in that case.
+		bool GenerateNormals(NormalWeighting weighting = NormalWeighting::ANGLE);
+		bool GenerateTangents();
+		// The incremental versions, for the deformed meshes: once 'UpdatePositions()' (or 'UpdateUvs()') moved
+		// 'dirtyVertices', only the normals (tangents) around them are recomputed, and only their range is sent
+		// to the GPU. The channel must already be in use, and the normals have to be regenerated before the tangents.
+		// The vertex -> triangle adjacency is kept from one call to the next, until the indices change.
+		bool RegenerateNormals(Span<const uint32_t> dirtyVertices, NormalWeighting weighting = NormalWeighting::ANGLE);
+		bool RegenerateTangents(Span<const uint32_t> dirtyVertices);
+
+		// Reorders the triangles for the vertex cache and overdraw, and the vertices for fetch locality.
+		// Works with the TRIANGLES topology only. The mesh looks exactly the same afterwards,
+		// but the order of the vertices (and so the vertex indices) changes.
+		MeshOptimizeReport Optimize(const MeshOptimizeSettings& settings = MeshOptimizeSettings{});
+
+		// Splits the triangles into clusters with their own bounds and normal cones, so they can be culled
+		// one by one. The indices are reordered to make every cluster a contiguous index range.
+		// Works with the TRIANGLES topology only. Returns 'false' if the mesh can't be clustered.
+		// The clusters are dropped whenever the indices, the positions or the topology change,
+		// so this should be the last step of the processing (after 'Optimize()').
+		bool BuildMeshlets(const MeshletSettings& settings = MeshletSettings{});
+		const std::vector<Meshlet>& GetMeshlets() const;
+		bool HasMeshlets() const;
+
+		// Generates a chain of simplified levels of detail (see 'SimplifyMesh()'). The levels share the vertex buffer,
+		// and their indices are stored right after the full detail ones in the index buffer (see 'IndexBufferInfo::lods').
+		// Works with the TRIANGLES topology only. Returns the number of levels including the full detail one,
+		// 0 if the mesh couldn't be simplified. The levels are dropped whenever the indices, the positions
+		// or the topology change.
+		uint32_t GenerateLods(const MeshLodSettings& settings = MeshLodSettings{});
+		const std::vector<IndexBufferLod>& GetLods() const;
+		// The indices of the levels after the full detail one (see 'IndexBufferLod::indexOffset').
+		Span<const uint32_t> GetLodIndices() const;
+
+		// Restores what 'BuildMeshlets()' and 'GenerateLods()' produced for the current data (e.g. from a mesh cache)
+		// instead of building it again. Nothing is validated, it has to match the current vertices and indices.
+		// Dropped on the same changes as the built ones.
+		void SetMeshletsAndLods(Span<const Meshlet> meshlets, Span<const IndexBufferLod> lods, Span<const uint32_t> lodIndices);
+		// Ready-made GPU buffers of the current data (e.g. of a cooked mesh): exactly what 'ConstructMeshVertexBuffer()'
+		// builds in 'vbLayout', and what 'ConstructMeshIndexBuffer()' builds in 'ibFormat' (the LOD chain included).
+		// They're copied as they are while the requested layout (index format) is the same, instead of being built.
+		// The memory has to stay valid the same way as for 'SetDataView()'. Any change of the vertices (indices) drops them.
+		void SetGpuBufferViews(Span<const char> vertexBuffer, const std::vector<VertexAttribDescriptor>& vbLayout,
+		                       Span<const char> indexBuffer, IndexFormat ibFormat);
+
+		// Builds a BVH over the triangles for the ray queries (see 'MeshBvh'). Works with the TRIANGLES topology only.
+		// The position changes refit it (at the end of the edit, if the mesh is being edited), anything that changes
+		// the triangles (the indices, the topology, the order or the count of the vertices) drops it.
+		// Returns 'false' if the mesh can't have one.
+		bool BuildBvh(const MeshBvhSettings& settings = MeshBvhSettings{});
+		void ResetBvh();
+		bool HasBvh() const;
+		const MeshBvh& GetBvh() const;
+
+		// 'ray' is in the space that 'world' transforms the mesh to (the same matrix as for 'ComputeWorldAABBPrecise()'),
+		// the query itself is done in the object space. The distances stay in the units of 'ray.direction'.
+		// Returns 'false' if there's no BVH, if the matrix can't be inverted, or if nothing was hit.
+		bool RayCastClosest(const MeshRay& ray, const numa::Mat4& world, MeshRayHit& hit) const;
+		bool RayCastAny(const MeshRay& ray, const numa::Mat4& world) const;
+
 		std::vector<char> ConstructMeshVertexBuffer() const;
 		std::vector<char> ConstructMeshIndexBuffer() const;
+		// Just the vertices [firstVertex, firstVertex + vertexCount) of the vertex buffer,
+		// to be written at the byte offset 'firstVertex * GetVertexStride()'.
+		std::vector<char> ConstructMeshVertexBuffer(uint32_t firstVertex, uint32_t vertexCount) const;
+		// Same for the indices, the range may reach into the LOD chain.
+		std::vector<char> ConstructMeshIndexBuffer(uint32_t firstIndex, uint32_t indexCount) const;
+		// The same, written to 'vb' (e.g. mapped memory) instead of a new vector. 'layout' is 'GetVertexAttribLayout()'.
+		void ConstructMeshVertexBuffer(char* vb, uint32_t firstVertex, uint32_t vertexCount,
+			                           const std::vector<VertexAttribDescriptor>& layout) const;
+		// The range covers the full detail indices followed by the LOD chain. 'ibFormat' can be wider than
+		// 'GetIndexFormat()', for the GPU APIs that don't take the narrow one.
+		void ConstructMeshIndexBuffer(char* ib, uint32_t firstIndex, uint32_t indexCount,
+			                          IndexFormat ibFormat) const;
 
 		MeshStat GetMeshStat() const;
 		VertexBufferInfo GetVertexBufferInfo() const;
@@ -109,6 +288,14 @@ namespace ember {
 		// Doesn't set the 'offset' member variable.
 		VertexAttribDescriptor GetDefaultUvVertexAttribDescriptor() const;
 
+		// Positions stored as UNORM16 relative to the object's AABB. Takes 8 bytes per vertex instead of 12
+		// (4 components, 3 component 16-bit formats aren't widely supported as vertex formats).
+		// Doesn't set the 'offset' member variable.
+		VertexAttribDescriptor GetQuantizedPositionVertexAttribDescriptor() const;
+
+		// Returns 'false' if the channel has no default descriptor (isn't stored on the CPU side).
+		bool GetDefaultVertexAttribDescriptor(VertexAttribDescriptor& attribDesc, VertexAttribChannel channel) const;
+
 		uint32_t GetAttributesMask() const;
 
 		const numa::AABB& GetObjectAABB() const;
@@ -120,6 +307,13 @@ namespace ember {
 
 		void SetObjectAABBPadding(float padding);
 		void SetObjectAABBPadding(const numa::Vec3& padding);
+		const numa::Vec3& GetObjectAABBPadding() const;
+
+		// When enabled, the vertex buffer stores positions relative to the object AABB (see 'VertexBufferInfo')
+		// and the position vertex attribute descriptor is overridden. The CPU side positions stay the same.
+		// Good for static geometry where the precision within the object's bounds (1/65535 of its size) is enough.
+		void SetPositionQuantization(bool quantizePositions);
+		bool ArePositionsQuantized() const;
 
 		void SetVertexCount(size_t vertexCount);
 		size_t GetVertexCount() const;
@@ -135,9 +329,16 @@ namespace ember {
 		void SetCullBackFaceState(bool cullBackFaces);
 		bool CullBackFaces() const;
 
+		// Disables the automatic index format narrowing.
 		void SetIndexFormat(IndexFormat format);
 		IndexFormat GetIndexFormat() const;
 
+		// When enabled (the default), the narrowest index format that fits the biggest index
+		// is picked every time the indices change. UINT8 is opt-in, not every GPU API supports it.
+		void SetIndexFormatAutoNarrowing(bool autoNarrowing, bool allowUint8 = false);
+		bool IsIndexFormatAutoNarrowingEnabled() const;
+		uint32_t GetMaxIndex() const;
+
 		uint32_t GetMeshId() const;
 
 		void MakeDynamic();
@@ -151,33 +352,96 @@ namespace ember {
 		void OnGpuMeshDataUpdate();
 
 	private:
+		enum MeshUpdateFlags : uint32_t {
+			MESH_UPDATE_AABB = 1 << 0,
+			MESH_UPDATE_GPU_SETTINGS = 1 << 1,
+			MESH_UPDATE_GPU_VERTEX_DATA = 1 << 2,
+			MESH_UPDATE_GPU_INDEX_DATA = 1 << 3,
+			MESH_UPDATE_NOTIFICATION = 1 << 4,
+			// Only the dirty ranges, a full update of the same data makes them redundant.
+			MESH_UPDATE_GPU_VERTEX_RANGE = 1 << 5,
+			MESH_UPDATE_GPU_INDEX_RANGE = 1 << 6,
+			MESH_UPDATE_BVH = 1 << 7,
+		};
+		// Returns 'true' if the mesh is being edited, the updates are postponed until 'EndEdit()' in that case.
+		bool DeferUpdates(uint32_t updates) const;
+
 		void SendMeshChangedEventNotifications() const;
 
 		void OnVertexDataUpdated() const;
 		void OnIndexDataUpdated() const;
 		void OnMeshSettingsUpdated() const;
 		void OnMeshDataUpdated() const;
+		void OnVertexDataRangeUpdated(VertexAttribChannel channel, uint32_t firstVertex, uint32_t count) const;
+		void OnIndexDataRangeUpdated(uint32_t firstIndex, uint32_t count) const;
 
+		// Fits the optional arrays to the vertex count (or to nothing, for the channels that aren't in the layout).
 		void ResizeVertexAttribArrays();
+		// Lays 'attribBlock' out again for the new vertex and index counts. Every array keeps its common part,
+		// the new elements are zeroed. The views and the adopted vectors stay where they are,
+		// unless their size changes or they're in 'detachSlotsMask' (bits of 'MeshAttribSlot').
+		void ResizeAttribArrays(size_t vertexCount, size_t indexCount, uint32_t detachSlotsMask = 0);
+		// Moves a view into the block first, the external memory is never written.
+		template <typename T>
+		T* GetMutableAttribData(MeshAttribArray<T>& attribArray);
+
+		// The shared head of the 'SetDataView()' versions, the arrays become the views.
+		void ViewDataArrays(const MeshDataView& dataView);
+		// The shared tail of the 'SetIndices()' versions and 'SetDataView()', once the indices are in place.
+		void OnIndicesReplaced();
+		// Adds the channel with its default descriptor, unless it's in the layout already.
+		void UseVertexAttribChannel(VertexAttribChannel channel);
+
+		bool HasVertexAttribChannel(VertexAttribChannel channel) const;
+		void StoreVertexAttribDescriptor(const VertexAttribDescriptor& vertAttribDesc);
+		void EraseVertexAttribDescriptor(VertexAttribChannel channel);
+		// The descriptor that the channel has in the vertex buffer (e.g. quantized positions).
+		// POSITION is always there, even if it's missing from the layout.
+		bool GetVertexBufferAttribDescriptor(VertexAttribDescriptor& attribDesc, VertexAttribChannel channel) const;
 
 		// Sets the attribute descriptors and ensures that the layout is valid.
 		// If there's an invalid attribute descriptor, its corresponding default version is used instead.
-		void SetVertexAttribLayoutMap(const std::vector<VertexAttribDescriptor>& vertAttribLayout);
+		void SetVertexAttribLayoutMap(Span<const VertexAttribDescriptor> vertAttribLayout);
+
+		// The shared parts of the 'SetVertices()' versions, before and after the arrays are written.
+		void BeginSetVertices(Span<const VertexAttribDescriptor> layout, uint32_t vertexCount);
+		void EndSetVertices();
+
+		bool IndicesOutOfBound(const IndexStreamStat& indexStat, std::vector<uint32_t>* outOfBoundIndices = nullptr);
+		bool IndicesIncomplete(const IndexStreamStat& indexStat, std::vector<uint32_t>* incompleteIndices = nullptr);
+
+		void ApplyIndexFormatNarrowing();
+
+		// Both are derived from the indices and the positions.
+		void ResetMeshletsAndLods();
 
-		void ResizeNormalVertexAttribArray(uint32_t size);
-		void ResizeTangentVertexAttribArray(uint32_t size);
-		void ResizeColorVertexAttribArray(uint32_t size);
-		void ResizeUvVertexAttribArray(uint32_t size);
+		// Follows the new positions, or drops the BVH if the vertex count changed.
+		void RefitBvh();
 
-		bool IndicesOutOfBound(std::vector<uint32_t>* outOfBoundIndices = nullptr);
-		bool IndicesIncomplete(std::vector<uint32_t>* incompleteIndices = nullptr);
+		bool CanGenerateTangentSpace() const;
+		// The triangles of the tangent space generation ('indexCount' is a multiple of 3), with 'triangleAdjacency'
+		// built for them. A non-indexed mesh gets the indices 0, 1, 2, ... Call after the arrays are resized,
+		// a resize can move the indices.
+		const uint32_t* PrepareTriangleAdjacency(size_t& indexCount);
+		// The adjacency depends on the indices only, every index update drops it.
+		void ResetTriangleAdjacency() const;
 
 		void ReportOutOfBoundIndices(const std::vector<uint32_t>& outOfBoundIndices);
 		void ReportIncompleteIndices(const std::vector<uint32_t>& incompleteIndices);
 
+		// Recomputes the AABB, or postpones it if the mesh is being edited.
+		void UpdateObjectAABB();
+		// For the methods that need the AABB in the middle of an edit.
+		void ResolvePendingObjectAABB();
 		void ComputeObjectAABB();
+		// Grows the AABB to include the given positions (padded). Returns 'false' if they were inside already.
+		bool GrowObjectAABB(uint32_t firstVertex, uint32_t count);
 		void ApplyObjectAABBPadding(numa::Vec3& min, numa::Vec3& max) const;
 
+		// The AABB relative remap that maps positions into the [0, 1] range.
+		VertexAttribRemap GetPositionQuantizationRemap() const;
+		void GetPositionDequantization(numa::Vec3& scale, numa::Vec3& offset) const;
+
 		// I/O methods.
 
 		bool FormatConversionPossible(VertexAttribFormat srcFormat,
@@ -189,49 +453,113 @@ namespace ember {
 
 		void UpdateGpuMeshVertexData() const;
 		void UpdateGpuMeshIndexData() const;
-
-		void ConstructMeshVertexBuffer(char* vb, uint32_t vertexCount,
-			                           const std::vector<VertexAttribDescriptor>& layout) const;
-		void ConstructMeshIndexBuffer(char* ib, uint32_t indexCount,
-			                          IndexFormat ibFormat) const;
+		void UpdateGpuMeshVertexRange() const;
+		void UpdateGpuMeshIndexRange() const;
 
 		void UpdateGpuMeshSettings() const;
 
-		void WriteSrcAttribToDstBuffer(const VertexAttribDescriptor& dstAttribDesc, char* dstBuffer, uint32_t vert) const;
-		void WriteSrcAttribToDstBuffer(const VertexAttribDescriptor& srcAttribDesc, const char* srcBuffer,
-			                           const VertexAttribDescriptor& dstAttribDesc, char* dstBuffer) const;
-
-		void WriteSrcIndexToDstBuffer(IndexFormat indexFormat, char* dstBuffer, uint32_t index) const;
+		// Returns an empty stream if the channel isn't stored on the CPU side.
+		VertexAttribStream GetVertexAttribStream(VertexAttribChannel channel) const;
+		// Copies a view into owned storage first, the external memory is never written.
+		float* GetVertexAttribArrayData(VertexAttribChannel channel);
 
 		void SetInternalVertexAttribArrayData(const void* src, uint32_t vertexCount,
 			                                  const std::vector<VertexAttribDescriptor>& layout);
+		// The kernels write a zero into the components the source doesn't have, a tangent without the handedness
+		// is taken as right-handed instead.
+		void FillMissingTangentHandedness(const VertexAttribDescriptor& srcAttribDesc);
+
+		// The floats per vertex of the CPU side array of the channel.
+		static constexpr uint32_t GetVertexAttribArrayComponents(VertexAttribChannel channel) {
+			switch (channel) {
+				case VertexAttribChannel::TANGENT:
+					return 4;
+				case VertexAttribChannel::UV0:
+					return 2;
+				default:
+					return 3;
+			}
+		}
 
-		void WriteSrcDataToAttribArray(const VertexAttribDescriptor& srcAttribDesc,
-			                           uint32_t vert, const char* srcBuffer);
-		void WriteSrcDataToAttribArray(const VertexAttribDescriptor& srcAttribDesc, const char* srcBuffer,
-			                           const VertexAttribDescriptor& dstAttribDesc, char* dstBuffer);
+		// True if the attribute has the exact shape of its CPU side array, so it can be copied as is.
+		static constexpr bool IsVertexAttribCopyable(const VertexAttribDescriptor& attribDesc) {
+			if (attribDesc.format != VertexAttribFormat::FLOAT32) {
+				return false;
+			}
+			switch (attribDesc.channel) {
+				case VertexAttribChannel::POSITION:
+				case VertexAttribChannel::NORMAL:
+				case VertexAttribChannel::COLOR:
+					return attribDesc.dimension == 3;
+				case VertexAttribChannel::TANGENT:
+					// With or without the handedness.
+					return attribDesc.dimension == 3 || attribDesc.dimension == 4;
+				case VertexAttribChannel::UV0:
+					return attribDesc.dimension == 2;
+				default:
+					return false;
+			}
+		}
+		template <typename Vertex, size_t... AttribIdx>
+		void SetStaticVertexAttribArrayData(const Vertex* src, uint32_t vertexCount, std::index_sequence<AttribIdx...>) {
+			static_assert((IsVertexAttribCopyable(Vertex::layout.attributes[AttribIdx]) && ...),
+			              "Every attribute of the vertex has to match its CPU side array!");
+			const char* vertexData = reinterpret_cast<const char*>(src);
+			(CopyFloatVertexAttrib<Vertex::layout.stride,
+			                       Vertex::layout.attributes[AttribIdx].offset,
+			                       Vertex::layout.attributes[AttribIdx].dimension,
+			                       GetVertexAttribArrayComponents(Vertex::layout.attributes[AttribIdx].channel)>(
+				vertexData, GetVertexAttribArrayData(Vertex::layout.attributes[AttribIdx].channel), vertexCount), ...);
+			(FillMissingTangentHandedness(Vertex::layout.attributes[AttribIdx]), ...);
+		}
 
-		void SendGpuMeshVertexBufferData(const void* vb) const;
-		void SendGpuMeshIndexBufferData(const void* ib) const;
 
-		std::unordered_map<VertexAttribChannel, VertexAttribDescriptor> vertAttribLayout;
+		// The channels of the vertex buffer, the ones after them are never stored on the CPU side.
+		static constexpr uint32_t vertexBufferChannelCount = static_cast<uint32_t>(VertexAttribChannel::UV0) + 1;
+
+		// Indexed by 'VertexAttribChannel', only the descriptors of the channels in 'vertAttribMask' are valid.
+		std::array<VertexAttribDescriptor, static_cast<size_t>(VertexAttribChannel::COUNT)> vertAttribLayout{};
+		uint32_t vertAttribMask{0};
 
 		CallbackStorage<uint32_t, std::function<void()>> meshChangedCallbackStorage;
 
 		std::string name;
 
-		std::vector<numa::Vec3> positions;
-		std::vector<numa::Vec3> normals;
-		std::vector<numa::Vec3> tangents;
-		std::vector<numa::Vec3> colors;
-		std::vector<numa::Vec2> uvs;
+		// All of the arrays below in a single allocation, except for the views and the adopted vectors.
+		MeshAttribBlock attribBlock;
+
+		MeshAttribArray<numa::Vec3> positions{MeshAttribSlot::POSITION};
+		MeshAttribArray<numa::Vec3> normals{MeshAttribSlot::NORMAL};
+		MeshAttribArray<numa::Vec4> tangents{MeshAttribSlot::TANGENT};
+		MeshAttribArray<numa::Vec3> colors{MeshAttribSlot::COLOR};
+		MeshAttribArray<numa::Vec2> uvs{MeshAttribSlot::UV0};
 
-		std::vector<uint32_t> indices;
+		MeshAttribArray<uint32_t> indices{MeshAttribSlot::INDEX};
+		// Index ranges of 'indices'.
+		std::vector<Meshlet> meshlets;
+		// The levels after the full detail one, one after another.
+		std::vector<uint32_t> lodIndices;
+		std::vector<IndexBufferLod> lods;
+
+		// See 'SetGpuBufferViews()'. Empty unless they match the arrays.
+		mutable Span<const char> vertexBufferView;
+		mutable Span<const char> indexBufferView;
+		std::vector<VertexAttribDescriptor> vertexBufferViewLayout;
+		IndexFormat indexBufferViewFormat{IndexFormat::UINT32};
+
+		MeshBvh bvh;
+
+		// Kept for the incremental tangent space updates, see 'PrepareTriangleAdjacency()'.
+		mutable VertexTriangleAdjacency triangleAdjacency;
+		std::vector<uint32_t> sequentialIndices;
 
 		numa::AABB objectAABB{};
 		numa::Vec3 aabbPadding{0.0f};
 
 		IndexFormat indexFormat{IndexFormat::UINT32};
+		uint32_t maxIndex{0};
+		bool autoNarrowIndexFormat{true};
+		bool allowUint8Indices{false};
 		MeshTopology meshTopology{MeshTopology::TRIANGLES};
 
 		uint32_t meshId{0};
@@ -241,8 +569,29 @@ namespace ember {
 		bool isDynamic{false};
 		bool cullBackFaces{true};
 		bool isTesselated{false};
+		bool quantizePositions{false};
 
 		bool autoUpdateGpuMeshData{true};
+
+		// Indexed by 'VertexAttribChannel'.
+		mutable MeshDirtyRange dirtyVertexRanges[static_cast<size_t>(VertexAttribChannel::COUNT)];
+		mutable MeshDirtyRange dirtyIndexRange{};
+
+		uint32_t editDepth{0};
+		// 'MeshUpdateFlags', the updates postponed until the end of the edit.
+		mutable uint32_t pendingUpdates{0};
+	};
+
+	// Keeps the mesh in the edit mode (see 'Mesh::BeginEdit()') for the lifetime of the scope.
+	class MeshEditScope {
+	public:
+		explicit MeshEditScope(Mesh& mesh);
+		~MeshEditScope();
+		CLASS_NO_COPY(MeshEditScope);
+		CLASS_NO_MOVE(MeshEditScope);
+
+	private:
+		Mesh& mesh;
 	};
 
 }
\ No newline at end of file
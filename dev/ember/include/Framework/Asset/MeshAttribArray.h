@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Core/Span.h"
+#include "Core/Util.h"
+#include "Framework/Asset/MeshAttribBlock.h"
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ember {
+
+	// A single vertex attribute (or index) array of a mesh. The elements are in one of three places:
+	// 
+	// - The mesh's 'MeshAttribBlock', the usual case. The array just points into it, the mesh rebinds it
+	//   whenever the block is laid out again.
+	// - A vector the mesh took over ('Mesh::SetPositions(std::vector&&)' and the like), owned by the array.
+	// - Memory that belongs to someone else (a memory-mapped file, a loader's buffer), see 'Mesh::SetDataView()'.
+	//   A view is read-only, the mesh moves it into the block before the first modification.
+	// 
+	// The read accessors mirror 'std::vector', so the code that only reads doesn't care which one it is.
+	template <typename T>
+	class MeshAttribArray {
+		static_assert(std::is_trivially_destructible_v<T>, "The block never runs destructors!");
+
+	public:
+		using ValueType = T;
+
+		explicit MeshAttribArray(MeshAttribSlot slot) : slot{slot} {}
+		~MeshAttribArray() = default;
+		CLASS_NO_COPY(MeshAttribArray);
+		MeshAttribArray(MeshAttribArray&& move) noexcept {
+			*this = std::move(move);
+		}
+		MeshAttribArray& operator=(MeshAttribArray&& move) noexcept {
+			// Moving a vector keeps its buffer, so 'ownedData' stays valid.
+			adopted = std::move(move.adopted);
+			ownedData = move.ownedData;
+			viewData = move.viewData;
+			count = move.count;
+			slot = move.slot;
+			isView = move.isView;
+			inBlock = move.inBlock;
+			move.Reset();
+			return *this;
+		}
+
+		void Bind(T* blockData, size_t size) {
+			Reset();
+			ownedData = blockData;
+			count = size;
+			inBlock = true;
+		}
+		void Adopt(std::vector<T>&& src) {
+			Reset();
+			adopted = std::move(src);
+			ownedData = adopted.data();
+			count = adopted.size();
+		}
+		void View(Span<const T> src) {
+			Reset();
+			viewData = src.data();
+			count = src.size();
+			isView = true;
+		}
+		void Reset() {
+			adopted = std::vector<T>{};
+			ownedData = nullptr;
+			viewData = nullptr;
+			count = 0;
+			isView = false;
+			inBlock = false;
+		}
+
+		MeshAttribSlot GetSlot() const { return slot; }
+		bool IsView() const { return isView; }
+		bool IsInBlock() const { return inBlock; }
+
+		// Not for views, see 'Mesh::GetMutableAttribData()'.
+		T* GetMutableData() {
+			assert(!isView && "The external memory of a view must not be written!");
+			return ownedData;
+		}
+
+		const T* data() const { return isView ? viewData : ownedData; }
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+
+		const T* begin() const { return data(); }
+		const T* end() const { return data() + count; }
+		const T& operator[](size_t idx) const { return data()[idx]; }
+
+		operator Span<const T>() const { return Span<const T>{data(), count}; }
+
+	private:
+		std::vector<T> adopted;
+		T* ownedData{nullptr};
+		const T* viewData{nullptr};
+		size_t count{0};
+		MeshAttribSlot slot{};
+		bool isView{false};
+		bool inBlock{false};
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Core/Util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ember {
+
+	// The arrays of a mesh that are stored in its 'MeshAttribBlock'.
+	// The vertex attribute ones go in the 'VertexAttribChannel' order.
+	enum class MeshAttribSlot : uint32_t {
+		POSITION,
+		NORMAL,
+		TANGENT,
+		COLOR,
+		UV0,
+		INDEX,
+		COUNT
+	};
+
+	// A single allocation split into slots that go one after another (SoA).
+	// Every slot starts on a cache line boundary, so every stream is aligned for any SIMD width.
+	// The slot offsets are computed once per allocation. The block never changes its size in place,
+	// a different set of sizes is a new block.
+	class MeshAttribBlock {
+	public:
+		static constexpr size_t alignment{64};
+		static constexpr uint32_t slotCount{static_cast<uint32_t>(MeshAttribSlot::COUNT)};
+
+		MeshAttribBlock() = default;
+		~MeshAttribBlock() = default;
+		CLASS_NO_COPY(MeshAttribBlock);
+		CLASS_DEFAULT_MOVE(MeshAttribBlock);
+
+		// The previous contents are released, the new slots are uninitialized. Empty slots take no space.
+		void Allocate(const size_t (&slotSizesInBytes)[slotCount]);
+		void Free();
+
+		void* GetSlotData(MeshAttribSlot slot) const;
+		size_t GetSlotOffset(MeshAttribSlot slot) const;
+		size_t GetSlotSizeInBytes(MeshAttribSlot slot) const;
+
+		// The whole block including the padding between the slots, it can be copied in one go.
+		const void* GetData() const;
+		size_t GetSizeInBytes() const;
+
+	private:
+		struct AlignedDeleter {
+			void operator()(std::byte* data) const;
+		};
+
+		std::unique_ptr<std::byte[], AlignedDeleter> data;
+		size_t slotOffsets[slotCount]{};
+		size_t slotSizes[slotCount]{};
+		size_t sizeInBytes{0};
+	};
+
+}
\ No newline at end of file
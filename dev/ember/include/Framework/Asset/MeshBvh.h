@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Vec.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ember {
+
+	struct MeshBvhSettings {
+		// The SAH is evaluated at the borders of this many bins of the triangle centroids, per axis.
+		uint32_t binCount{16};
+	};
+
+	// 'direction' doesn't have to be normalized, the distances along the ray are in its units.
+	struct MeshRay {
+		numa::Vec3 origin{0.0f};
+		numa::Vec3 direction{0.0f, 0.0f, 1.0f};
+		float tMin{0.0f};
+		float tMax{std::numeric_limits<float>::infinity()};
+	};
+
+	struct MeshRayHit {
+		// The hit point is 'origin + direction * t'.
+		float t{std::numeric_limits<float>::infinity()};
+		// The barycentric coordinates of the hit point relative to the 2nd and the 3rd vertex of the triangle.
+		float u{0.0f};
+		float v{0.0f};
+		// The indices of the triangle are 'indices[triangle * 3]' ... 'indices[triangle * 3 + 2]'.
+		uint32_t triangle{0};
+	};
+
+	// A bounding volume hierarchy over the triangles of a mesh, for the ray queries in the object space
+	// (picking, snapping). Built top-down with the binned SAH ("On fast Construction of SAH-based Bounding Volume
+	// Hierarchies", Wald 2007) and then collapsed into 4 wide nodes, so that the 4 children of a node are tested
+	// at once (SSE). The leaves are packets of up to 4 triangles, tested at once as well (Moller-Trumbore).
+	// Both sides of a triangle are hit.
+	//
+	// The triangles are copied into the packets, the hierarchy doesn't reference the mesh. 'Refit()' follows moved
+	// vertices (same triangles), the tree gets worse if they move a lot, it's better to build it again then.
+	class MeshBvh {
+	public:
+		// 'positions' are 3 floats per vertex, every index must be smaller than 'vertexCount'.
+		// An incomplete triangle at the end of 'indices' is ignored.
+		void Build(const uint32_t* indices, size_t indexCount, const float* positions, uint32_t vertexCount,
+		           const MeshBvhSettings& settings = MeshBvhSettings{});
+		// 'positions' must have the same vertex count as the one the tree was built for.
+		void Refit(const float* positions);
+		void Clear();
+
+		bool IsEmpty() const;
+		uint32_t GetVertexCount() const;
+		size_t GetTriangleCount() const;
+		size_t GetNodeCount() const;
+
+		// The closest hit in [ray.tMin, ray.tMax]. Returns 'false' if nothing was hit, 'hit' isn't changed then.
+		bool RayCastClosest(const MeshRay& ray, MeshRayHit& hit) const;
+		// Any hit in [ray.tMin, ray.tMax], the traversal stops at the first one.
+		bool RayCastAny(const MeshRay& ray) const;
+
+	private:
+		// The bounds of the 4 children in the structure of arrays form: min x, y, z and max x, y, z.
+		// A child is another node or a packet ('leafChildFlag'), the unused ones have empty bounds.
+		struct alignas(16) Node {
+			float bounds[6][4];
+			uint32_t children[4];
+		};
+		// The triangles as a vertex and two edges, every component for the 4 lanes at once.
+		// The unused lanes have zero edges, so they're never hit.
+		struct alignas(16) TrianglePacket {
+			float v0[3][4];
+			float e1[3][4];
+			float e2[3][4];
+		};
+		static constexpr uint32_t leafChildFlag{1u << 31};
+		static constexpr uint32_t emptyChild{~0u};
+
+		class Builder;
+		template <bool AnyHit>
+		bool Traverse(const MeshRay& ray, MeshRayHit& hit) const;
+		void UpdatePacket(uint32_t packetIdx, const float* positions);
+		void ComputePacketBounds(float min[3], float max[3], uint32_t packetIdx, const float* positions) const;
+
+		std::vector<Node> nodes;
+		std::vector<TrianglePacket> packets;
+		// 4 per packet, the triangle of every lane ('emptyChild' for the unused ones).
+		std::vector<uint32_t> packetTriangles;
+		// 12 per packet, the vertices of every lane (for the refit).
+		std::vector<uint32_t> packetVertices;
+		uint32_t vertexCount{0};
+		size_t triangleCount{0};
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Core/MappedFile.h"
+#include "Core/Span.h"
+#include "Framework/Asset/Mesh.h"
+#include "Framework/Asset/MeshAttribBlock.h"
+#include "Framework/Asset/Vertex.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ember {
+
+	// The cooked mesh format (.emesh). A fixed size header followed by the blobs, each of them
+	// starting on a 'MeshAttribBlock::alignment' boundary. Every blob is stored exactly the way it's
+	// used in memory (little endian), so a mapped file is used as is, nothing is parsed or converted.
+	// The format is versioned as a whole, a file of a different version is rejected (the source asset
+	// has to be cooked again).
+
+	constexpr char meshCacheMagic[4]{'E', 'M', 'S', 'H'};
+	constexpr uint32_t meshCacheVersion{2};
+
+	enum class MeshCacheBlobType : uint32_t {
+		// The CPU side arrays, in the 'MeshAttribSlot' order. The unused channels are empty.
+		POSITION,
+		NORMAL,
+		TANGENT,
+		COLOR,
+		UV0,
+		INDEX,
+		// 'Mesh::GetLodIndices()', 'Mesh::GetLods()' and 'Mesh::GetMeshlets()'.
+		LOD_INDEX,
+		LOD,
+		MESHLET,
+		// What 'Mesh::ConstructMeshVertexBuffer()' and 'Mesh::ConstructMeshIndexBuffer()' build,
+		// ready to be uploaded to the GPU as they are (see 'Mesh::SetGpuBufferViews()').
+		VERTEX_BUFFER,
+		INDEX_BUFFER,
+		COUNT
+	};
+
+	enum MeshCacheFlags : uint32_t {
+		MESH_CACHE_INDEXED = 1 << 0,
+		MESH_CACHE_DYNAMIC = 1 << 1,
+		MESH_CACHE_TESSELLATED = 1 << 2,
+		MESH_CACHE_CULL_BACK_FACES = 1 << 3,
+		MESH_CACHE_POSITIONS_QUANTIZED = 1 << 4,
+		MESH_CACHE_INDEX_AUTO_NARROWING = 1 << 5,
+	};
+
+	struct MeshCacheBlob {
+		// From the beginning of the file.
+		uint64_t offset{0};
+		uint64_t sizeInBytes{0};
+	};
+
+	// 'VertexAttribDescriptor' with the enums stored as fixed size integers.
+	struct MeshCacheVertexAttrib {
+		uint32_t dimension{0};
+		uint32_t offset{0};
+		uint32_t channel{0};
+		uint32_t format{0};
+	};
+
+	struct MeshCacheHeader {
+		char magic[4]{};
+		uint32_t version{0};
+		uint32_t headerSizeInBytes{0};
+		uint32_t flags{0};
+
+		// 'MeshStat'
+		uint32_t vertexCount{0};
+		uint32_t indexCount{0};
+		uint32_t vertexStride{0};
+		uint32_t attributesMask{0};
+		uint32_t meshTopology{0};
+		uint32_t patchVertexCount{0};
+		uint32_t indexFormat{0};
+		uint32_t maxIndex{0};
+		uint32_t lodCount{0};
+		uint32_t meshletCount{0};
+
+		// The layout of the mesh by channel ('Mesh::GetVertexAttribDescriptor()'),
+		// only the channels in 'vertexAttribMask' are valid.
+		uint32_t vertexAttribMask{0};
+		MeshCacheVertexAttrib vertexAttribs[static_cast<size_t>(VertexAttribChannel::COUNT)]{};
+		// The layout of the VERTEX_BUFFER blob ('Mesh::GetVertexAttribLayout()').
+		uint32_t vertexBufferAttribCount{0};
+		MeshCacheVertexAttrib vertexBufferAttribs[static_cast<size_t>(VertexAttribChannel::COUNT)]{};
+
+		// The padded object AABB, and the dequantization of the VERTEX_BUFFER positions (see 'VertexBufferInfo').
+		float aabbCenter[3]{};
+		float aabbRadius[3]{};
+		float aabbPadding[3]{};
+		float positionScale[3]{};
+		float positionOffset[3]{};
+
+		MeshCacheBlob blobs[static_cast<size_t>(MeshCacheBlobType::COUNT)]{};
+	};
+
+	// Cooks the mesh into a file. Returns 'false' if the file can't be written.
+	bool WriteMeshCache(const Mesh& mesh, const std::string& path);
+
+	// A mapped .emesh file. Opening it only checks the header and that the blobs fit the file,
+	// the blobs themselves are read (paged in) by whoever uses them.
+	class MeshCacheFile {
+	public:
+		// Returns 'false' if the file can't be mapped, or if it isn't a valid cache of the current version.
+		bool Open(const std::string& path);
+		void Close();
+		bool IsOpen() const;
+
+		const MeshCacheHeader& GetHeader() const;
+
+		// Views of the mapped file, valid while it's open.
+		Span<const char> GetBlob(MeshCacheBlobType blobType) const;
+		MeshDataView GetDataView() const;
+		Span<const char> GetVertexBuffer() const;
+		Span<const char> GetIndexBuffer() const;
+		VertexBufferInfo GetVertexBufferInfo() const;
+		IndexBufferInfo GetIndexBufferInfo() const;
+
+		// The mesh gets views of the file (see 'Mesh::SetDataView()'), so the file has to stay open
+		// for as long as the mesh reads them. Everything else is restored from the header as well,
+		// the meshlets, the LOD chain, the AABB and the largest index included, nothing is recomputed.
+		// The GPU uploads copy the vertex and the index buffer blobs while the mesh stays as it is.
+		void LoadMesh(Mesh& mesh) const;
+
+	private:
+		bool ValidateHeader() const;
+
+		template <typename T>
+		Span<const T> GetBlobAs(MeshCacheBlobType blobType) const {
+			Span<const char> blob = GetBlob(blobType);
+			return Span<const T>{reinterpret_cast<const T*>(blob.data()), blob.size() / sizeof(T)};
+		}
+
+		MappedFile file;
+		const MeshCacheHeader* header{nullptr};
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ember {
+
+	// Post-transform vertex cache statistics of an index buffer, simulated with a FIFO cache.
+	// ACMR - average cache miss ratio, the number of transformed vertices per triangle (0.5 - 3.0, lower is better).
+	// ATVR - average transformed vertex ratio, the number of transformed vertices per vertex (1.0 is the best).
+	struct VertexCacheStat {
+		uint32_t transformedVertexCount{0};
+		float acmr{0.0f};
+		float atvr{0.0f};
+	};
+
+	struct MeshOptimizeSettings {
+		// 16 is a reasonable guess, the exact size doesn't matter much as long as it isn't overestimated.
+		uint32_t vertexCacheSize{16};
+		float overdrawThreshold{1.05f};
+		bool optimizeVertexCache{true};
+		bool optimizeOverdraw{true};
+		bool optimizeVertexFetch{true};
+	};
+
+	struct MeshOptimizeReport {
+		VertexCacheStat before{};
+		VertexCacheStat after{};
+		// 'false' if the mesh couldn't be optimized (not indexed, not made of triangles, or has broken indices).
+		bool optimized{false};
+	};
+
+	// Vertex -> triangles adjacency in the CSR form: the triangles of vertex 'v'
+	// are 'triangles[offsets[v]]' ... 'triangles[offsets[v + 1] - 1]'.
+	struct VertexTriangleAdjacency {
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> triangles;
+		std::vector<uint32_t> counts;
+	};
+
+	// 'indexCount' must be a multiple of 3.
+	void BuildVertexTriangleAdjacency(VertexTriangleAdjacency& adjacency,
+	                                  const uint32_t* indices, size_t indexCount, uint32_t vertexCount);
+
+	VertexCacheStat AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, uint32_t vertexCount,
+	                                   uint32_t cacheSize);
+
+	// Reorders the triangles for post-transform vertex cache locality.
+	// Tipsify: "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" (Sander et al. 2007).
+	// 'dst' must have room for 'indexCount' indices and can't alias 'indices'.
+	void OptimizeVertexCache(uint32_t* dst, const uint32_t* indices, size_t indexCount, uint32_t vertexCount,
+	                         uint32_t cacheSize);
+
+	// Reorders clusters of triangles so that the ones facing away from the center of the mesh are drawn first
+	// (same paper as above). 'indices' must already be optimized for the vertex cache, the clusters are split
+	// where doing so keeps the ACMR within 'threshold' (1.05 allows it to get 5% worse).
+	// 'positions' are 3 floats per vertex, 'center' is the center of the mesh (the center of its AABB).
+	// 'dst' must have room for 'indexCount' indices and can't alias 'indices'.
+	void OptimizeOverdraw(uint32_t* dst, const uint32_t* indices, size_t indexCount,
+	                      const float* positions, uint32_t vertexCount, const float center[3],
+	                      uint32_t cacheSize, float threshold);
+
+	// Builds a remap table that puts the vertices in the order of their first use by the index buffer.
+	// 'remap[oldVertex]' is the new position of the vertex. Unreferenced vertices are moved to the end.
+	void OptimizeVertexFetchRemap(std::vector<uint32_t>& remap, const uint32_t* indices, size_t indexCount,
+	                              uint32_t vertexCount);
+
+	template <typename Attribute>
+	void RemapVertexAttribArray(Attribute* attribArray, size_t vertexCount, const std::vector<uint32_t>& remap) {
+		if (vertexCount == 0) {
+			return;
+		}
+		std::vector<Attribute> remapped(vertexCount);
+		for (size_t vert = 0; vert < vertexCount; vert++) {
+			remapped[remap[vert]] = attribArray[vert];
+		}
+		std::copy(remapped.begin(), remapped.end(), attribArray);
+	}
+	void RemapIndices(uint32_t* indices, size_t indexCount, const std::vector<uint32_t>& remap);
+
+}
\ No newline at end of file
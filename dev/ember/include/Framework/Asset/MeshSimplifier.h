@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ember {
+
+	struct MeshLodSettings {
+		// The triangle count of every level relative to the full detail mesh, in decreasing order.
+		std::vector<float> targetRatios{0.5f, 0.25f, 0.125f, 0.0625f};
+		// The error a level can have at most, relative to the size of the object (the biggest side of its AABB).
+		float maxError{0.05f};
+		// A level that isn't at least this much smaller than the previous one isn't worth it, and ends the chain.
+		float minReduction{0.1f};
+		// Reorders the vertices so that every level uses a prefix of the vertex buffer (coarser levels a shorter one).
+		// Lets the coarse levels be drawn (or kept resident) with a fraction of the vertex buffer.
+		bool compactVertices{false};
+	};
+
+	// Simplifies a triangle list to about 'targetIndexCount' indices (or less), with quadric error metric
+	// driven edge collapses ("Surface Simplification Using Quadric Error Metrics", Garland and Heckbert 1997).
+	// Vertices are only ever collapsed onto one of their neighbors, never moved, so the result uses
+	// a subset of the same vertex set and can share the vertex buffer with the original.
+	//
+	// Stops early once the next collapse would introduce an error bigger than 'maxError' (object space distance).
+	// Border vertices only slide along the border, and vertices that share their position with another vertex
+	// (attribute seams) are never collapsed, so neither borders nor seams open up.
+	// 
+	// 'positions' are 3 floats per vertex. 'dst' must have room for 'indexCount' indices and can alias 'indices'.
+	// Returns the number of indices written to 'dst'. The error of the result (the root of the mean squared
+	// distance to the original planes around the collapsed vertices, the worst one) goes to 'resultError'.
+	size_t SimplifyMesh(uint32_t* dst, const uint32_t* indices, size_t indexCount,
+	                    const float* positions, uint32_t vertexCount,
+	                    size_t targetIndexCount, float maxError, float* resultError = nullptr);
+
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Framework/Asset/MeshOptimizer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ember {
+
+	// How much a triangle contributes to the normals of its vertices.
+	// ANGLE (the angle at the corner) doesn't depend on how the surface is tessellated, AREA favors the big triangles.
+	enum class NormalWeighting {
+		AREA,
+		ANGLE,
+		AREA_ANGLE,
+	};
+
+	// All of the functions below work on triangle lists: 'positions' and 'normals' are 3 floats per vertex,
+	// 'tangents' 4 floats per vertex, 'uvs' 2 floats per vertex. Every index must be smaller than the vertex count, 'adjacency' must be built for
+	// the same indices (see 'BuildVertexTriangleAdjacency()'). Degenerate triangles are skipped.
+	//
+	// The triangles are processed in parallel chunks, and then every vertex sums its triangles in the order of
+	// the adjacency lists, so the result is deterministic (the same bits no matter how many threads there are).
+
+	// Smooth vertex normals, a vertex without a (non-degenerate) triangle gets a zero normal.
+	void GenerateVertexNormals(float* normals, const uint32_t* indices, size_t indexCount,
+	                           const float* positions, uint32_t vertexCount,
+	                           const VertexTriangleAdjacency& adjacency, NormalWeighting weighting);
+
+	// Tangents that match what MikkTSpace ("Simulation of Wrinkled Surfaces Revisited", Mikkelsen 2008) computes
+	// for a mesh that's already split along its UV seams: the triangle tangents are projected onto the plane of
+	// the vertex normal and summed with the angles at the corners as the weights, then normalized.
+	// The 4th component is the handedness, the bitangent is 'w * cross(normal, tangent)' (same as glTF).
+	// MikkTSpace would split a vertex shared by triangles with mirrored UVs, the vertices aren't split here,
+	// such a vertex gets the tangent and the handedness of the side with the bigger weight.
+	// A vertex without a usable triangle (degenerate in the UV space) gets an arbitrary tangent orthogonal to the normal.
+	void GenerateVertexTangents(float* tangents, const uint32_t* indices, size_t indexCount,
+	                            const float* positions, const float* normals, const float* uvs, uint32_t vertexCount,
+	                            const VertexTriangleAdjacency& adjacency);
+
+	// The incremental versions, for the meshes that are deformed a few vertices at a time.
+	// 'GatherTangentSpaceVertices()' finds the vertices whose normals/tangents depend on the moved ones
+	// (the vertices of every triangle that uses one of 'dirtyVertices'), sorted, every vertex once.
+	// Only those are recomputed by 'UpdateVertexNormals()'/'UpdateVertexTangents()', with the same results
+	// as generating all of them again. The tangents depend on the normals, those have to be updated first.
+	void GatherTangentSpaceVertices(std::vector<uint32_t>& vertices, const uint32_t* indices,
+	                                const VertexTriangleAdjacency& adjacency,
+	                                const uint32_t* dirtyVertices, size_t dirtyVertexCount);
+	void UpdateVertexNormals(float* normals, const uint32_t* indices, const float* positions,
+	                         const VertexTriangleAdjacency& adjacency, NormalWeighting weighting,
+	                         const uint32_t* vertices, size_t count);
+	void UpdateVertexTangents(float* tangents, const uint32_t* indices,
+	                          const float* positions, const float* normals, const float* uvs,
+	                          const VertexTriangleAdjacency& adjacency, const uint32_t* vertices, size_t count);
+
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Framework/Asset/VertexKernels.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ember {
+
+	struct VertexWeldStream {
+		VertexAttribStream stream{};
+		// 0 means that the components must match exactly (bit for bit, except for the sign of zero).
+		// Otherwise the components are snapped to a grid with cells of this size and compared on the grid.
+		// Values close to a cell border can end up in different cells, so this is a cheap approximation
+		// of "closer than epsilon", not an exact one.
+		float epsilon{0.0f};
+	};
+
+	// Finds the vertices whose attribute tuples (across all of the streams) are the same.
+	// 'remap[vertex]' is the index of the vertex in the welded vertex set, where the unique vertices
+	// keep the order of their first occurrence. Returns the number of unique vertices.
+	// 
+	// The vertices are hashed in parallel chunks, and then deduplicated in parallel shards
+	// (every shard owns its part of the hash space, so there's no locking), the result is deterministic.
+	uint32_t GenerateVertexWeldRemap(std::vector<uint32_t>& remap,
+	                                 const std::vector<VertexWeldStream>& weldStreams, uint32_t vertexCount);
+
+	// Moves every vertex to 'remap[vertex]' in place, the first 'uniqueVertexCount' elements are the result.
+	// Of the vertices that share the same slot, the first one wins.
+	template <typename Attribute>
+	void CompactVertexAttribArray(Attribute* attribArray, size_t vertexCount, const std::vector<uint32_t>& remap) {
+		// The first occurrence of every unique vertex is mapped to the next free slot,
+		// so a slot is being written for the first time exactly when it's the next one.
+		// The next slot is never past the current vertex, so nothing is overwritten before it's read.
+		uint32_t nextSlot{0};
+		for (size_t vert = 0; vert < vertexCount; vert++) {
+			if (remap[vert] == nextSlot) {
+				attribArray[nextSlot++] = attribArray[vert];
+			}
+		}
+	}
+
+}
\ No newline at end of file
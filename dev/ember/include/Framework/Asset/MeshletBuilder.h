@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Vec.hpp"
+#include "Shape.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ember {
+
+	struct MeshletSettings {
+		// 64/124 are the limits that work well for mesh shaders on most GPUs, and they keep the clusters
+		// small enough to be worth culling on their own.
+		uint32_t maxVertices{64};
+		uint32_t maxTriangles{124};
+		// How much the next triangle's normal deviating from the cluster's average normal is penalized,
+		// relative to the cost of adding a new vertex. Higher values give tighter normal cones.
+		float coneWeight{0.5f};
+	};
+
+	// A cluster of triangles that are contiguous in the (reordered) index buffer,
+	// '[indexOffset, indexOffset + triangleCount * 3)', so it can be drawn as a range of the mesh's indices.
+	struct Meshlet {
+		uint32_t indexOffset{0};
+		uint32_t triangleCount{0};
+		// The number of unique vertices of the cluster (at most 'MeshletSettings::maxVertices').
+		uint32_t vertexCount{0};
+
+		numa::AABB aabb{};
+		numa::Vec3 sphereCenter{0.0f};
+		float sphereRadius{0.0f};
+
+		// Every triangle of the cluster faces away from a camera at 'cameraPos' when
+		// 'dot(normalize(coneApex - cameraPos), coneAxis) >= coneCutoff' (see 'IsMeshletBackfacing()').
+		// 'coneCutoff' is above 1 if the normals are spread too much for the cone to ever cull the cluster.
+		numa::Vec3 coneApex{0.0f};
+		numa::Vec3 coneAxis{0.0f};
+		float coneCutoff{2.0f};
+	};
+
+	// Splits the triangles into clusters, reordering 'indices' in place so that every cluster's triangles
+	// are contiguous. Clusters are grown greedily from the triangles adjacent to the ones already in, preferring
+	// the ones that add no new vertices and keep the normal cone tight. 'indices' should be optimized for
+	// the vertex cache first, a new cluster is always started from the next unclustered triangle in that order.
+	// An incomplete triangle at the end of 'indices' is ignored (and left where it is).
+	// 'positions' are 3 floats per vertex.
+	void BuildMeshlets(std::vector<Meshlet>& meshlets, uint32_t* indices, size_t indexCount,
+	                   const float* positions, uint32_t vertexCount, const MeshletSettings& settings);
+
+	// Bounds of a range of triangles. 'meshlet.indexOffset' and 'meshlet.triangleCount' must be set.
+	void ComputeMeshletBounds(Meshlet& meshlet, const uint32_t* indices, const float* positions);
+
+	bool IsMeshletBackfacing(const Meshlet& meshlet, const numa::Vec3& cameraPos);
+
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <Vec.hpp>
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -27,16 +28,54 @@ namespace ember {
 		UINT16,
 		UINT8,
 		FLOAT32,
+		FLOAT16,
+		// Normalized formats. The shader sees floats in the [-1, 1] (SNORM) or [0, 1] (UNORM) range.
+		SNORM16,
+		SNORM8,
+		UNORM16,
+		UNORM8,
+		// A unit vector (normal, tangent) folded onto an octahedron and stored as 2 SNORM16 components.
+		// The attribute dimension must be 2, the shader has to unpack it back to 3 components.
+		OCT_SNORM16,
 	};
 
-	uint32_t GetVertexAttribFormatSizeInBytes(VertexAttribFormat vertexAttribFormat);
+	// Returns the size of a single component.
+	constexpr uint32_t GetVertexAttribFormatSizeInBytes(VertexAttribFormat vertexAttribFormat) {
+		static_assert(sizeof(float) == 4 && sizeof(uint32_t) == 4 && sizeof(int32_t) == 4, "All types must be 4 bytes in size!");
+		static_assert(sizeof(uint16_t) == 2 && sizeof(int16_t) == 2, "All types must be 2 bytes in size!");
+		static_assert(sizeof(uint8_t) == 1 && sizeof(int8_t) == 1, "All types must be 1 byte in size!");
+		switch (vertexAttribFormat) {
+			case VertexAttribFormat::FLOAT32:
+			case VertexAttribFormat::UINT32:
+			case VertexAttribFormat::INT32:
+				return 4;
+			case VertexAttribFormat::UINT16:
+			case VertexAttribFormat::INT16:
+			case VertexAttribFormat::FLOAT16:
+			case VertexAttribFormat::SNORM16:
+			case VertexAttribFormat::UNORM16:
+			case VertexAttribFormat::OCT_SNORM16:
+				return 2;
+			case VertexAttribFormat::UINT8:
+			case VertexAttribFormat::INT8:
+			case VertexAttribFormat::SNORM8:
+			case VertexAttribFormat::UNORM8:
+				return 1;
+			default:
+				// Unknown vertex attribute format
+				return 0;
+		}
+	}
 
 	bool IsVertexAttribFormatInt(VertexAttribFormat vertexAttribFormat);
 	bool IsVertexAttribFormatUint(VertexAttribFormat vertexAttribFormat);
 	bool IsVertexAttribFormatFloat(VertexAttribFormat vertexAttribFormat);
+	bool IsVertexAttribFormatNormalized(VertexAttribFormat vertexAttribFormat);
 
 	struct VertexAttribDescriptor {
-		uint32_t GetVertexAttribSize() const;
+		constexpr uint32_t GetVertexAttribSize() const {
+			return dimension * GetVertexAttribFormatSizeInBytes(format);
+		}
 
 		uint32_t dimension{0};
 		uint32_t offset{0};
@@ -46,31 +85,70 @@ namespace ember {
 
 	uint32_t CalculateVertexStride(const std::vector<VertexAttribDescriptor>& vertAttribLayout);
 
+	// A vertex layout known at compile time, see 'MakeStaticVertexAttribLayout()'.
+	template <size_t AttribCount>
+	struct StaticVertexAttribLayout {
+		std::vector<VertexAttribDescriptor> ToVector() const {
+			return std::vector<VertexAttribDescriptor>(attributes.begin(), attributes.end());
+		}
+
+		std::array<VertexAttribDescriptor, AttribCount> attributes{};
+		uint32_t stride{0};
+		// Bits by 'VertexAttribChannel'.
+		uint32_t attributesMask{0};
+	};
+
+	// The attributes are packed in the given order, their 'offset' member variables are ignored.
+	template <typename... Descriptors>
+	constexpr StaticVertexAttribLayout<sizeof...(Descriptors)> MakeStaticVertexAttribLayout(const Descriptors&... descriptors) {
+		StaticVertexAttribLayout<sizeof...(Descriptors)> layout{};
+		const VertexAttribDescriptor attributes[]{descriptors...};
+		for (size_t attribIdx = 0; attribIdx < sizeof...(Descriptors); attribIdx++) {
+			layout.attributes[attribIdx] = attributes[attribIdx];
+			layout.attributes[attribIdx].offset = layout.stride;
+			layout.stride += attributes[attribIdx].GetVertexAttribSize();
+			layout.attributesMask |= 1u << static_cast<uint32_t>(attributes[attribIdx].channel);
+		}
+		return layout;
+	}
+
+	constexpr VertexAttribDescriptor vertexPositionFloat32{3, 0, VertexAttribChannel::POSITION, VertexAttribFormat::FLOAT32};
+	constexpr VertexAttribDescriptor vertexNormalFloat32{3, 0, VertexAttribChannel::NORMAL, VertexAttribFormat::FLOAT32};
+	constexpr VertexAttribDescriptor vertexTangentFloat32{3, 0, VertexAttribChannel::TANGENT, VertexAttribFormat::FLOAT32};
+	constexpr VertexAttribDescriptor vertexColorFloat32{3, 0, VertexAttribChannel::COLOR, VertexAttribFormat::FLOAT32};
+	constexpr VertexAttribDescriptor vertexUvFloat32{2, 0, VertexAttribChannel::UV0, VertexAttribFormat::FLOAT32};
+
+	// The vertex structs have their 'layout' as a vector as well ('attributes'), for the code that takes any layout.
+
 	// P - position.
 	struct VertexP {
 		numa::Vec3 vertexPosition;
-		static constexpr uint32_t stride = sizeof(numa::Vec3);
+		static constexpr auto layout = MakeStaticVertexAttribLayout(vertexPositionFloat32);
+		static constexpr uint32_t stride = layout.stride;
 		static const std::vector<VertexAttribDescriptor> attributes;
 	};
 	// P - position, N - normal.
 	struct VertexPN {
 		numa::Vec3 vertexPosition;
 		numa::Vec3 vertexNormal;
-		static constexpr uint32_t stride = 2 * sizeof(numa::Vec3);
+		static constexpr auto layout = MakeStaticVertexAttribLayout(vertexPositionFloat32, vertexNormalFloat32);
+		static constexpr uint32_t stride = layout.stride;
 		static const std::vector<VertexAttribDescriptor> attributes;
 	};
 	// P - position, C - color.
 	struct VertexPC {
 		numa::Vec3 vertexPosition;
 		numa::Vec3 vertexColor;
-		static constexpr uint32_t stride = 2 * sizeof(numa::Vec3);
+		static constexpr auto layout = MakeStaticVertexAttribLayout(vertexPositionFloat32, vertexColorFloat32);
+		static constexpr uint32_t stride = layout.stride;
 		static const std::vector<VertexAttribDescriptor> attributes;
 	};
 	// P - position, U - uv texture coordinates.
 	struct VertexPU {
 		numa::Vec3 vertexPosition;
 		numa::Vec2 vertexUv;
-		static constexpr uint32_t stride = sizeof(numa::Vec3) + sizeof(numa::Vec2);
+		static constexpr auto layout = MakeStaticVertexAttribLayout(vertexPositionFloat32, vertexUvFloat32);
+		static constexpr uint32_t stride = layout.stride;
 		static const std::vector<VertexAttribDescriptor> attributes;
 	};
 	// P - position, N - normal, T - tangent.
@@ -78,7 +156,8 @@ namespace ember {
 		numa::Vec3 vertexPosition;
 		numa::Vec3 vertexNormal;
 		numa::Vec3 vertexTangent;
-		static constexpr uint32_t stride = 3 * sizeof(numa::Vec3);
+		static constexpr auto layout = MakeStaticVertexAttribLayout(vertexPositionFloat32, vertexNormalFloat32, vertexTangentFloat32);
+		static constexpr uint32_t stride = layout.stride;
 		static const std::vector<VertexAttribDescriptor> attributes;
 	};
 	// P - position, N - normal, C - color.
@@ -86,7 +165,8 @@ namespace ember {
 		numa::Vec3 vertexPosition;
 		numa::Vec3 vertexNormal;
 		numa::Vec3 vertexColor;
-		static constexpr uint32_t stride = 3 * sizeof(numa::Vec3);
+		static constexpr auto layout = MakeStaticVertexAttribLayout(vertexPositionFloat32, vertexNormalFloat32, vertexColorFloat32);
+		static constexpr uint32_t stride = layout.stride;
 		static const std::vector<VertexAttribDescriptor> attributes;
 	};
 	// P - position, N - normal, U - uv
@@ -94,7 +174,8 @@ namespace ember {
 		numa::Vec3 vertexPosition;
 		numa::Vec3 vertexNormal;
 		numa::Vec2 vertexUv;
-		static constexpr uint32_t stride = 2 * sizeof(numa::Vec3) + sizeof(numa::Vec2);
+		static constexpr auto layout = MakeStaticVertexAttribLayout(vertexPositionFloat32, vertexNormalFloat32, vertexUvFloat32);
+		static constexpr uint32_t stride = layout.stride;
 		static const std::vector<VertexAttribDescriptor> attributes;
 	};
 	// P - position, N - normal, T - tangent, U - uv
@@ -103,7 +184,8 @@ namespace ember {
 		numa::Vec3 vertexNormal;
 		numa::Vec3 vertexTangent;
 		numa::Vec2 vertexUv;
-		static constexpr uint32_t stride = 3 * sizeof(numa::Vec3) + sizeof(numa::Vec2);
+		static constexpr auto layout = MakeStaticVertexAttribLayout(vertexPositionFloat32, vertexNormalFloat32, vertexTangentFloat32, vertexUvFloat32);
+		static constexpr uint32_t stride = layout.stride;
 		static const std::vector<VertexAttribDescriptor> attributes;
 	};
 	// P - position, N - normal, T - tangent, C - color, U - uv
@@ -113,14 +195,32 @@ namespace ember {
 		numa::Vec3 vertexTangent;
 		numa::Vec3 vertexColor;
 		numa::Vec2 vertexUv;
-		static constexpr uint32_t stride = 4 * sizeof(numa::Vec3) + sizeof(numa::Vec2);
+		static constexpr auto layout = MakeStaticVertexAttribLayout(vertexPositionFloat32, vertexNormalFloat32, vertexTangentFloat32, vertexColorFloat32, vertexUvFloat32);
+		static constexpr uint32_t stride = layout.stride;
 		static const std::vector<VertexAttribDescriptor> attributes;
 	};
 
+	// The structs are copied to the vertex buffers as they are, they can't have any padding.
+	static_assert(sizeof(VertexP) == VertexP::stride, "VertexP doesn't match its layout!");
+	static_assert(sizeof(VertexPN) == VertexPN::stride, "VertexPN doesn't match its layout!");
+	static_assert(sizeof(VertexPC) == VertexPC::stride, "VertexPC doesn't match its layout!");
+	static_assert(sizeof(VertexPU) == VertexPU::stride, "VertexPU doesn't match its layout!");
+	static_assert(sizeof(VertexPNT) == VertexPNT::stride, "VertexPNT doesn't match its layout!");
+	static_assert(sizeof(VertexPNC) == VertexPNC::stride, "VertexPNC doesn't match its layout!");
+	static_assert(sizeof(VertexPNU) == VertexPNU::stride, "VertexPNU doesn't match its layout!");
+	static_assert(sizeof(VertexPNTU) == VertexPNTU::stride, "VertexPNTU doesn't match its layout!");
+	static_assert(sizeof(VertexPNTCU) == VertexPNTCU::stride, "VertexPNTCU doesn't match its layout!");
+
 	struct VertexBufferInfo {
 		std::vector<VertexAttribDescriptor> vertexAttribLayout;
 		uint32_t vertexCount{0};
 		uint32_t vertexStride{0};
+		// Quantized positions are stored in the [0, 1] range of the object's AABB.
+		// The object space position is 'position * positionScale + positionOffset',
+		// which can be folded into the world matrix. Identity if the positions aren't quantized.
+		numa::Vec3 positionScale{1.0f};
+		numa::Vec3 positionOffset{0.0f};
+		bool positionsQuantized{false};
 	};
 
 	enum class IndexFormat {
@@ -131,9 +231,22 @@ namespace ember {
 
 	uint32_t GetIndexFormatSizeInBytes(IndexFormat indexFormat);
 
+	// A level of detail, a range of the index buffer.
+	struct IndexBufferLod {
+		uint32_t indexOffset{0};
+		uint32_t indexCount{0};
+		// The level uses the vertices [0, vertexCount) only.
+		uint32_t vertexCount{0};
+		// Object space geometric error relative to the full detail level.
+		float error{0.0f};
+	};
+
 	struct IndexBufferInfo {
 		uint32_t indexCount{0};
 		IndexFormat indexFormat{};
+		// The levels of detail, stored one after another in the same index buffer. The first one
+		// is the full detail mesh ('indexCount' indices at offset 0). Empty if there's no LOD chain.
+		std::vector<IndexBufferLod> lods;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Framework/Asset/Vertex.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ember {
+
+	// Converts 'count' vertices of a tightly packed float attribute stream ('srcComponents' floats per vertex)
+	// into a strided destination buffer, converting every component to the destination format.
+	// Components that the source doesn't have are written as zeros, extra source components are dropped.
+	using VertexAttribEncodeKernel = void (*)(const float* src, uint32_t srcComponents,
+	                                          char* dst, uint32_t dstStride, uint32_t dstDimension,
+	                                          uint32_t count);
+
+	// Returns a kernel specialized for the given source/destination shape if there is one,
+	// and a generic (slower) kernel otherwise. Never returns 'nullptr'.
+	VertexAttribEncodeKernel PickVertexAttribEncodeKernel(VertexAttribFormat dstFormat,
+	                                                      uint32_t srcComponents, uint32_t dstDimension);
+
+	// The inverse of 'VertexAttribEncodeKernel'. Reads 'count' vertices of a strided source attribute
+	// ('srcDimension' components of the source format) and writes them as a tightly packed float stream
+	// ('dstComponents' floats per vertex). Components that the source doesn't have are written as zeros.
+	using VertexAttribDecodeKernel = void (*)(const char* src, uint32_t srcStride, uint32_t srcDimension,
+	                                          float* dst, uint32_t dstComponents,
+	                                          uint32_t count);
+
+	VertexAttribDecodeKernel PickVertexAttribDecodeKernel(VertexAttribFormat srcFormat,
+	                                                      uint32_t srcDimension, uint32_t dstComponents);
+
+	// The compile-time counterpart of the kernels above, for a float attribute that doesn't need a conversion.
+	// Everything about the layout is a constant, so this is a plain strided copy. The destination can have
+	// more components than the source ('DstComponents' floats per vertex), those are written as zeros.
+	template <uint32_t SrcStride, uint32_t SrcOffset, uint32_t Components, uint32_t DstComponents = Components>
+	void CopyFloatVertexAttrib(const char* src, float* dst, uint32_t count) {
+		static_assert(Components <= DstComponents, "The extra source components can't be dropped!");
+		for (size_t vert = 0; vert < count; vert++) {
+			std::memcpy(dst + vert * DstComponents, src + vert * SrcStride + SrcOffset, Components * sizeof(float));
+			for (uint32_t componentIdx = Components; componentIdx < DstComponents; componentIdx++) {
+				dst[vert * DstComponents + componentIdx] = 0.0f;
+			}
+		}
+	}
+
+	struct VertexAttribStream {
+		const float* data{nullptr};
+		uint32_t components{0};
+	};
+
+	// An affine remap applied to the source floats right before they're encoded: (value - offset) * scale.
+	// Used to map values into the range of a normalized format (e.g. positions relative to the bounding box).
+	struct VertexAttribRemap {
+		float offset[4]{0.0f, 0.0f, 0.0f, 0.0f};
+		float scale[4]{1.0f, 1.0f, 1.0f, 1.0f};
+	};
+
+	// Interleaves a set of float attribute streams into a vertex buffer.
+	//
+	// The kernels are resolved once in 'AddAttrib()', so a single instance can be reused
+	// for any number of 'Interleave()' calls as long as the layout and the streams stay the same.
+	// Vertices are processed in small blocks and every attribute of a block is written
+	// before moving on to the next one. This way the destination is only streamed through once.
+	class VertexInterleaver {
+	public:
+		void AddAttrib(const VertexAttribDescriptor& dstAttribDesc, const VertexAttribStream& srcStream);
+		// The remap is applied block by block into a small scratch buffer, the source stream itself is never modified.
+		void AddAttrib(const VertexAttribDescriptor& dstAttribDesc, const VertexAttribStream& srcStream,
+		               const VertexAttribRemap& remap);
+		void SetVertexStride(uint32_t vertexStride);
+
+		// 'dst' points to the first byte of the vertex 'firstVertex'.
+		void Interleave(char* dst, uint32_t firstVertex, uint32_t vertexCount) const;
+
+	private:
+		struct EncodeOp {
+			VertexAttribEncodeKernel kernel{nullptr};
+			const float* src{nullptr};
+			uint32_t srcComponents{0};
+			uint32_t dstOffset{0};
+			uint32_t dstDimension{0};
+			bool remapped{false};
+			VertexAttribRemap remap{};
+		};
+
+		std::vector<EncodeOp> encodeOps;
+		uint32_t vertexStride{0};
+	};
+
+	// Splits an interleaved vertex buffer into float attribute streams.
+	// Same idea as 'VertexInterleaver': the kernels are resolved once per layout, and then
+	// the vertices are processed in blocks, with every attribute of a block converted before the next one.
+	class VertexDeinterleaver {
+	public:
+		void AddAttrib(const VertexAttribDescriptor& srcAttribDesc, float* dst, uint32_t dstComponents);
+		void SetVertexStride(uint32_t vertexStride);
+
+		// 'src' points to the first byte of the vertex 'firstVertex'.
+		void Deinterleave(const char* src, uint32_t firstVertex, uint32_t vertexCount) const;
+
+	private:
+		struct DecodeOp {
+			VertexAttribDecodeKernel kernel{nullptr};
+			float* dst{nullptr};
+			uint32_t dstComponents{0};
+			uint32_t srcOffset{0};
+			uint32_t srcDimension{0};
+		};
+
+		std::vector<DecodeOp> decodeOps;
+		uint32_t vertexStride{0};
+	};
+
+}
\ No newline at end of file
@@ -43,6 +43,9 @@ namespace ember {
 		virtual void OnMeshSettingsChange(const Mesh* mesh) = 0;
 		virtual void OnMeshVertexBufferUpdate(const Mesh* mesh) = 0;
 		virtual void OnMeshIndexBufferUpdate(const Mesh* mesh) = 0;
+		// Only the vertices (indices) [first, first + count) changed, see 'Mesh::GetDirtyVertexRange()'.
+		virtual void OnMeshVertexBufferRangeUpdate(const Mesh* mesh, uint32_t firstVertex, uint32_t vertexCount) = 0;
+		virtual void OnMeshIndexBufferRangeUpdate(const Mesh* mesh, uint32_t firstIndex, uint32_t indexCount) = 0;
 	};
 
 	GpuApiType ChooseGpuApi(const CmdLineArgs& cmdLineArgs);
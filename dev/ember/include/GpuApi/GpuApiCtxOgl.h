@@ -3,8 +3,12 @@
 #include "Core/Util.h"
 #include "GpuApi/GpuApiCtx.h"
 
+#include <glad/gl.h>
+
 #include <string_view>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace ember {
 
@@ -20,6 +24,20 @@ namespace ember {
 		std::string_view glslVersion{"#version 460"};
 	};
 
+	// The buffers of a mesh and the vertex array that reads them, the vertices are bound to the binding 0.
+	struct OpenGLMeshGpuResource {
+		GLuint vertexArray{0};
+		GLuint vertexBuffer{0};
+		GLuint indexBuffer{0};
+		// What the buffers hold, the layout is the one the vertex array was set up with.
+		std::vector<VertexAttribDescriptor> vertexAttribLayout;
+		uint32_t vertexStride{0};
+		uint32_t vertexCount{0};
+		IndexFormat indexFormat{IndexFormat::UINT32};
+		// The full detail indices and the LOD chain.
+		uint32_t indexCount{0};
+	};
+
 	class GpuApiCtxOgl : public GpuApiCtx {
 	public:
 		GpuApiCtxOgl(const SettingsOgl& settings);
@@ -64,10 +82,18 @@ namespace ember {
 		void OnMeshSettingsChange(const Mesh* mesh) override;
 		void OnMeshVertexBufferUpdate(const Mesh* mesh) override;
 		void OnMeshIndexBufferUpdate(const Mesh* mesh) override;
+		void OnMeshVertexBufferRangeUpdate(const Mesh* mesh, uint32_t firstVertex, uint32_t vertexCount) override;
+		void OnMeshIndexBufferRangeUpdate(const Mesh* mesh, uint32_t firstIndex, uint32_t indexCount) override;
 
 	private:
+		void UploadMeshVertices(const Mesh& mesh, OpenGLMeshGpuResource& meshRes);
+		void UploadMeshIndices(const Mesh& mesh, OpenGLMeshGpuResource& meshRes);
+		void DestroyMeshGpuResource(OpenGLMeshGpuResource& meshRes);
+
 		WindowGlfw* window{nullptr};
 		OglGlfwImGuiCtx* imGuiCtx{nullptr};
+
+		std::unordered_map<const Mesh*, OpenGLMeshGpuResource> meshGpuResources;
 	};
 
 	// GlfwGpuApiCtxOgl or GlfwOglGpuApiCtx
@@ -8,12 +8,22 @@
 #include "GpuApi/Vulkan/VulkanRenderPass.h"
 #include "GpuApi/Vulkan/VulkanPipelineLayout.h"
 #include "GpuApi/Vulkan/VulkanFramebuffer.h"
+#include "GpuApi/Vulkan/VulkanShader.h"
+#include "GpuApi/Vulkan/VulkanUploadScheduler.h"
+#include "GpuApi/Vulkan/Memory/VulkanBufferArena.h"
+#include "GpuApi/Vulkan/Memory/VulkanStagingRing.h"
+
+#include "Math/Frustum.h"
+#include "Math/FrustumCulling.h"
+#include "Renderer/OcclusionCuller.h"
 
 #include <vulkan/vulkan.h>
 
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace ember {
 
@@ -21,16 +31,33 @@ namespace ember {
 	class GpuApiImGuiCtx;
 
 	struct SettingsVk {
-		// TODO
+		// The size of the buffers that the vertices and the indices of the meshes are suballocated from.
+		VkDeviceSize meshVertexArenaPageSize{64ull << 20};
+		VkDeviceSize meshIndexArenaPageSize{32ull << 20};
+		// The uploads go through it. When it's full, the uploads so far are submitted and waited for.
+		VkDeviceSize stagingRingSize{32ull << 20};
+		// The uploads of the meshes that aren't drawn yet go through it, on the transfer queue.
+		VkDeviceSize transferStagingRingSize{64ull << 20};
+		// 'false' puts the transfer queue on the graphics queue family even if the device has a family
+		// for the copies, the same as on the devices without one (e.g. the CPU implementations).
+		bool useDedicatedTransferQueueFamily{true};
+		// A mesh is drawn with its coarsest LOD whose error is at most this many pixels on the screen.
+		float meshLodPixelError{1.0f};
+		// The visible meshes whose bounds cover at least this part of the screen hide what's behind them.
+		float occluderMinScreenArea{0.02f};
 	};
 
 	struct VulkanQueueFamilyIndices {
 		bool HasGraphicsQueueFamily() const;
 		bool HasPresentQueueFamily() const;
+		bool HasTransferQueueFamily() const;
+		// The transfer queue family is optional.
 		bool Complete() const;
 
 		std::optional<uint32_t> graphicsQueueFamily;
 		std::optional<uint32_t> presentQueueFamily;
+		// A family that can copy but can't draw, usually a DMA engine that works alongside the graphics queue.
+		std::optional<uint32_t> transferQueueFamily;
 	};
 
 	struct VulkanQueueFamily {
@@ -51,6 +78,7 @@ namespace ember {
 		std::optional<VulkanSwapchainQueryInfo> swapchainInfo;
 		std::vector<VkExtensionProperties> deviceExtensions;
 		VulkanQueueFamilyIndices queueFamilyIds;
+		bool timelineSemaphoreSupported{false};
 		VkPhysicalDevice physicalDevice{VK_NULL_HANDLE};
 	};
 
@@ -82,6 +110,8 @@ namespace ember {
 
 		VulkanQueueFamily graphicsQueueFamily{};
 		VulkanQueueFamily presentationQueueFamily{};
+		// The graphics queue family if there's no dedicated transfer one, with a command pool of its own.
+		VulkanQueueFamily transferQueueFamily{};
 
 		std::vector<const char*> requestedDeviceExtensions;
 		std::vector<const char*> requestedDeviceLayers;
@@ -93,6 +123,8 @@ namespace ember {
 		VkFence frameFinishedFence{VK_NULL_HANDLE};
 		VkSemaphore imageAvailableSemaphore{VK_NULL_HANDLE};
 		VkCommandBuffer commandBuffer{VK_NULL_HANDLE};
+		// The last submission of the command buffer, complete once the fence is signaled.
+		uint64_t submissionIdx{0};
 	};
 	struct VulkanSwapchainImageResources {
 		VulkanFramebuffer framebuffer;
@@ -101,6 +133,76 @@ namespace ember {
 		VkSemaphore renderingFinishedSemaphore{VK_NULL_HANDLE};
 	};
 
+	// What a mesh needs from the pipeline: its vertex input and the fixed function state.
+	struct VulkanMeshPipelineKey {
+		bool operator==(const VulkanMeshPipelineKey& other) const;
+
+		uint32_t vertexStride{0};
+		VertexAttribDescriptor position{};
+		// 'dimension == 0' if the mesh has no colors, a constant one is read instead.
+		VertexAttribDescriptor color{};
+		VkPrimitiveTopology topology{VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST};
+		bool cullBackFaces{true};
+	};
+
+	struct VulkanMeshPipeline {
+		VulkanMeshPipelineKey key;
+		std::shared_ptr<VulkanGraphicsPipeline> pipeline;
+	};
+
+	// The GPU side of a mesh. The mesh only reports what changed, the data is uploaded once per frame
+	// (see 'GpuApiCtxVk::UploadMeshes()'), so that the changes in between are merged.
+	// The push constants of the mesh vertex shader, the same block as in 'triag_vert_shader.vert'.
+	struct VulkanMeshPushConstants {
+		// The quantized positions are 'position * positionScale + positionOffset' (see 'VertexBufferInfo'),
+		// identity otherwise. The 'w' components are padding, a vec3 takes 16 bytes in the block.
+		float positionScale[4]{1.0f, 1.0f, 1.0f, 0.0f};
+		float positionOffset[4]{0.0f, 0.0f, 0.0f, 0.0f};
+	};
+
+	struct VulkanMeshGpuResource {
+		VulkanBufferRange vertexBuffer;
+		// The full detail indices followed by the LOD chain.
+		VulkanBufferRange indexBuffer;
+		uint32_t vertexCount{0};
+		uint32_t vertexStride{0};
+		// The full detail level only.
+		uint32_t indexCount{0};
+		// The levels of detail in 'indexBuffer', see 'IndexBufferInfo::lods'. Empty if there's no LOD chain.
+		std::vector<IndexBufferLod> lods;
+		// Can be wider than the one of the mesh, UINT8 indices aren't supported everywhere.
+		IndexFormat indexFormat{IndexFormat::UINT32};
+		// Matches the resident vertex buffer, it's updated along with it.
+		VulkanMeshPushConstants pushConstants;
+		// Into 'meshPipelines', '~0u' if the mesh can't be drawn (e.g. the PATCHES topology).
+		uint32_t pipelineIdx{~0u};
+		bool hasColors{false};
+		// Until the mesh is drawn for the first time, its data goes through the 'uploadScheduler'.
+		// It's drawn once the upload timeline reaches 'uploadValue'.
+		bool resident{false};
+		uint64_t uploadValue{0};
+
+		MeshDirtyRange dirtyVertexRange;
+		MeshDirtyRange dirtyIndexRange;
+		bool vertexBufferDirty{true};
+		bool indexBufferDirty{true};
+		bool settingsDirty{true};
+	};
+
+	// A mesh that's resident, its bounds are in 'GpuApiCtxVk::meshBounds' at the same index.
+	struct VulkanMeshDraw {
+		const Mesh* mesh{nullptr};
+		const VulkanMeshGpuResource* meshRes{nullptr};
+	};
+
+	// A range that the submissions up to 'submissionIdx', and the uploads up to 'uploadValue', may still use.
+	struct VulkanDeferredFree {
+		VulkanBufferArena* arena{nullptr};
+		VulkanBufferRange range;
+		uint64_t submissionIdx{0};
+		uint64_t uploadValue{0};
+	};
+
 	struct VulkanData {
 		VkInstance GetInstance() const;
 		VkPhysicalDevice GetPhysicalDevice() const;
@@ -122,6 +224,9 @@ namespace ember {
 		VulkanQueueFamily& GetPresentationQueueFamily();
 		const VulkanQueueFamily& GetPresentationQueueFamily() const;
 
+		VulkanQueueFamily& GetTransferQueueFamily();
+		const VulkanQueueFamily& GetTransferQueueFamily() const;
+
 		VulkanDeviceData deviceData{};
 		VulkanInstanceData instanceData{};
 		VkSurfaceKHR surface{VK_NULL_HANDLE};
@@ -158,6 +263,8 @@ namespace ember {
 		void OnMeshSettingsChange(const Mesh* mesh) override;
 		void OnMeshVertexBufferUpdate(const Mesh* mesh) override;
 		void OnMeshIndexBufferUpdate(const Mesh* mesh) override;
+		void OnMeshVertexBufferRangeUpdate(const Mesh* mesh, uint32_t firstVertex, uint32_t vertexCount) override;
+		void OnMeshIndexBufferRangeUpdate(const Mesh* mesh, uint32_t firstIndex, uint32_t indexCount) override;
 
 		const SettingsVk& GetSettingsVk() const;
 
@@ -223,6 +330,7 @@ namespace ember {
 		VkPhysicalDeviceProperties GetVulkanPhysicalDeviceProperties(VkPhysicalDevice device) const;
 		VkPhysicalDeviceFeatures GetVulkanPhysicalDeviceFeatures(VkPhysicalDevice device) const;
 		VulkanQueueFamilyIndices GetVulkanPhysicalDeviceQueueFamilies(VkPhysicalDevice device) const;
+		bool GetVulkanPhysicalDeviceTimelineSemaphoreSupport(VkPhysicalDevice device, uint32_t apiVersion) const;
 
 		VkPhysicalDeviceFeatures EnumerateRequestedDeviceFeatures() const;
 		bool RequestedVulkanDeviceFeaturesSupported(
@@ -257,10 +365,16 @@ namespace ember {
 		void ResizeSwapchain();
 		void HandleSurfaceLostError();
 
-		void CreateGraphicsPipeline();
 		void CreateRenderPass();
 		void CreatePipelineLayout();
-
+		void CreateMeshShaderModules();
+		void DestroyMeshShaderModules();
+		// Returns the index of the pipeline in 'meshPipelines', creates it the first time.
+		uint32_t GetMeshPipeline(const VulkanMeshPipelineKey& key);
+		void DestroyMeshPipelines();
+
+		void CreateDepthBuffer();
+		void DestroyDepthBuffer();
 		void CreateFramebuffers();
 		void DestroyFramebuffers();
 
@@ -268,6 +382,30 @@ namespace ember {
 		void DestroyCommandPools();
 		void CreateCommandBuffers();
 		void RecordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t swapchainImageIdx);
+		void RecordUploads(VkCommandBuffer commandBuffer);
+		void RecordMeshDraws(VkCommandBuffer commandBuffer);
+		// Drops the meshes of 'visibleMeshes' that are hidden behind the big ones.
+		void CullOccludedMeshes(float maxLodError);
+
+		void CreateMeshBuffers();
+		void DestroyMeshBuffers();
+		// Creates the resource if the mesh doesn't have one (e.g. it was moved to a new address).
+		VulkanMeshGpuResource& GetMeshGpuResource(const Mesh* mesh);
+		void UploadMeshes();
+		void UpdateMeshSettings(const Mesh& mesh, VulkanMeshGpuResource& meshRes);
+		void UploadMeshVertices(const Mesh& mesh, VulkanMeshGpuResource& meshRes);
+		void UploadMeshIndices(const Mesh& mesh, VulkanMeshGpuResource& meshRes);
+		// Returns where to write the 'size' bytes that go to 'dstBuffer' at 'dstOffset'.
+		// 'size' can't be bigger than the staging ring.
+		char* StageUpload(VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size);
+		// Same, through the 'uploadScheduler' if the mesh isn't resident yet. Returns nullptr if the upload
+		// has to wait for a later frame.
+		char* StageMeshUpload(VulkanMeshGpuResource& meshRes, VkBuffer dstBuffer, VkDeviceSize dstOffset,
+		                      VkDeviceSize size);
+		// Submits the pending uploads and waits for them, when the staging ring is full.
+		void FlushUploads();
+		void FreeBufferRangeDeferred(VulkanBufferArena& arena, VulkanBufferRange& range);
+		void ReleaseCompletedSubmissions(uint64_t completedSubmissionIdx);
 
 		void CreateSynchronizationObjects();
 		void CreateFrameResourceSynchronizationObjects();
@@ -282,9 +420,38 @@ namespace ember {
 		std::vector<VulkanFrameResources> frameRes;
 		std::vector<VulkanSwapchainImageResources> swapchainImageRes;
 
-		std::shared_ptr<VulkanGraphicsPipeline> graphicsPipeline;
 		std::shared_ptr<VulkanRenderPass> renderPass;
 		std::shared_ptr<VulkanPipelineLayout> pipelineLayout;
+		// One for all of the swapchain images, there's a single frame in flight.
+		VkImage depthImage{VK_NULL_HANDLE};
+		VkDeviceMemory depthImageMemory{VK_NULL_HANDLE};
+		VkImageView depthImageView{VK_NULL_HANDLE};
+
+		VulkanShaderModule meshVertexShaderModule;
+		VulkanShaderModule meshFragmentShaderModule;
+		std::vector<VulkanMeshPipeline> meshPipelines;
+
+		std::unordered_map<const Mesh*, VulkanMeshGpuResource> meshGpuResources;
+		VulkanBufferArena vertexBufferArena;
+		VulkanBufferArena indexBufferArena;
+		VulkanStagingRing stagingRing;
+		// A white color for the meshes without colors, read with the stride of 0.
+		VulkanBufferRange defaultColorBuffer;
+		std::vector<VulkanBufferUpload> pendingUploads;
+		std::vector<VulkanDeferredFree> deferredFrees;
+		VulkanUploadScheduler uploadScheduler;
+		// Every submission to the graphics queue gets the next index. A resource that a submission uses
+		// is given back once its index is complete (see 'ReleaseCompletedSubmissions()').
+		uint64_t nextSubmissionIdx{1};
+		uint64_t completedSubmissionIdx{0};
+
+		// The meshes are drawn in the clip space for now, they're culled against its bounds and behind the big ones.
+		Frustum clipSpaceFrustum;
+		AabbBatch meshBounds;
+		std::vector<VulkanMeshDraw> meshDrawList;
+		std::vector<uint32_t> visibleMeshes;
+		OcclusionCuller occlusionCuller;
+		std::vector<uint32_t> occluders;
 
 		VkClearColorValue clearColor{0.0f, 0.0f, 0.0f, 1.0f};
 
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Framework/Asset/Vertex.h"
+
+#include <glad/gl.h>
+
+#include <vector>
+
+namespace ember {
+
+	// The component type passed to 'glVertexArrayAttribFormat()' (or 'glVertexArrayAttribIFormat()').
+	GLenum PickOpenGLVertexAttribType(VertexAttribFormat format);
+
+	// Integer formats that aren't normalized must be fed to the shader as integers
+	// (same as the '_UINT/_SINT' Vulkan formats), everything else is fed as floats.
+	bool IsOpenGLVertexAttribInteger(VertexAttribFormat format);
+	GLboolean IsOpenGLVertexAttribNormalized(VertexAttribFormat format);
+
+	// Specifies the formats of all attributes of the layout and binds them to 'bindingIndex' of the vertex array.
+	// Same as with Vulkan, the channel of an attribute is its location in the shader.
+	void SetOpenGLVertexAttribLayout(GLuint vao, GLuint bindingIndex,
+		                             const std::vector<VertexAttribDescriptor>& attribLayout);
+
+}
\ No newline at end of file
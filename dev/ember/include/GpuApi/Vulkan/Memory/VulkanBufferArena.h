@@ -0,0 +1,61 @@
+#pragma once
+
+#include "GpuApi/Vulkan/Memory/VulkanMemoryAllocator.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace ember {
+
+	// A part of one of the buffers of a 'VulkanBufferArena'.
+	struct VulkanBufferRange {
+		bool IsValid() const;
+
+		uint32_t pageIdx{~0u};
+		VkDeviceSize offset{0};
+		VkDeviceSize size{0};
+	};
+
+	// Big 'VkBuffer's (pages) that the small buffers are suballocated from, so that thousands of meshes take
+	// a few device memory allocations instead of one each ('maxMemoryAllocationCount' can be as low as 4096).
+	// Every page is bound to a single allocation of its own, managed by a 'VulkanMemoryAllocator', so the
+	// offsets in the memory are the offsets in the buffer. A new page is added when none of them has room,
+	// the ranges bigger than a page get a page of their own size.
+	class VulkanBufferArena {
+	public:
+		// The buffers are shared between the 'queueFamilies' if there's more than one of them.
+		void Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkBufferUsageFlags usage,
+		                VkMemoryPropertyFlags memoryProperties, VkDeviceSize pageSize,
+		                const std::vector<uint32_t>& queueFamilies = {});
+		void Destroy(VkDevice device);
+
+		// 'alignment' is on top of the alignment of the buffer itself.
+		VulkanBufferRange Alloc(VkDevice device, VkDeviceSize size, uint32_t alignment);
+		void Free(const VulkanBufferRange& range);
+
+		VkBuffer GetBuffer(uint32_t pageIdx) const;
+		uint32_t GetPageCount() const;
+		VkDeviceSize GetPageSize() const;
+		bool IsInitialized() const;
+
+	private:
+		struct Page {
+			VkBuffer buffer{VK_NULL_HANDLE};
+			VulkanMemoryAllocator allocator;
+		};
+
+		// Returns the index of the new page.
+		uint32_t AddPage(VkDevice device, VkDeviceSize size);
+
+		std::vector<Page> pages;
+		VkPhysicalDevice physicalDevice{VK_NULL_HANDLE};
+		VkBufferUsageFlags usage{0};
+		VkMemoryPropertyFlags memoryProperties{0};
+		std::vector<uint32_t> queueFamilies;
+		VkDeviceSize pageSize{0};
+		bool initialized{false};
+	};
+
+}
\ No newline at end of file
@@ -1,3 +1,16 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
 namespace ember {
 
+	// Picks the first memory type allowed by 'memoryTypeBits' (see 'VkMemoryRequirements') that has all of the
+	// 'properties'. Returns 'false' if there's none.
+	bool FindVulkanMemoryTypeIndex(VkPhysicalDevice physicalDevice, uint32_t memoryTypeBits,
+	                               VkMemoryPropertyFlags properties, uint32_t& memoryTypeIndex);
+
+	VkDeviceSize AlignVulkanDeviceSize(VkDeviceSize size, VkDeviceSize alignment);
+
 }
\ No newline at end of file
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <vulkan/vulkan.h>
 
 #include <cstdint>
@@ -23,6 +25,8 @@ namespace ember {
 		void Destroy(VkDevice device);
 
 		VulkanMemoryMarker Alloc(size_t size, uint32_t alignment);
+		// Same as 'Alloc()', but returns 'false' instead of throwing when there's no block big enough.
+		bool TryAlloc(size_t size, uint32_t alignment, VulkanMemoryMarker& marker);
 		void Free(VulkanMemoryMarker marker);
 		VulkanMemoryMarker Realloc(VulkanMemoryMarker marker, size_t newSize, uint32_t alignment);
 
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+
+namespace ember {
+
+	// A persistently mapped host visible buffer that the uploads are written to before they're copied to the
+	// device local buffers. The space is handed out in a ring: everything allocated between two 'CloseSubmission()'
+	// calls belongs to that submission, and it's given back by 'Release()' once the GPU is done with it.
+	class VulkanStagingRing {
+	public:
+		void Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size);
+		void Destroy(VkDevice device);
+
+		// Returns where to write the 'size' bytes, 'offset' is the same place in 'GetBuffer()'.
+		// Returns nullptr if there's no room until more of the submissions are released.
+		char* Alloc(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+		// Everything allocated since the previous call is used by the submission 'submissionIdx'.
+		// The submission indices must grow.
+		void CloseSubmission(uint64_t submissionIdx);
+		// Gives back the space of the submissions up to 'completedSubmissionIdx' (inclusive).
+		void Release(uint64_t completedSubmissionIdx);
+
+		VkBuffer GetBuffer() const;
+		VkDeviceSize GetSize() const;
+		bool IsInitialized() const;
+
+	private:
+		struct Submission {
+			uint64_t submissionIdx{0};
+			// Where the space of the submission ends, the next one starts there.
+			VkDeviceSize end{0};
+		};
+
+		VkBuffer buffer{VK_NULL_HANDLE};
+		VkDeviceMemory memory{VK_NULL_HANDLE};
+		char* mappedData{nullptr};
+		VkDeviceSize size{0};
+		// The space in use is [tail, head), wrapping around the end. 'head == tail' means that it's empty,
+		// the ring is never filled up completely.
+		VkDeviceSize head{0};
+		VkDeviceSize tail{0};
+		std::deque<Submission> submissions;
+		bool initialized{false};
+	};
+
+}
\ No newline at end of file
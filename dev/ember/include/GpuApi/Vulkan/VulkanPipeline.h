@@ -22,6 +22,9 @@ namespace ember {
         void SetFragmentShaderModule(const VulkanShaderModule& fragmentShaderModule);
 
         void SetVertexLayoutInterleaved(const VertexBufferInfo& vbInfo);
+        void SetVertexInputDescription(
+            const std::vector<VkVertexInputBindingDescription>& bindingDescs,
+            const std::vector<VkVertexInputAttributeDescription>& attribDescs);
         void SetPrimitiveTopology(VkPrimitiveTopology topology);
 
         void SetViewport(VkViewport viewport);
@@ -35,6 +38,10 @@ namespace ember {
         void EnableMultisampling(VkSampleCountFlagBits vulkanSampleCount);
         void DisableMultisampling();
 
+        // The render pass must have a depth attachment.
+        void EnableDepthTest(VkCompareOp depthCompareOp);
+        void DisableDepthTest();
+
         void SetBlendingAttachmentState(
             const VkPipelineColorBlendAttachmentState& blendingAttachmentState, uint32_t attachmentIdx);
         void SetDefaultBlendingAttachmentState(
@@ -61,6 +68,7 @@ namespace ember {
         VkPipelineViewportStateCreateInfo CreateVulkanViewportStateInfo() const;
         VkPipelineRasterizationStateCreateInfo CreateVulkanRasterizationStateInfo() const;
         VkPipelineMultisampleStateCreateInfo CreateVulkanMultisampleStateInfo() const;
+        VkPipelineDepthStencilStateCreateInfo CreateVulkanDepthStencilStateInfo() const;
         VkPipelineColorBlendStateCreateInfo CreateVulkanBlendingStateInfo() const;
         VkPipelineDynamicStateCreateInfo CreateVulkanDynamicStateInfo() const;
 
@@ -89,6 +97,9 @@ namespace ember {
 
         VkSampleCountFlagBits samples{};
         bool multisamplingEnabled{};
+
+        VkCompareOp depthCompareOp{};
+        bool depthTestEnabled{};
     };
     
 }
\ No newline at end of file
@@ -2,15 +2,20 @@
 
 #include <vulkan/vulkan.h>
 
+#include <vector>
+
 namespace ember {
 
 	class VulkanPipelineLayout {
 	public:
+		void AddPushConstantRange(const VkPushConstantRange& pushConstantRange);
+
 		void CreatePipelineLayout(VkDevice device);
 		void DestroyPipelineLayout(VkDevice device);
 		VkPipelineLayout GetPipelineLayout() const;
 
 	private:
+		std::vector<VkPushConstantRange> pushConstantRanges;
 		VkPipelineLayout pipelineLayout{VK_NULL_HANDLE};
 	};
 
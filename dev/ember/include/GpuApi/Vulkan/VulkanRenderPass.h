@@ -9,6 +9,7 @@ namespace ember {
 
 	struct VulkanAttachmentReferences {
 		std::vector<VkAttachmentReference> colorAttachments;
+		VkAttachmentReference depthStencilAttachment{};
 	};
 
 	class VulkanRenderPass {
@@ -21,6 +22,7 @@ namespace ember {
 		void SetAttachment(
 			const VkAttachmentDescription& attachmentDescription,
 			uint32_t attachmentIdx);
+		void SetSubpassDependency(const VkSubpassDependency& subpassDependency, uint32_t subpassDependencyIdx);
 
 		void SetRenderTargetColorAttachment(VkFormat attachmentFormat, uint32_t attachmentIdx);
 		void SetPresentRenderTargetColorAttachment(VkFormat attachmentFormat, uint32_t attachmentIdx);
@@ -33,6 +35,7 @@ namespace ember {
 		void SetSubpassColorAttachmentReferences(const std::vector<uint32_t>& attachments, uint32_t subpassIdx);
 		void SetSubpassColorAttachmentReferences(
 			const std::vector<uint32_t>& attachments, VkImageLayout layout, uint32_t subpassIdx);
+		void SetSubpassDepthStencilAttachmentReference(uint32_t attachmentId, uint32_t subpassIdx);
 
 		void CreateRenderPass(VkDevice device);
 		void DestroyRenderPass(VkDevice device);
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "GpuApi/Vulkan/Memory/VulkanStagingRing.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace ember {
+
+	// A copy from a staging buffer.
+	struct VulkanBufferUpload {
+		VkBuffer dstBuffer{VK_NULL_HANDLE};
+		VkBufferCopy region{};
+	};
+
+	// Records the copies from 'srcBuffer', one copy command per destination buffer. Reorders 'uploads'.
+	void RecordVulkanBufferUploads(VkCommandBuffer commandBuffer, VkBuffer srcBuffer,
+	                               std::vector<VulkanBufferUpload>& uploads);
+
+	// Uploads that don't hold up the frames: the copies are batched into submissions of their own, on a transfer
+	// queue if the device has one (it runs alongside the graphics queue), and the frames keep going without the
+	// data until it's there. Every batch signals the next value of a timeline semaphore, 'Update()' polls it.
+	//
+	// The destination ranges must not be in use by the other queues until the value of their batch is reached,
+	// and the queue that reads them must wait for that value (already reached, so it doesn't stall), so that
+	// the writes are visible to it. The buffers must be shared with the queue family ('VK_SHARING_MODE_CONCURRENT')
+	// if it's a different one.
+	class VulkanUploadScheduler {
+	public:
+		// 'commandPool' must be of the family of 'queue', with 'VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT'.
+		void Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue queue, VkCommandPool commandPool,
+		                VkDeviceSize stagingSize);
+		void Destroy(VkDevice device);
+
+		// Returns where to write the 'size' bytes that go to 'dstBuffer' at 'dstOffset'. Returns nullptr if the
+		// staging ring is full, it's given back as the batches finish (the upload can be retried later).
+		char* StageUpload(VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size);
+		// Submits the uploads staged since the previous call as one batch, if there are any.
+		void Submit(VkDevice device);
+		// Checks which batches finished, and gives back their staging space.
+		void Update(VkDevice device);
+
+		// The value the uploads staged so far are done at (once they're submitted).
+		uint64_t GetPendingValue() const;
+		// The value reached as of the last 'Update()'.
+		uint64_t GetCompletedValue() const;
+		VkSemaphore GetTimelineSemaphore() const;
+		VkDeviceSize GetStagingSize() const;
+		bool IsInitialized() const;
+
+	private:
+		struct Batch {
+			VkCommandBuffer commandBuffer{VK_NULL_HANDLE};
+			uint64_t value{0};
+		};
+
+		VkQueue queue{VK_NULL_HANDLE};
+		VkCommandPool commandPool{VK_NULL_HANDLE};
+		VkSemaphore timelineSemaphore{VK_NULL_HANDLE};
+		VulkanStagingRing stagingRing;
+		std::vector<VulkanBufferUpload> pendingUploads;
+		std::deque<Batch> batches;
+		// The command buffers of the finished batches, reused.
+		std::vector<VkCommandBuffer> freeCommandBuffers;
+		uint64_t nextValue{1};
+		uint64_t completedValue{0};
+		bool initialized{false};
+	};
+
+}
\ No newline at end of file
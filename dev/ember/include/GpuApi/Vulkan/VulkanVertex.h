@@ -10,6 +10,7 @@ namespace ember {
 	VkFormat PickVulkanVertexAttribFormat(VertexAttribFormat format, uint32_t dimension);
 
 	VkFormat PickFloat32VulkanVertexAttribFormat(uint32_t dimension);
+	VkFormat PickFloat16VulkanVertexAttribFormat(uint32_t dimension);
 
 	VkFormat PickUint32VulkanVertexAttribFormat(uint32_t dimension);
 	VkFormat PickUint16VulkanVertexAttribFormat(uint32_t dimension);
@@ -19,6 +20,11 @@ namespace ember {
 	VkFormat PickInt16VulkanVertexAttribFormat(uint32_t dimension);
 	VkFormat PickInt8VulkanVertexAttribFormat(uint32_t dimension);
 
+	VkFormat PickSnorm16VulkanVertexAttribFormat(uint32_t dimension);
+	VkFormat PickSnorm8VulkanVertexAttribFormat(uint32_t dimension);
+	VkFormat PickUnorm16VulkanVertexAttribFormat(uint32_t dimension);
+	VkFormat PickUnorm8VulkanVertexAttribFormat(uint32_t dimension);
+
 	VertexAttribFormat InferVertexAttribFormat(VkFormat vkFormat);
 	uint32_t InferVertexAttribDimension(VkFormat vkFormat);
 
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+namespace ember {
+
+	// Axis aligned bounds of 'count' positions (3 floats per position).
+	// 'min' is +inf and 'max' is -inf if 'count' is 0. Large inputs are split across threads.
+	void ComputePositionBounds(const float* positions, size_t count, float min[3], float max[3]);
+
+	// Same as above, for the positions transformed by an affine transform. 'affine' is a column major 3x4 matrix:
+	// the 3 columns of the linear part followed by the translation (12 floats). The points are never
+	// stored, the transform and the min/max reduction are done in registers.
+	void ComputeTransformedPositionBounds(const float* positions, size_t count, const float affine[12],
+	                                      float min[3], float max[3]);
+
+	// A batch of boxes in the structure of arrays form, 'center[axis][box]' and 'extent[axis][box]'
+	// (the extent is the half size, same as 'numa::AABB::radius').
+	struct AabbStreams {
+		const float* center[3]{nullptr, nullptr, nullptr};
+		const float* extent[3]{nullptr, nullptr, nullptr};
+	};
+	struct AabbOutputStreams {
+		float* center[3]{nullptr, nullptr, nullptr};
+		float* extent[3]{nullptr, nullptr, nullptr};
+	};
+	// A batch of affine transforms, 'elements[element][instance]', with the elements in the same
+	// column major 3x4 order as the 'affine' parameter of 'ComputeTransformedPositionBounds()'.
+	struct AffineTransformStreams {
+		const float* elements[12]{};
+	};
+
+	// Bounds of the transformed boxes with the center/extent method ("Transforming Axis-Aligned Bounding Boxes",
+	// Arvo 1990): the center is transformed, and the new extent is the absolute linear part times the old one.
+	// Gives exactly the bounds of the 8 transformed corners, without transforming them. 4 (SSE) or 8 (AVX2)
+	// boxes are done at a time, large batches are split across threads. 'dst' can alias 'src'.
+	void TransformAabbs(const AabbOutputStreams& dst, const AabbStreams& src,
+	                    const AffineTransformStreams& transforms, size_t count);
+
+}
\ No newline at end of file
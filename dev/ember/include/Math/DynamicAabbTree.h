@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Math/Frustum.h"
+
+#include "Vec.hpp"
+#include "Shape.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace ember {
+
+	struct DynamicAabbTreeSettings {
+		// The boxes in the tree are enlarged by 'margin' plus 'relativeMargin' times their extent (on every side),
+		// so that an object that moves a little stays inside of its box and the tree doesn't change.
+		float margin{0.1f};
+		float relativeMargin{0.1f};
+	};
+
+	struct AabbTreeRayHit {
+		uint32_t handle{0};
+		// Where the ray enters the (enlarged) box, 'origin + direction * t'.
+		float t{0.0f};
+	};
+
+	// A bounding volume hierarchy of objects that move, are added and removed at runtime (the mesh instances
+	// of a scene, with the world bounds from 'Mesh::ComputeWorldAABBApproximate()'), for the culling and the
+	// picking. The objects are identified by their handles, whatever the owner uses for them.
+	//
+	// A binary tree built incrementally: a new leaf goes next to the node where it increases the surface area
+	// of the tree the least (the branch and bound descent of Box2D, "Dynamic Bounding Volume Hierarchies",
+	// Catto 2019), and the nodes on the way up are rotated when that lowers the SAH cost ("Fast, Effective BVH
+	// Updates for Animated Scenes", Kopta et al. 2012). The leaves have enlarged boxes, an update only moves
+	// a leaf when the new box isn't inside of its enlarged one anymore.
+	//
+	// The queries test the enlarged boxes, so they're conservative, and append the handles in no particular order.
+	class DynamicAabbTree {
+	public:
+		explicit DynamicAabbTree(const DynamicAabbTreeSettings& settings = DynamicAabbTreeSettings{});
+
+		// Returns 'false' if the handle is in the tree already.
+		bool Insert(uint32_t handle, const numa::AABB& aabb);
+		// Returns 'true' if the leaf was moved in the tree (the box left its enlarged one),
+		// 'false' if it was inside of it or the handle isn't in the tree.
+		bool Update(uint32_t handle, const numa::AABB& aabb);
+		// Returns 'false' if the handle isn't in the tree.
+		bool Remove(uint32_t handle);
+		void Clear();
+
+		bool Contains(uint32_t handle) const;
+		size_t GetSize() const;
+		// The number of nodes on the longest path from the root to a leaf, 0 for an empty tree.
+		uint32_t GetHeight() const;
+		// The enlarged box of the handle. Returns 'false' if it isn't in the tree.
+		bool GetFatAabb(uint32_t handle, numa::AABB& aabb) const;
+
+		void QueryBox(const numa::AABB& box, std::vector<uint32_t>& handles) const;
+		void QuerySphere(const numa::Vec3& center, float radius, std::vector<uint32_t>& handles) const;
+		// The subtrees that are completely inside of the frustum are added without testing their nodes.
+		void QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& handles) const;
+		// The boxes hit by the ray in [0, tMax], sorted by the distance of their entry points (so the closest
+		// instance is found by ray casting their meshes in this order until a hit is closer than the next box).
+		// 'direction' doesn't have to be normalized, the distances are in its units.
+		void QueryRay(const numa::Vec3& origin, const numa::Vec3& direction, std::vector<AabbTreeRayHit>& hits,
+		              float tMax = std::numeric_limits<float>::infinity()) const;
+
+	private:
+		static constexpr uint32_t nullNode{~0u};
+
+		// The leaves have no children ('children[0] == nullNode'), the free nodes link the next free one
+		// through 'parent'.
+		struct Node {
+			numa::Vec3 min{0.0f};
+			numa::Vec3 max{0.0f};
+			uint32_t parent{nullNode};
+			uint32_t children[2]{nullNode, nullNode};
+			uint32_t handle{0};
+			uint32_t height{0};
+
+			bool IsLeaf() const;
+		};
+
+		uint32_t AllocateNode();
+		void FreeNode(uint32_t nodeIdx);
+		void InsertLeaf(uint32_t leaf);
+		void RemoveLeaf(uint32_t leaf);
+		// Walks from the node to the root, refitting and rotating the nodes.
+		void RefitAncestors(uint32_t nodeIdx);
+		void RefitNode(uint32_t nodeIdx);
+		void RotateNode(uint32_t nodeIdx);
+		void SwapSubtrees(uint32_t first, uint32_t second);
+		void SetFatBounds(Node& leaf, const numa::AABB& aabb) const;
+
+		template <typename NodeTest>
+		void Query(std::vector<uint32_t>& handles, NodeTest&& nodeTest) const;
+		void AppendSubtree(uint32_t nodeIdx, std::vector<uint32_t>& handles, std::vector<uint32_t>& stack) const;
+
+		DynamicAabbTreeSettings settings;
+		std::vector<Node> nodes;
+		std::unordered_map<uint32_t, uint32_t> leaves;
+		uint32_t root{nullNode};
+		uint32_t freeList{nullNode};
+	};
+
+}
\ No newline at end of file
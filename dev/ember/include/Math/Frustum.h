@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Vec.hpp"
+#include "Shape.h"
+
+#include <cstdint>
+
+namespace ember {
+
+	// The depth range of the clip space that the projection matrix maps to.
+	// Vulkan and D3D use [0, 1], OpenGL uses [-1, 1] (unless 'glClipControl()' says otherwise).
+	enum class ClipDepthRange {
+		ZERO_TO_ONE,
+		MINUS_ONE_TO_ONE,
+	};
+
+	enum class FrustumTestResult {
+		OUTSIDE,
+		INTERSECTING,
+		INSIDE,
+	};
+
+	// The planes of a view frustum: left, right, bottom, top, near, far (in this order), facing inwards.
+	// A point 'p' is inside of a plane if 'dot(plane.xyz, p) + plane.w >= 0'. The normals are unit length,
+	// so that's the signed distance. An infinite far plane is a plane that everything is inside of.
+	struct Frustum {
+		static constexpr uint32_t planeCount{6};
+		numa::Vec4 planes[planeCount];
+	};
+
+	// "Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix" (Gribb and Hartmann 2001).
+	// With a view-projection matrix the planes are in the world space, with a world-view-projection one
+	// they're in the object space. Works for both the reversed and the regular depth.
+	Frustum ExtractFrustum(const numa::Mat4& viewProjection, ClipDepthRange depthRange);
+
+	// Conservative: a box that's outside of none of the planes, but still outside of the frustum
+	// (near one of its edges), is reported as intersecting.
+	FrustumTestResult TestFrustumAabb(const Frustum& frustum, const numa::Vec3& min, const numa::Vec3& max);
+	FrustumTestResult TestFrustumSphere(const Frustum& frustum, const numa::Vec3& center, float radius);
+
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Math/BoundsKernels.h"
+#include "Math/Frustum.h"
+
+#include "Vec.hpp"
+#include "Shape.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ember {
+
+	// A batch of oriented boxes in the structure of arrays form. The box spans 'center +- axis[i] * extent[i]',
+	// 'axes[i * 3 + component][box]' is a component of the i-th axis. The axes don't have to be unit length:
+	// 'Mesh::ComputeWorldOBB()' keeps the whole linear part of the world matrix there, with the object extent.
+	struct ObbStreams {
+		const float* center[3]{nullptr, nullptr, nullptr};
+		const float* extent[3]{nullptr, nullptr, nullptr};
+		const float* axes[9]{};
+	};
+
+	// Replaces the contents of 'visible' with the indices of the boxes that aren't outside of any of the frustum
+	// planes, in the ascending order. Same test as 'TestFrustumAabb()', conservative near the edges of the frustum.
+	// 4 (SSE) or 8 (AVX2) boxes are tested against a plane at once, large batches are split across threads.
+	void CullAabbs(std::vector<uint32_t>& visible, const Frustum& frustum, const AabbStreams& boxes, size_t count);
+	void CullObbs(std::vector<uint32_t>& visible, const Frustum& frustum, const ObbStreams& boxes, size_t count);
+
+	// Owning batches of the world bounds of the instances, filled from the bounds that 'Mesh' computes
+	// ('ComputeWorldAABBApproximate()'/'ComputeWorldAABBPrecise()', 'ComputeWorldOBB()'), in the layout the culling wants.
+	// The index of a box is the order it was added in.
+	class AabbBatch {
+	public:
+		void Clear();
+		void Reserve(size_t count);
+		void Add(const numa::AABB& aabb);
+
+		size_t GetSize() const;
+		AabbStreams GetStreams() const;
+
+	private:
+		std::vector<float> center[3];
+		std::vector<float> extent[3];
+	};
+
+	class ObbBatch {
+	public:
+		void Clear();
+		void Reserve(size_t count);
+		void Add(const numa::OBB& obb);
+
+		size_t GetSize() const;
+		ObbStreams GetStreams() const;
+
+	private:
+		std::vector<float> center[3];
+		std::vector<float> extent[3];
+		std::vector<float> axes[9];
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Framework/Asset/Mesh.h"
+#include "Math/BoundsKernels.h"
+#include "Math/Frustum.h"
+
+#include "Vec.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ember {
+
+	struct OcclusionCullerSettings {
+		// The resolution of the depth buffer, rounded up to whole tiles (32x8 pixels).
+		// It only has to be good enough to tell the big occluders apart, a fraction of the screen resolution.
+		uint32_t width{512};
+		uint32_t height{256};
+		// The clip space depth range of the projection matrices, the occluders are clipped the same way the GPU clips them.
+		ClipDepthRange depthRange{ClipDepthRange::ZERO_TO_ONE};
+		// The winding of the front faces in the framebuffer space (y pointing down), same as 'VkFrontFace'.
+		bool counterClockwiseFrontFaces{true};
+		// The projection is orthographic (w is 1 everywhere, e.g. positions that are in the clip space already).
+		// The depth is then the distance to the far side plane (w - z) instead of 1/w, it can't be the reversed one.
+		bool orthographic{false};
+	};
+
+	// A CPU occlusion culler for the scenes with a lot of hidden geometry ("Masked Software Occlusion Culling",
+	// Hasselgren et al. 2016). The occluders are rasterized into a low resolution depth buffer, and the bounding
+	// boxes of the instances are tested against it before their draws are recorded.
+	//
+	// The buffer is made of 32x8 pixel tiles. A tile keeps a coverage mask instead of the depth of every pixel:
+	// the farthest depth of the tile that's completely covered, and a second, partially covered layer that gets
+	// merged into the first one once its mask is full. The depth is 1/w (linear in the screen space, bigger is
+	// nearer), so the depth range and the reversed depth don't matter ('orthographic' is the exception). A pyramid
+	// of the farthest tile depths makes the tests of the big boxes cheap.
+	//
+	// The results are conservative as long as the occluders are inside of what they represent: a simplified LOD
+	// can reach past the silhouette of the full detail mesh (by up to its error), and hide something that's visible.
+	//
+	// Every frame: 'BeginFrame()', 'AddOccluder()' for the occluders (the biggest/nearest ones first, the tiles
+	// fill up faster), 'RasterizeOccluders()', then the tests.
+	class OcclusionCuller {
+	public:
+		explicit OcclusionCuller(const OcclusionCullerSettings& settings = OcclusionCullerSettings{});
+
+		// Clears the occluders and the depth buffer. 'viewProjection' is used by the occluders and the tests.
+		void BeginFrame(const numa::Mat4& viewProjection);
+
+		// The triangles are transformed, clipped and set up right away, but rasterized by 'RasterizeOccluders()'.
+		// 'positions' are 3 floats per vertex. 'indices' is a triangle list (nullptr means the vertices in order,
+		// 'indexCount' of them), every index must be smaller than 'vertexCount'.
+		void AddOccluder(const float* positions, uint32_t vertexCount, const uint32_t* indices, size_t indexCount,
+		                 const numa::Mat4& world, bool cullBackFaces);
+		// A level of detail of the mesh (see 'Mesh::GenerateLods()'), 0 is the full detail one. The levels
+		// past the last one use the last one. Returns 'false' if the mesh isn't a triangle list.
+		bool AddOccluder(const Mesh& mesh, const numa::Mat4& world, uint32_t lodLevel = 0);
+
+		// Rasterizes the occluders in the order they were added. The bands of tile rows are split across threads.
+		void RasterizeOccluders();
+
+		// Returns 'false' if the box is behind the occluders for sure. The boxes that cross the camera plane,
+		// or aren't on the screen, are visible (the frustum culling is a separate step).
+		bool IsAabbVisible(const numa::Vec3& min, const numa::Vec3& max) const;
+		// Replaces the contents of 'visible' with the visible ones of the boxes 'candidates' (e.g. the output
+		// of 'CullAabbs()'), in the same order. 'candidates' can be 'visible.data()'.
+		void CullAabbs(std::vector<uint32_t>& visible, const AabbStreams& boxes, const uint32_t* candidates,
+		               size_t candidateCount) const;
+
+		uint32_t GetWidth() const;
+		uint32_t GetHeight() const;
+		size_t GetOccluderTriangleCount() const;
+		// The depth (1/w) that every pixel of the tile is nearer than, 0 if the tile isn't completely covered yet.
+		float GetTileDepth(uint32_t tileX, uint32_t tileY) const;
+
+	private:
+		static constexpr uint32_t tileWidth{32};
+		static constexpr uint32_t tileHeight{8};
+
+		// An edge as the bound of the covered x of a row: 'x + slope * (rowY - y)', see 'SetupProjectedTriangle()'.
+		struct TriangleEdge {
+			float x;
+			float y;
+			float slope;
+			// A left or a right bound, or a horizontal edge where 'slope' is the sign of the rows that are inside.
+			uint32_t kind;
+		};
+		struct Triangle {
+			TriangleEdge edges[3];
+			// The depth plane 'depthX * x + depthY * y + depthOffset', and the farthest depth of the vertices.
+			float depthX;
+			float depthY;
+			float depthOffset;
+			float minDepth;
+			// The covered tiles, inclusive.
+			uint32_t firstTileX;
+			uint32_t lastTileX;
+			uint32_t firstTileY;
+			uint32_t lastTileY;
+		};
+		struct Tile {
+			// 32 bits per row, bit 'x' of row 'y' is the pixel (x, y) of the tile.
+			uint32_t mask[tileHeight];
+			float depth0;
+			float depth1;
+		};
+
+		void SetupTriangle(std::vector<Triangle>& triangles, const float* v0, const float* v1, const float* v2,
+		                   bool cullBackFaces) const;
+		void SetupProjectedTriangle(std::vector<Triangle>& triangles, const float* v0, const float* v1, const float* v2,
+		                            bool cullBackFaces) const;
+		void RasterizeTileRow(uint32_t tileY);
+		// The covered pixels [start, end) of the 8 rows starting at 'firstRow', the pixels whose centers are
+		// inside of all of the edges. 8 (AVX2) or 4 (SSE) rows at once.
+		static void ComputeRowSpans(const TriangleEdge edges[3], uint32_t firstRow, uint32_t width,
+		                            int32_t starts[8], int32_t ends[8]);
+		void BuildDepthPyramid();
+		bool IsTileRangeOccluded(uint32_t level, uint32_t firstX, uint32_t lastX, uint32_t firstY, uint32_t lastY,
+		                         float depth) const;
+
+		OcclusionCullerSettings settings;
+		uint32_t tileCountX{0};
+		uint32_t tileCountY{0};
+		// Rows of the view-projection matrix.
+		float viewProjection[4][4]{};
+
+		std::vector<Triangle> triangles;
+		std::vector<Tile> tiles;
+		// Level 0 is the 'depth0' of the tiles, every next level is the minimum of 2x2 of the previous one.
+		std::vector<std::vector<float>> depthPyramid;
+		std::vector<uint32_t> pyramidWidths;
+		std::vector<uint32_t> pyramidHeights;
+		// The clip space positions of the occluder that's being added, reused.
+		std::vector<float> clipPositions;
+	};
+
+}
\ No newline at end of file
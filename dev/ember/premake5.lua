@@ -35,7 +35,14 @@ project("ember")
         libdirs    {"%{lib_dirs.vulkan_win32}"}
         links      {"vulkan-1"}
     filter{"system:linux"}
-        links      {"vulkan"}
+        links      {"vulkan", "pthread"}
+
+    filter("options:simd=sse4.1")
+        vectorextensions("SSE4.1")
+    filter("options:simd=avx2")
+        vectorextensions("AVX2")
+    filter({"options:simd=avx2", "toolset:not msc*"})
+        buildoptions({"-mf16c", "-mfma"})
 
     filter("configurations:Debug")
         defines({"DEBUG", "_DEBUG"})
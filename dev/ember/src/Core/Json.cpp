@@ -0,0 +1,349 @@
+#include "Core/Json.h"
+
+#include <charconv>
+#include <cmath>
+#include <limits>
+
+namespace ember {
+
+	static const JsonValue nullJsonValue{};
+	static const std::string emptyJsonString{};
+
+	JsonType JsonValue::GetType() const {
+		return type;
+	}
+	bool JsonValue::IsNull() const {
+		return type == JsonType::NUL;
+	}
+	bool JsonValue::IsNumber() const {
+		return type == JsonType::NUMBER;
+	}
+	bool JsonValue::IsString() const {
+		return type == JsonType::STRING;
+	}
+	bool JsonValue::IsArray() const {
+		return type == JsonType::ARRAY;
+	}
+	bool JsonValue::IsObject() const {
+		return type == JsonType::OBJECT;
+	}
+
+	size_t JsonValue::GetSize() const {
+		return elements.size();
+	}
+	const JsonValue& JsonValue::operator[](size_t idx) const {
+		if (type != JsonType::ARRAY || idx >= elements.size()) {
+			return nullJsonValue;
+		}
+		return elements[idx];
+	}
+	const JsonValue& JsonValue::operator[](const std::string& key) const {
+		if (type != JsonType::OBJECT) {
+			return nullJsonValue;
+		}
+		for (size_t memberIdx = 0; memberIdx < keys.size(); memberIdx++) {
+			if (keys[memberIdx] == key) {
+				return elements[memberIdx];
+			}
+		}
+		return nullJsonValue;
+	}
+	bool JsonValue::HasMember(const std::string& key) const {
+		if (type != JsonType::OBJECT) {
+			return false;
+		}
+		for (const std::string& memberKey : keys) {
+			if (memberKey == key) {
+				return true;
+			}
+		}
+		return false;
+	}
+	const std::string& JsonValue::GetMemberKey(size_t idx) const {
+		if (type != JsonType::OBJECT || idx >= keys.size()) {
+			return emptyJsonString;
+		}
+		return keys[idx];
+	}
+
+	bool JsonValue::AsBool(bool defaultValue) const {
+		return type == JsonType::BOOLEAN ? boolean : defaultValue;
+	}
+	double JsonValue::AsDouble(double defaultValue) const {
+		return type == JsonType::NUMBER ? number : defaultValue;
+	}
+	uint32_t JsonValue::AsUint(uint32_t defaultValue) const {
+		if (type != JsonType::NUMBER || number < 0.0 || number > std::numeric_limits<uint32_t>::max() ||
+		    number != std::floor(number)) {
+			return defaultValue;
+		}
+		return static_cast<uint32_t>(number);
+	}
+	int32_t JsonValue::AsInt(int32_t defaultValue) const {
+		if (type != JsonType::NUMBER || number < std::numeric_limits<int32_t>::min() ||
+		    number > std::numeric_limits<int32_t>::max() || number != std::floor(number)) {
+			return defaultValue;
+		}
+		return static_cast<int32_t>(number);
+	}
+	const std::string& JsonValue::AsString() const {
+		return type == JsonType::STRING ? string : emptyJsonString;
+	}
+
+	// A recursive descent parser, the nesting depth is limited so that a malicious file can't blow the stack.
+	class JsonParser {
+	public:
+		JsonParser(const char* text, size_t length) : cur{text}, begin{text}, end{text + length} {}
+
+		bool Parse(JsonValue& root) {
+			SkipWhitespace();
+			if (!ParseValue(root, 0)) {
+				return false;
+			}
+			SkipWhitespace();
+			return cur == end || Fail("Unexpected characters after the root value");
+		}
+
+		std::string GetError() const {
+			return error + " (at byte " + std::to_string(errorOffset) + ")";
+		}
+
+	private:
+		static constexpr uint32_t maxDepth{256};
+
+		bool Fail(const char* message) {
+			if (error.empty()) {
+				this->error = message;
+				this->errorOffset = static_cast<size_t>(cur - begin);
+			}
+			return false;
+		}
+
+		void SkipWhitespace() {
+			while (cur < end && (*cur == ' ' || *cur == '\t' || *cur == '\n' || *cur == '\r')) {
+				cur++;
+			}
+		}
+		bool Consume(char expected) {
+			SkipWhitespace();
+			if (cur < end && *cur == expected) {
+				cur++;
+				return true;
+			}
+			return false;
+		}
+		bool ConsumeLiteral(const char* literal, size_t literalLength) {
+			if (static_cast<size_t>(end - cur) < literalLength || std::string(cur, literalLength) != literal) {
+				return Fail("Invalid literal");
+			}
+			cur += literalLength;
+			return true;
+		}
+
+		bool ParseValue(JsonValue& value, uint32_t depth) {
+			if (depth > maxDepth) {
+				return Fail("The document is nested too deep");
+			}
+			SkipWhitespace();
+			if (cur == end) {
+				return Fail("Unexpected end of the document");
+			}
+			switch (*cur) {
+				case '{':
+					return ParseObject(value, depth);
+				case '[':
+					return ParseArray(value, depth);
+				case '"':
+					value.type = JsonType::STRING;
+					return ParseString(value.string);
+				case 't':
+					value.type = JsonType::BOOLEAN;
+					value.boolean = true;
+					return ConsumeLiteral("true", 4);
+				case 'f':
+					value.type = JsonType::BOOLEAN;
+					value.boolean = false;
+					return ConsumeLiteral("false", 5);
+				case 'n':
+					value.type = JsonType::NUL;
+					return ConsumeLiteral("null", 4);
+				default:
+					value.type = JsonType::NUMBER;
+					return ParseNumber(value.number);
+			}
+		}
+
+		bool ParseObject(JsonValue& value, uint32_t depth) {
+			value.type = JsonType::OBJECT;
+			cur++;
+			if (Consume('}')) {
+				return true;
+			}
+			do {
+				SkipWhitespace();
+				if (cur == end || *cur != '"') {
+					return Fail("Expected an object key");
+				}
+				value.keys.emplace_back();
+				if (!ParseString(value.keys.back())) {
+					return false;
+				}
+				if (!Consume(':')) {
+					return Fail("Expected ':' after an object key");
+				}
+				value.elements.emplace_back();
+				if (!ParseValue(value.elements.back(), depth + 1)) {
+					return false;
+				}
+			} while (Consume(','));
+			return Consume('}') || Fail("Expected ',' or '}' in an object");
+		}
+
+		bool ParseArray(JsonValue& value, uint32_t depth) {
+			value.type = JsonType::ARRAY;
+			cur++;
+			if (Consume(']')) {
+				return true;
+			}
+			do {
+				value.elements.emplace_back();
+				if (!ParseValue(value.elements.back(), depth + 1)) {
+					return false;
+				}
+			} while (Consume(','));
+			return Consume(']') || Fail("Expected ',' or ']' in an array");
+		}
+
+		bool ParseHex4(uint32_t& codeUnit) {
+			if (end - cur < 4) {
+				return Fail("Truncated unicode escape");
+			}
+			auto result = std::from_chars(cur, cur + 4, codeUnit, 16);
+			if (result.ptr != cur + 4) {
+				return Fail("Invalid unicode escape");
+			}
+			cur += 4;
+			return true;
+		}
+		static void AppendUtf8(std::string& str, uint32_t codePoint) {
+			if (codePoint < 0x80) {
+				str += static_cast<char>(codePoint);
+			} else if (codePoint < 0x800) {
+				str += static_cast<char>(0xC0 | (codePoint >> 6));
+				str += static_cast<char>(0x80 | (codePoint & 0x3F));
+			} else if (codePoint < 0x10000) {
+				str += static_cast<char>(0xE0 | (codePoint >> 12));
+				str += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+				str += static_cast<char>(0x80 | (codePoint & 0x3F));
+			} else {
+				str += static_cast<char>(0xF0 | (codePoint >> 18));
+				str += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+				str += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+				str += static_cast<char>(0x80 | (codePoint & 0x3F));
+			}
+		}
+
+		bool ParseString(std::string& str) {
+			cur++;
+			while (true) {
+				// The plain characters are appended in runs.
+				const char* runBegin = cur;
+				while (cur < end && *cur != '"' && *cur != '\\' && static_cast<unsigned char>(*cur) >= 0x20) {
+					cur++;
+				}
+				str.append(runBegin, cur);
+				if (cur == end) {
+					return Fail("Unterminated string");
+				}
+				if (*cur == '"') {
+					cur++;
+					return true;
+				}
+				if (*cur != '\\') {
+					return Fail("Control character in a string");
+				}
+				cur++;
+				if (cur == end) {
+					return Fail("Unterminated string");
+				}
+				char escaped = *cur++;
+				switch (escaped) {
+					case '"': str += '"'; break;
+					case '\\': str += '\\'; break;
+					case '/': str += '/'; break;
+					case 'b': str += '\b'; break;
+					case 'f': str += '\f'; break;
+					case 'n': str += '\n'; break;
+					case 'r': str += '\r'; break;
+					case 't': str += '\t'; break;
+					case 'u': {
+						uint32_t codePoint{0};
+						if (!ParseHex4(codePoint)) {
+							return false;
+						}
+						// A surrogate pair encodes a code point outside of the BMP.
+						if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+							uint32_t low{0};
+							if (end - cur < 2 || cur[0] != '\\' || cur[1] != 'u') {
+								return Fail("Unpaired surrogate");
+							}
+							cur += 2;
+							if (!ParseHex4(low)) {
+								return false;
+							}
+							if (low < 0xDC00 || low >= 0xE000) {
+								return Fail("Unpaired surrogate");
+							}
+							codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+						} else if (codePoint >= 0xDC00 && codePoint < 0xE000) {
+							return Fail("Unpaired surrogate");
+						}
+						AppendUtf8(str, codePoint);
+						break;
+					}
+					default:
+						return Fail("Invalid escape sequence");
+				}
+			}
+		}
+
+		bool ParseNumber(double& number) {
+			// 'from_chars()' accepts a superset of the JSON grammar (e.g. "inf"), which is harmless here.
+			// Unlike 'strtod()' it doesn't depend on the locale and doesn't need a null terminated string.
+			const char* numberBegin = cur;
+			if (cur < end && *cur == '-') {
+				cur++;
+			}
+			if (cur == end || *cur < '0' || *cur > '9') {
+				cur = numberBegin;
+				return Fail("Invalid value");
+			}
+			auto result = std::from_chars(numberBegin, end, number);
+			if (result.ec != std::errc{}) {
+				return Fail("Invalid number");
+			}
+			cur = result.ptr;
+			return true;
+		}
+
+		const char* cur{nullptr};
+		const char* begin{nullptr};
+		const char* end{nullptr};
+		std::string error;
+		size_t errorOffset{0};
+	};
+
+	bool ParseJson(JsonValue& root, const char* text, size_t length, std::string* error) {
+		root = JsonValue{};
+		JsonParser parser{text, length};
+		if (!parser.Parse(root)) {
+			root = JsonValue{};
+			if (error != nullptr) {
+				*error = parser.GetError();
+			}
+			return false;
+		}
+		return true;
+	}
+
+}
\ No newline at end of file
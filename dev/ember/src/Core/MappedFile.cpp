@@ -0,0 +1,120 @@
+#include "Core/MappedFile.h"
+
+#ifdef EMBER_PLATFORM_WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#elif EMBER_PLATFORM_LINUX
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace ember {
+
+	MappedFile::~MappedFile() {
+		Close();
+	}
+	MappedFile::MappedFile(MappedFile&& other) noexcept {
+		*this = std::move(other);
+	}
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+		if (this != &other) {
+			Close();
+			std::swap(data, other.data);
+			std::swap(sizeInBytes, other.sizeInBytes);
+#ifdef EMBER_PLATFORM_WIN32
+			std::swap(fileHandle, other.fileHandle);
+			std::swap(mappingHandle, other.mappingHandle);
+#endif
+		}
+		return *this;
+	}
+
+#ifdef EMBER_PLATFORM_WIN32
+	bool MappedFile::Open(const std::string& path) {
+		Close();
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		LARGE_INTEGER fileSize{};
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+			CloseHandle(file);
+			return false;
+		}
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr) {
+			CloseHandle(file);
+			return false;
+		}
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (view == nullptr) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+		this->data = static_cast<const char*>(view);
+		this->sizeInBytes = static_cast<size_t>(fileSize.QuadPart);
+		this->fileHandle = file;
+		this->mappingHandle = mapping;
+		return true;
+	}
+	void MappedFile::Close() {
+		if (data != nullptr) {
+			UnmapViewOfFile(data);
+			CloseHandle(static_cast<HANDLE>(mappingHandle));
+			CloseHandle(static_cast<HANDLE>(fileHandle));
+		}
+		this->data = nullptr;
+		this->sizeInBytes = 0;
+		this->fileHandle = nullptr;
+		this->mappingHandle = nullptr;
+	}
+#elif EMBER_PLATFORM_LINUX
+	bool MappedFile::Open(const std::string& path) {
+		Close();
+		int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (file < 0) {
+			return false;
+		}
+		struct stat fileStat{};
+		if (fstat(file, &fileStat) != 0 || fileStat.st_size <= 0) {
+			close(file);
+			return false;
+		}
+		size_t fileSize = static_cast<size_t>(fileStat.st_size);
+		void* view = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, file, 0);
+		// The mapping keeps its own reference to the file.
+		close(file);
+		if (view == MAP_FAILED) {
+			return false;
+		}
+		this->data = static_cast<const char*>(view);
+		this->sizeInBytes = fileSize;
+		return true;
+	}
+	void MappedFile::Close() {
+		if (data != nullptr) {
+			munmap(const_cast<char*>(data), sizeInBytes);
+		}
+		this->data = nullptr;
+		this->sizeInBytes = 0;
+	}
+#endif
+
+	bool MappedFile::IsOpen() const {
+		return data != nullptr;
+	}
+
+	const char* MappedFile::GetData() const {
+		return data;
+	}
+	size_t MappedFile::GetSizeInBytes() const {
+		return sizeInBytes;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#include "Core/Parallel.h"
+
+namespace ember {
+
+	uint32_t GetParallelWorkerCount() {
+		// Can return 0 if the value isn't computable.
+		static const uint32_t workerCount = std::max(1u, std::thread::hardware_concurrency());
+		return workerCount;
+	}
+
+	size_t GetParallelChunkCount(size_t count, size_t minChunkSize) {
+		minChunkSize = std::max<size_t>(minChunkSize, 1);
+		size_t maxChunkCount = std::max<size_t>(count / minChunkSize, 1);
+		return std::min<size_t>(GetParallelWorkerCount(), maxChunkCount);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,506 @@
+#include "Framework/Asset/GltfImporter.h"
+#include "Core/Json.h"
+#include "Core/Parallel.h"
+#include "Framework/Asset/VertexKernels.h"
+
+#include <charconv>
+#include <cstring>
+#include <type_traits>
+
+namespace ember {
+
+	static constexpr uint32_t glbMagic{0x46546C67}; // "glTF"
+	static constexpr uint32_t glbChunkJson{0x4E4F534A}; // "JSON"
+	static constexpr uint32_t glbChunkBin{0x004E4942}; // "BIN\0"
+
+	// A resolved glTF accessor: where its elements are and what they look like.
+	struct GltfAccessor {
+		// The first element. 'nullptr' if the accessor has no buffer view (all of its elements are zeros).
+		const char* data{nullptr};
+		uint32_t count{0};
+		uint32_t stride{0};
+		uint32_t componentCount{0};
+		uint32_t componentType{0};
+		VertexAttribFormat format{};
+	};
+
+	static uint32_t GetGltfComponentSize(uint32_t componentType) {
+		switch (componentType) {
+			case 5120: // BYTE
+			case 5121: // UNSIGNED_BYTE
+				return 1;
+			case 5122: // SHORT
+			case 5123: // UNSIGNED_SHORT
+				return 2;
+			case 5125: // UNSIGNED_INT
+			case 5126: // FLOAT
+				return 4;
+			default:
+				return 0;
+		}
+	}
+	static bool GetGltfVertexAttribFormat(VertexAttribFormat& format, uint32_t componentType, bool normalized) {
+		switch (componentType) {
+			case 5120:
+				format = normalized ? VertexAttribFormat::SNORM8 : VertexAttribFormat::INT8;
+				return true;
+			case 5121:
+				format = normalized ? VertexAttribFormat::UNORM8 : VertexAttribFormat::UINT8;
+				return true;
+			case 5122:
+				format = normalized ? VertexAttribFormat::SNORM16 : VertexAttribFormat::INT16;
+				return true;
+			case 5123:
+				format = normalized ? VertexAttribFormat::UNORM16 : VertexAttribFormat::UINT16;
+				return true;
+			case 5125:
+				format = VertexAttribFormat::UINT32;
+				return !normalized;
+			case 5126:
+				format = VertexAttribFormat::FLOAT32;
+				return !normalized;
+			default:
+				return false;
+		}
+	}
+	static uint32_t GetGltfComponentCount(const std::string& type) {
+		if (type == "SCALAR") {
+			return 1;
+		} else if (type == "VEC2") {
+			return 2;
+		} else if (type == "VEC3") {
+			return 3;
+		} else if (type == "VEC4") {
+			return 4;
+		}
+		// The matrices are never vertex attributes or indices.
+		return 0;
+	}
+	static bool GetGltfMeshTopology(MeshTopology& meshTopology, uint32_t mode) {
+		switch (mode) {
+			case 0:
+				meshTopology = MeshTopology::POINTS;
+				return true;
+			case 1:
+				meshTopology = MeshTopology::LINES;
+				return true;
+			case 3:
+				meshTopology = MeshTopology::LINE_STRIP;
+				return true;
+			case 4:
+				meshTopology = MeshTopology::TRIANGLES;
+				return true;
+			case 5:
+				meshTopology = MeshTopology::TRIANGLE_STRIP;
+				return true;
+			default:
+				// LINE_LOOP and TRIANGLE_FAN have no 'MeshTopology'.
+				return false;
+		}
+	}
+
+	static bool ResolveGltfAccessor(GltfAccessor& accessor, const JsonValue& document,
+	                                const std::vector<Span<const char>>& buffers, uint32_t accessorIdx, std::string& warning) {
+		const JsonValue& accessorJson = document["accessors"][accessorIdx];
+		if (!accessorJson.IsObject()) {
+			warning = "Accessor " + std::to_string(accessorIdx) + " doesn't exist";
+			return false;
+		}
+		if (accessorJson.HasMember("sparse")) {
+			warning = "Sparse accessors aren't supported (accessor " + std::to_string(accessorIdx) + ")";
+			return false;
+		}
+		accessor.count = accessorJson["count"].AsUint();
+		accessor.componentType = accessorJson["componentType"].AsUint();
+		accessor.componentCount = GetGltfComponentCount(accessorJson["type"].AsString());
+		uint32_t componentSize = GetGltfComponentSize(accessor.componentType);
+		if (accessor.componentCount == 0 || componentSize == 0 ||
+		    !GetGltfVertexAttribFormat(accessor.format, accessor.componentType, accessorJson["normalized"].AsBool())) {
+			warning = "Accessor " + std::to_string(accessorIdx) + " has an unsupported type";
+			return false;
+		}
+		uint32_t elementSize = accessor.componentCount * componentSize;
+		accessor.stride = elementSize;
+		if (!accessorJson.HasMember("bufferView")) {
+			accessor.data = nullptr;
+			return true;
+		}
+
+		const JsonValue& viewJson = document["bufferViews"][accessorJson["bufferView"].AsUint(UINT32_MAX)];
+		uint32_t bufferIdx = viewJson["buffer"].AsUint(UINT32_MAX);
+		if (!viewJson.IsObject() || bufferIdx >= buffers.size()) {
+			warning = "Accessor " + std::to_string(accessorIdx) + " has an invalid buffer view";
+			return false;
+		}
+		accessor.stride = viewJson["byteStride"].AsUint(elementSize);
+		uint64_t viewOffset = viewJson["byteOffset"].AsUint();
+		uint64_t viewLength = viewJson["byteLength"].AsUint();
+		uint64_t accessorOffset = accessorJson["byteOffset"].AsUint();
+		// The last element has to fit the view, and the view has to fit the buffer.
+		uint64_t accessorEnd = accessor.count == 0 ? accessorOffset :
+		                       accessorOffset + uint64_t{accessor.stride} * (accessor.count - 1) + elementSize;
+		if (accessor.stride < elementSize || accessorEnd > viewLength || viewOffset + viewLength > buffers[bufferIdx].size()) {
+			warning = "Accessor " + std::to_string(accessorIdx) + " is out of the bounds of its buffer";
+			return false;
+		}
+		accessor.data = buffers[bufferIdx].data() + viewOffset + accessorOffset;
+		return true;
+	}
+
+	// Views the accessor if it's already laid out like the 'Mesh' array, decodes it into 'decoded' otherwise.
+	template <typename T>
+	static void ImportGltfVertexAttrib(Span<const T>& stream, std::vector<T>& decoded, const GltfAccessor& accessor) {
+		static_assert(std::is_trivially_copyable_v<T>, "The vertex attribute arrays are filled as floats!");
+		constexpr uint32_t components{static_cast<uint32_t>(sizeof(T) / sizeof(float))};
+		bool aligned = reinterpret_cast<uintptr_t>(accessor.data) % alignof(T) == 0;
+		if (accessor.data != nullptr && aligned && accessor.format == VertexAttribFormat::FLOAT32 &&
+		    accessor.componentCount == components && accessor.stride == sizeof(T)) {
+			stream = Span<const T>{reinterpret_cast<const T*>(accessor.data), accessor.count};
+			return;
+		}
+		decoded.resize(accessor.count);
+		float* dst = reinterpret_cast<float*>(decoded.data());
+		if (accessor.data == nullptr) {
+			std::memset(dst, 0, decoded.size() * sizeof(T));
+		} else {
+			// The kernels read the components one by one, so the source doesn't have to be aligned.
+			VertexAttribDecodeKernel kernel = PickVertexAttribDecodeKernel(accessor.format, accessor.componentCount, components);
+			kernel(accessor.data, accessor.stride, accessor.componentCount, dst, components, accessor.count);
+		}
+		stream = decoded;
+	}
+
+	template <typename IndexType>
+	static void DecodeGltfIndices(uint32_t* dst, const char* src, uint32_t stride, uint32_t count) {
+		for (uint32_t idx = 0; idx < count; idx++) {
+			IndexType index{};
+			std::memcpy(&index, src + static_cast<size_t>(idx) * stride, sizeof(IndexType));
+			dst[idx] = index;
+		}
+	}
+	static bool ImportGltfIndices(Span<const uint32_t>& stream, std::vector<uint32_t>& decoded, const GltfAccessor& accessor) {
+		if (accessor.componentCount != 1 || accessor.data == nullptr) {
+			return false;
+		}
+		bool aligned = reinterpret_cast<uintptr_t>(accessor.data) % alignof(uint32_t) == 0;
+		if (accessor.componentType == 5125 && aligned && accessor.stride == sizeof(uint32_t)) {
+			stream = Span<const uint32_t>{reinterpret_cast<const uint32_t*>(accessor.data), accessor.count};
+			return true;
+		}
+		decoded.resize(accessor.count);
+		switch (accessor.componentType) {
+			case 5121:
+				DecodeGltfIndices<uint8_t>(decoded.data(), accessor.data, accessor.stride, accessor.count);
+				break;
+			case 5123:
+				DecodeGltfIndices<uint16_t>(decoded.data(), accessor.data, accessor.stride, accessor.count);
+				break;
+			case 5125:
+				DecodeGltfIndices<uint32_t>(decoded.data(), accessor.data, accessor.stride, accessor.count);
+				break;
+			default:
+				return false;
+		}
+		stream = decoded;
+		return true;
+	}
+
+	static void AppendGltfWarning(std::string& warnings, const std::string& warning) {
+		warnings += warnings.empty() ? warning : "; " + warning;
+	}
+
+	// Runs on a worker thread. The mesh is being edited (see 'Mesh::BeginEdit()'), so the GPU updates
+	// and the notifications wait for the calling thread.
+	template <typename Decoded>
+	static bool ImportGltfPrimitive(Mesh& mesh, Decoded& decoded, const JsonValue& document, const JsonValue& primitiveJson,
+	                                const std::vector<Span<const char>>& buffers, const GltfImportSettings& settings,
+	                                std::string& warning) {
+		MeshTopology meshTopology{};
+		if (!GetGltfMeshTopology(meshTopology, primitiveJson["mode"].AsUint(4))) {
+			warning = "Unsupported primitive mode " + std::to_string(primitiveJson["mode"].AsUint());
+			return false;
+		}
+		const JsonValue& attributes = primitiveJson["attributes"];
+		GltfAccessor positionAccessor{};
+		if (!attributes.HasMember("POSITION")) {
+			warning = "The primitive has no positions";
+			return false;
+		}
+		if (!ResolveGltfAccessor(positionAccessor, document, buffers, attributes["POSITION"].AsUint(UINT32_MAX), warning)) {
+			return false;
+		}
+		MeshDataView dataView{};
+		ImportGltfVertexAttrib(dataView.positions, decoded.positions, positionAccessor);
+
+		// The optional channels are dropped (with a warning) if they can't be imported.
+		auto importOptional = [&](const char* attribName, auto& stream, auto& decodedArray) {
+			if (!attributes.HasMember(attribName)) {
+				return;
+			}
+			GltfAccessor accessor{};
+			std::string attribWarning;
+			if (!ResolveGltfAccessor(accessor, document, buffers, attributes[attribName].AsUint(UINT32_MAX), attribWarning)) {
+				AppendGltfWarning(warning, attribWarning);
+				return;
+			}
+			if (accessor.count != positionAccessor.count) {
+				AppendGltfWarning(warning, std::string(attribName) + " doesn't match the positions");
+				return;
+			}
+			ImportGltfVertexAttrib(stream, decodedArray, accessor);
+		};
+		importOptional("NORMAL", dataView.normals, decoded.normals);
+		// The tangents are VEC4 with the handedness in 'w', the same as 'Mesh' keeps them. A decoded copy snaps 'w'
+		// to 1 or -1, a VEC3 accessor (not valid glTF, but some exporters write it) gets a right-handed 1.
+		importOptional("TANGENT", dataView.tangents, decoded.tangents);
+		for (numa::Vec4& tangent : decoded.tangents) {
+			tangent.w = tangent.w < 0.0f ? -1.0f : 1.0f;
+		}
+		// The colors can be VEC4 as well, the alpha is dropped.
+		importOptional("COLOR_0", dataView.colors, decoded.colors);
+		importOptional("TEXCOORD_0", dataView.uvs, decoded.uvs);
+
+		if (primitiveJson.HasMember("indices")) {
+			GltfAccessor indexAccessor{};
+			if (!ResolveGltfAccessor(indexAccessor, document, buffers, primitiveJson["indices"].AsUint(UINT32_MAX), warning)) {
+				return false;
+			}
+			if (!ImportGltfIndices(dataView.indices, decoded.indices, indexAccessor)) {
+				warning = "The primitive has invalid indices";
+				return false;
+			}
+		}
+
+		mesh.SetMeshTopology(meshTopology);
+		mesh.SetDataView(dataView);
+		// The generated arrays are owned by the mesh, the other ones stay views.
+		if (settings.generateMissingNormals && !mesh.HasNormals() && !mesh.GenerateNormals()) {
+			AppendGltfWarning(warning, "Can't generate the normals");
+		}
+		if (settings.generateMissingTangents && !mesh.HasTangents() && !mesh.GenerateTangents()) {
+			AppendGltfWarning(warning, "Can't generate the tangents");
+		}
+		return true;
+	}
+
+	static bool DecodeBase64(std::vector<char>& decoded, const char* text, size_t length) {
+		auto decodeChar = [](char c) -> int {
+			if (c >= 'A' && c <= 'Z') return c - 'A';
+			if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+			if (c >= '0' && c <= '9') return c - '0' + 52;
+			if (c == '+') return 62;
+			if (c == '/') return 63;
+			return -1;
+		};
+		decoded.clear();
+		decoded.reserve(length / 4 * 3);
+		uint32_t bits{0};
+		uint32_t bitCount{0};
+		for (size_t charIdx = 0; charIdx < length && text[charIdx] != '='; charIdx++) {
+			int value = decodeChar(text[charIdx]);
+			if (value < 0) {
+				return false;
+			}
+			bits = (bits << 6) | static_cast<uint32_t>(value);
+			bitCount += 6;
+			if (bitCount >= 8) {
+				bitCount -= 8;
+				decoded.push_back(static_cast<char>((bits >> bitCount) & 0xFF));
+			}
+		}
+		return true;
+	}
+	static std::string DecodeUriPath(const std::string& uri) {
+		std::string path;
+		path.reserve(uri.size());
+		for (size_t charIdx = 0; charIdx < uri.size(); charIdx++) {
+			uint32_t escaped{0};
+			if (uri[charIdx] == '%' && charIdx + 2 < uri.size() &&
+			    std::from_chars(uri.data() + charIdx + 1, uri.data() + charIdx + 3, escaped, 16).ptr == uri.data() + charIdx + 3) {
+				path += static_cast<char>(escaped);
+				charIdx += 2;
+			} else {
+				path += uri[charIdx];
+			}
+		}
+		return path;
+	}
+
+	bool GltfImporter::Import(const std::string& path, const GltfImportSettings& settings) {
+		Reset();
+		MappedFile file;
+		if (!file.Open(path)) {
+			this->error = "Can't open '" + path + "'";
+			return false;
+		}
+		const char* fileData = file.GetData();
+		size_t fileSize = file.GetSizeInBytes();
+		Span<const char> jsonText{fileData, fileSize};
+		Span<const char> glbBinChunk{};
+		uint32_t magic{0};
+		if (fileSize >= sizeof(magic)) {
+			std::memcpy(&magic, fileData, sizeof(magic));
+		}
+		if (magic == glbMagic) {
+			// The 12 byte header, then the JSON chunk and the optional BIN chunk, each with an 8 byte header.
+			uint32_t chunkHeader[2]{};
+			size_t offset{12};
+			for (uint32_t chunkIdx = 0; chunkIdx < 2 && offset + sizeof(chunkHeader) <= fileSize; chunkIdx++) {
+				std::memcpy(chunkHeader, fileData + offset, sizeof(chunkHeader));
+				offset += sizeof(chunkHeader);
+				if (chunkHeader[0] > fileSize - offset) {
+					this->error = "Truncated .glb chunk";
+					return false;
+				}
+				Span<const char> chunk{fileData + offset, chunkHeader[0]};
+				if (chunkIdx == 0 && chunkHeader[1] == glbChunkJson) {
+					jsonText = chunk;
+				} else if (chunkIdx == 0) {
+					this->error = "The first .glb chunk isn't JSON";
+					return false;
+				} else if (chunkHeader[1] == glbChunkBin) {
+					glbBinChunk = chunk;
+				}
+				offset += chunkHeader[0];
+			}
+		}
+		JsonValue document;
+		std::string jsonError;
+		if (!ParseJson(document, jsonText.data(), jsonText.size(), &jsonError)) {
+			this->error = "Invalid glTF JSON: " + jsonError;
+			return false;
+		}
+		if (document["asset"]["version"].AsString().compare(0, 2, "2.") != 0) {
+			this->error = "Only glTF 2.0 is supported";
+			return false;
+		}
+		mappedFiles.push_back(std::move(file));
+		if (!LoadBuffers(document, path, glbBinChunk)) {
+			return false;
+		}
+
+		struct PrimitiveRef {
+			uint32_t meshIdx{0};
+			uint32_t primitiveIdx{0};
+		};
+		std::vector<PrimitiveRef> primitiveRefs;
+		const JsonValue& meshesJson = document["meshes"];
+		for (uint32_t meshIdx = 0; meshIdx < meshesJson.GetSize(); meshIdx++) {
+			for (uint32_t primitiveIdx = 0; primitiveIdx < meshesJson[meshIdx]["primitives"].GetSize(); primitiveIdx++) {
+				primitiveRefs.push_back(PrimitiveRef{meshIdx, primitiveIdx});
+			}
+		}
+
+		// The meshes talk to the GPU API context when they're created and when an edit ends,
+		// so both happen here. The workers only fill them in.
+		this->meshes.resize(primitiveRefs.size());
+		this->decodedPrimitives.resize(primitiveRefs.size());
+		for (size_t primIdx = 0; primIdx < primitiveRefs.size(); primIdx++) {
+			const PrimitiveRef& ref = primitiveRefs[primIdx];
+			const JsonValue& meshJson = meshesJson[ref.meshIdx];
+			GltfImportedMesh& imported = meshes[primIdx];
+			imported.mesh = std::make_unique<Mesh>();
+			imported.mesh->BeginEdit();
+			imported.name = meshJson["name"].IsString() ? meshJson["name"].AsString() : "mesh" + std::to_string(ref.meshIdx);
+			if (meshJson["primitives"].GetSize() > 1) {
+				imported.name += "#" + std::to_string(ref.primitiveIdx);
+			}
+			imported.gltfMeshIdx = ref.meshIdx;
+			imported.gltfPrimitiveIdx = ref.primitiveIdx;
+			imported.gltfMaterialIdx = meshJson["primitives"][ref.primitiveIdx]["material"].AsInt(-1);
+		}
+		std::vector<std::string> primitiveWarnings(primitiveRefs.size());
+		std::vector<char> primitiveImported(primitiveRefs.size(), 0);
+		size_t minChunkSize = std::max<size_t>(settings.minPrimitivesPerThread, 1);
+		ParallelFor(primitiveRefs.size(), minChunkSize, [&](size_t, size_t begin, size_t end) {
+			for (size_t primIdx = begin; primIdx < end; primIdx++) {
+				const PrimitiveRef& ref = primitiveRefs[primIdx];
+				const JsonValue& primitiveJson = meshesJson[ref.meshIdx]["primitives"][ref.primitiveIdx];
+				primitiveImported[primIdx] = ImportGltfPrimitive(*meshes[primIdx].mesh, decodedPrimitives[primIdx], document,
+				                                                 primitiveJson, buffers, settings, primitiveWarnings[primIdx]);
+			}
+		});
+
+		// In the document order, the failed primitives are dropped.
+		size_t importedCount{0};
+		for (size_t primIdx = 0; primIdx < primitiveRefs.size(); primIdx++) {
+			meshes[primIdx].mesh->EndEdit();
+			if (!primitiveWarnings[primIdx].empty()) {
+				warnings.push_back(meshes[primIdx].name + ": " + primitiveWarnings[primIdx]);
+			}
+			if (!primitiveImported[primIdx]) {
+				continue;
+			}
+			// Moving a vector keeps its storage, so the views of the decoded arrays stay valid.
+			if (importedCount != primIdx) {
+				meshes[importedCount] = std::move(meshes[primIdx]);
+				decodedPrimitives[importedCount] = std::move(decodedPrimitives[primIdx]);
+			}
+			importedCount++;
+		}
+		meshes.resize(importedCount);
+		decodedPrimitives.resize(importedCount);
+		return true;
+	}
+
+	std::vector<GltfImportedMesh>& GltfImporter::GetMeshes() {
+		return meshes;
+	}
+	const std::string& GltfImporter::GetError() const {
+		return error;
+	}
+	const std::vector<std::string>& GltfImporter::GetWarnings() const {
+		return warnings;
+	}
+
+	void GltfImporter::Reset() {
+		// The meshes view the buffers, so they go first.
+		meshes.clear();
+		decodedPrimitives.clear();
+		buffers.clear();
+		embeddedBuffers.clear();
+		mappedFiles.clear();
+		error.clear();
+		warnings.clear();
+	}
+
+	bool GltfImporter::LoadBuffers(const JsonValue& document, const std::string& path, Span<const char> glbBinChunk) {
+		size_t separator = path.find_last_of("/\\");
+		std::string directory = separator == std::string::npos ? std::string{} : path.substr(0, separator + 1);
+		const JsonValue& buffersJson = document["buffers"];
+		for (uint32_t bufferIdx = 0; bufferIdx < buffersJson.GetSize(); bufferIdx++) {
+			const JsonValue& bufferJson = buffersJson[bufferIdx];
+			size_t byteLength = bufferJson["byteLength"].AsUint();
+			const std::string& uri = bufferJson["uri"].AsString();
+			Span<const char> buffer{};
+			if (uri.empty()) {
+				buffer = glbBinChunk;
+			} else if (uri.compare(0, 5, "data:") == 0) {
+				size_t dataBegin = uri.find(";base64,");
+				embeddedBuffers.emplace_back();
+				if (dataBegin == std::string::npos ||
+				    !DecodeBase64(embeddedBuffers.back(), uri.data() + dataBegin + 8, uri.size() - dataBegin - 8)) {
+					this->error = "Buffer " + std::to_string(bufferIdx) + " has an invalid data URI";
+					return false;
+				}
+				buffer = embeddedBuffers.back();
+			} else {
+				MappedFile bufferFile;
+				if (!bufferFile.Open(directory + DecodeUriPath(uri))) {
+					this->error = "Can't open buffer '" + uri + "'";
+					return false;
+				}
+				buffer = Span<const char>{bufferFile.GetData(), bufferFile.GetSizeInBytes()};
+				mappedFiles.push_back(std::move(bufferFile));
+			}
+			// The .glb BIN chunk can be padded, so only the declared length counts.
+			if (buffer.size() < byteLength) {
+				this->error = "Buffer " + std::to_string(bufferIdx) + " is shorter than its byteLength";
+				return false;
+			}
+			buffers.push_back(buffer.subspan(0, byteLength));
+		}
+		return true;
+	}
+
+}
\ No newline at end of file
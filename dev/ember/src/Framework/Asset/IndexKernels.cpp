@@ -0,0 +1,159 @@
+#include "Framework/Asset/IndexKernels.h"
+
+#include "Core/Simd.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+namespace ember {
+
+#if defined(EMBER_SIMD_SSE2)
+	// SSE2 has no 32-bit max at all, and SSE4.1 is the first one with an unsigned one.
+	// Without it, the values are kept with their sign bit flipped, which maps unsigned order onto signed order,
+	// so a signed compare and a blend do the job.
+	static __m128i MaxEpu32(__m128i a, __m128i b) {
+#if defined(EMBER_SIMD_SSE41)
+		return _mm_max_epu32(a, b);
+#else
+		__m128i greater = _mm_cmpgt_epi32(a, b);
+		return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+#endif
+	}
+	static uint32_t HorizontalMaxEpu32(__m128i v) {
+		alignas(16) uint32_t lanes[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+		return std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+	}
+#endif
+
+	static uint32_t ScanMaxIndex(const uint32_t* indices, size_t indexCount) {
+		uint32_t maxIndex{0};
+		size_t idx{0};
+#if defined(EMBER_SIMD_AVX2)
+		// 4 independent accumulators, so that the loop isn't bound by the latency of a single max chain.
+		__m256i max0 = _mm256_setzero_si256();
+		__m256i max1 = _mm256_setzero_si256();
+		__m256i max2 = _mm256_setzero_si256();
+		__m256i max3 = _mm256_setzero_si256();
+		for (; idx + 32 <= indexCount; idx += 32) {
+			const __m256i* src = reinterpret_cast<const __m256i*>(indices + idx);
+			max0 = _mm256_max_epu32(max0, _mm256_loadu_si256(src + 0));
+			max1 = _mm256_max_epu32(max1, _mm256_loadu_si256(src + 1));
+			max2 = _mm256_max_epu32(max2, _mm256_loadu_si256(src + 2));
+			max3 = _mm256_max_epu32(max3, _mm256_loadu_si256(src + 3));
+		}
+		__m256i max = _mm256_max_epu32(_mm256_max_epu32(max0, max1), _mm256_max_epu32(max2, max3));
+		__m128i max128 = _mm_max_epu32(_mm256_castsi256_si128(max), _mm256_extracti128_si256(max, 1));
+		maxIndex = HorizontalMaxEpu32(max128);
+#elif defined(EMBER_SIMD_SSE2)
+#if defined(EMBER_SIMD_SSE41)
+		const __m128i bias = _mm_setzero_si128();
+#else
+		const __m128i bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+#endif
+		__m128i max0 = bias;
+		__m128i max1 = bias;
+		__m128i max2 = bias;
+		__m128i max3 = bias;
+		for (; idx + 16 <= indexCount; idx += 16) {
+			const __m128i* src = reinterpret_cast<const __m128i*>(indices + idx);
+			max0 = MaxEpu32(max0, _mm_xor_si128(_mm_loadu_si128(src + 0), bias));
+			max1 = MaxEpu32(max1, _mm_xor_si128(_mm_loadu_si128(src + 1), bias));
+			max2 = MaxEpu32(max2, _mm_xor_si128(_mm_loadu_si128(src + 2), bias));
+			max3 = MaxEpu32(max3, _mm_xor_si128(_mm_loadu_si128(src + 3), bias));
+		}
+		__m128i max = MaxEpu32(MaxEpu32(max0, max1), MaxEpu32(max2, max3));
+		// In the flipped domain the signed lanes have to be compared as signed values, flip back first.
+		max = _mm_xor_si128(max, bias);
+		maxIndex = HorizontalMaxEpu32(max);
+#endif
+		for (; idx < indexCount; idx++) {
+			maxIndex = std::max(maxIndex, indices[idx]);
+		}
+		return maxIndex;
+	}
+
+	IndexStreamStat ScanIndices(const uint32_t* indices, size_t indexCount, uint32_t multiplicity) {
+		IndexStreamStat stat{};
+		stat.maxIndex = ScanMaxIndex(indices, indexCount);
+		stat.completeIndexCount = multiplicity == 0 ? indexCount : indexCount - indexCount % multiplicity;
+		return stat;
+	}
+
+	IndexFormat PickNarrowestIndexFormat(uint32_t maxIndex, bool allowUint8) {
+		if (allowUint8 && maxIndex <= std::numeric_limits<uint8_t>::max()) {
+			return IndexFormat::UINT8;
+		}
+		if (maxIndex <= std::numeric_limits<uint16_t>::max()) {
+			return IndexFormat::UINT16;
+		}
+		return IndexFormat::UINT32;
+	}
+
+	static void PackIndicesUint16(const uint32_t* indices, size_t indexCount, char* dst) {
+		size_t idx{0};
+#if defined(EMBER_SIMD_AVX2)
+		for (; idx + 16 <= indexCount; idx += 16) {
+			__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + idx));
+			__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + idx + 8));
+			// The pack works per 128-bit half (a0 b0 a1 b1), put the quarters back in order.
+			__m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0b11011000);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + idx * sizeof(uint16_t)), packed);
+		}
+#endif
+#if defined(EMBER_SIMD_SSE2)
+		for (; idx + 8 <= indexCount; idx += 8) {
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + idx));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + idx + 4));
+#if defined(EMBER_SIMD_SSE41)
+			__m128i packed = _mm_packus_epi32(a, b);
+#else
+			// No unsigned 32 -> 16 pack before SSE4.1. Bias into the signed range, pack, and flip the sign bit back.
+			const __m128i bias = _mm_set1_epi32(32768);
+			__m128i packed = _mm_packs_epi32(_mm_sub_epi32(a, bias), _mm_sub_epi32(b, bias));
+			packed = _mm_xor_si128(packed, _mm_set1_epi16(static_cast<short>(0x8000)));
+#endif
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + idx * sizeof(uint16_t)), packed);
+		}
+#endif
+		for (; idx < indexCount; idx++) {
+			uint16_t index = static_cast<uint16_t>(indices[idx]);
+			std::memcpy(dst + idx * sizeof(uint16_t), &index, sizeof(uint16_t));
+		}
+	}
+	static void PackIndicesUint8(const uint32_t* indices, size_t indexCount, char* dst) {
+		size_t idx{0};
+#if defined(EMBER_SIMD_SSE2)
+		for (; idx + 16 <= indexCount; idx += 16) {
+			const __m128i* src = reinterpret_cast<const __m128i*>(indices + idx);
+			// The indices are at most 255, so the signed 32 -> 16 pack can't saturate.
+			__m128i lo = _mm_packs_epi32(_mm_loadu_si128(src + 0), _mm_loadu_si128(src + 1));
+			__m128i hi = _mm_packs_epi32(_mm_loadu_si128(src + 2), _mm_loadu_si128(src + 3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + idx), _mm_packus_epi16(lo, hi));
+		}
+#endif
+		for (; idx < indexCount; idx++) {
+			dst[idx] = static_cast<char>(static_cast<uint8_t>(indices[idx]));
+		}
+	}
+
+	void PackIndices(const uint32_t* indices, size_t indexCount, IndexFormat dstFormat, char* dst) {
+		switch (dstFormat) {
+			case IndexFormat::UINT32:
+				std::memcpy(dst, indices, indexCount * sizeof(uint32_t));
+				break;
+			case IndexFormat::UINT16:
+				PackIndicesUint16(indices, indexCount, dst);
+				break;
+			case IndexFormat::UINT8:
+				PackIndicesUint8(indices, indexCount, dst);
+				break;
+			default:
+				assert(false && "Unknown index format provided!");
+				break;
+		}
+	}
+
+}
\ No newline at end of file
@@ -1,15 +1,33 @@
 #include "Framework/Asset/Mesh.h"
 
+#include "Core/Parallel.h"
+#include "Framework/Asset/IndexKernels.h"
 #include "GpuApi/GpuApiCtx.h"
+#include "Math/BoundsKernels.h"
 
 #include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <utility>
 
 namespace ember {
 
-	template <typename SrcType, typename DstType>
-	void WriteSrcToDst(const SrcType* src, DstType* dst) {
-		DstType value = static_cast<DstType>(*src);
-		*dst = value;
+	bool MeshStat::IsIndexed() const {
+		return ibInfo.indexCount > 0;
+	}
+
+	static bool VertexAttribLayoutsEqual(const std::vector<VertexAttribDescriptor>& lhs,
+	                                     const std::vector<VertexAttribDescriptor>& rhs) {
+		return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+		                  [](const VertexAttribDescriptor& lhsAttrib, const VertexAttribDescriptor& rhsAttrib) {
+			return lhsAttrib.dimension == rhsAttrib.dimension && lhsAttrib.offset == rhsAttrib.offset &&
+			       lhsAttrib.channel == rhsAttrib.channel && lhsAttrib.format == rhsAttrib.format;
+		});
 	}
 
 	uint32_t GetIndexMultiplicity(MeshTopology meshTopology) {
@@ -28,6 +46,55 @@ namespace ember {
 		}
 	}
 
+	void MeshDirtyRange::Add(uint32_t first, uint32_t count) {
+		if (count == 0) {
+			return;
+		}
+		if (IsEmpty()) {
+			begin = first;
+			end = first + count;
+			return;
+		}
+		begin = std::min(begin, first);
+		end = std::max(end, first + count);
+	}
+	void MeshDirtyRange::Add(const MeshDirtyRange& other) {
+		Add(other.begin, other.GetCount());
+	}
+	bool MeshDirtyRange::IsEmpty() const {
+		return begin == end;
+	}
+	uint32_t MeshDirtyRange::GetCount() const {
+		return end - begin;
+	}
+
+	static bool UpdateRangeInBounds(size_t arraySize, uint32_t first, uint32_t count) {
+		bool inBounds = static_cast<size_t>(first) + count <= arraySize;
+		assert(inBounds && "The updated range is out of bounds (or the channel isn't in use)!");
+		return inBounds;
+	}
+
+	// The columns of the affine part of the matrix, taken without assuming anything about its memory layout.
+	// The w component of the transformed points is never used, so the bottom row doesn't matter.
+	static void GetAffineColumns(const numa::Mat4& world, float affine[12]) {
+		const numa::Vec4 basis[4]{
+			numa::Vec4{1.0f, 0.0f, 0.0f, 0.0f}, numa::Vec4{0.0f, 1.0f, 0.0f, 0.0f},
+			numa::Vec4{0.0f, 0.0f, 1.0f, 0.0f}, numa::Vec4{0.0f, 0.0f, 0.0f, 1.0f},
+		};
+		for (uint32_t column = 0; column < 4; column++) {
+			numa::Vec4 worldColumn = world * basis[column];
+			std::copy_n(reinterpret_cast<const float*>(&worldColumn), 3, affine + column * 3);
+		}
+	}
+
+	MeshEditScope::MeshEditScope(Mesh& mesh)
+		: mesh(mesh) {
+		mesh.BeginEdit();
+	}
+	MeshEditScope::~MeshEditScope() {
+		mesh.EndEdit();
+	}
+
 	Mesh::Mesh() {
 		GetCurrentGpuApiCtx()->CreateMeshGpuResource(this);
 	}
@@ -35,14 +102,25 @@ namespace ember {
 		GetCurrentGpuApiCtx()->DeleteMeshGpuResource(this);
 	}
 
-	void Mesh::SetPositions(const std::vector<numa::Vec3>& positions) {
-		if (positions.size() > this->positions.size()) {
-			this->positions.resize(positions.size());
-		}
-		ResizeVertexAttribArrays();
+	void Mesh::SetPositions(Span<const numa::Vec3> positions) {
+		UseVertexAttribChannel(VertexAttribChannel::POSITION);
+		ResizeAttribArrays(std::max(this->positions.size(), positions.size()), indices.size());
 		size_t minCount = std::min(this->positions.size(), positions.size());
-		std::copy_n(positions.begin(), minCount, this->positions.begin());
-		ComputeObjectAABB();
+		std::copy_n(positions.begin(), minCount, GetMutableAttribData(this->positions));
+		UpdateObjectAABB();
+		// The cluster bounds and the LOD errors are computed from the positions.
+		ResetMeshletsAndLods();
+		RefitBvh();
+		OnVertexDataUpdated();
+	}
+	void Mesh::SetPositions(std::vector<numa::Vec3>&& positions) {
+		this->positions.Adopt(std::move(positions));
+		UseVertexAttribChannel(VertexAttribChannel::POSITION);
+		// The optional channels follow the new vertex count.
+		ResizeVertexAttribArrays();
+		UpdateObjectAABB();
+		ResetMeshletsAndLods();
+		RefitBvh();
 		OnVertexDataUpdated();
 	}
 
@@ -56,100 +134,123 @@ namespace ember {
 	// 2. The optional array is currently not in use, which means the array doesn't exist.
 	// 
 
-	void Mesh::SetNormals(const std::vector<numa::Vec3>& normals) {
+	void Mesh::SetNormals(Span<const numa::Vec3> normals) {
 		if (!HasNormals()) {
-			ResizeNormalVertexAttribArray(static_cast<uint32_t>(positions.size()));
-			vertAttribLayout.insert({VertexAttribChannel::NORMAL, GetDefaultNormalVertexAttribDescriptor()});
+			StoreVertexAttribDescriptor(GetDefaultNormalVertexAttribDescriptor());
+			ResizeVertexAttribArrays();
 		}
 		size_t minCount = std::min(this->normals.size(), normals.size());
-		std::copy_n(normals.begin(), minCount, this->normals.begin());
+		std::copy_n(normals.begin(), minCount, GetMutableAttribData(this->normals));
+		OnVertexDataUpdated();
+	}
+	void Mesh::SetNormals(std::vector<numa::Vec3>&& normals) {
+		this->normals.Adopt(std::move(normals));
+		UseVertexAttribChannel(VertexAttribChannel::NORMAL);
+		ResizeVertexAttribArrays();
 		OnVertexDataUpdated();
 	}
 	void Mesh::ResetNormals() {
-		vertAttribLayout.erase(VertexAttribChannel::NORMAL);
-		normals.clear();
+		EraseVertexAttribDescriptor(VertexAttribChannel::NORMAL);
+		ResizeVertexAttribArrays();
 		OnVertexDataUpdated();
 	}
 	bool Mesh::HasNormals() const {
-		auto findRes = vertAttribLayout.find(VertexAttribChannel::NORMAL);
-		return findRes != vertAttribLayout.end();
+		return HasVertexAttribChannel(VertexAttribChannel::NORMAL);
 	}
 
-	void Mesh::SetTangents(const std::vector<numa::Vec3>& tangents) {
+	void Mesh::SetTangents(Span<const numa::Vec4> tangents) {
 		if (!HasTangents()) {
-			ResizeTangentVertexAttribArray(static_cast<uint32_t>(positions.size()));
-			vertAttribLayout.insert({VertexAttribChannel::TANGENT, GetDefaultTangentVertexAttribDescriptor()});
+			StoreVertexAttribDescriptor(GetDefaultTangentVertexAttribDescriptor());
+			ResizeVertexAttribArrays();
 		}
 		size_t minCount = std::min(this->tangents.size(), tangents.size());
-		std::copy_n(tangents.begin(), minCount, this->tangents.begin());
+		std::copy_n(tangents.begin(), minCount, GetMutableAttribData(this->tangents));
+		OnVertexDataUpdated();
+	}
+	void Mesh::SetTangents(std::vector<numa::Vec4>&& tangents) {
+		this->tangents.Adopt(std::move(tangents));
+		UseVertexAttribChannel(VertexAttribChannel::TANGENT);
+		ResizeVertexAttribArrays();
 		OnVertexDataUpdated();
 	}
 	void Mesh::ResetTangents() {
-		vertAttribLayout.erase(VertexAttribChannel::TANGENT);
-		tangents.clear();
+		EraseVertexAttribDescriptor(VertexAttribChannel::TANGENT);
+		ResizeVertexAttribArrays();
 		OnVertexDataUpdated();
 	}
 	bool Mesh::HasTangents() const {
-		auto findRes = vertAttribLayout.find(VertexAttribChannel::TANGENT);
-		return findRes != vertAttribLayout.end();
+		return HasVertexAttribChannel(VertexAttribChannel::TANGENT);
 	}
 
-	void Mesh::SetColors(const std::vector<numa::Vec3>& colors) {
+	void Mesh::SetColors(Span<const numa::Vec3> colors) {
 		if (!HasColors()) {
-			ResizeColorVertexAttribArray(static_cast<uint32_t>(positions.size()));
-			vertAttribLayout.insert({VertexAttribChannel::COLOR, GetDefaultColorVertexAttribDescriptor()});
+			StoreVertexAttribDescriptor(GetDefaultColorVertexAttribDescriptor());
+			ResizeVertexAttribArrays();
 		}
 		size_t minCount = std::min(this->colors.size(), colors.size());
-		std::copy_n(colors.begin(), minCount, this->colors.begin());
+		std::copy_n(colors.begin(), minCount, GetMutableAttribData(this->colors));
+		OnVertexDataUpdated();
+	}
+	void Mesh::SetColors(std::vector<numa::Vec3>&& colors) {
+		this->colors.Adopt(std::move(colors));
+		UseVertexAttribChannel(VertexAttribChannel::COLOR);
+		ResizeVertexAttribArrays();
 		OnVertexDataUpdated();
 	}
 	void Mesh::ResetColors() {
-		vertAttribLayout.erase(VertexAttribChannel::COLOR);
-		colors.clear();
+		EraseVertexAttribDescriptor(VertexAttribChannel::COLOR);
+		ResizeVertexAttribArrays();
 		OnVertexDataUpdated();
 	}
 	bool Mesh::HasColors() const {
-		auto findRes = vertAttribLayout.find(VertexAttribChannel::COLOR);
-		return findRes != vertAttribLayout.end();
+		return HasVertexAttribChannel(VertexAttribChannel::COLOR);
 	}
 
-	void Mesh::SetUvs(const std::vector<numa::Vec2>& uvs) {
+	void Mesh::SetUvs(Span<const numa::Vec2> uvs) {
 		if (!HasUvs()) {
-			ResizeUvVertexAttribArray(static_cast<uint32_t>(positions.size()));
-			vertAttribLayout.insert({VertexAttribChannel::UV0, GetDefaultUvVertexAttribDescriptor()});
+			StoreVertexAttribDescriptor(GetDefaultUvVertexAttribDescriptor());
+			ResizeVertexAttribArrays();
 		}
 		size_t minCount = std::min(this->uvs.size(), uvs.size());
-		std::copy_n(uvs.begin(), minCount, this->uvs.begin());
+		std::copy_n(uvs.begin(), minCount, GetMutableAttribData(this->uvs));
+		OnVertexDataUpdated();
+	}
+	void Mesh::SetUvs(std::vector<numa::Vec2>&& uvs) {
+		this->uvs.Adopt(std::move(uvs));
+		UseVertexAttribChannel(VertexAttribChannel::UV0);
+		ResizeVertexAttribArrays();
 		OnVertexDataUpdated();
 	}
 	void Mesh::ResetUvs() {
-		vertAttribLayout.erase(VertexAttribChannel::UV0);
-		uvs.clear();
+		EraseVertexAttribDescriptor(VertexAttribChannel::UV0);
+		ResizeVertexAttribArrays();
 		OnVertexDataUpdated();
 	}
 	bool Mesh::HasUvs() const {
-		auto findRes = vertAttribLayout.find(VertexAttribChannel::UV0);
-		return findRes != vertAttribLayout.end();
+		return HasVertexAttribChannel(VertexAttribChannel::UV0);
 	}
 
 	void Mesh::SetVertices(const void* src, uint32_t vertexCount, const std::vector<VertexAttribDescriptor>& layout) {
-		SetVertexAttribLayoutMap(layout);
+		BeginSetVertices(layout, vertexCount);
+		// The source buffer is described by the layout provided in the parameter, not by the fixed up mesh layout.
+		// Whatever the fix up had to add doesn't exist in the source buffer, so there's nothing to read for it.
+		SetInternalVertexAttribArrayData(src, vertexCount, layout);
+		EndSetVertices();
+	}
+
+	void Mesh::BeginSetVertices(Span<const VertexAttribDescriptor> layout, uint32_t vertexCount) {
 		// The layout provided in the parameter can lack the positions vertex attribute, which is
 		// probably because of the user's mistake. The SetVertexAttribLayoutMap() function tries
 		// to fix such mistakes, if there are any, so that we always end up with a valid layout.
-		// The possibility of the layout parameter being invalid is the reason why we request
-		// the vertex attribute layout vector using the internal method. If any fixes had to be done
-		// before assigning the provided layout, they will be reflected here.
-		std::vector<VertexAttribDescriptor> meshLayout = GetVertexAttribLayout();
-		if (vertexCount > this->positions.size()) {
-			this->positions.resize(vertexCount);
-		}
-		ResizeVertexAttribArrays();
-		SetInternalVertexAttribArrayData(src, vertexCount, meshLayout);
-		ComputeObjectAABB();
-		// Send this to the GPU
-		SendGpuMeshVertexBufferData(src);
-		SendMeshChangedEventNotifications();
+		SetVertexAttribLayoutMap(layout);
+		ResizeAttribArrays(std::max<size_t>(vertexCount, this->positions.size()), indices.size());
+	}
+	void Mesh::EndSetVertices() {
+		UpdateObjectAABB();
+		ResetMeshletsAndLods();
+		RefitBvh();
+		// The layout may have changed, and the LOD chain of the index buffer is gone.
+		OnMeshDataUpdated();
 	}
 
 	// 
@@ -173,31 +274,567 @@ namespace ember {
 	// to the user that such issues are present (exist)?
 	//
 
-	void Mesh::SetIndices(const std::vector<uint32_t>& indices) {
-		if (indices.size() > this->indices.size()) {
-			this->indices.resize(indices.size());
-		}
+	void Mesh::SetIndices(Span<const uint32_t> indices) {
+		ResizeAttribArrays(positions.size(), std::max(this->indices.size(), indices.size()));
 		size_t minCount = std::min(this->indices.size(), indices.size());
-		std::copy_n(indices.begin(), minCount, this->indices.begin());
+		std::copy_n(indices.begin(), minCount, GetMutableAttribData(this->indices));
+		OnIndicesReplaced();
+	}
+	void Mesh::SetIndices(std::vector<uint32_t>&& indices) {
+		this->indices.Adopt(std::move(indices));
+		OnIndicesReplaced();
+	}
+	void Mesh::OnIndicesReplaced() {
+		ResetMeshletsAndLods();
+		ResetBvh();
+
+		// Both checks below and the index format narrowing need only this single pass over the indices.
+		IndexStreamStat indexStat = ScanIndices(this->indices.data(), this->indices.size(),
+		                                        GetIndexMultiplicity(this->meshTopology));
+		this->maxIndex = indexStat.maxIndex;
 
 		std::vector<uint32_t> outOfBoundIndices;
-		if (IndicesOutOfBound(&outOfBoundIndices)) {
+		if (IndicesOutOfBound(indexStat, &outOfBoundIndices)) {
 			ReportOutOfBoundIndices(outOfBoundIndices);
 		}
 		std::vector<uint32_t> incompleteIndices;
-		if (IndicesIncomplete(&incompleteIndices)) {
+		if (IndicesIncomplete(indexStat, &incompleteIndices)) {
 			ReportIncompleteIndices(incompleteIndices);
 		}
+		ApplyIndexFormatNarrowing();
 		OnIndexDataUpdated();
 	}
 	void Mesh::ResetIndices() {
-		this->indices.clear();
+		ResizeAttribArrays(positions.size(), 0);
+		ResetMeshletsAndLods();
+		ResetBvh();
+		this->maxIndex = 0;
+		ApplyIndexFormatNarrowing();
 		OnIndexDataUpdated();
 	}
 	bool Mesh::HasIndices() const {
 		return indices.size();
 	}
 
+	void Mesh::SetDataView(const MeshDataView& dataView) {
+		// A single GPU update and notification for all of the arrays.
+		MeshEditScope edit{*this};
+		ViewDataArrays(dataView);
+		UpdateObjectAABB();
+		OnVertexDataUpdated();
+		OnIndicesReplaced();
+	}
+	void Mesh::SetDataView(const MeshDataView& dataView, const numa::AABB& objectAABB, uint32_t maxIndex) {
+		MeshEditScope edit{*this};
+		ViewDataArrays(dataView);
+		// Whatever postponed the AABB update (e.g. a new padding) is covered by the given one.
+		pendingUpdates &= ~MESH_UPDATE_AABB;
+		this->objectAABB = objectAABB;
+		OnVertexDataUpdated();
+
+		// 'OnIndicesReplaced()' without the scan, the indices were checked when the data was made.
+		ResetMeshletsAndLods();
+		ResetBvh();
+		this->maxIndex = maxIndex;
+		ApplyIndexFormatNarrowing();
+		OnIndexDataUpdated();
+	}
+	void Mesh::ViewDataArrays(const MeshDataView& dataView) {
+		positions.View(dataView.positions);
+		UseVertexAttribChannel(VertexAttribChannel::POSITION);
+		auto viewVertexAttribArray = [this, &dataView](auto& attribArray, auto stream, VertexAttribChannel channel) {
+			assert((stream.empty() || stream.size() == dataView.positions.size()) &&
+			       "The vertex attribute stream doesn't match the positions!");
+			if (stream.empty() || stream.size() != dataView.positions.size()) {
+				// Dropped by 'ResizeVertexAttribArrays()' below.
+				EraseVertexAttribDescriptor(channel);
+				return;
+			}
+			UseVertexAttribChannel(channel);
+			attribArray.View(stream);
+		};
+		viewVertexAttribArray(normals, dataView.normals, VertexAttribChannel::NORMAL);
+		viewVertexAttribArray(tangents, dataView.tangents, VertexAttribChannel::TANGENT);
+		viewVertexAttribArray(colors, dataView.colors, VertexAttribChannel::COLOR);
+		viewVertexAttribArray(uvs, dataView.uvs, VertexAttribChannel::UV0);
+		indices.View(dataView.indices);
+		// The views stay where they are, whatever else is left in the block goes.
+		ResizeVertexAttribArrays();
+	}
+	bool Mesh::IsDataView() const {
+		return positions.IsView() || normals.IsView() || tangents.IsView() ||
+		       colors.IsView() || uvs.IsView() || indices.IsView();
+	}
+	MeshDataView Mesh::GetDataView() const {
+		return MeshDataView{positions, normals, tangents, colors, uvs, indices};
+	}
+
+	void Mesh::UpdatePositions(uint32_t firstVertex, const numa::Vec3* positions, uint32_t count) {
+		if (!UpdateRangeInBounds(this->positions.size(), firstVertex, count) || count == 0) {
+			return;
+		}
+		std::copy_n(positions, count, GetMutableAttribData(this->positions) + firstVertex);
+		// Dropping the LODs shrinks the index buffer.
+		bool hadLods = !lods.empty();
+		ResetMeshletsAndLods();
+		RefitBvh();
+		if (hadLods) {
+			OnIndexDataUpdated();
+		}
+		// A pending full recompute covers the new positions anyway.
+		bool aabbGrown = !(pendingUpdates & MESH_UPDATE_AABB) && GrowObjectAABB(firstVertex, count);
+		if (quantizePositions && aabbGrown) {
+			// Every quantized position is relative to the AABB.
+			OnVertexDataUpdated();
+			return;
+		}
+		OnVertexDataRangeUpdated(VertexAttribChannel::POSITION, firstVertex, count);
+	}
+	void Mesh::UpdateNormals(uint32_t firstVertex, const numa::Vec3* normals, uint32_t count) {
+		if (UpdateRangeInBounds(this->normals.size(), firstVertex, count)) {
+			std::copy_n(normals, count, GetMutableAttribData(this->normals) + firstVertex);
+			OnVertexDataRangeUpdated(VertexAttribChannel::NORMAL, firstVertex, count);
+		}
+	}
+	void Mesh::UpdateTangents(uint32_t firstVertex, const numa::Vec4* tangents, uint32_t count) {
+		if (UpdateRangeInBounds(this->tangents.size(), firstVertex, count)) {
+			std::copy_n(tangents, count, GetMutableAttribData(this->tangents) + firstVertex);
+			OnVertexDataRangeUpdated(VertexAttribChannel::TANGENT, firstVertex, count);
+		}
+	}
+	void Mesh::UpdateColors(uint32_t firstVertex, const numa::Vec3* colors, uint32_t count) {
+		if (UpdateRangeInBounds(this->colors.size(), firstVertex, count)) {
+			std::copy_n(colors, count, GetMutableAttribData(this->colors) + firstVertex);
+			OnVertexDataRangeUpdated(VertexAttribChannel::COLOR, firstVertex, count);
+		}
+	}
+	void Mesh::UpdateUvs(uint32_t firstVertex, const numa::Vec2* uvs, uint32_t count) {
+		if (UpdateRangeInBounds(this->uvs.size(), firstVertex, count)) {
+			std::copy_n(uvs, count, GetMutableAttribData(this->uvs) + firstVertex);
+			OnVertexDataRangeUpdated(VertexAttribChannel::UV0, firstVertex, count);
+		}
+	}
+	void Mesh::UpdateIndices(uint32_t firstIndex, const uint32_t* indices, uint32_t count) {
+		if (!UpdateRangeInBounds(this->indices.size(), firstIndex, count) || count == 0) {
+			return;
+		}
+		std::copy_n(indices, count, GetMutableAttribData(this->indices) + firstIndex);
+		bool hadLods = !lods.empty();
+		ResetMeshletsAndLods();
+		ResetBvh();
+
+		// Only the updated range is scanned, so the max index can only grow here.
+		IndexStreamStat indexStat = ScanIndices(indices, count, 0);
+		if (indexStat.maxIndex >= positions.size()) {
+			std::vector<uint32_t> outOfBoundIndices;
+			std::copy_if(indices, indices + count, std::back_inserter(outOfBoundIndices),
+			             [this](uint32_t index) { return index >= positions.size(); });
+			ReportOutOfBoundIndices(outOfBoundIndices);
+		}
+		this->maxIndex = std::max(this->maxIndex, indexStat.maxIndex);
+		IndexFormat prevIndexFormat = this->indexFormat;
+		ApplyIndexFormatNarrowing();
+		if (hadLods || this->indexFormat != prevIndexFormat) {
+			// The whole index buffer changes: it either shrinks or gets wider indices.
+			OnIndexDataUpdated();
+			return;
+		}
+		OnIndexDataRangeUpdated(firstIndex, count);
+	}
+
+	MeshDirtyRange Mesh::GetDirtyVertexRange(VertexAttribChannel channel) const {
+		if (channel == VertexAttribChannel::UNDEFINED || channel == VertexAttribChannel::COUNT) {
+			return MeshDirtyRange{};
+		}
+		return dirtyVertexRanges[static_cast<size_t>(channel)];
+	}
+	MeshDirtyRange Mesh::GetDirtyVertexRange() const {
+		MeshDirtyRange dirtyRange{};
+		for (const MeshDirtyRange& channelDirtyRange : dirtyVertexRanges) {
+			dirtyRange.Add(channelDirtyRange);
+		}
+		return dirtyRange;
+	}
+	MeshDirtyRange Mesh::GetDirtyIndexRange() const {
+		return dirtyIndexRange;
+	}
+
+	uint32_t Mesh::WeldVertices(float positionEpsilon) {
+		uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+		// With fewer vertices the out of bound indices would point at the wrong ones.
+		if (vertexCount == 0 || (!indices.empty() && maxIndex >= vertexCount)) {
+			return vertexCount;
+		}
+		static constexpr VertexAttribChannel channels[]{
+			VertexAttribChannel::POSITION, VertexAttribChannel::NORMAL, VertexAttribChannel::TANGENT,
+			VertexAttribChannel::COLOR, VertexAttribChannel::UV0,
+		};
+		// Same bit order as in 'GetAttributesMask()'.
+		uint32_t attributesMask = GetAttributesMask();
+		std::vector<VertexWeldStream> weldStreams;
+		for (uint32_t channelIdx = 0; channelIdx < std::size(channels); channelIdx++) {
+			if (attributesMask & (1 << channelIdx)) {
+				VertexWeldStream weldStream{};
+				weldStream.stream = GetVertexAttribStream(channels[channelIdx]);
+				weldStream.epsilon = channels[channelIdx] == VertexAttribChannel::POSITION ? positionEpsilon : 0.0f;
+				weldStreams.push_back(weldStream);
+			}
+		}
+
+		std::vector<uint32_t> remap;
+		uint32_t uniqueVertexCount = GenerateVertexWeldRemap(remap, weldStreams, vertexCount);
+		if (uniqueVertexCount == vertexCount && !indices.empty()) {
+			return vertexCount;
+		}
+
+		ResetMeshletsAndLods();
+		ResetBvh();
+		if (indices.empty()) {
+			ResizeAttribArrays(vertexCount, remap.size());
+			std::copy(remap.begin(), remap.end(), GetMutableAttribData(indices));
+		} else {
+			uint32_t* indexData = GetMutableAttribData(indices);
+			ParallelFor(indices.size(), 65536, [indexData, &remap](size_t, size_t begin, size_t end) {
+				for (size_t idx = begin; idx < end; idx++) {
+					indexData[idx] = remap[indexData[idx]];
+				}
+			});
+		}
+		CompactVertexAttribArray(GetMutableAttribData(positions), positions.size(), remap);
+		CompactVertexAttribArray(GetMutableAttribData(normals), normals.size(), remap);
+		CompactVertexAttribArray(GetMutableAttribData(tangents), tangents.size(), remap);
+		CompactVertexAttribArray(GetMutableAttribData(colors), colors.size(), remap);
+		CompactVertexAttribArray(GetMutableAttribData(uvs), uvs.size(), remap);
+		ResizeAttribArrays(uniqueVertexCount, indices.size());
+
+		// Welding with an epsilon picks one of the close positions, the bounds can change a little.
+		UpdateObjectAABB();
+		this->maxIndex = ScanIndices(indices.data(), indices.size(), 0).maxIndex;
+		ApplyIndexFormatNarrowing();
+		OnMeshDataUpdated();
+		return uniqueVertexCount;
+	}
+
+	bool Mesh::GenerateNormals(NormalWeighting weighting) {
+		if (!CanGenerateTangentSpace()) {
+			return false;
+		}
+		UseVertexAttribChannel(VertexAttribChannel::NORMAL);
+		ResizeVertexAttribArrays();
+		float* normalData = GetVertexAttribArrayData(VertexAttribChannel::NORMAL);
+		size_t indexCount{0};
+		const uint32_t* indexData = PrepareTriangleAdjacency(indexCount);
+		GenerateVertexNormals(normalData, indexData, indexCount, reinterpret_cast<const float*>(positions.data()),
+		                      static_cast<uint32_t>(positions.size()), triangleAdjacency, weighting);
+		OnVertexDataUpdated();
+		return true;
+	}
+	bool Mesh::GenerateTangents() {
+		if (!CanGenerateTangentSpace() || !HasNormals() || !HasUvs()) {
+			return false;
+		}
+		UseVertexAttribChannel(VertexAttribChannel::TANGENT);
+		ResizeVertexAttribArrays();
+		float* tangentData = GetVertexAttribArrayData(VertexAttribChannel::TANGENT);
+		size_t indexCount{0};
+		const uint32_t* indexData = PrepareTriangleAdjacency(indexCount);
+		GenerateVertexTangents(tangentData, indexData, indexCount, reinterpret_cast<const float*>(positions.data()),
+		                       reinterpret_cast<const float*>(normals.data()), reinterpret_cast<const float*>(uvs.data()),
+		                       static_cast<uint32_t>(positions.size()), triangleAdjacency);
+		OnVertexDataUpdated();
+		return true;
+	}
+	bool Mesh::RegenerateNormals(Span<const uint32_t> dirtyVertices, NormalWeighting weighting) {
+		if (!CanGenerateTangentSpace() || !HasNormals()) {
+			return false;
+		}
+		float* normalData = GetVertexAttribArrayData(VertexAttribChannel::NORMAL);
+		size_t indexCount{0};
+		const uint32_t* indexData = PrepareTriangleAdjacency(indexCount);
+		std::vector<uint32_t> vertices;
+		GatherTangentSpaceVertices(vertices, indexData, triangleAdjacency, dirtyVertices.data(), dirtyVertices.size());
+		if (vertices.empty()) {
+			return true;
+		}
+		UpdateVertexNormals(normalData, indexData, reinterpret_cast<const float*>(positions.data()),
+		                    triangleAdjacency, weighting, vertices.data(), vertices.size());
+		OnVertexDataRangeUpdated(VertexAttribChannel::NORMAL, vertices.front(), vertices.back() - vertices.front() + 1);
+		return true;
+	}
+	bool Mesh::RegenerateTangents(Span<const uint32_t> dirtyVertices) {
+		if (!CanGenerateTangentSpace() || !HasNormals() || !HasUvs() || !HasTangents()) {
+			return false;
+		}
+		float* tangentData = GetVertexAttribArrayData(VertexAttribChannel::TANGENT);
+		size_t indexCount{0};
+		const uint32_t* indexData = PrepareTriangleAdjacency(indexCount);
+		std::vector<uint32_t> vertices;
+		GatherTangentSpaceVertices(vertices, indexData, triangleAdjacency, dirtyVertices.data(), dirtyVertices.size());
+		if (vertices.empty()) {
+			return true;
+		}
+		UpdateVertexTangents(tangentData, indexData, reinterpret_cast<const float*>(positions.data()),
+		                     reinterpret_cast<const float*>(normals.data()), reinterpret_cast<const float*>(uvs.data()),
+		                     triangleAdjacency, vertices.data(), vertices.size());
+		OnVertexDataRangeUpdated(VertexAttribChannel::TANGENT, vertices.front(), vertices.back() - vertices.front() + 1);
+		return true;
+	}
+
+	MeshOptimizeReport Mesh::Optimize(const MeshOptimizeSettings& settings) {
+		MeshOptimizeReport report{};
+		uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+		if (meshTopology != MeshTopology::TRIANGLES || indices.empty() || maxIndex >= vertexCount) {
+			return report;
+		}
+		report.before = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount, settings.vertexCacheSize);
+
+		std::vector<uint32_t> reordered(indices.size());
+		if (settings.optimizeVertexCache) {
+			OptimizeVertexCache(reordered.data(), indices.data(), indices.size(), vertexCount, settings.vertexCacheSize);
+			std::copy(reordered.begin(), reordered.end(), GetMutableAttribData(indices));
+		}
+		if (settings.optimizeOverdraw) {
+			// The clusters are sorted relative to the center of the object AABB.
+			ResolvePendingObjectAABB();
+			numa::Vec3 center = objectAABB.center;
+			OptimizeOverdraw(reordered.data(), indices.data(), indices.size(),
+			                 reinterpret_cast<const float*>(positions.data()), vertexCount,
+			                 reinterpret_cast<const float*>(&center),
+			                 settings.vertexCacheSize, settings.overdrawThreshold);
+			std::copy(reordered.begin(), reordered.end(), GetMutableAttribData(indices));
+		}
+		if (settings.optimizeVertexFetch) {
+			std::vector<uint32_t> remap;
+			OptimizeVertexFetchRemap(remap, indices.data(), indices.size(), vertexCount);
+			RemapIndices(GetMutableAttribData(indices), indices.size(), remap);
+			RemapVertexAttribArray(GetMutableAttribData(positions), positions.size(), remap);
+			RemapVertexAttribArray(GetMutableAttribData(normals), normals.size(), remap);
+			RemapVertexAttribArray(GetMutableAttribData(tangents), tangents.size(), remap);
+			RemapVertexAttribArray(GetMutableAttribData(colors), colors.size(), remap);
+			RemapVertexAttribArray(GetMutableAttribData(uvs), uvs.size(), remap);
+		}
+
+		// The triangles were reordered, the clusters don't match the index ranges anymore,
+		// and the vertex order of the LODs is gone.
+		ResetMeshletsAndLods();
+		ResetBvh();
+		report.after = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount, settings.vertexCacheSize);
+		report.optimized = true;
+		// The vertex set stays the same, so the AABB is still valid. The max index can only get smaller
+		// (the referenced vertices are moved to the front), which might allow a narrower index format.
+		this->maxIndex = ScanIndices(indices.data(), indices.size(), 0).maxIndex;
+		ApplyIndexFormatNarrowing();
+		OnMeshDataUpdated();
+		return report;
+	}
+
+	bool Mesh::BuildMeshlets(const MeshletSettings& settings) {
+		uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+		if (meshTopology != MeshTopology::TRIANGLES || indices.empty() || maxIndex >= vertexCount) {
+			return false;
+		}
+		ember::BuildMeshlets(meshlets, GetMutableAttribData(indices), indices.size(),
+		                     reinterpret_cast<const float*>(positions.data()), vertexCount, settings);
+		// Same triangles in a different order, the max index and the AABB stay the same.
+		// The BVH hits would point at the old triangle order though.
+		ResetBvh();
+		OnIndexDataUpdated();
+		return true;
+	}
+	const std::vector<Meshlet>& Mesh::GetMeshlets() const {
+		return meshlets;
+	}
+	bool Mesh::HasMeshlets() const {
+		return !meshlets.empty();
+	}
+
+	uint32_t Mesh::GenerateLods(const MeshLodSettings& settings) {
+		this->lods.clear();
+		this->lodIndices.clear();
+		uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+		if (meshTopology != MeshTopology::TRIANGLES || indices.size() < 3 || maxIndex >= vertexCount) {
+			OnIndexDataUpdated();
+			return 0;
+		}
+		const float* positionData = reinterpret_cast<const float*>(positions.data());
+		ResolvePendingObjectAABB();
+		const float* aabbRadius = reinterpret_cast<const float*>(&objectAABB.radius);
+		float objectSize = 2.0f * std::max(aabbRadius[0], std::max(aabbRadius[1], aabbRadius[2]));
+		float maxError = settings.maxError * objectSize;
+
+		IndexBufferLod fullDetail{};
+		fullDetail.indexCount = static_cast<uint32_t>(indices.size());
+		fullDetail.vertexCount = vertexCount;
+		this->lods.push_back(fullDetail);
+
+		// Every level is simplified from the previous one, it's faster, and it makes the levels nested
+		// (every level uses a subset of the vertices of the previous one), which the vertex compaction relies on.
+		size_t fullDetailIndexCount = indices.size() / 3 * 3;
+		std::vector<uint32_t> previousLevel(indices.begin(), indices.begin() + fullDetailIndexCount);
+		std::vector<uint32_t> level(fullDetailIndexCount);
+		float error{0.0f};
+		for (float targetRatio : settings.targetRatios) {
+			size_t targetIndexCount = static_cast<size_t>(static_cast<float>(fullDetailIndexCount) * targetRatio) / 3 * 3;
+			float levelError{0.0f};
+			size_t levelIndexCount = SimplifyMesh(level.data(), previousLevel.data(), previousLevel.size(),
+			                                      positionData, vertexCount, targetIndexCount, maxError - error, &levelError);
+			if (levelIndexCount == 0 ||
+			    static_cast<float>(levelIndexCount) > static_cast<float>(previousLevel.size()) * (1.0f - settings.minReduction)) {
+				break;
+			}
+			// The simplified triangles keep their old order, which has lost its vertex cache locality.
+			previousLevel.resize(levelIndexCount);
+			OptimizeVertexCache(previousLevel.data(), level.data(), levelIndexCount, vertexCount, MeshOptimizeSettings{}.vertexCacheSize);
+			// The errors of the nested levels add up (at worst).
+			error += levelError;
+
+			IndexBufferLod lod{};
+			lod.indexOffset = static_cast<uint32_t>(indices.size() + lodIndices.size());
+			lod.indexCount = static_cast<uint32_t>(levelIndexCount);
+			lod.vertexCount = vertexCount;
+			lod.error = error;
+			this->lods.push_back(lod);
+			this->lodIndices.insert(lodIndices.end(), previousLevel.begin(), previousLevel.end());
+		}
+		if (lods.size() == 1) {
+			this->lods.clear();
+			OnIndexDataUpdated();
+			return 0;
+		}
+		if (!settings.compactVertices) {
+			OnIndexDataUpdated();
+			return static_cast<uint32_t>(lods.size());
+		}
+
+		// Vertices are sorted by the coarsest level that uses them (stable, so the fetch order within a level
+		// stays the same). Every level's vertices end up being a prefix of the vertex buffer.
+		// 'vertexLevel' is the coarsest level + 1, 0 for the unreferenced vertices that go last.
+		std::vector<uint32_t> vertexLevel(vertexCount, 0);
+		for (uint32_t lodIdx = 0; lodIdx < lods.size(); lodIdx++) {
+			const uint32_t* lodIndexData = lodIdx == 0 ? indices.data() : lodIndices.data() + (lods[lodIdx].indexOffset - indices.size());
+			for (uint32_t idx = 0; idx < lods[lodIdx].indexCount; idx++) {
+				vertexLevel[lodIndexData[idx]] = lodIdx + 1;
+			}
+		}
+		std::vector<uint32_t> levelOffsets(lods.size() + 2, 0);
+		for (uint32_t vert = 0; vert < vertexCount; vert++) {
+			levelOffsets[lods.size() - vertexLevel[vert] + 1]++;
+		}
+		for (size_t levelIdx = 1; levelIdx < levelOffsets.size(); levelIdx++) {
+			levelOffsets[levelIdx] += levelOffsets[levelIdx - 1];
+		}
+		for (uint32_t lodIdx = 0; lodIdx < lods.size(); lodIdx++) {
+			this->lods[lodIdx].vertexCount = levelOffsets[lods.size() - lodIdx];
+		}
+		std::vector<uint32_t> remap(vertexCount);
+		for (uint32_t vert = 0; vert < vertexCount; vert++) {
+			remap[vert] = levelOffsets[lods.size() - vertexLevel[vert]]++;
+		}
+		RemapIndices(GetMutableAttribData(indices), indices.size(), remap);
+		RemapIndices(lodIndices.data(), lodIndices.size(), remap);
+		RemapVertexAttribArray(GetMutableAttribData(positions), positions.size(), remap);
+		RemapVertexAttribArray(GetMutableAttribData(normals), normals.size(), remap);
+		RemapVertexAttribArray(GetMutableAttribData(tangents), tangents.size(), remap);
+		RemapVertexAttribArray(GetMutableAttribData(colors), colors.size(), remap);
+		RemapVertexAttribArray(GetMutableAttribData(uvs), uvs.size(), remap);
+		// The meshlets are index ranges, they survive the vertex remap. The BVH doesn't.
+		ResetBvh();
+		this->maxIndex = ScanIndices(indices.data(), indices.size(), 0).maxIndex;
+		ApplyIndexFormatNarrowing();
+		OnMeshDataUpdated();
+		return static_cast<uint32_t>(lods.size());
+	}
+	const std::vector<IndexBufferLod>& Mesh::GetLods() const {
+		return lods;
+	}
+	Span<const uint32_t> Mesh::GetLodIndices() const {
+		return lodIndices;
+	}
+
+	void Mesh::SetMeshletsAndLods(Span<const Meshlet> meshlets, Span<const IndexBufferLod> lods, Span<const uint32_t> lodIndices) {
+		this->meshlets.assign(meshlets.begin(), meshlets.end());
+		this->lods.assign(lods.begin(), lods.end());
+		this->lodIndices.assign(lodIndices.begin(), lodIndices.end());
+		// The LOD indices are a part of the index buffer.
+		OnIndexDataUpdated();
+	}
+	void Mesh::SetGpuBufferViews(Span<const char> vertexBuffer, const std::vector<VertexAttribDescriptor>& vbLayout,
+	                             Span<const char> indexBuffer, IndexFormat ibFormat) {
+		assert(vertexBuffer.size() == GetVertexCount() * CalculateVertexStride(vbLayout) &&
+		       "The vertex buffer doesn't match the vertices!");
+		assert(indexBuffer.size() == (GetIndexCount() + lodIndices.size()) * GetIndexFormatSizeInBytes(ibFormat) &&
+		       "The index buffer doesn't match the indices!");
+		this->vertexBufferView = vertexBuffer;
+		this->vertexBufferViewLayout = vbLayout;
+		this->indexBufferView = indexBuffer;
+		this->indexBufferViewFormat = ibFormat;
+	}
+
+	bool Mesh::BuildBvh(const MeshBvhSettings& settings) {
+		uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+		if (meshTopology != MeshTopology::TRIANGLES || indices.size() < 3 || maxIndex >= vertexCount) {
+			bvh.Clear();
+			return false;
+		}
+		bvh.Build(indices.data(), indices.size(), reinterpret_cast<const float*>(positions.data()), vertexCount, settings);
+		// A refit postponed by an edit is already covered.
+		pendingUpdates &= ~MESH_UPDATE_BVH;
+		return true;
+	}
+	void Mesh::ResetBvh() {
+		bvh.Clear();
+	}
+	bool Mesh::HasBvh() const {
+		return !bvh.IsEmpty();
+	}
+	const MeshBvh& Mesh::GetBvh() const {
+		return bvh;
+	}
+
+	// The inverse of the affine part of 'world' (see 'GetAffineColumns()') applied to the ray.
+	// The parameter along the ray is the same in both spaces, so the distances don't change.
+	static bool TransformRayToObjectSpace(MeshRay& objectRay, const MeshRay& ray, const numa::Mat4& world) {
+		float affine[12];
+		GetAffineColumns(world, affine);
+		const float* c0 = affine;
+		const float* c1 = affine + 3;
+		const float* c2 = affine + 6;
+		// The rows of the inverse are the cross products of the columns, divided by the determinant.
+		float rows[3][3]{
+			{c1[1] * c2[2] - c1[2] * c2[1], c1[2] * c2[0] - c1[0] * c2[2], c1[0] * c2[1] - c1[1] * c2[0]},
+			{c2[1] * c0[2] - c2[2] * c0[1], c2[2] * c0[0] - c2[0] * c0[2], c2[0] * c0[1] - c2[1] * c0[0]},
+			{c0[1] * c1[2] - c0[2] * c1[1], c0[2] * c1[0] - c0[0] * c1[2], c0[0] * c1[1] - c0[1] * c1[0]},
+		};
+		float det = c0[0] * rows[0][0] + c0[1] * rows[0][1] + c0[2] * rows[0][2];
+		if (det == 0.0f || !std::isfinite(det)) {
+			return false;
+		}
+		const float* origin = reinterpret_cast<const float*>(&ray.origin);
+		const float* direction = reinterpret_cast<const float*>(&ray.direction);
+		float relativeOrigin[3]{origin[0] - affine[9], origin[1] - affine[10], origin[2] - affine[11]};
+		float objectOrigin[3];
+		float objectDirection[3];
+		for (uint32_t row = 0; row < 3; row++) {
+			objectOrigin[row] = (rows[row][0] * relativeOrigin[0] + rows[row][1] * relativeOrigin[1] +
+			                     rows[row][2] * relativeOrigin[2]) / det;
+			objectDirection[row] = (rows[row][0] * direction[0] + rows[row][1] * direction[1] +
+			                        rows[row][2] * direction[2]) / det;
+		}
+		objectRay = ray;
+		objectRay.origin = numa::Vec3{objectOrigin[0], objectOrigin[1], objectOrigin[2]};
+		objectRay.direction = numa::Vec3{objectDirection[0], objectDirection[1], objectDirection[2]};
+		return true;
+	}
+
+	bool Mesh::RayCastClosest(const MeshRay& ray, const numa::Mat4& world, MeshRayHit& hit) const {
+		MeshRay objectRay{};
+		return !bvh.IsEmpty() && TransformRayToObjectSpace(objectRay, ray, world) && bvh.RayCastClosest(objectRay, hit);
+	}
+	bool Mesh::RayCastAny(const MeshRay& ray, const numa::Mat4& world) const {
+		MeshRay objectRay{};
+		return !bvh.IsEmpty() && TransformRayToObjectSpace(objectRay, ray, world) && bvh.RayCastAny(objectRay);
+	}
+
 	std::vector<char> Mesh::ConstructMeshVertexBuffer() const {
 		std::vector<VertexAttribDescriptor> vertexAttribLayout = GetVertexAttribLayout();
 		uint32_t vertexStride = CalculateVertexStride(vertexAttribLayout);
@@ -206,17 +843,40 @@ namespace ember {
 
 		std::vector<char> vertexBuffer(vertexBufferSizeInBytes);
 		char* vb = vertexBuffer.data();
-		ConstructMeshVertexBuffer(vb, vertexCount, vertexAttribLayout);
+		ConstructMeshVertexBuffer(vb, 0, vertexCount, vertexAttribLayout);
 		return vertexBuffer;
 	}
 	std::vector<char> Mesh::ConstructMeshIndexBuffer() const {
-		uint32_t indexCount = static_cast<uint32_t>(GetIndexCount());
+		// The LOD chain (if any) goes right after the full detail indices.
+		uint32_t indexCount = static_cast<uint32_t>(GetIndexCount() + lodIndices.size());
+		uint32_t indexFormatSize = GetIndexFormatSizeInBytes(indexFormat);
+		size_t indexBufferSizeInBytes{static_cast<size_t>(indexCount) * indexFormatSize};
+
+		std::vector<char> indexBuffer(indexBufferSizeInBytes);
+		char* ib = indexBuffer.data();
+		ConstructMeshIndexBuffer(ib, 0, indexCount, indexFormat);
+		return indexBuffer;
+	}
+	std::vector<char> Mesh::ConstructMeshVertexBuffer(uint32_t firstVertex, uint32_t vertexCount) const {
+		assert(static_cast<size_t>(firstVertex) + vertexCount <= GetVertexCount() && "The vertex range is out of bounds!");
+		std::vector<VertexAttribDescriptor> vertexAttribLayout = GetVertexAttribLayout();
+		uint32_t vertexStride = CalculateVertexStride(vertexAttribLayout);
+		size_t vertexBufferSizeInBytes{static_cast<size_t>(vertexCount) * vertexStride};
+
+		std::vector<char> vertexBuffer(vertexBufferSizeInBytes);
+		char* vb = vertexBuffer.data();
+		ConstructMeshVertexBuffer(vb, firstVertex, vertexCount, vertexAttribLayout);
+		return vertexBuffer;
+	}
+	std::vector<char> Mesh::ConstructMeshIndexBuffer(uint32_t firstIndex, uint32_t indexCount) const {
+		assert(static_cast<size_t>(firstIndex) + indexCount <= GetIndexCount() + lodIndices.size() &&
+		       "The index range is out of bounds!");
 		uint32_t indexFormatSize = GetIndexFormatSizeInBytes(indexFormat);
 		size_t indexBufferSizeInBytes{static_cast<size_t>(indexCount) * indexFormatSize};
 
 		std::vector<char> indexBuffer(indexBufferSizeInBytes);
 		char* ib = indexBuffer.data();
-		ConstructMeshIndexBuffer(ib, indexCount, indexFormat);
+		ConstructMeshIndexBuffer(ib, firstIndex, indexCount, indexFormat);
 		return indexBuffer;
 	}
 
@@ -230,6 +890,7 @@ namespace ember {
 		meshStat.isDynamic = IsMeshDynamic();
 		meshStat.cullBackFaces = CullBackFaces();
 		meshStat.isTessellated = IsMeshTessellated();
+		meshStat.meshlets = meshlets;
 		return meshStat;
 	}
 	VertexBufferInfo Mesh::GetVertexBufferInfo() const {
@@ -237,17 +898,23 @@ namespace ember {
 		vbInfo.vertexAttribLayout = GetVertexAttribLayout();
 		vbInfo.vertexCount = static_cast<uint32_t>(GetVertexCount());
 		vbInfo.vertexStride = CalculateVertexStride(vbInfo.vertexAttribLayout);
+		vbInfo.positionsQuantized = quantizePositions;
+		if (quantizePositions) {
+			GetPositionDequantization(vbInfo.positionScale, vbInfo.positionOffset);
+		}
 		return vbInfo;
 	}
 	IndexBufferInfo Mesh::GetIndexBufferInfo() const {
 		IndexBufferInfo ibInfo{};
 		ibInfo.indexCount = static_cast<uint32_t>(GetIndexCount());
 		ibInfo.indexFormat = GetIndexFormat();
+		ibInfo.lods = lods;
 		return ibInfo;
 	}
 
 	void Mesh::SetVertexAttribDescriptor(const VertexAttribDescriptor& vertAttribDesc) {
-		vertAttribLayout.insert({vertAttribDesc.channel, vertAttribDesc});
+		// Overwrites the existing descriptor, this is how a mesh switches an attribute to a compact GPU format.
+		StoreVertexAttribDescriptor(vertAttribDesc);
 		ResizeVertexAttribArrays();
 		OnVertexDataUpdated();
 	}
@@ -256,16 +923,15 @@ namespace ember {
 			// TODO: report to the user that the position vertex attribute is mandatory and cannot be removed!
 			return;
 		}
-		vertAttribLayout.erase(channel);
+		EraseVertexAttribDescriptor(channel);
 		ResizeVertexAttribArrays();
 		OnVertexDataUpdated();
 	}
 	bool Mesh::GetVertexAttribDescriptor(VertexAttribDescriptor& attribDesc, VertexAttribChannel channel) const {
-		auto searchRes = vertAttribLayout.find(channel);
-		if (searchRes == vertAttribLayout.end()) {
+		if (!HasVertexAttribChannel(channel)) {
 			return false;
 		}
-		attribDesc = searchRes->second;
+		attribDesc = vertAttribLayout[static_cast<size_t>(channel)];
 		return true;
 	}
 
@@ -276,39 +942,28 @@ namespace ember {
 	}
 	std::vector<VertexAttribDescriptor> Mesh::GetVertexAttribLayout() const {
 		std::vector<VertexAttribDescriptor> vertexAttribLayout;
-		VertexAttribDescriptor attribDesc{};
+		vertexAttribLayout.reserve(vertexBufferChannelCount);
 		uint32_t offset{0};
-		// Position vertex attribute
-		GetVertexAttribDescriptor(attribDesc, VertexAttribChannel::POSITION);
-		attribDesc.offset = offset;
-		vertexAttribLayout.push_back(attribDesc);
-		offset += attribDesc.GetVertexAttribSize();
-		// Normal vertex attribute
-		if (GetVertexAttribDescriptor(attribDesc, VertexAttribChannel::NORMAL)) {
-			attribDesc.offset = offset;
-			vertexAttribLayout.push_back(attribDesc);
-			offset += attribDesc.GetVertexAttribSize();
-		}
-		// Tangent vertex attribute
-		if (GetVertexAttribDescriptor(attribDesc, VertexAttribChannel::TANGENT)) {
-			attribDesc.offset = offset;
-			vertexAttribLayout.push_back(attribDesc);
-			offset += attribDesc.GetVertexAttribSize();
-		}
-		// Color vertex attribute
-		if (GetVertexAttribDescriptor(attribDesc, VertexAttribChannel::COLOR)) {
-			attribDesc.offset = offset;
-			vertexAttribLayout.push_back(attribDesc);
-			offset += attribDesc.GetVertexAttribSize();
-		}
-		// Uv vertex attribute
-		if (GetVertexAttribDescriptor(attribDesc, VertexAttribChannel::UV0)) {
+		for (uint32_t channel = 0; channel < vertexBufferChannelCount; channel++) {
+			VertexAttribDescriptor attribDesc{};
+			if (!GetVertexBufferAttribDescriptor(attribDesc, static_cast<VertexAttribChannel>(channel))) {
+				continue;
+			}
 			attribDesc.offset = offset;
 			vertexAttribLayout.push_back(attribDesc);
 			offset += attribDesc.GetVertexAttribSize();
 		}
 		return vertexAttribLayout;
 	}
+	bool Mesh::GetVertexBufferAttribDescriptor(VertexAttribDescriptor& attribDesc, VertexAttribChannel channel) const {
+		if (channel == VertexAttribChannel::POSITION) {
+			// Always a part of the vertex buffer.
+			attribDesc = quantizePositions ? GetQuantizedPositionVertexAttribDescriptor() :
+			                                 vertAttribLayout[static_cast<size_t>(VertexAttribChannel::POSITION)];
+			return true;
+		}
+		return GetVertexAttribDescriptor(attribDesc, channel);
+	}
 
 	VertexAttribDescriptor Mesh::GetDefaultPositionVertexAttribDescriptor() const {
 		VertexAttribDescriptor posAttribDesc{
@@ -328,7 +983,7 @@ namespace ember {
 	}
 	VertexAttribDescriptor Mesh::GetDefaultTangentVertexAttribDescriptor() const {
 		VertexAttribDescriptor tangentAttribDesc{
-			3,
+			4,
 			0,
 			VertexAttribChannel::TANGENT,
 			VertexAttribFormat::FLOAT32,
@@ -354,14 +1009,40 @@ namespace ember {
 		return uvAttribDesc;
 	}
 
+	VertexAttribDescriptor Mesh::GetQuantizedPositionVertexAttribDescriptor() const {
+		VertexAttribDescriptor posAttribDesc{
+			4, 0,
+			VertexAttribChannel::POSITION,
+			VertexAttribFormat::UNORM16,
+		};
+		return posAttribDesc;
+	}
+
+	bool Mesh::GetDefaultVertexAttribDescriptor(VertexAttribDescriptor& attribDesc, VertexAttribChannel channel) const {
+		switch (channel) {
+			case VertexAttribChannel::POSITION:
+				attribDesc = GetDefaultPositionVertexAttribDescriptor();
+				return true;
+			case VertexAttribChannel::NORMAL:
+				attribDesc = GetDefaultNormalVertexAttribDescriptor();
+				return true;
+			case VertexAttribChannel::TANGENT:
+				attribDesc = GetDefaultTangentVertexAttribDescriptor();
+				return true;
+			case VertexAttribChannel::COLOR:
+				attribDesc = GetDefaultColorVertexAttribDescriptor();
+				return true;
+			case VertexAttribChannel::UV0:
+				attribDesc = GetDefaultUvVertexAttribDescriptor();
+				return true;
+			default:
+				return false;
+		}
+	}
+
 	uint32_t Mesh::GetAttributesMask() const {
-		uint32_t attributeMask{0};
-		attributeMask |= 1; // POSITION
-		attributeMask |= HasNormals() ? 1 << 1 : 0; // NORMAL
-		attributeMask |= HasTangents() ? 1 << 2 : 0; // TANGENT
-		attributeMask |= HasColors() ? 1 << 3 : 0; // COLOR
-		attributeMask |= HasUvs() ? 1 << 4 : 0; // UV
-		return attributeMask;
+		// Same bits as 'vertAttribMask', limited to the channels of the vertex buffer. POSITION is always there.
+		return 1u | (vertAttribMask & ((1u << vertexBufferChannelCount) - 1));
 	}
 
 	const numa::AABB& Mesh::GetObjectAABB() const {
@@ -369,29 +1050,32 @@ namespace ember {
 	}
 
 	numa::AABB Mesh::ComputeWorldAABBApproximate(const numa::Mat4& world) const {
-		// Stackoverflow: https://gamedev.stackexchange.com/a/162824/160940
-		// glm::vec3 min = glm::vec3{1.0f, 1.0f, 1.0f} * std::numeric_limits<float>().max();
-		// glm::vec3 max = glm::vec3{1.0f, 1.0f, 1.0f} * std::numeric_limits<float>().min();
-
-		numa::Vec3 min = numa::Vec3{std::numeric_limits<float>().infinity()};
-		numa::Vec3 max = numa::Vec3{-std::numeric_limits<float>().infinity()};
-
-		std::array<numa::Vec3, 8> localAABBVertexPositions = this->objectAABB.GetAABBVertexPositions();
-		for (uint32_t vert = 0; vert < localAABBVertexPositions.size(); vert++) {
-			numa::Vec4 worldSpaceVert = world * numa::Vec4{localAABBVertexPositions[vert], 1.0f};
-			min = numa::Min(numa::Vec3{worldSpaceVert}, min);
-			max = numa::Max(numa::Vec3{worldSpaceVert}, max);
+		// Arvo's method (see 'TransformAabbs()'), the same box as the bounds of the 8 transformed corners.
+		// Padding is already applied to the object AABB, so there's no need to do it again.
+		float affine[12];
+		GetAffineColumns(world, affine);
+		AffineTransformStreams transform{};
+		for (uint32_t element = 0; element < 12; element++) {
+			transform.elements[element] = affine + element;
 		}
-
-		// Apply padding
-		// 
-		// Padding is already applied to the object AABB, so
-		// there's no need to do it again.
-		// 
-		// ApplyLocalAABBPadding(min, max);
+		const float* objectCenter = reinterpret_cast<const float*>(&this->objectAABB.center);
+		const float* objectExtent = reinterpret_cast<const float*>(&this->objectAABB.radius);
+		float worldCenter[3];
+		float worldExtent[3];
+		AabbStreams src{};
+		AabbOutputStreams dst{};
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			src.center[axis] = objectCenter + axis;
+			src.extent[axis] = objectExtent + axis;
+			dst.center[axis] = worldCenter + axis;
+			dst.extent[axis] = worldExtent + axis;
+		}
+		TransformAabbs(dst, src, transform, 1);
 
 		numa::AABB worldAABB{};
-		worldAABB.InitializeFromMinMax(min, max);
+		worldAABB.InitializeFromMinMax(
+			numa::Vec3{worldCenter[0] - worldExtent[0], worldCenter[1] - worldExtent[1], worldCenter[2] - worldExtent[2]},
+			numa::Vec3{worldCenter[0] + worldExtent[0], worldCenter[1] + worldExtent[1], worldCenter[2] + worldExtent[2]});
 		return worldAABB;
 	}
 	numa::AABB Mesh::ComputeWorldAABBPrecise(const numa::Mat4& world) const {
@@ -399,14 +1083,14 @@ namespace ember {
 		// glm::vec3 min = glm::vec3{ 1.0f, 1.0f, 1.0f } * std::numeric_limits<float>().max();
 		// glm::vec3 max = glm::vec3{ 1.0f, 1.0f, 1.0f } * std::numeric_limits<float>().min();
 
-		numa::Vec3 min = numa::Vec3{std::numeric_limits<float>().infinity()};
-		numa::Vec3 max = numa::Vec3{-std::numeric_limits<float>().infinity()};
-
-		for (uint32_t vert = 0; vert < positions.size(); vert++) {
-			numa::Vec4 worldSpaceVert = world * numa::Vec4{positions[vert], 1.0f};
-			min = numa::Min(numa::Vec3{worldSpaceVert}, min);
-			max = numa::Max(numa::Vec3{worldSpaceVert}, max);
-		}
+		float affine[12];
+		GetAffineColumns(world, affine);
+		float transformedMin[3];
+		float transformedMax[3];
+		ComputeTransformedPositionBounds(reinterpret_cast<const float*>(positions.data()), positions.size(), affine,
+		                                 transformedMin, transformedMax);
+		numa::Vec3 min{transformedMin[0], transformedMin[1], transformedMin[2]};
+		numa::Vec3 max{transformedMax[0], transformedMax[1], transformedMax[2]};
 
 		// Apply padding
 		// 
@@ -433,16 +1117,43 @@ namespace ember {
 	}
 	void Mesh::SetObjectAABBPadding(const numa::Vec3& padding) {
 		this->aabbPadding = padding;
+		if (pendingUpdates & MESH_UPDATE_AABB) {
+			// The AABB will be recomputed with the new padding anyway.
+			if (quantizePositions) {
+				OnVertexDataUpdated();
+			}
+			return;
+		}
 		numa::Vec3 min = this->objectAABB.MinPoint();
 		numa::Vec3 max = this->objectAABB.MaxPoint();
 		ApplyObjectAABBPadding(min, max);
 		this->objectAABB.InitializeFromMinMax(min, max);
+		if (quantizePositions) {
+			// The quantized positions are relative to the AABB, so the vertex buffer has to be rebuilt.
+			OnVertexDataUpdated();
+			return;
+		}
 		SendMeshChangedEventNotifications();
 	}
+	const numa::Vec3& Mesh::GetObjectAABBPadding() const {
+		return this->aabbPadding;
+	}
+
+	void Mesh::SetPositionQuantization(bool quantizePositions) {
+		if (this->quantizePositions == quantizePositions) {
+			return;
+		}
+		this->quantizePositions = quantizePositions;
+		OnVertexDataUpdated();
+	}
+	bool Mesh::ArePositionsQuantized() const {
+		return quantizePositions;
+	}
 
 	void Mesh::SetVertexCount(size_t vertexCount) {
-		this->positions.resize(vertexCount);
-		ResizeVertexAttribArrays();
+		ResizeAttribArrays(vertexCount, indices.size());
+		ResetMeshletsAndLods();
+		ResetBvh();
 		OnVertexDataUpdated();
 	}
 	size_t Mesh::GetVertexCount() const {
@@ -450,7 +1161,11 @@ namespace ember {
 	}
 
 	void Mesh::SetIndexCount(size_t indexCount) {
-		this->indices.resize(indexCount);
+		ResizeAttribArrays(positions.size(), indexCount);
+		ResetMeshletsAndLods();
+		ResetBvh();
+		this->maxIndex = ScanIndices(this->indices.data(), this->indices.size(), 0).maxIndex;
+		ApplyIndexFormatNarrowing();
 		OnIndexDataUpdated();
 	}
 	size_t Mesh::GetIndexCount() const {
@@ -458,11 +1173,21 @@ namespace ember {
 	}
 
 	uint32_t Mesh::GetVertexStride() const {
-		return CalculateVertexStride(GetVertexAttribLayout());
+		// Same as the stride of 'GetVertexAttribLayout()', without building it.
+		uint32_t stride{0};
+		for (uint32_t channel = 0; channel < vertexBufferChannelCount; channel++) {
+			VertexAttribDescriptor attribDesc{};
+			if (GetVertexBufferAttribDescriptor(attribDesc, static_cast<VertexAttribChannel>(channel))) {
+				stride += attribDesc.GetVertexAttribSize();
+			}
+		}
+		return stride;
 	}
 
 	void Mesh::SetMeshTopology(MeshTopology meshTopology) {
 		this->meshTopology = meshTopology;
+		ResetMeshletsAndLods();
+		ResetBvh();
 		OnMeshSettingsUpdated();
 	}
 	MeshTopology Mesh::GetMeshTopology() const {
@@ -478,6 +1203,10 @@ namespace ember {
 	}
 
 	void Mesh::SetIndexFormat(IndexFormat format) {
+		assert(GetIndexFormatSizeInBytes(format) >= GetIndexFormatSizeInBytes(PickNarrowestIndexFormat(maxIndex, true)) &&
+		       "The index format is too narrow for the indices of the mesh!");
+		// An explicitly requested format always wins over the automatically picked one.
+		this->autoNarrowIndexFormat = false;
 		this->indexFormat = format;
 		OnIndexDataUpdated();
 	}
@@ -485,6 +1214,28 @@ namespace ember {
 		return indexFormat;
 	}
 
+	void Mesh::SetIndexFormatAutoNarrowing(bool autoNarrowing, bool allowUint8) {
+		this->autoNarrowIndexFormat = autoNarrowing;
+		this->allowUint8Indices = allowUint8;
+		IndexFormat currentIndexFormat = this->indexFormat;
+		ApplyIndexFormatNarrowing();
+		if (this->indexFormat != currentIndexFormat) {
+			OnIndexDataUpdated();
+		}
+	}
+	bool Mesh::IsIndexFormatAutoNarrowingEnabled() const {
+		return autoNarrowIndexFormat;
+	}
+	uint32_t Mesh::GetMaxIndex() const {
+		return maxIndex;
+	}
+	void Mesh::ApplyIndexFormatNarrowing() {
+		if (!autoNarrowIndexFormat) {
+			return;
+		}
+		this->indexFormat = PickNarrowestIndexFormat(maxIndex, allowUint8Indices);
+	}
+
 	uint32_t Mesh::GetMeshId() const {
 		return meshId;
 	}
@@ -530,47 +1281,233 @@ namespace ember {
 		OnMeshDataUpdated();
 	}
 
+	void Mesh::BeginEdit() {
+		editDepth++;
+	}
+	void Mesh::EndEdit() {
+		assert(editDepth > 0 && "EndEdit() without a matching BeginEdit()!");
+		if (--editDepth > 0) {
+			return;
+		}
+		// Cleared first, so that anything that the callbacks below do to the mesh is handled as usual.
+		uint32_t updates = pendingUpdates;
+		pendingUpdates = 0;
+		// The vertex buffer can depend on the AABB (quantized positions), so it goes first.
+		if (updates & MESH_UPDATE_AABB) {
+			ComputeObjectAABB();
+		}
+		if (updates & MESH_UPDATE_BVH) {
+			RefitBvh();
+		}
+		if (updates & MESH_UPDATE_GPU_SETTINGS) {
+			UpdateGpuMeshSettings();
+		}
+		if (updates & MESH_UPDATE_GPU_VERTEX_DATA) {
+			UpdateGpuMeshVertexData();
+		}
+		else if (updates & MESH_UPDATE_GPU_VERTEX_RANGE) {
+			UpdateGpuMeshVertexRange();
+		}
+		if (updates & MESH_UPDATE_GPU_INDEX_DATA) {
+			UpdateGpuMeshIndexData();
+		}
+		else if (updates & MESH_UPDATE_GPU_INDEX_RANGE) {
+			UpdateGpuMeshIndexRange();
+		}
+		if (updates & MESH_UPDATE_NOTIFICATION) {
+			meshChangedCallbackStorage.Invoke();
+		}
+	}
+	bool Mesh::IsBeingEdited() const {
+		return editDepth > 0;
+	}
+
+	bool Mesh::DeferUpdates(uint32_t updates) const {
+		if (editDepth == 0) {
+			return false;
+		}
+		pendingUpdates |= updates;
+		return true;
+	}
+
 	void Mesh::SendMeshChangedEventNotifications() const {
+		if (DeferUpdates(MESH_UPDATE_NOTIFICATION)) {
+			return;
+		}
 		meshChangedCallbackStorage.Invoke();
 	}
 
 	void Mesh::OnVertexDataUpdated() const {
+		this->vertexBufferView = Span<const char>{};
+		if (DeferUpdates(MESH_UPDATE_GPU_VERTEX_DATA | MESH_UPDATE_NOTIFICATION)) {
+			return;
+		}
 		UpdateGpuMeshVertexData();
 		SendMeshChangedEventNotifications();
 	}
 	void Mesh::OnIndexDataUpdated() const {
+		this->indexBufferView = Span<const char>{};
+		ResetTriangleAdjacency();
+		if (DeferUpdates(MESH_UPDATE_GPU_INDEX_DATA | MESH_UPDATE_NOTIFICATION)) {
+			return;
+		}
 		UpdateGpuMeshIndexData();
 		SendMeshChangedEventNotifications();
 	}
 	void Mesh::OnMeshSettingsUpdated() const {
+		if (DeferUpdates(MESH_UPDATE_GPU_SETTINGS | MESH_UPDATE_NOTIFICATION)) {
+			return;
+		}
 		UpdateGpuMeshSettings();
 		SendMeshChangedEventNotifications();
 	}
 	void Mesh::OnMeshDataUpdated() const {
+		this->vertexBufferView = Span<const char>{};
+		this->indexBufferView = Span<const char>{};
+		ResetTriangleAdjacency();
+		if (DeferUpdates(MESH_UPDATE_GPU_SETTINGS | MESH_UPDATE_GPU_VERTEX_DATA |
+		                 MESH_UPDATE_GPU_INDEX_DATA | MESH_UPDATE_NOTIFICATION)) {
+			return;
+		}
 		UpdateGpuMeshSettings();
 		UpdateGpuMeshVertexData();
 		UpdateGpuMeshIndexData();
 		SendMeshChangedEventNotifications();
 	}
+	void Mesh::OnVertexDataRangeUpdated(VertexAttribChannel channel, uint32_t firstVertex, uint32_t count) const {
+		if (count == 0) {
+			return;
+		}
+		this->vertexBufferView = Span<const char>{};
+		dirtyVertexRanges[static_cast<size_t>(channel)].Add(firstVertex, count);
+		if (DeferUpdates(MESH_UPDATE_GPU_VERTEX_RANGE | MESH_UPDATE_NOTIFICATION)) {
+			return;
+		}
+		UpdateGpuMeshVertexRange();
+		SendMeshChangedEventNotifications();
+	}
+	void Mesh::OnIndexDataRangeUpdated(uint32_t firstIndex, uint32_t count) const {
+		if (count == 0) {
+			return;
+		}
+		this->indexBufferView = Span<const char>{};
+		dirtyIndexRange.Add(firstIndex, count);
+		ResetTriangleAdjacency();
+		if (DeferUpdates(MESH_UPDATE_GPU_INDEX_RANGE | MESH_UPDATE_NOTIFICATION)) {
+			return;
+		}
+		UpdateGpuMeshIndexRange();
+		SendMeshChangedEventNotifications();
+	}
 
 	void Mesh::ResizeVertexAttribArrays() {
-		uint32_t normalVertexAttribArraySize = HasNormals() ? static_cast<uint32_t>(positions.size()) : 0;
-		ResizeNormalVertexAttribArray(normalVertexAttribArraySize);
+		ResizeAttribArrays(positions.size(), indices.size());
+	}
+	void Mesh::ResizeAttribArrays(size_t vertexCount, size_t indexCount, uint32_t detachSlotsMask) {
+		const size_t counts[MeshAttribBlock::slotCount]{
+			vertexCount,
+			HasNormals() ? vertexCount : 0,
+			HasTangents() ? vertexCount : 0,
+			HasColors() ? vertexCount : 0,
+			HasUvs() ? vertexCount : 0,
+			indexCount,
+		};
+		// The arrays that keep their size stay where they are, except for the ones in the current block
+		// (it's replaced as a whole) and the detached views.
+		bool relayout{false};
+		size_t slotSizes[MeshAttribBlock::slotCount]{};
+		auto planSlot = [&](const auto& attribArray) {
+			uint32_t slot = static_cast<uint32_t>(attribArray.GetSlot());
+			bool stays = attribArray.size() == counts[slot] && !(detachSlotsMask & (1u << slot));
+			relayout |= !stays;
+			if (!stays || attribArray.IsInBlock()) {
+				slotSizes[slot] = counts[slot] * sizeof(typename std::decay_t<decltype(attribArray)>::ValueType);
+			}
+		};
+		planSlot(positions);
+		planSlot(normals);
+		planSlot(tangents);
+		planSlot(colors);
+		planSlot(uvs);
+		planSlot(indices);
+		if (!relayout) {
+			return;
+		}
 
-		uint32_t tangentVertexAttribArraySize = HasTangents() ? static_cast<uint32_t>(positions.size()) : 0;
-		ResizeTangentVertexAttribArray(tangentVertexAttribArraySize);
+		MeshAttribBlock block{};
+		block.Allocate(slotSizes);
+		auto moveSlot = [&](auto& attribArray) {
+			using Attribute = typename std::decay_t<decltype(attribArray)>::ValueType;
+			uint32_t slot = static_cast<uint32_t>(attribArray.GetSlot());
+			if (counts[slot] == 0) {
+				attribArray.Reset();
+				return;
+			}
+			if (slotSizes[slot] == 0) {
+				return;
+			}
+			Attribute* slotData = static_cast<Attribute*>(block.GetSlotData(attribArray.GetSlot()));
+			size_t keptCount = std::min(attribArray.size(), counts[slot]);
+			std::uninitialized_copy_n(attribArray.data(), keptCount, slotData);
+			std::uninitialized_value_construct_n(slotData + keptCount, counts[slot] - keptCount);
+			attribArray.Bind(slotData, counts[slot]);
+		};
+		moveSlot(positions);
+		moveSlot(normals);
+		moveSlot(tangents);
+		moveSlot(colors);
+		moveSlot(uvs);
+		moveSlot(indices);
+		// The old block goes only now, the arrays were copied out of it.
+		this->attribBlock = std::move(block);
+	}
+
+	template <typename T>
+	T* Mesh::GetMutableAttribData(MeshAttribArray<T>& attribArray) {
+		if (attribArray.IsView()) {
+			ResizeAttribArrays(positions.size(), indices.size(), 1u << static_cast<uint32_t>(attribArray.GetSlot()));
+		}
+		return attribArray.GetMutableData();
+	}
 
-		uint32_t colorVertexAttribArraySize = HasColors() ? static_cast<uint32_t>(positions.size()) : 0;
-		ResizeColorVertexAttribArray(colorVertexAttribArraySize);
+	void Mesh::UseVertexAttribChannel(VertexAttribChannel channel) {
+		VertexAttribDescriptor attribDesc{};
+		if (!HasVertexAttribChannel(channel) && GetDefaultVertexAttribDescriptor(attribDesc, channel)) {
+			StoreVertexAttribDescriptor(attribDesc);
+		}
+	}
+
+	static bool IsVertexAttribChannelValid(VertexAttribChannel channel) {
+		return channel >= VertexAttribChannel::POSITION && channel < VertexAttribChannel::COUNT;
+	}
 
-		uint32_t uvVertexAttribArraySize = HasUvs() ? static_cast<uint32_t>(positions.size()) : 0;
-		ResizeUvVertexAttribArray(uvVertexAttribArraySize);
+	bool Mesh::HasVertexAttribChannel(VertexAttribChannel channel) const {
+		return IsVertexAttribChannelValid(channel) && (vertAttribMask & (1u << static_cast<uint32_t>(channel))) != 0;
+	}
+	void Mesh::StoreVertexAttribDescriptor(const VertexAttribDescriptor& vertAttribDesc) {
+		if (!IsVertexAttribChannelValid(vertAttribDesc.channel)) {
+			assert(false && "Unidentified vertex attribute type provided!");
+			return;
+		}
+		vertAttribLayout[static_cast<size_t>(vertAttribDesc.channel)] = vertAttribDesc;
+		vertAttribMask |= 1u << static_cast<uint32_t>(vertAttribDesc.channel);
+	}
+	void Mesh::EraseVertexAttribDescriptor(VertexAttribChannel channel) {
+		if (!IsVertexAttribChannelValid(channel)) {
+			return;
+		}
+		vertAttribLayout[static_cast<size_t>(channel)] = VertexAttribDescriptor{};
+		vertAttribMask &= ~(1u << static_cast<uint32_t>(channel));
 	}
 
-	void Mesh::SetVertexAttribLayoutMap(const std::vector<VertexAttribDescriptor>& vertAttribLayout) {
-		this->vertAttribLayout.clear();
+	void Mesh::SetVertexAttribLayoutMap(Span<const VertexAttribDescriptor> vertAttribLayout) {
+		vertAttribMask = 0;
+		this->vertAttribLayout.fill(VertexAttribDescriptor{});
 		for (const VertexAttribDescriptor& vertAttrib : vertAttribLayout) {
-			this->vertAttribLayout.insert({vertAttrib.channel, vertAttrib});
+			// The first descriptor of a channel wins.
+			if (!HasVertexAttribChannel(vertAttrib.channel)) {
+				StoreVertexAttribDescriptor(vertAttrib);
+			}
 		}
 		// Ensure that the position vertex attribute exists.
 		VertexAttribDescriptor vertAttribDesc{};
@@ -578,37 +1515,25 @@ namespace ember {
 			// TODO: report to the user that the layout they provided lacks the POSITION vertex attribute,
 			//       and use the default vertex attribute descriptor.
 			vertAttribDesc = GetDefaultPositionVertexAttribDescriptor();
-			this->vertAttribLayout.insert({VertexAttribChannel::POSITION, vertAttribDesc});
+			StoreVertexAttribDescriptor(vertAttribDesc);
 		}
 	}
 
-	void Mesh::ResizeNormalVertexAttribArray(uint32_t size) {
-		normals.resize(size);
-	}
-	void Mesh::ResizeTangentVertexAttribArray(uint32_t size) {
-		tangents.resize(size);
-	}
-	void Mesh::ResizeColorVertexAttribArray(uint32_t size) {
-		colors.resize(size);
-	}
-	void Mesh::ResizeUvVertexAttribArray(uint32_t size) {
-		uvs.resize(size);
-	}
-
-	bool Mesh::IndicesOutOfBound(std::vector<uint32_t>* outOfBoundIndices) {
-		bool outOfBound{false};
-		uint32_t biggestPossibleIndex = static_cast<uint32_t>(positions.size() - 1);
-		for (uint32_t index : this->indices) {
-			if (index > biggestPossibleIndex) {
-				outOfBound = true;
-				if (outOfBoundIndices != nullptr) {
+	bool Mesh::IndicesOutOfBound(const IndexStreamStat& indexStat, std::vector<uint32_t>* outOfBoundIndices) {
+		if (this->indices.empty() || indexStat.maxIndex < positions.size()) {
+			return false;
+		}
+		// Only a broken mesh gets here, so the second pass over the indices is fine.
+		if (outOfBoundIndices != nullptr) {
+			for (uint32_t index : this->indices) {
+				if (index >= positions.size()) {
 					outOfBoundIndices->push_back(index);
 				}
 			}
 		}
-		return outOfBound;
+		return true;
 	}
-	bool Mesh::IndicesIncomplete(std::vector<uint32_t>* incompleteIndices) {
+	bool Mesh::IndicesIncomplete(const IndexStreamStat& indexStat, std::vector<uint32_t>* incompleteIndices) {
 		// Takes the currently set mesh topology into account
 		uint32_t multiplicity = GetIndexMultiplicity(this->meshTopology);
 		if (multiplicity == 0) {
@@ -635,14 +1560,15 @@ namespace ember {
 		// 
 		// We're looking for the 'smallest closest number', which tells us where the last complete primitive ends.
 		// 
-		uint32_t remainder = this->indices.size() % multiplicity;
-		if (remainder == 0) {
+		// The 'smallest closest number' is computed by the index scan ('completeIndexCount').
+		// 
+		size_t smallestClosestNumber = indexStat.completeIndexCount;
+		if (smallestClosestNumber == this->indices.size()) {
 			// The indices array is complete for the current mesh topology
 			return false;
 		}
 		if (incompleteIndices != nullptr) {
-			uint32_t smallestClosestNumber = static_cast<uint32_t>(this->indices.size() - remainder);
-			auto firstIncompleteIndexIter = this->indices.end() - remainder;
+			auto firstIncompleteIndexIter = this->indices.begin() + smallestClosestNumber;
 			incompleteIndices->assign(firstIncompleteIndexIter, this->indices.end());
 		}
 		return true;
@@ -657,26 +1583,136 @@ namespace ember {
 		// Logger::Info("Incomplete indices detected!");
 	}
 
+	void Mesh::ResetMeshletsAndLods() {
+		this->meshlets.clear();
+		this->lods.clear();
+		this->lodIndices.clear();
+	}
+
+	void Mesh::RefitBvh() {
+		if (bvh.IsEmpty()) {
+			return;
+		}
+		if (bvh.GetVertexCount() != positions.size()) {
+			bvh.Clear();
+			return;
+		}
+		if (DeferUpdates(MESH_UPDATE_BVH)) {
+			return;
+		}
+		bvh.Refit(reinterpret_cast<const float*>(positions.data()));
+	}
+
+	bool Mesh::CanGenerateTangentSpace() const {
+		size_t vertexCount = positions.size();
+		size_t indexCount = indices.empty() ? vertexCount : indices.size();
+		return meshTopology == MeshTopology::TRIANGLES && indexCount >= 3 && (indices.empty() || maxIndex < vertexCount);
+	}
+	const uint32_t* Mesh::PrepareTriangleAdjacency(size_t& indexCount) {
+		uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+		const uint32_t* indexData = indices.data();
+		indexCount = indices.size() / 3 * 3;
+		if (indices.empty()) {
+			indexCount = vertexCount / 3 * 3;
+			if (sequentialIndices.size() != indexCount) {
+				sequentialIndices.resize(indexCount);
+				std::iota(sequentialIndices.begin(), sequentialIndices.end(), 0u);
+			}
+			indexData = sequentialIndices.data();
+		}
+		if (triangleAdjacency.offsets.size() != static_cast<size_t>(vertexCount) + 1 ||
+		    triangleAdjacency.triangles.size() != indexCount) {
+			BuildVertexTriangleAdjacency(triangleAdjacency, indexData, indexCount, vertexCount);
+		}
+		return indexData;
+	}
+	void Mesh::ResetTriangleAdjacency() const {
+		this->triangleAdjacency.offsets.clear();
+	}
+
+	void Mesh::UpdateObjectAABB() {
+		if (DeferUpdates(MESH_UPDATE_AABB)) {
+			return;
+		}
+		ComputeObjectAABB();
+	}
+	void Mesh::ResolvePendingObjectAABB() {
+		if (pendingUpdates & MESH_UPDATE_AABB) {
+			pendingUpdates &= ~MESH_UPDATE_AABB;
+			ComputeObjectAABB();
+		}
+	}
 	void Mesh::ComputeObjectAABB() {
 		// Stackoverflow: https://gamedev.stackexchange.com/a/162824/160940
 		// numa::Vec3 min = numa::Vec3{1.0f, 1.0f, 1.0f} * std::numeric_limits<float>().max();
 		// numa::Vec3 max = numa::Vec3{1.0f, 1.0f, 1.0f} * std::numeric_limits<float>().min();
 
-		numa::Vec3 min = numa::Vec3{std::numeric_limits<float>().infinity()};
-		numa::Vec3 max = numa::Vec3{-std::numeric_limits<float>().infinity()};
-		for (uint32_t vert = 0; vert < positions.size(); vert++) {
-			min = numa::Min(positions[vert], min);
-			max = numa::Max(positions[vert], max);
-		}
+		float positionMin[3];
+		float positionMax[3];
+		ComputePositionBounds(reinterpret_cast<const float*>(positions.data()), positions.size(), positionMin, positionMax);
+		numa::Vec3 min{positionMin[0], positionMin[1], positionMin[2]};
+		numa::Vec3 max{positionMax[0], positionMax[1], positionMax[2]};
 		// Apply padding
 		ApplyObjectAABBPadding(min, max);
 		this->objectAABB.InitializeFromMinMax(min, max);
 	}
+	bool Mesh::GrowObjectAABB(uint32_t firstVertex, uint32_t count) {
+		float positionMin[3];
+		float positionMax[3];
+		ComputePositionBounds(reinterpret_cast<const float*>(positions.data() + firstVertex), count, positionMin, positionMax);
+		numa::Vec3 min{positionMin[0], positionMin[1], positionMin[2]};
+		numa::Vec3 max{positionMax[0], positionMax[1], positionMax[2]};
+		ApplyObjectAABBPadding(min, max);
+
+		const float* center = reinterpret_cast<const float*>(&objectAABB.center);
+		const float* extent = reinterpret_cast<const float*>(&objectAABB.radius);
+		float* newMin = reinterpret_cast<float*>(&min);
+		float* newMax = reinterpret_cast<float*>(&max);
+		bool grown = false;
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			float oldMin = center[axis] - extent[axis];
+			float oldMax = center[axis] + extent[axis];
+			grown |= newMin[axis] < oldMin || newMax[axis] > oldMax;
+			newMin[axis] = std::min(newMin[axis], oldMin);
+			newMax[axis] = std::max(newMax[axis], oldMax);
+		}
+		if (grown) {
+			this->objectAABB.InitializeFromMinMax(min, max);
+		}
+		return grown;
+	}
 	void Mesh::ApplyObjectAABBPadding(numa::Vec3& min, numa::Vec3& max) const {
 		min -= aabbPadding;
 		max += aabbPadding;
 	}
 
+	VertexAttribRemap Mesh::GetPositionQuantizationRemap() const {
+		numa::Vec3 scale{};
+		numa::Vec3 offset{};
+		GetPositionDequantization(scale, offset);
+		VertexAttribRemap remap{};
+		const float* extent = reinterpret_cast<const float*>(&scale);
+		const float* min = reinterpret_cast<const float*>(&offset);
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			remap.offset[axis] = min[axis];
+			// A flat axis is always quantized to 0, dequantization puts it back at 'min'.
+			remap.scale[axis] = extent[axis] > 0.0f ? 1.0f / extent[axis] : 0.0f;
+		}
+		return remap;
+	}
+	void Mesh::GetPositionDequantization(numa::Vec3& scale, numa::Vec3& offset) const {
+		if (positions.empty()) {
+			scale = numa::Vec3{1.0f};
+			offset = numa::Vec3{0.0f};
+			return;
+		}
+		numa::Vec3 min = objectAABB.MinPoint();
+		numa::Vec3 max = objectAABB.MaxPoint();
+		scale = max;
+		scale -= min;
+		offset = min;
+	}
+
 	bool Mesh::FormatConversionPossible(VertexAttribFormat srcFormat,
 		                                VertexAttribFormat destFormat) const {
 		// The following are the types available:
@@ -687,6 +1723,12 @@ namespace ember {
 		// UINT16
 		// UINT8
 		// FLOAT32
+		// FLOAT16
+		// SNORM16, SNORM8, UNORM16, UNORM8 (normalized)
+		// OCT_SNORM16 (octahedral unit vectors)
+		// 
+		// The CPU side arrays are always FLOAT32, so the compact formats only matter for the GPU vertex buffer
+		// (see 'ConstructMeshVertexBuffer()'), or for the source buffer of 'SetVertices()'.
 		// 
 		// We have a couple of choices in what checks to do here.
 		// 1. We can allow everything, even conversions with some loss of information.
@@ -724,220 +1766,144 @@ namespace ember {
 
 	void Mesh::UpdateGpuMeshVertexData() const {
 		GetCurrentGpuApiCtx()->OnMeshVertexBufferUpdate(this);
+		std::fill(std::begin(dirtyVertexRanges), std::end(dirtyVertexRanges), MeshDirtyRange{});
 	}
 	void Mesh::UpdateGpuMeshIndexData() const {
 		GetCurrentGpuApiCtx()->OnMeshIndexBufferUpdate(this);
+		dirtyIndexRange = MeshDirtyRange{};
+	}
+	void Mesh::UpdateGpuMeshVertexRange() const {
+		// The per channel ranges are still there during the call, in case the context wants them.
+		MeshDirtyRange dirtyRange = GetDirtyVertexRange();
+		if (!dirtyRange.IsEmpty()) {
+			GetCurrentGpuApiCtx()->OnMeshVertexBufferRangeUpdate(this, dirtyRange.begin, dirtyRange.GetCount());
+		}
+		std::fill(std::begin(dirtyVertexRanges), std::end(dirtyVertexRanges), MeshDirtyRange{});
+	}
+	void Mesh::UpdateGpuMeshIndexRange() const {
+		if (!dirtyIndexRange.IsEmpty()) {
+			GetCurrentGpuApiCtx()->OnMeshIndexBufferRangeUpdate(this, dirtyIndexRange.begin, dirtyIndexRange.GetCount());
+		}
+		dirtyIndexRange = MeshDirtyRange{};
 	}
 
-	void Mesh::ConstructMeshVertexBuffer(char* vb, uint32_t vertexCount,
+	void Mesh::ConstructMeshVertexBuffer(char* vb, uint32_t firstVertex, uint32_t vertexCount,
 		                                 const std::vector<VertexAttribDescriptor>& layout) const {
-		for (uint32_t vert = 0; vert < vertexCount; vert++) {
-			for (const VertexAttribDescriptor& vertexAttrib : layout) {
-				WriteSrcAttribToDstBuffer(vertexAttrib, vb, vert);
-				vb = vb + vertexAttrib.GetVertexAttribSize();
+		if (!vertexBufferView.empty() && VertexAttribLayoutsEqual(layout, vertexBufferViewLayout)) {
+			size_t vertexStride = CalculateVertexStride(layout);
+			std::memcpy(vb, vertexBufferView.data() + firstVertex * vertexStride, vertexCount * vertexStride);
+			return;
+		}
+		// The kernels are resolved once per layout instead of once per vertex and attribute.
+		VertexInterleaver interleaver{};
+		interleaver.SetVertexStride(CalculateVertexStride(layout));
+		for (const VertexAttribDescriptor& vertexAttrib : layout) {
+			if (quantizePositions && vertexAttrib.channel == VertexAttribChannel::POSITION) {
+				interleaver.AddAttrib(vertexAttrib, GetVertexAttribStream(vertexAttrib.channel), GetPositionQuantizationRemap());
+				continue;
 			}
+			interleaver.AddAttrib(vertexAttrib, GetVertexAttribStream(vertexAttrib.channel));
 		}
+		interleaver.Interleave(vb, firstVertex, vertexCount);
 	}
-	void Mesh::ConstructMeshIndexBuffer(char* ib, uint32_t indexCount,
+	void Mesh::ConstructMeshIndexBuffer(char* ib, uint32_t firstIndex, uint32_t indexCount,
 		                                IndexFormat ibFormat) const {
-		uint32_t indexFormatSize = GetIndexFormatSizeInBytes(ibFormat);
-		for (uint32_t idx = 0; idx < indexCount; idx++) {
-			WriteSrcIndexToDstBuffer(ibFormat, ib, idx);
-			ib = ib + indexFormatSize;
+		if (!indexBufferView.empty() && ibFormat == indexBufferViewFormat) {
+			size_t indexSize = GetIndexFormatSizeInBytes(ibFormat);
+			std::memcpy(ib, indexBufferView.data() + firstIndex * indexSize, indexCount * indexSize);
+			return;
 		}
+		size_t fullDetailIndexCount = this->indices.size();
+		size_t rangeEnd = static_cast<size_t>(firstIndex) + indexCount;
+		size_t fullDetailBegin = std::min<size_t>(firstIndex, fullDetailIndexCount);
+		size_t fullDetailEnd = std::min(rangeEnd, fullDetailIndexCount);
+		PackIndices(this->indices.data() + fullDetailBegin, fullDetailEnd - fullDetailBegin, ibFormat, ib);
+		size_t lodBegin = std::max<size_t>(firstIndex, fullDetailIndexCount) - fullDetailIndexCount;
+		size_t lodEnd = std::max(rangeEnd, fullDetailIndexCount) - fullDetailIndexCount;
+		PackIndices(this->lodIndices.data() + lodBegin, lodEnd - lodBegin, ibFormat,
+		            ib + (fullDetailEnd - fullDetailBegin) * GetIndexFormatSizeInBytes(ibFormat));
 	}
 
 	void Mesh::UpdateGpuMeshSettings() const {
 		GetCurrentGpuApiCtx()->OnMeshSettingsChange(this);
 	}
 
-	void Mesh::WriteSrcAttribToDstBuffer(const VertexAttribDescriptor& dstAttribDesc, char* dstBuffer, uint32_t vert) const {
-		// TODO
-	}
-	void Mesh::WriteSrcAttribToDstBuffer(const VertexAttribDescriptor& srcAttribDesc, const char* srcBuffer,
-		                                 const VertexAttribDescriptor& dstAttribDesc, char* dstBuffer) const {
-		// TODO
-	}
-
-	void Mesh::WriteSrcIndexToDstBuffer(IndexFormat indexFormat, char* dstBuffer, uint32_t index) const {
-		// TODO
-	}
-
-	void Mesh::SetInternalVertexAttribArrayData(const void* src, uint32_t vertexCount,
-		                                        const std::vector<VertexAttribDescriptor>& layout) {
-		const char* vb = reinterpret_cast<const char*>(src);
-		for (uint32_t vert = 0; vert < vertexCount; vert++) {
-			for (const VertexAttribDescriptor& attrib : layout) {
-				WriteSrcDataToAttribArray(attrib, vert, vb);
-				vb = vb + attrib.GetVertexAttribSize();
-			}
-		}
-	}
-
-	void Mesh::WriteSrcDataToAttribArray(const VertexAttribDescriptor& srcAttribDesc,
-			                             uint32_t vert, const char* srcBuffer) {
-		switch (srcAttribDesc.channel) {
-			case VertexAttribChannel::POSITION: {
-				VertexAttribDescriptor dstAttribDesc = GetDefaultPositionVertexAttribDescriptor();
-				if (WritePossible(srcAttribDesc, dstAttribDesc)) {
-					numa::Vec3* dstDataPtr = reinterpret_cast<numa::Vec3*>(positions.data());
-					dstDataPtr += vert;
-					char* dstBuffer = reinterpret_cast<char*>(dstDataPtr);
-					WriteSrcDataToAttribArray(srcAttribDesc, srcBuffer, dstAttribDesc, dstBuffer);
-				}
+	VertexAttribStream Mesh::GetVertexAttribStream(VertexAttribChannel channel) const {
+		VertexAttribStream stream{};
+		switch (channel) {
+			case VertexAttribChannel::POSITION:
+				stream.data = reinterpret_cast<const float*>(positions.data());
+				stream.components = 3;
 				break;
-			}
-			case VertexAttribChannel::NORMAL: {
-				VertexAttribDescriptor dstAttribDesc = GetDefaultNormalVertexAttribDescriptor();
-				if (WritePossible(srcAttribDesc, dstAttribDesc)) {
-					numa::Vec3* dstDataPtr = reinterpret_cast<numa::Vec3*>(normals.data());
-					dstDataPtr += vert;
-					char* dstBuffer = reinterpret_cast<char*>(dstDataPtr);
-					WriteSrcDataToAttribArray(srcAttribDesc, srcBuffer, dstAttribDesc, dstBuffer);
-				}
+			case VertexAttribChannel::NORMAL:
+				stream.data = reinterpret_cast<const float*>(normals.data());
+				stream.components = 3;
 				break;
-			}
-			case VertexAttribChannel::TANGENT: {
-				VertexAttribDescriptor dstAttribDesc = GetDefaultTangentVertexAttribDescriptor();
-				if (WritePossible(srcAttribDesc, dstAttribDesc)) {
-					numa::Vec3* dstDataPtr = reinterpret_cast<numa::Vec3*>(tangents.data());
-					dstDataPtr += vert;
-					char* dstBuffer = reinterpret_cast<char*>(dstDataPtr);
-					WriteSrcDataToAttribArray(srcAttribDesc, srcBuffer, dstAttribDesc, dstBuffer);
-				}
+			case VertexAttribChannel::TANGENT:
+				stream.data = reinterpret_cast<const float*>(tangents.data());
+				stream.components = 4;
 				break;
-			}
-			case VertexAttribChannel::COLOR: {
-				VertexAttribDescriptor dstAttribDesc = GetDefaultColorVertexAttribDescriptor();
-				if (WritePossible(srcAttribDesc, dstAttribDesc)) {
-					numa::Vec3* dstDataPtr = reinterpret_cast<numa::Vec3*>(colors.data());
-					dstDataPtr += vert;
-					char* dstBuffer = reinterpret_cast<char*>(dstDataPtr);
-					WriteSrcDataToAttribArray(srcAttribDesc, srcBuffer, dstAttribDesc, dstBuffer);
-				}
+			case VertexAttribChannel::COLOR:
+				stream.data = reinterpret_cast<const float*>(colors.data());
+				stream.components = 3;
 				break;
-			}
-			case VertexAttribChannel::UV0: {
-				VertexAttribDescriptor dstAttribDesc = GetDefaultUvVertexAttribDescriptor();
-				if (WritePossible(srcAttribDesc, dstAttribDesc)) {
-					numa::Vec2* dstDataPtr = reinterpret_cast<numa::Vec2*>(uvs.data());
-					dstDataPtr += vert;
-					char* dstBuffer = reinterpret_cast<char*>(dstDataPtr);
-					WriteSrcDataToAttribArray(srcAttribDesc, srcBuffer, dstAttribDesc, dstBuffer);
-				}
+			case VertexAttribChannel::UV0:
+				stream.data = reinterpret_cast<const float*>(uvs.data());
+				stream.components = 2;
 				break;
-			}
-			default: {
-				assert(true && "Unidentified vertex attribute type provided!");
-			}
+			default:
+				break;
+		}
+		return stream;
+	}
+	float* Mesh::GetVertexAttribArrayData(VertexAttribChannel channel) {
+		switch (channel) {
+			case VertexAttribChannel::POSITION:
+				return reinterpret_cast<float*>(GetMutableAttribData(positions));
+			case VertexAttribChannel::NORMAL:
+				return reinterpret_cast<float*>(GetMutableAttribData(normals));
+			case VertexAttribChannel::TANGENT:
+				return reinterpret_cast<float*>(GetMutableAttribData(tangents));
+			case VertexAttribChannel::COLOR:
+				return reinterpret_cast<float*>(GetMutableAttribData(colors));
+			case VertexAttribChannel::UV0:
+				return reinterpret_cast<float*>(GetMutableAttribData(uvs));
+			default:
+				return nullptr;
 		}
 	}
-	void Mesh::WriteSrcDataToAttribArray(const VertexAttribDescriptor& srcAttribDesc, const char* srcBuffer,
-		                                 const VertexAttribDescriptor& dstAttribDesc, char* dstBuffer) {
-		// All of our destination attributes are floats, they only differ in dimension.
-		float* dstAttribBuffer = reinterpret_cast<float*>(dstBuffer);
-		// We take the minimum dimension between the one offered in 'srcAttribDesc',
-		// and the one requested by the user in 'dstAttribDesc'.
-		uint32_t minDim = std::min(srcAttribDesc.dimension, dstAttribDesc.dimension);
-		// Source vertex attributes need to be converted to the type of the destination attributes (floats in our case).
-		switch (srcAttribDesc.format) {
-			case VertexAttribFormat::FLOAT32: {
-				const float* src = reinterpret_cast<const float*>(srcBuffer);
-				float* dst = dstAttribBuffer;
-				for (uint32_t componentIdx = 0; componentIdx < minDim; componentIdx++) {
-					WriteSrcToDst(src, dst);
-					src++;
-					dst++;
-				}
-				break;
-			}
-			case VertexAttribFormat::UINT32: {
-				for (uint32_t componentIdx = 0; componentIdx < minDim; componentIdx++) {
-					const uint32_t* src = reinterpret_cast<const uint32_t*>(srcBuffer);
-					float* dst = dstAttribBuffer;
-					for (uint32_t componentIdx = 0; componentIdx < minDim; componentIdx++) {
-						WriteSrcToDst(src, dst);
-						src++;
-						dst++;
-					}
-				}
-				break;
-			}
-			case VertexAttribFormat::UINT16: {
-				for (uint32_t componentIdx = 0; componentIdx < minDim; componentIdx++) {
-					const uint16_t* src = reinterpret_cast<const uint16_t*>(srcBuffer);
-					float* dst = dstAttribBuffer;
-					for (uint32_t componentIdx = 0; componentIdx < minDim; componentIdx++) {
-						WriteSrcToDst(src, dst);
-						src++;
-						dst++;
-					}
-				}
-				break;
-			}
-			case VertexAttribFormat::UINT8: {
-				for (uint32_t componentIdx = 0; componentIdx < minDim; componentIdx++) {
-					const uint8_t* src = reinterpret_cast<const uint8_t*>(srcBuffer);
-					float* dst = dstAttribBuffer;
-					for (uint32_t componentIdx = 0; componentIdx < minDim; componentIdx++) {
-						WriteSrcToDst(src, dst);
-						src++;
-						dst++;
-					}
-				}
-				break;
-			}
-			case VertexAttribFormat::INT32: {
-				for (uint32_t componentIdx = 0; componentIdx < minDim; componentIdx++) {
-					const int32_t* src = reinterpret_cast<const int32_t*>(srcBuffer);
-					float* dst = dstAttribBuffer;
-					for (uint32_t componentIdx = 0; componentIdx < minDim; componentIdx++) {
-						WriteSrcToDst(src, dst);
-						src++;
-						dst++;
-					}
-				}
-				break;
-			}
-			case VertexAttribFormat::INT16: {
-				for (uint32_t componentIdx = 0; componentIdx < minDim; componentIdx++) {
-					const int16_t* src = reinterpret_cast<const int16_t*>(srcBuffer);
-					float* dst = dstAttribBuffer;
-					for (uint32_t componentIdx = 0; componentIdx < minDim; componentIdx++) {
-						WriteSrcToDst(src, dst);
-						src++;
-						dst++;
-					}
-				}
-				break;
-			}
-			case VertexAttribFormat::INT8: {
-				for (uint32_t componentIdx = 0; componentIdx < minDim; componentIdx++) {
-					const int8_t* src = reinterpret_cast<const int8_t*>(srcBuffer);
-					float* dst = dstAttribBuffer;
-					for (uint32_t componentIdx = 0; componentIdx < minDim; componentIdx++) {
-						WriteSrcToDst(src, dst);
-						src++;
-						dst++;
-					}
-				}
-				break;
+
+
+	void Mesh::SetInternalVertexAttribArrayData(const void* src, uint32_t vertexCount,
+		                                        const std::vector<VertexAttribDescriptor>& layout) {
+		// The layout is resolved once: every attribute gets its conversion kernel and destination array,
+		// and then the whole column of that attribute is converted in one go.
+		VertexDeinterleaver deinterleaver{};
+		deinterleaver.SetVertexStride(CalculateVertexStride(layout));
+		for (const VertexAttribDescriptor& srcAttribDesc : layout) {
+			VertexAttribDescriptor dstAttribDesc{};
+			if (!GetDefaultVertexAttribDescriptor(dstAttribDesc, srcAttribDesc.channel)) {
+				assert(false && "Unidentified vertex attribute type provided!");
+				continue;
 			}
-			default: {
-				assert(true && "Unknown vertex attribute format provided!");
+			if (!WritePossible(srcAttribDesc, dstAttribDesc)) {
+				continue;
 			}
+			deinterleaver.AddAttrib(srcAttribDesc, GetVertexAttribArrayData(srcAttribDesc.channel), dstAttribDesc.dimension);
+		}
+		deinterleaver.Deinterleave(reinterpret_cast<const char*>(src), 0, vertexCount);
+		for (const VertexAttribDescriptor& srcAttribDesc : layout) {
+			FillMissingTangentHandedness(srcAttribDesc);
 		}
 	}
-
-	void Mesh::SendGpuMeshVertexBufferData(const void* vb) const {
-		// TODO
-		// VertexBufferInfo vbInfo = GetVertexBufferInfo();
-		// coreGlobal.gpuResourceDatabase->UpdateMeshVertexBufferGpuResource(GetMeshId(), vb, vbInfo);
-	}
-	void Mesh::SendGpuMeshIndexBufferData(const void* ib) const {
-		// TODO
-		// IndexBufferInfo ibInfo = GetIndexBufferInfo();
-		// coreGlobal.gpuResourceDatabase->UpdateMeshIndexBufferGpuResource(GetMeshId(), ib, ibInfo);
+	void Mesh::FillMissingTangentHandedness(const VertexAttribDescriptor& srcAttribDesc) {
+		if (srcAttribDesc.channel != VertexAttribChannel::TANGENT || srcAttribDesc.dimension >= 4) {
+			return;
+		}
+		numa::Vec4* tangentData = GetMutableAttribData(tangents);
+		for (size_t vert = 0; vert < tangents.size(); vert++) {
+			tangentData[vert].w = 1.0f;
+		}
 	}
 
 }
\ No newline at end of file
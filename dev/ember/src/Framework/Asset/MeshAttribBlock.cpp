@@ -0,0 +1,55 @@
+#include "Framework/Asset/MeshAttribBlock.h"
+
+#include <algorithm>
+#include <iterator>
+#include <new>
+
+namespace ember {
+
+	static size_t AlignUp(size_t size, size_t alignment) {
+		return (size + alignment - 1) / alignment * alignment;
+	}
+
+	void MeshAttribBlock::AlignedDeleter::operator()(std::byte* data) const {
+		::operator delete[](data, std::align_val_t{alignment});
+	}
+
+	void MeshAttribBlock::Allocate(const size_t (&slotSizesInBytes)[slotCount]) {
+		Free();
+		size_t offset{0};
+		for (uint32_t slot = 0; slot < slotCount; slot++) {
+			slotOffsets[slot] = offset;
+			slotSizes[slot] = slotSizesInBytes[slot];
+			offset += AlignUp(slotSizesInBytes[slot], alignment);
+		}
+		sizeInBytes = offset;
+		if (sizeInBytes > 0) {
+			data.reset(static_cast<std::byte*>(::operator new[](sizeInBytes, std::align_val_t{alignment})));
+		}
+	}
+	void MeshAttribBlock::Free() {
+		data.reset();
+		std::fill(std::begin(slotOffsets), std::end(slotOffsets), size_t{0});
+		std::fill(std::begin(slotSizes), std::end(slotSizes), size_t{0});
+		sizeInBytes = 0;
+	}
+
+	void* MeshAttribBlock::GetSlotData(MeshAttribSlot slot) const {
+		uint32_t slotIdx = static_cast<uint32_t>(slot);
+		return slotSizes[slotIdx] > 0 ? data.get() + slotOffsets[slotIdx] : nullptr;
+	}
+	size_t MeshAttribBlock::GetSlotOffset(MeshAttribSlot slot) const {
+		return slotOffsets[static_cast<uint32_t>(slot)];
+	}
+	size_t MeshAttribBlock::GetSlotSizeInBytes(MeshAttribSlot slot) const {
+		return slotSizes[static_cast<uint32_t>(slot)];
+	}
+
+	const void* MeshAttribBlock::GetData() const {
+		return data.get();
+	}
+	size_t MeshAttribBlock::GetSizeInBytes() const {
+		return sizeInBytes;
+	}
+
+}
\ No newline at end of file
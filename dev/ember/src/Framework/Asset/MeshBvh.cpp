@@ -0,0 +1,592 @@
+#include "Framework/Asset/MeshBvh.h"
+
+#include "Core/Parallel.h"
+#include "Core/Simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ember {
+
+	// A packet is cheap to set up, the chunks just have to be big enough for a thread.
+	static constexpr size_t bvhChunkSize{16384};
+	static constexpr uint32_t packetLaneCount{4};
+	// The SAH splits can be unbalanced, below this depth the triangles are split in half instead,
+	// so the depth (and the traversal stack) stays bounded.
+	static constexpr uint32_t maxSahDepth{32};
+	// 3 children stay on the stack per level at most, the depth is at most 'maxSahDepth' + 32.
+	static constexpr uint32_t traversalStackSize{256};
+
+	static float GetHalfArea(const float min[3], const float max[3]) {
+		float dx = max[0] - min[0];
+		float dy = max[1] - min[1];
+		float dz = max[2] - min[2];
+		return dx * dy + dy * dz + dz * dx;
+	}
+	static void ResetBounds(float min[3], float max[3]) {
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			min[axis] = std::numeric_limits<float>::infinity();
+			max[axis] = -std::numeric_limits<float>::infinity();
+		}
+	}
+	static void GrowBounds(float min[3], float max[3], const float* boxMin, const float* boxMax) {
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			min[axis] = std::min(min[axis], boxMin[axis]);
+			max[axis] = std::max(max[axis], boxMax[axis]);
+		}
+	}
+
+	// The binary hierarchy, collapsed into the 4 wide one once it's done.
+	class MeshBvh::Builder {
+	public:
+		struct BuildNode {
+			float min[3];
+			float max[3];
+			// A leaf has the triangles 'order[first]' ... 'order[first + count - 1]', an inner node has 'count' 0.
+			uint32_t first{0};
+			uint32_t count{0};
+			uint32_t left{0};
+			uint32_t right{0};
+		};
+
+		Builder(const uint32_t* indices, size_t triangleCount, const float* positions, uint32_t binCount)
+			: indices(indices), positions(positions), binCount(std::max(binCount, 2u)),
+			  triangleBounds(triangleCount * 6), centroids(triangleCount * 3), order(triangleCount) {
+			ParallelFor(triangleCount, bvhChunkSize, [this](size_t, size_t begin, size_t end) {
+				for (size_t tri = begin; tri < end; tri++) {
+					float* min = triangleBounds.data() + tri * 6;
+					float* max = min + 3;
+					ResetBounds(min, max);
+					for (uint32_t corner = 0; corner < 3; corner++) {
+						const float* p = this->positions + static_cast<size_t>(this->indices[tri * 3 + corner]) * 3;
+						GrowBounds(min, max, p, p);
+					}
+					for (uint32_t axis = 0; axis < 3; axis++) {
+						centroids[tri * 3 + axis] = (min[axis] + max[axis]) * 0.5f;
+					}
+				}
+			});
+			for (uint32_t tri = 0; tri < triangleCount; tri++) {
+				order[tri] = tri;
+			}
+			buildNodes.reserve(triangleCount / 2 + 1);
+		}
+
+		void Build(MeshBvh& bvh) {
+			BuildBinary(0, static_cast<uint32_t>(order.size()), 0);
+			this->bvh = &bvh;
+			EmitNode(0);
+		}
+
+	private:
+		struct Bin {
+			float min[3];
+			float max[3];
+			uint32_t count{0};
+		};
+
+		uint32_t BuildBinary(uint32_t first, uint32_t count, uint32_t depth) {
+			uint32_t nodeIdx = static_cast<uint32_t>(buildNodes.size());
+			buildNodes.emplace_back();
+			float min[3];
+			float max[3];
+			float centroidMin[3];
+			float centroidMax[3];
+			ResetBounds(min, max);
+			ResetBounds(centroidMin, centroidMax);
+			for (uint32_t idx = first; idx < first + count; idx++) {
+				const float* bounds = triangleBounds.data() + static_cast<size_t>(order[idx]) * 6;
+				const float* centroid = centroids.data() + static_cast<size_t>(order[idx]) * 3;
+				GrowBounds(min, max, bounds, bounds + 3);
+				GrowBounds(centroidMin, centroidMax, centroid, centroid);
+			}
+			std::copy_n(min, 3, buildNodes[nodeIdx].min);
+			std::copy_n(max, 3, buildNodes[nodeIdx].max);
+			if (count <= packetLaneCount) {
+				buildNodes[nodeIdx].first = first;
+				buildNodes[nodeIdx].count = count;
+				return nodeIdx;
+			}
+
+			uint32_t split = depth < maxSahDepth ? PartitionSah(first, count, centroidMin, centroidMax) : first;
+			if (split == first || split == first + count) {
+				// No useful SAH split (e.g. every centroid is the same), half of the triangles go to each side.
+				uint32_t axis = 0;
+				for (uint32_t candidate = 1; candidate < 3; candidate++) {
+					if (centroidMax[candidate] - centroidMin[candidate] > centroidMax[axis] - centroidMin[axis]) {
+						axis = candidate;
+					}
+				}
+				split = first + count / 2;
+				std::nth_element(order.begin() + first, order.begin() + split, order.begin() + first + count,
+				                 [this, axis](uint32_t a, uint32_t b) {
+					return centroids[static_cast<size_t>(a) * 3 + axis] < centroids[static_cast<size_t>(b) * 3 + axis];
+				});
+			}
+			uint32_t left = BuildBinary(first, split - first, depth + 1);
+			uint32_t right = BuildBinary(split, first + count - split, depth + 1);
+			buildNodes[nodeIdx].left = left;
+			buildNodes[nodeIdx].right = right;
+			return nodeIdx;
+		}
+
+		uint32_t GetBin(float centroid, float centroidMin, float binScale) const {
+			// NaN positions end up in the first bin.
+			float bin = std::max(0.0f, (centroid - centroidMin) * binScale);
+			return static_cast<uint32_t>(std::min(bin, static_cast<float>(binCount - 1)));
+		}
+
+		// Returns where the triangles were split, 'first' if there's no split that's worth it.
+		uint32_t PartitionSah(uint32_t first, uint32_t count, const float centroidMin[3], const float centroidMax[3]) {
+			float bestCost = std::numeric_limits<float>::infinity();
+			uint32_t bestAxis{0};
+			uint32_t bestSplit{0};
+			std::vector<Bin>& bins = this->bins;
+			std::vector<float>& rightAreas = this->rightAreas;
+			bins.resize(binCount);
+			rightAreas.resize(binCount);
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				float extent = centroidMax[axis] - centroidMin[axis];
+				if (!(extent > 0.0f)) {
+					continue;
+				}
+				float binScale = static_cast<float>(binCount) / extent;
+				for (Bin& bin : bins) {
+					ResetBounds(bin.min, bin.max);
+					bin.count = 0;
+				}
+				for (uint32_t idx = first; idx < first + count; idx++) {
+					uint32_t tri = order[idx];
+					Bin& bin = bins[GetBin(centroids[static_cast<size_t>(tri) * 3 + axis], centroidMin[axis], binScale)];
+					const float* bounds = triangleBounds.data() + static_cast<size_t>(tri) * 6;
+					GrowBounds(bin.min, bin.max, bounds, bounds + 3);
+					bin.count++;
+				}
+				// 'rightAreas[binIdx]' is the area of the bins 'binIdx' ... 'binCount - 1'.
+				float min[3];
+				float max[3];
+				ResetBounds(min, max);
+				for (uint32_t binIdx = binCount - 1; binIdx > 0; binIdx--) {
+					GrowBounds(min, max, bins[binIdx].min, bins[binIdx].max);
+					// Garbage while the bins are still empty, it's never used then ('rightCount' is 0).
+					rightAreas[binIdx] = GetHalfArea(min, max);
+				}
+				ResetBounds(min, max);
+				uint32_t leftCount{0};
+				for (uint32_t binIdx = 1; binIdx < binCount; binIdx++) {
+					GrowBounds(min, max, bins[binIdx - 1].min, bins[binIdx - 1].max);
+					leftCount += bins[binIdx - 1].count;
+					uint32_t rightCount = count - leftCount;
+					if (leftCount == 0 || rightCount == 0) {
+						continue;
+					}
+					float cost = GetHalfArea(min, max) * static_cast<float>(leftCount) +
+					             rightAreas[binIdx] * static_cast<float>(rightCount);
+					if (cost < bestCost) {
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = binIdx;
+					}
+				}
+			}
+			if (bestSplit == 0) {
+				return first;
+			}
+			float binScale = static_cast<float>(binCount) / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+			auto splitIt = std::partition(order.begin() + first, order.begin() + first + count,
+			                              [this, bestAxis, bestSplit, &centroidMin, binScale](uint32_t tri) {
+				return GetBin(centroids[static_cast<size_t>(tri) * 3 + bestAxis], centroidMin[bestAxis], binScale) < bestSplit;
+			});
+			return static_cast<uint32_t>(splitIt - order.begin());
+		}
+
+		// The 4 wide nodes are emitted parent first, so a refit can go through them backwards.
+		uint32_t EmitNode(uint32_t buildNodeIdx) {
+			uint32_t nodeIdx = static_cast<uint32_t>(bvh->nodes.size());
+			bvh->nodes.emplace_back();
+			// The children of the binary node, the biggest inner one is replaced by its own children
+			// until there are 4 of them (or only leaves).
+			uint32_t children[4]{buildNodeIdx};
+			uint32_t childCount{1};
+			if (buildNodes[buildNodeIdx].count == 0) {
+				children[0] = buildNodes[buildNodeIdx].left;
+				children[1] = buildNodes[buildNodeIdx].right;
+				childCount = 2;
+			}
+			while (childCount < 4) {
+				uint32_t biggest = childCount;
+				float biggestArea{-1.0f};
+				for (uint32_t childIdx = 0; childIdx < childCount; childIdx++) {
+					const BuildNode& child = buildNodes[children[childIdx]];
+					float area = GetHalfArea(child.min, child.max);
+					if (child.count == 0 && area > biggestArea) {
+						biggest = childIdx;
+						biggestArea = area;
+					}
+				}
+				if (biggest == childCount) {
+					break;
+				}
+				uint32_t expanded = children[biggest];
+				children[biggest] = buildNodes[expanded].left;
+				children[childCount++] = buildNodes[expanded].right;
+			}
+
+			for (uint32_t slot = 0; slot < 4; slot++) {
+				uint32_t child = emptyChild;
+				float min[3];
+				float max[3];
+				ResetBounds(min, max);
+				if (slot < childCount) {
+					const BuildNode& buildNode = buildNodes[children[slot]];
+					std::copy_n(buildNode.min, 3, min);
+					std::copy_n(buildNode.max, 3, max);
+					child = buildNode.count > 0 ? EmitPacket(buildNode) | leafChildFlag : EmitNode(children[slot]);
+				}
+				// 'nodes' might have grown in the meantime.
+				Node& node = bvh->nodes[nodeIdx];
+				for (uint32_t axis = 0; axis < 3; axis++) {
+					node.bounds[axis][slot] = min[axis];
+					node.bounds[3 + axis][slot] = max[axis];
+				}
+				node.children[slot] = child;
+			}
+			return nodeIdx;
+		}
+
+		uint32_t EmitPacket(const BuildNode& leaf) {
+			uint32_t packetIdx = static_cast<uint32_t>(bvh->packets.size());
+			bvh->packets.emplace_back();
+			for (uint32_t lane = 0; lane < packetLaneCount; lane++) {
+				uint32_t tri = lane < leaf.count ? order[leaf.first + lane] : emptyChild;
+				bvh->packetTriangles.push_back(tri);
+				for (uint32_t corner = 0; corner < 3; corner++) {
+					bvh->packetVertices.push_back(tri != emptyChild ? indices[static_cast<size_t>(tri) * 3 + corner] : 0);
+				}
+			}
+			return packetIdx;
+		}
+
+		const uint32_t* indices{nullptr};
+		const float* positions{nullptr};
+		uint32_t binCount{0};
+		// Min and max of every triangle.
+		std::vector<float> triangleBounds;
+		std::vector<float> centroids;
+		std::vector<uint32_t> order;
+		std::vector<BuildNode> buildNodes;
+		std::vector<Bin> bins;
+		std::vector<float> rightAreas;
+		MeshBvh* bvh{nullptr};
+	};
+
+	void MeshBvh::Build(const uint32_t* indices, size_t indexCount, const float* positions, uint32_t vertexCount,
+	                    const MeshBvhSettings& settings) {
+		Clear();
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0) {
+			return;
+		}
+		this->vertexCount = vertexCount;
+		this->triangleCount = triangleCount;
+		Builder builder{indices, triangleCount, positions, settings.binCount};
+		builder.Build(*this);
+		ParallelFor(packets.size(), bvhChunkSize, [this, positions](size_t, size_t begin, size_t end) {
+			for (size_t packetIdx = begin; packetIdx < end; packetIdx++) {
+				UpdatePacket(static_cast<uint32_t>(packetIdx), positions);
+			}
+		});
+	}
+
+	void MeshBvh::Refit(const float* positions) {
+		ParallelFor(packets.size(), bvhChunkSize, [this, positions](size_t, size_t begin, size_t end) {
+			for (size_t packetIdx = begin; packetIdx < end; packetIdx++) {
+				UpdatePacket(static_cast<uint32_t>(packetIdx), positions);
+			}
+		});
+		// The children come after their parents.
+		for (size_t nodeIdx = nodes.size(); nodeIdx-- > 0;) {
+			Node& node = nodes[nodeIdx];
+			for (uint32_t slot = 0; slot < 4; slot++) {
+				uint32_t child = node.children[slot];
+				if (child == emptyChild) {
+					continue;
+				}
+				float min[3];
+				float max[3];
+				ResetBounds(min, max);
+				if (child & leafChildFlag) {
+					ComputePacketBounds(min, max, child & ~leafChildFlag, positions);
+				} else {
+					const Node& childNode = nodes[child];
+					for (uint32_t childSlot = 0; childSlot < 4; childSlot++) {
+						for (uint32_t axis = 0; axis < 3; axis++) {
+							min[axis] = std::min(min[axis], childNode.bounds[axis][childSlot]);
+							max[axis] = std::max(max[axis], childNode.bounds[3 + axis][childSlot]);
+						}
+					}
+				}
+				for (uint32_t axis = 0; axis < 3; axis++) {
+					node.bounds[axis][slot] = min[axis];
+					node.bounds[3 + axis][slot] = max[axis];
+				}
+			}
+		}
+	}
+
+	void MeshBvh::Clear() {
+		nodes.clear();
+		packets.clear();
+		packetTriangles.clear();
+		packetVertices.clear();
+		vertexCount = 0;
+		triangleCount = 0;
+	}
+
+	bool MeshBvh::IsEmpty() const {
+		return nodes.empty();
+	}
+	uint32_t MeshBvh::GetVertexCount() const {
+		return vertexCount;
+	}
+	size_t MeshBvh::GetTriangleCount() const {
+		return triangleCount;
+	}
+	size_t MeshBvh::GetNodeCount() const {
+		return nodes.size();
+	}
+
+	void MeshBvh::UpdatePacket(uint32_t packetIdx, const float* positions) {
+		TrianglePacket& packet = packets[packetIdx];
+		for (uint32_t lane = 0; lane < packetLaneCount; lane++) {
+			const uint32_t* vertices = packetVertices.data() + (static_cast<size_t>(packetIdx) * packetLaneCount + lane) * 3;
+			bool used = packetTriangles[static_cast<size_t>(packetIdx) * packetLaneCount + lane] != emptyChild;
+			const float* p0 = positions + static_cast<size_t>(vertices[0]) * 3;
+			const float* p1 = positions + static_cast<size_t>(vertices[1]) * 3;
+			const float* p2 = positions + static_cast<size_t>(vertices[2]) * 3;
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				packet.v0[axis][lane] = used ? p0[axis] : 0.0f;
+				packet.e1[axis][lane] = used ? p1[axis] - p0[axis] : 0.0f;
+				packet.e2[axis][lane] = used ? p2[axis] - p0[axis] : 0.0f;
+			}
+		}
+	}
+
+	void MeshBvh::ComputePacketBounds(float min[3], float max[3], uint32_t packetIdx, const float* positions) const {
+		for (uint32_t lane = 0; lane < packetLaneCount; lane++) {
+			size_t laneIdx = static_cast<size_t>(packetIdx) * packetLaneCount + lane;
+			if (packetTriangles[laneIdx] == emptyChild) {
+				continue;
+			}
+			for (uint32_t corner = 0; corner < 3; corner++) {
+				const float* p = positions + static_cast<size_t>(packetVertices[laneIdx * 3 + corner]) * 3;
+				GrowBounds(min, max, p, p);
+			}
+		}
+	}
+
+	// The ray, set up for the slab tests.
+	struct BvhRay {
+		float origin[3];
+		float direction[3];
+		float invDirection[3];
+		// The bounds row (see 'MeshBvh::Node') that's hit first on every axis, the other one is hit last.
+		uint32_t nearRow[3];
+		uint32_t farRow[3];
+		float tMin;
+	};
+
+	static BvhRay SetUpBvhRay(const MeshRay& ray) {
+		BvhRay bvhRay{};
+		const float* origin = reinterpret_cast<const float*>(&ray.origin);
+		const float* direction = reinterpret_cast<const float*>(&ray.direction);
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			bvhRay.origin[axis] = origin[axis];
+			bvhRay.direction[axis] = direction[axis];
+			// A tiny direction instead of 0, so that a slab test never multiplies 0 by infinity.
+			float d = std::abs(direction[axis]) > 1e-30f ? direction[axis] : std::copysign(1e-30f, direction[axis]);
+			bvhRay.invDirection[axis] = 1.0f / d;
+			bvhRay.nearRow[axis] = bvhRay.invDirection[axis] >= 0.0f ? axis : 3 + axis;
+			bvhRay.farRow[axis] = bvhRay.invDirection[axis] >= 0.0f ? 3 + axis : axis;
+		}
+		bvhRay.tMin = ray.tMin;
+		return bvhRay;
+	}
+
+	// Returns the mask of the hit children, and the distances at which they're entered.
+	static uint32_t IntersectNodeChildren(const float bounds[6][4], const BvhRay& ray, float tMax, float tNear[4]) {
+#if defined(EMBER_SIMD_SSE2)
+		__m128 tEnter = _mm_set1_ps(ray.tMin);
+		__m128 tExit = _mm_set1_ps(tMax);
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			__m128 origin = _mm_set1_ps(ray.origin[axis]);
+			__m128 invDirection = _mm_set1_ps(ray.invDirection[axis]);
+			__m128 nearT = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(bounds[ray.nearRow[axis]]), origin), invDirection);
+			__m128 farT = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(bounds[ray.farRow[axis]]), origin), invDirection);
+			tEnter = _mm_max_ps(tEnter, nearT);
+			tExit = _mm_min_ps(tExit, farT);
+		}
+		_mm_storeu_ps(tNear, tEnter);
+		return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tEnter, tExit)));
+#else
+		uint32_t mask{0};
+		for (uint32_t slot = 0; slot < 4; slot++) {
+			float tEnter = ray.tMin;
+			float tExit = tMax;
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				tEnter = std::max(tEnter, (bounds[ray.nearRow[axis]][slot] - ray.origin[axis]) * ray.invDirection[axis]);
+				tExit = std::min(tExit, (bounds[ray.farRow[axis]][slot] - ray.origin[axis]) * ray.invDirection[axis]);
+			}
+			tNear[slot] = tEnter;
+			mask |= tEnter <= tExit ? 1u << slot : 0u;
+		}
+		return mask;
+#endif
+	}
+
+	// Moller-Trumbore for the 4 lanes, returns the mask of the lanes hit in [tMin, tMax].
+	static uint32_t IntersectTrianglePacket(const float v0[3][4], const float e1[3][4], const float e2[3][4],
+	                                        const BvhRay& ray, float tMax, float t[4], float u[4], float v[4]) {
+#if defined(EMBER_SIMD_SSE2)
+		__m128 d[3]{_mm_set1_ps(ray.direction[0]), _mm_set1_ps(ray.direction[1]), _mm_set1_ps(ray.direction[2])};
+		__m128 a[3]{_mm_loadu_ps(e1[0]), _mm_loadu_ps(e1[1]), _mm_loadu_ps(e1[2])};
+		__m128 b[3]{_mm_loadu_ps(e2[0]), _mm_loadu_ps(e2[1]), _mm_loadu_ps(e2[2])};
+		auto cross = [](__m128* r, const __m128* x, const __m128* y) {
+			r[0] = _mm_sub_ps(_mm_mul_ps(x[1], y[2]), _mm_mul_ps(x[2], y[1]));
+			r[1] = _mm_sub_ps(_mm_mul_ps(x[2], y[0]), _mm_mul_ps(x[0], y[2]));
+			r[2] = _mm_sub_ps(_mm_mul_ps(x[0], y[1]), _mm_mul_ps(x[1], y[0]));
+		};
+		auto dot = [](const __m128* x, const __m128* y) {
+			return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x[0], y[0]), _mm_mul_ps(x[1], y[1])), _mm_mul_ps(x[2], y[2]));
+		};
+		__m128 p[3];
+		cross(p, d, b);
+		__m128 det = dot(a, p);
+		__m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+		__m128 s[3];
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			s[axis] = _mm_sub_ps(_mm_set1_ps(ray.origin[axis]), _mm_loadu_ps(v0[axis]));
+		}
+		__m128 uu = _mm_mul_ps(dot(s, p), invDet);
+		__m128 q[3];
+		cross(q, s, a);
+		__m128 vv = _mm_mul_ps(dot(d, q), invDet);
+		__m128 tt = _mm_mul_ps(dot(b, q), invDet);
+		__m128 zero = _mm_setzero_ps();
+		// NaNs (a zero determinant) fail every comparison.
+		__m128 hit = _mm_cmpneq_ps(det, zero);
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(uu, zero));
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(vv, zero));
+		hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(uu, vv), _mm_set1_ps(1.0f)));
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(tt, _mm_set1_ps(ray.tMin)));
+		hit = _mm_and_ps(hit, _mm_cmple_ps(tt, _mm_set1_ps(tMax)));
+		_mm_storeu_ps(t, tt);
+		_mm_storeu_ps(u, uu);
+		_mm_storeu_ps(v, vv);
+		return static_cast<uint32_t>(_mm_movemask_ps(hit));
+#else
+		uint32_t mask{0};
+		for (uint32_t lane = 0; lane < 4; lane++) {
+			const float* d = ray.direction;
+			float a[3]{e1[0][lane], e1[1][lane], e1[2][lane]};
+			float b[3]{e2[0][lane], e2[1][lane], e2[2][lane]};
+			float p[3]{d[1] * b[2] - d[2] * b[1], d[2] * b[0] - d[0] * b[2], d[0] * b[1] - d[1] * b[0]};
+			float det = a[0] * p[0] + a[1] * p[1] + a[2] * p[2];
+			if (det == 0.0f) {
+				continue;
+			}
+			float invDet = 1.0f / det;
+			float s[3]{ray.origin[0] - v0[0][lane], ray.origin[1] - v0[1][lane], ray.origin[2] - v0[2][lane]};
+			float q[3]{s[1] * a[2] - s[2] * a[1], s[2] * a[0] - s[0] * a[2], s[0] * a[1] - s[1] * a[0]};
+			u[lane] = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+			v[lane] = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * invDet;
+			t[lane] = (b[0] * q[0] + b[1] * q[1] + b[2] * q[2]) * invDet;
+			if (u[lane] >= 0.0f && v[lane] >= 0.0f && u[lane] + v[lane] <= 1.0f &&
+			    t[lane] >= ray.tMin && t[lane] <= tMax) {
+				mask |= 1u << lane;
+			}
+		}
+		return mask;
+#endif
+	}
+
+	template <bool AnyHit>
+	bool MeshBvh::Traverse(const MeshRay& ray, MeshRayHit& hit) const {
+		if (nodes.empty() || !(ray.tMin <= ray.tMax)) {
+			return false;
+		}
+		BvhRay bvhRay = SetUpBvhRay(ray);
+		float closest = ray.tMax;
+		bool found{false};
+
+		struct StackEntry {
+			uint32_t child;
+			float tNear;
+		};
+		StackEntry stack[traversalStackSize];
+		uint32_t stackSize{0};
+		stack[stackSize++] = StackEntry{0, ray.tMin};
+		while (stackSize > 0) {
+			StackEntry entry = stack[--stackSize];
+			// The closest hit might have moved closer since the entry was pushed.
+			if (entry.tNear > closest) {
+				continue;
+			}
+			if (entry.child & leafChildFlag) {
+				uint32_t packetIdx = entry.child & ~leafChildFlag;
+				const TrianglePacket& packet = packets[packetIdx];
+				float t[4];
+				float u[4];
+				float v[4];
+				uint32_t mask = IntersectTrianglePacket(packet.v0, packet.e1, packet.e2, bvhRay, closest, t, u, v);
+				for (uint32_t lane = 0; lane < packetLaneCount; lane++) {
+					if ((mask & (1u << lane)) && t[lane] <= closest) {
+						if constexpr (AnyHit) {
+							return true;
+						}
+						closest = t[lane];
+						hit.t = t[lane];
+						hit.u = u[lane];
+						hit.v = v[lane];
+						hit.triangle = packetTriangles[static_cast<size_t>(packetIdx) * packetLaneCount + lane];
+						found = true;
+					}
+				}
+				continue;
+			}
+
+			const Node& node = nodes[entry.child];
+			float tNear[4];
+			uint32_t mask = IntersectNodeChildren(node.bounds, bvhRay, closest, tNear);
+			// The closest child goes on the top of the stack, so it's visited first.
+			uint32_t firstPushed = stackSize;
+			for (uint32_t slot = 0; slot < 4; slot++) {
+				if (!(mask & (1u << slot))) {
+					continue;
+				}
+				StackEntry childEntry{node.children[slot], tNear[slot]};
+				uint32_t pos = stackSize++;
+				while (pos > firstPushed && stack[pos - 1].tNear < childEntry.tNear) {
+					stack[pos] = stack[pos - 1];
+					pos--;
+				}
+				stack[pos] = childEntry;
+			}
+		}
+		return found;
+	}
+
+	bool MeshBvh::RayCastClosest(const MeshRay& ray, MeshRayHit& hit) const {
+		MeshRayHit closestHit{};
+		if (!Traverse<false>(ray, closestHit)) {
+			return false;
+		}
+		hit = closestHit;
+		return true;
+	}
+	bool MeshBvh::RayCastAny(const MeshRay& ray) const {
+		MeshRayHit anyHit{};
+		return Traverse<true>(ray, anyHit);
+	}
+
+}
\ No newline at end of file
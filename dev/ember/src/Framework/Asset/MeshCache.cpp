@@ -0,0 +1,315 @@
+#include "Framework/Asset/MeshCache.h"
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace ember {
+
+	static_assert(std::is_trivially_copyable_v<MeshCacheHeader>, "The header is written and mapped as is!");
+	static_assert(std::is_trivially_copyable_v<IndexBufferLod> && std::is_trivially_copyable_v<Meshlet>,
+	              "The LODs and the meshlets are written and mapped as they are!");
+	static_assert(static_cast<uint32_t>(MeshCacheBlobType::INDEX) == static_cast<uint32_t>(MeshAttribSlot::INDEX),
+	              "The attribute blobs must go in the 'MeshAttribSlot' order!");
+
+	static constexpr size_t channelCount{static_cast<size_t>(VertexAttribChannel::COUNT)};
+
+	static MeshCacheVertexAttrib ToMeshCacheVertexAttrib(const VertexAttribDescriptor& attribDesc) {
+		return MeshCacheVertexAttrib{
+			attribDesc.dimension,
+			attribDesc.offset,
+			static_cast<uint32_t>(attribDesc.channel),
+			static_cast<uint32_t>(attribDesc.format),
+		};
+	}
+	static VertexAttribDescriptor ToVertexAttribDescriptor(const MeshCacheVertexAttrib& attrib) {
+		return VertexAttribDescriptor{
+			attrib.dimension,
+			attrib.offset,
+			static_cast<VertexAttribChannel>(attrib.channel),
+			static_cast<VertexAttribFormat>(attrib.format),
+		};
+	}
+	static bool IsMeshCacheVertexAttribValid(const MeshCacheVertexAttrib& attrib) {
+		return attrib.channel < channelCount && attrib.dimension <= 4 &&
+		       GetVertexAttribFormatSizeInBytes(static_cast<VertexAttribFormat>(attrib.format)) != 0;
+	}
+
+	static void CopyVec3(float (&dst)[3], const numa::Vec3& src) {
+		std::memcpy(dst, &src, sizeof(dst));
+	}
+	static numa::Vec3 LoadVec3(const float (&src)[3]) {
+		return numa::Vec3{src[0], src[1], src[2]};
+	}
+
+	static size_t AlignBlobOffset(size_t offset) {
+		return (offset + MeshAttribBlock::alignment - 1) / MeshAttribBlock::alignment * MeshAttribBlock::alignment;
+	}
+
+	bool WriteMeshCache(const Mesh& mesh, const std::string& path) {
+		MeshStat meshStat = mesh.GetMeshStat();
+		MeshDataView dataView = mesh.GetDataView();
+		Span<const uint32_t> lodIndices = mesh.GetLodIndices();
+		std::vector<char> vertexBuffer = mesh.ConstructMeshVertexBuffer();
+		std::vector<char> indexBuffer = mesh.ConstructMeshIndexBuffer();
+
+		MeshCacheHeader header{};
+		std::memcpy(header.magic, meshCacheMagic, sizeof(header.magic));
+		header.version = meshCacheVersion;
+		header.headerSizeInBytes = sizeof(MeshCacheHeader);
+		header.flags |= meshStat.IsIndexed() ? static_cast<uint32_t>(MESH_CACHE_INDEXED) : 0u;
+		header.flags |= meshStat.isDynamic ? static_cast<uint32_t>(MESH_CACHE_DYNAMIC) : 0u;
+		header.flags |= meshStat.isTessellated ? static_cast<uint32_t>(MESH_CACHE_TESSELLATED) : 0u;
+		header.flags |= meshStat.cullBackFaces ? static_cast<uint32_t>(MESH_CACHE_CULL_BACK_FACES) : 0u;
+		header.flags |= meshStat.vbInfo.positionsQuantized ? static_cast<uint32_t>(MESH_CACHE_POSITIONS_QUANTIZED) : 0u;
+		header.flags |= mesh.IsIndexFormatAutoNarrowingEnabled() ? static_cast<uint32_t>(MESH_CACHE_INDEX_AUTO_NARROWING) : 0u;
+
+		header.vertexCount = meshStat.vbInfo.vertexCount;
+		header.indexCount = meshStat.ibInfo.indexCount;
+		header.vertexStride = meshStat.vbInfo.vertexStride;
+		header.attributesMask = meshStat.attributesMask;
+		header.meshTopology = static_cast<uint32_t>(meshStat.meshTopology);
+		header.patchVertexCount = meshStat.patchVertexCount;
+		header.indexFormat = static_cast<uint32_t>(meshStat.ibInfo.indexFormat);
+		header.maxIndex = mesh.GetMaxIndex();
+		header.lodCount = static_cast<uint32_t>(meshStat.ibInfo.lods.size());
+		header.meshletCount = static_cast<uint32_t>(meshStat.meshlets.size());
+
+		for (uint32_t channel = 0; channel < channelCount; channel++) {
+			VertexAttribDescriptor attribDesc{};
+			if (mesh.GetVertexAttribDescriptor(attribDesc, static_cast<VertexAttribChannel>(channel))) {
+				header.vertexAttribMask |= 1u << channel;
+				header.vertexAttribs[channel] = ToMeshCacheVertexAttrib(attribDesc);
+			}
+		}
+		const std::vector<VertexAttribDescriptor>& vbLayout = meshStat.vbInfo.vertexAttribLayout;
+		assert(vbLayout.size() <= channelCount && "The vertex buffer has more attributes than there are channels!");
+		header.vertexBufferAttribCount = static_cast<uint32_t>(vbLayout.size());
+		for (size_t attribIdx = 0; attribIdx < vbLayout.size(); attribIdx++) {
+			header.vertexBufferAttribs[attribIdx] = ToMeshCacheVertexAttrib(vbLayout[attribIdx]);
+		}
+
+		const numa::AABB& aabb = mesh.GetObjectAABB();
+		CopyVec3(header.aabbCenter, aabb.center);
+		CopyVec3(header.aabbRadius, aabb.radius);
+		CopyVec3(header.aabbPadding, mesh.GetObjectAABBPadding());
+		CopyVec3(header.positionScale, meshStat.vbInfo.positionScale);
+		CopyVec3(header.positionOffset, meshStat.vbInfo.positionOffset);
+
+		const void* blobData[static_cast<size_t>(MeshCacheBlobType::COUNT)]{
+			dataView.positions.data(),
+			dataView.normals.data(),
+			dataView.tangents.data(),
+			dataView.colors.data(),
+			dataView.uvs.data(),
+			dataView.indices.data(),
+			lodIndices.data(),
+			meshStat.ibInfo.lods.data(),
+			meshStat.meshlets.data(),
+			vertexBuffer.data(),
+			indexBuffer.data(),
+		};
+		const size_t blobSizes[static_cast<size_t>(MeshCacheBlobType::COUNT)]{
+			dataView.positions.size() * sizeof(numa::Vec3),
+			dataView.normals.size() * sizeof(numa::Vec3),
+			dataView.tangents.size() * sizeof(numa::Vec4),
+			dataView.colors.size() * sizeof(numa::Vec3),
+			dataView.uvs.size() * sizeof(numa::Vec2),
+			dataView.indices.size() * sizeof(uint32_t),
+			lodIndices.size() * sizeof(uint32_t),
+			meshStat.ibInfo.lods.size() * sizeof(IndexBufferLod),
+			meshStat.meshlets.size() * sizeof(Meshlet),
+			vertexBuffer.size(),
+			indexBuffer.size(),
+		};
+		size_t offset = AlignBlobOffset(sizeof(MeshCacheHeader));
+		for (size_t blobIdx = 0; blobIdx < static_cast<size_t>(MeshCacheBlobType::COUNT); blobIdx++) {
+			header.blobs[blobIdx].offset = offset;
+			header.blobs[blobIdx].sizeInBytes = blobSizes[blobIdx];
+			offset = AlignBlobOffset(offset + blobSizes[blobIdx]);
+		}
+
+		std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+		if (!stream) {
+			return false;
+		}
+		const char padding[MeshAttribBlock::alignment]{};
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(MeshCacheHeader));
+		size_t written{sizeof(MeshCacheHeader)};
+		for (size_t blobIdx = 0; blobIdx < static_cast<size_t>(MeshCacheBlobType::COUNT); blobIdx++) {
+			stream.write(padding, static_cast<std::streamsize>(header.blobs[blobIdx].offset - written));
+			stream.write(static_cast<const char*>(blobData[blobIdx]), static_cast<std::streamsize>(blobSizes[blobIdx]));
+			written = header.blobs[blobIdx].offset + blobSizes[blobIdx];
+		}
+		return static_cast<bool>(stream.flush());
+	}
+
+	bool MeshCacheFile::Open(const std::string& path) {
+		Close();
+		if (!file.Open(path) || file.GetSizeInBytes() < sizeof(MeshCacheHeader)) {
+			Close();
+			return false;
+		}
+		// The mapping is page aligned, so the header and the blobs are aligned in memory as well.
+		this->header = reinterpret_cast<const MeshCacheHeader*>(file.GetData());
+		if (!ValidateHeader()) {
+			Close();
+			return false;
+		}
+		return true;
+	}
+	void MeshCacheFile::Close() {
+		file.Close();
+		this->header = nullptr;
+	}
+	bool MeshCacheFile::IsOpen() const {
+		return header != nullptr;
+	}
+
+	const MeshCacheHeader& MeshCacheFile::GetHeader() const {
+		assert(IsOpen() && "The mesh cache file isn't open!");
+		return *header;
+	}
+
+	Span<const char> MeshCacheFile::GetBlob(MeshCacheBlobType blobType) const {
+		if (!IsOpen()) {
+			return Span<const char>{};
+		}
+		const MeshCacheBlob& blob = header->blobs[static_cast<size_t>(blobType)];
+		return Span<const char>{file.GetData() + blob.offset, static_cast<size_t>(blob.sizeInBytes)};
+	}
+	MeshDataView MeshCacheFile::GetDataView() const {
+		MeshDataView dataView{};
+		dataView.positions = GetBlobAs<numa::Vec3>(MeshCacheBlobType::POSITION);
+		dataView.normals = GetBlobAs<numa::Vec3>(MeshCacheBlobType::NORMAL);
+		dataView.tangents = GetBlobAs<numa::Vec4>(MeshCacheBlobType::TANGENT);
+		dataView.colors = GetBlobAs<numa::Vec3>(MeshCacheBlobType::COLOR);
+		dataView.uvs = GetBlobAs<numa::Vec2>(MeshCacheBlobType::UV0);
+		dataView.indices = GetBlobAs<uint32_t>(MeshCacheBlobType::INDEX);
+		return dataView;
+	}
+	Span<const char> MeshCacheFile::GetVertexBuffer() const {
+		return GetBlob(MeshCacheBlobType::VERTEX_BUFFER);
+	}
+	Span<const char> MeshCacheFile::GetIndexBuffer() const {
+		return GetBlob(MeshCacheBlobType::INDEX_BUFFER);
+	}
+	VertexBufferInfo MeshCacheFile::GetVertexBufferInfo() const {
+		const MeshCacheHeader& header = GetHeader();
+		VertexBufferInfo vbInfo{};
+		for (uint32_t attribIdx = 0; attribIdx < header.vertexBufferAttribCount; attribIdx++) {
+			vbInfo.vertexAttribLayout.push_back(ToVertexAttribDescriptor(header.vertexBufferAttribs[attribIdx]));
+		}
+		vbInfo.vertexCount = header.vertexCount;
+		vbInfo.vertexStride = header.vertexStride;
+		vbInfo.positionScale = LoadVec3(header.positionScale);
+		vbInfo.positionOffset = LoadVec3(header.positionOffset);
+		vbInfo.positionsQuantized = (header.flags & MESH_CACHE_POSITIONS_QUANTIZED) != 0;
+		return vbInfo;
+	}
+	IndexBufferInfo MeshCacheFile::GetIndexBufferInfo() const {
+		const MeshCacheHeader& header = GetHeader();
+		IndexBufferInfo ibInfo{};
+		ibInfo.indexCount = header.indexCount;
+		ibInfo.indexFormat = static_cast<IndexFormat>(header.indexFormat);
+		Span<const IndexBufferLod> lods = GetBlobAs<IndexBufferLod>(MeshCacheBlobType::LOD);
+		ibInfo.lods.assign(lods.begin(), lods.end());
+		return ibInfo;
+	}
+
+	void MeshCacheFile::LoadMesh(Mesh& mesh) const {
+		const MeshCacheHeader& header = GetHeader();
+		// A single GPU update and notification for everything.
+		MeshEditScope edit{mesh};
+		// The settings go first, the AABB, the index format and the LODs depend on them.
+		mesh.SetObjectAABBPadding(LoadVec3(header.aabbPadding));
+		mesh.SetMeshTopology(static_cast<MeshTopology>(header.meshTopology));
+		mesh.SetCullBackFaceState((header.flags & MESH_CACHE_CULL_BACK_FACES) != 0);
+		if (header.flags & MESH_CACHE_DYNAMIC) {
+			mesh.MakeDynamic();
+		} else {
+			mesh.MakeStatic();
+		}
+		mesh.SetPositionQuantization((header.flags & MESH_CACHE_POSITIONS_QUANTIZED) != 0);
+		std::vector<VertexAttribDescriptor> layout;
+		for (uint32_t channel = 0; channel < channelCount; channel++) {
+			if (header.vertexAttribMask & (1u << channel)) {
+				layout.push_back(ToVertexAttribDescriptor(header.vertexAttribs[channel]));
+			}
+		}
+		mesh.SetVertexAttribLayout(layout);
+
+		// The AABB and the largest index are known already, the arrays aren't scanned.
+		numa::AABB objectAABB{};
+		objectAABB.center = LoadVec3(header.aabbCenter);
+		objectAABB.radius = LoadVec3(header.aabbRadius);
+		mesh.SetDataView(GetDataView(), objectAABB, header.maxIndex);
+
+		IndexFormat indexFormat = static_cast<IndexFormat>(header.indexFormat);
+		if (header.flags & MESH_CACHE_INDEX_AUTO_NARROWING) {
+			// UINT8 could only have been picked if it was allowed.
+			mesh.SetIndexFormatAutoNarrowing(true, indexFormat == IndexFormat::UINT8);
+		} else {
+			mesh.SetIndexFormat(indexFormat);
+		}
+		mesh.SetMeshletsAndLods(GetBlobAs<Meshlet>(MeshCacheBlobType::MESHLET),
+		                        GetBlobAs<IndexBufferLod>(MeshCacheBlobType::LOD),
+		                        GetBlobAs<uint32_t>(MeshCacheBlobType::LOD_INDEX));
+		// Last, every change of the data before this would drop them.
+		mesh.SetGpuBufferViews(GetVertexBuffer(), GetVertexBufferInfo().vertexAttribLayout, GetIndexBuffer(), indexFormat);
+	}
+
+	bool MeshCacheFile::ValidateHeader() const {
+		if (std::memcmp(header->magic, meshCacheMagic, sizeof(header->magic)) != 0 ||
+		    header->version != meshCacheVersion || header->headerSizeInBytes != sizeof(MeshCacheHeader)) {
+			return false;
+		}
+		// Every blob has to be aligned, and it has to fit the file.
+		size_t fileSize = file.GetSizeInBytes();
+		for (const MeshCacheBlob& blob : header->blobs) {
+			if (blob.offset % MeshAttribBlock::alignment != 0 || blob.offset > fileSize || blob.sizeInBytes > fileSize - blob.offset) {
+				return false;
+			}
+		}
+		// And it has to have exactly as many elements as the header says.
+		auto blobSizeIs = [this](MeshCacheBlobType blobType, uint64_t sizeInBytes) {
+			return header->blobs[static_cast<size_t>(blobType)].sizeInBytes == sizeInBytes;
+		};
+		auto channelBlobSizeIs = [this, &blobSizeIs](MeshCacheBlobType blobType, VertexAttribChannel channel, size_t elementSize) {
+			bool inUse = (header->vertexAttribMask & (1u << static_cast<uint32_t>(channel))) != 0;
+			return blobSizeIs(blobType, inUse ? uint64_t{header->vertexCount} * elementSize : 0);
+		};
+		uint64_t lodIndexCount = header->blobs[static_cast<size_t>(MeshCacheBlobType::LOD_INDEX)].sizeInBytes / sizeof(uint32_t);
+		uint32_t indexSize = GetIndexFormatSizeInBytes(static_cast<IndexFormat>(header->indexFormat));
+		if (!blobSizeIs(MeshCacheBlobType::POSITION, uint64_t{header->vertexCount} * sizeof(numa::Vec3)) ||
+		    !channelBlobSizeIs(MeshCacheBlobType::NORMAL, VertexAttribChannel::NORMAL, sizeof(numa::Vec3)) ||
+		    !channelBlobSizeIs(MeshCacheBlobType::TANGENT, VertexAttribChannel::TANGENT, sizeof(numa::Vec4)) ||
+		    !channelBlobSizeIs(MeshCacheBlobType::COLOR, VertexAttribChannel::COLOR, sizeof(numa::Vec3)) ||
+		    !channelBlobSizeIs(MeshCacheBlobType::UV0, VertexAttribChannel::UV0, sizeof(numa::Vec2)) ||
+		    !blobSizeIs(MeshCacheBlobType::INDEX, uint64_t{header->indexCount} * sizeof(uint32_t)) ||
+		    !blobSizeIs(MeshCacheBlobType::LOD_INDEX, lodIndexCount * sizeof(uint32_t)) ||
+		    !blobSizeIs(MeshCacheBlobType::LOD, uint64_t{header->lodCount} * sizeof(IndexBufferLod)) ||
+		    !blobSizeIs(MeshCacheBlobType::MESHLET, uint64_t{header->meshletCount} * sizeof(Meshlet)) ||
+		    !blobSizeIs(MeshCacheBlobType::VERTEX_BUFFER, uint64_t{header->vertexCount} * header->vertexStride) ||
+		    indexSize == 0 ||
+		    !blobSizeIs(MeshCacheBlobType::INDEX_BUFFER, (header->indexCount + lodIndexCount) * indexSize)) {
+			return false;
+		}
+		if (header->vertexBufferAttribCount > channelCount) {
+			return false;
+		}
+		for (uint32_t channel = 0; channel < channelCount; channel++) {
+			if ((header->vertexAttribMask & (1u << channel)) && !IsMeshCacheVertexAttribValid(header->vertexAttribs[channel])) {
+				return false;
+			}
+		}
+		for (uint32_t attribIdx = 0; attribIdx < header->vertexBufferAttribCount; attribIdx++) {
+			if (!IsMeshCacheVertexAttribValid(header->vertexBufferAttribs[attribIdx])) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include "Framework/Asset/MeshOptimizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace ember {
+
+	static constexpr uint32_t invalidVertex{std::numeric_limits<uint32_t>::max()};
+
+	// FIFO cache simulation. A vertex is in the cache if less than 'cacheSize' vertices were added since it was.
+	// Flushing the cache is just a matter of bumping the timestamp by more than 'cacheSize'.
+	class VertexCacheSimulator {
+	public:
+		VertexCacheSimulator(uint32_t vertexCount, uint32_t cacheSize)
+			: cacheTimestamps(vertexCount, 0), timestamp(cacheSize + 1), cacheSize(cacheSize) {}
+
+		bool InCache(uint32_t vertex) const {
+			return timestamp - cacheTimestamps[vertex] <= cacheSize;
+		}
+		// Returns 'true' on a cache miss.
+		bool Access(uint32_t vertex) {
+			if (InCache(vertex)) {
+				return false;
+			}
+			cacheTimestamps[vertex] = timestamp++;
+			return true;
+		}
+		uint32_t AccessTriangle(const uint32_t* triangle) {
+			return static_cast<uint32_t>(Access(triangle[0])) +
+			       static_cast<uint32_t>(Access(triangle[1])) +
+			       static_cast<uint32_t>(Access(triangle[2]));
+		}
+		void Flush() {
+			timestamp += cacheSize + 1;
+		}
+
+		// The number of vertices added to the cache after this one. Only meaningful for cached vertices.
+		uint32_t GetAge(uint32_t vertex) const {
+			return timestamp - cacheTimestamps[vertex];
+		}
+
+	private:
+		std::vector<uint32_t> cacheTimestamps;
+		uint32_t timestamp{0};
+		uint32_t cacheSize{0};
+	};
+
+	void BuildVertexTriangleAdjacency(VertexTriangleAdjacency& adjacency,
+	                                  const uint32_t* indices, size_t indexCount, uint32_t vertexCount) {
+		adjacency.counts.assign(vertexCount, 0);
+		for (size_t idx = 0; idx < indexCount; idx++) {
+			adjacency.counts[indices[idx]]++;
+		}
+		adjacency.offsets.resize(static_cast<size_t>(vertexCount) + 1);
+		adjacency.offsets[0] = 0;
+		for (uint32_t vert = 0; vert < vertexCount; vert++) {
+			adjacency.offsets[vert + 1] = adjacency.offsets[vert] + adjacency.counts[vert];
+		}
+		adjacency.triangles.resize(indexCount);
+		std::vector<uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+		for (size_t idx = 0; idx < indexCount; idx++) {
+			adjacency.triangles[fill[indices[idx]]++] = static_cast<uint32_t>(idx / 3);
+		}
+	}
+
+	VertexCacheStat AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, uint32_t vertexCount,
+	                                   uint32_t cacheSize) {
+		VertexCacheStat stat{};
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0 || vertexCount == 0) {
+			return stat;
+		}
+		VertexCacheSimulator cache{vertexCount, cacheSize};
+		for (size_t tri = 0; tri < triangleCount; tri++) {
+			stat.transformedVertexCount += cache.AccessTriangle(indices + tri * 3);
+		}
+		stat.acmr = static_cast<float>(stat.transformedVertexCount) / static_cast<float>(triangleCount);
+		stat.atvr = static_cast<float>(stat.transformedVertexCount) / static_cast<float>(vertexCount);
+		return stat;
+	}
+
+	void OptimizeVertexCache(uint32_t* dst, const uint32_t* indices, size_t indexCount, uint32_t vertexCount,
+	                         uint32_t cacheSize) {
+		assert((dst != indices || indexCount == 0) && "In-place vertex cache optimization is not supported!");
+		size_t triangleIndexCount = indexCount - indexCount % 3;
+		// Incomplete primitives (if any) are left at the end as they are.
+		std::copy(indices + triangleIndexCount, indices + indexCount, dst + triangleIndexCount);
+		if (triangleIndexCount == 0) {
+			return;
+		}
+
+		VertexTriangleAdjacency adjacency{};
+		BuildVertexTriangleAdjacency(adjacency, indices, triangleIndexCount, vertexCount);
+		// The number of triangles of each vertex that are yet to be emitted.
+		std::vector<uint32_t>& liveTriangles = adjacency.counts;
+		std::vector<bool> emitted(triangleIndexCount / 3, false);
+		// Recently used vertices, the first place to look for the next fanning vertex when we get stuck.
+		std::vector<uint32_t> deadEndStack;
+		std::vector<uint32_t> candidates;
+		VertexCacheSimulator cache{vertexCount, cacheSize};
+
+		uint32_t* out = dst;
+		uint32_t cursor{0};
+		uint32_t fanningVertex{0};
+		while (fanningVertex != invalidVertex) {
+			candidates.clear();
+			for (uint32_t adj = adjacency.offsets[fanningVertex]; adj < adjacency.offsets[fanningVertex + 1]; adj++) {
+				uint32_t tri = adjacency.triangles[adj];
+				if (emitted[tri]) {
+					continue;
+				}
+				for (uint32_t corner = 0; corner < 3; corner++) {
+					uint32_t vert = indices[tri * 3 + corner];
+					*out++ = vert;
+					deadEndStack.push_back(vert);
+					candidates.push_back(vert);
+					liveTriangles[vert]--;
+					cache.Access(vert);
+				}
+				emitted[tri] = true;
+			}
+
+			// The next fanning vertex is the one among the vertices we've just emitted that will still be
+			// in the cache after all of its remaining triangles are emitted (and is the oldest one of them).
+			uint32_t nextVertex{invalidVertex};
+			int64_t bestPriority{-1};
+			for (uint32_t vert : candidates) {
+				if (liveTriangles[vert] == 0) {
+					continue;
+				}
+				int64_t priority{0};
+				uint32_t age = cache.GetAge(vert);
+				if (age + 2 * liveTriangles[vert] <= cacheSize) {
+					priority = age;
+				}
+				if (priority > bestPriority) {
+					bestPriority = priority;
+					nextVertex = vert;
+				}
+			}
+			// Dead end. Try the most recently used vertices first, and then just the next vertex in the input order.
+			while (nextVertex == invalidVertex && !deadEndStack.empty()) {
+				uint32_t vert = deadEndStack.back();
+				deadEndStack.pop_back();
+				if (liveTriangles[vert] > 0) {
+					nextVertex = vert;
+				}
+			}
+			for (; nextVertex == invalidVertex && cursor < vertexCount; cursor++) {
+				if (liveTriangles[cursor] > 0) {
+					nextVertex = cursor;
+				}
+			}
+			fanningVertex = nextVertex;
+		}
+		assert(out == dst + triangleIndexCount && "Not every triangle was emitted!");
+	}
+
+	struct TriangleCluster {
+		uint32_t firstTriangle{0};
+		uint32_t triangleCount{0};
+		float sortKey{0.0f};
+	};
+
+	static void SplitTriangleClusters(std::vector<TriangleCluster>& clusters,
+	                                  const uint32_t* indices, uint32_t triangleCount, uint32_t vertexCount,
+	                                  uint32_t cacheSize, float threshold) {
+		// Hard boundaries: triangles where all 3 vertices miss the cache. This is where the vertex cache
+		// optimization had to jump somewhere else, so splitting here doesn't make the ACMR any worse.
+		std::vector<uint32_t> hardBoundaries;
+		VertexCacheSimulator cache{vertexCount, cacheSize};
+		for (uint32_t tri = 0; tri < triangleCount; tri++) {
+			if (cache.AccessTriangle(indices + tri * 3) == 3) {
+				hardBoundaries.push_back(tri);
+			}
+		}
+		hardBoundaries.push_back(triangleCount);
+
+		// Soft boundaries: a hard cluster is split further as soon as the ACMR of the current part
+		// gets close enough to the ACMR of the whole hard cluster.
+		for (size_t hardCluster = 0; hardCluster + 1 < hardBoundaries.size(); hardCluster++) {
+			uint32_t clusterStart = hardBoundaries[hardCluster];
+			uint32_t clusterEnd = hardBoundaries[hardCluster + 1];
+
+			cache.Flush();
+			uint32_t clusterMisses{0};
+			for (uint32_t tri = clusterStart; tri < clusterEnd; tri++) {
+				clusterMisses += cache.AccessTriangle(indices + tri * 3);
+			}
+			float clusterAcmr = static_cast<float>(clusterMisses) / static_cast<float>(clusterEnd - clusterStart);
+
+			cache.Flush();
+			uint32_t softStart = clusterStart;
+			uint32_t softMisses{0};
+			for (uint32_t tri = clusterStart; tri < clusterEnd; tri++) {
+				softMisses += cache.AccessTriangle(indices + tri * 3);
+				float softAcmr = static_cast<float>(softMisses) / static_cast<float>(tri + 1 - softStart);
+				if (tri + 1 < clusterEnd && softAcmr <= threshold * clusterAcmr) {
+					clusters.push_back(TriangleCluster{softStart, tri + 1 - softStart});
+					softStart = tri + 1;
+					softMisses = 0;
+					cache.Flush();
+				}
+			}
+			clusters.push_back(TriangleCluster{softStart, clusterEnd - softStart});
+		}
+	}
+
+	static float ComputeClusterSortKey(const TriangleCluster& cluster, const uint32_t* indices,
+	                                   const float* positions, const float center[3]) {
+		// Area weighted centroid and normal of the cluster. The length of the cross product
+		// is twice the area of the triangle, so the sum of them is already area weighted.
+		float centroid[3]{0.0f, 0.0f, 0.0f};
+		float normal[3]{0.0f, 0.0f, 0.0f};
+		float area{0.0f};
+		for (uint32_t tri = cluster.firstTriangle; tri < cluster.firstTriangle + cluster.triangleCount; tri++) {
+			const float* p0 = positions + static_cast<size_t>(indices[tri * 3 + 0]) * 3;
+			const float* p1 = positions + static_cast<size_t>(indices[tri * 3 + 1]) * 3;
+			const float* p2 = positions + static_cast<size_t>(indices[tri * 3 + 2]) * 3;
+			float e0[3]{p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+			float e1[3]{p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+			float n[3]{
+				e0[1] * e1[2] - e0[2] * e1[1],
+				e0[2] * e1[0] - e0[0] * e1[2],
+				e0[0] * e1[1] - e0[1] * e1[0],
+			};
+			float triArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				centroid[axis] += (p0[axis] + p1[axis] + p2[axis]) * (triArea / 3.0f);
+				normal[axis] += n[axis];
+			}
+			area += triArea;
+		}
+		float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (area <= 0.0f || normalLength <= 0.0f) {
+			return 0.0f;
+		}
+		float sortKey{0.0f};
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			sortKey += (centroid[axis] / area - center[axis]) * (normal[axis] / normalLength);
+		}
+		return sortKey;
+	}
+
+	void OptimizeOverdraw(uint32_t* dst, const uint32_t* indices, size_t indexCount,
+	                      const float* positions, uint32_t vertexCount, const float center[3],
+	                      uint32_t cacheSize, float threshold) {
+		assert((dst != indices || indexCount == 0) && "In-place overdraw optimization is not supported!");
+		size_t triangleIndexCount = indexCount - indexCount % 3;
+		std::copy(indices + triangleIndexCount, indices + indexCount, dst + triangleIndexCount);
+		if (triangleIndexCount == 0) {
+			return;
+		}
+		uint32_t triangleCount = static_cast<uint32_t>(triangleIndexCount / 3);
+
+		std::vector<TriangleCluster> clusters;
+		SplitTriangleClusters(clusters, indices, triangleCount, vertexCount, cacheSize, threshold);
+		for (TriangleCluster& cluster : clusters) {
+			cluster.sortKey = ComputeClusterSortKey(cluster, indices, positions, center);
+		}
+		// Clusters that face away from the center (the outer surface of the mesh) are likely
+		// to occlude the rest, so they're drawn first. Stable, so that ties keep the cache friendly order.
+		std::stable_sort(clusters.begin(), clusters.end(), [](const TriangleCluster& a, const TriangleCluster& b) {
+			return a.sortKey > b.sortKey;
+		});
+
+		uint32_t* out = dst;
+		for (const TriangleCluster& cluster : clusters) {
+			out = std::copy(indices + static_cast<size_t>(cluster.firstTriangle) * 3,
+			                indices + static_cast<size_t>(cluster.firstTriangle + cluster.triangleCount) * 3,
+			                out);
+		}
+	}
+
+	void OptimizeVertexFetchRemap(std::vector<uint32_t>& remap, const uint32_t* indices, size_t indexCount,
+	                              uint32_t vertexCount) {
+		remap.assign(vertexCount, invalidVertex);
+		uint32_t nextVertex{0};
+		for (size_t idx = 0; idx < indexCount; idx++) {
+			uint32_t vert = indices[idx];
+			if (remap[vert] == invalidVertex) {
+				remap[vert] = nextVertex++;
+			}
+		}
+		for (uint32_t& newVertex : remap) {
+			if (newVertex == invalidVertex) {
+				newVertex = nextVertex++;
+			}
+		}
+	}
+
+	void RemapIndices(uint32_t* indices, size_t indexCount, const std::vector<uint32_t>& remap) {
+		for (size_t idx = 0; idx < indexCount; idx++) {
+			indices[idx] = remap[indices[idx]];
+		}
+	}
+
+}
\ No newline at end of file
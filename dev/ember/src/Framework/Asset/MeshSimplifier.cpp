@@ -0,0 +1,427 @@
+#include "Framework/Asset/MeshSimplifier.h"
+
+#include "Framework/Asset/MeshOptimizer.h"
+#include "Framework/Asset/MeshWelder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace ember {
+
+	// Borders count this much more than the surface, so they're only collapsed along themselves.
+	static constexpr float borderWeight{10.0f};
+
+	enum class VertexKind : uint8_t {
+		MANIFOLD, // can collapse onto any neighbor
+		BORDER,   // can collapse only along a border edge
+		LOCKED,   // never collapses (seams, non-manifold vertices)
+	};
+
+	// Symmetric 4x4 matrix of the sum of the squared distances to a set of planes, weighted by 'w'.
+	// error(p) = p^T A p + 2 b^T p + c
+	struct Quadric {
+		float a00{0.0f}, a11{0.0f}, a22{0.0f};
+		float a10{0.0f}, a20{0.0f}, a21{0.0f};
+		float b0{0.0f}, b1{0.0f}, b2{0.0f};
+		float c{0.0f};
+		float w{0.0f};
+	};
+
+	// Plane 'n.p + d = 0', 'n' is normalized.
+	static Quadric QuadricFromPlane(const float n[3], float d, float w) {
+		Quadric q{};
+		q.a00 = w * n[0] * n[0];
+		q.a11 = w * n[1] * n[1];
+		q.a22 = w * n[2] * n[2];
+		q.a10 = w * n[1] * n[0];
+		q.a20 = w * n[2] * n[0];
+		q.a21 = w * n[2] * n[1];
+		q.b0 = w * n[0] * d;
+		q.b1 = w * n[1] * d;
+		q.b2 = w * n[2] * d;
+		q.c = w * d * d;
+		q.w = w;
+		return q;
+	}
+	static void QuadricAdd(Quadric& q, const Quadric& r) {
+		q.a00 += r.a00;
+		q.a11 += r.a11;
+		q.a22 += r.a22;
+		q.a10 += r.a10;
+		q.a20 += r.a20;
+		q.a21 += r.a21;
+		q.b0 += r.b0;
+		q.b1 += r.b1;
+		q.b2 += r.b2;
+		q.c += r.c;
+		q.w += r.w;
+	}
+	static float QuadricError(const Quadric& q, const float* p) {
+		float rx = q.a00 * p[0] + q.a10 * p[1] + q.a20 * p[2] + q.b0;
+		float ry = q.a10 * p[0] + q.a11 * p[1] + q.a21 * p[2] + q.b1;
+		float rz = q.a20 * p[0] + q.a21 * p[1] + q.a22 * p[2] + q.b2;
+		float error = rx * p[0] + ry * p[1] + rz * p[2] + q.b0 * p[0] + q.b1 * p[1] + q.b2 * p[2] + q.c;
+		// Can be slightly negative because of rounding.
+		return std::fabs(error);
+	}
+
+	static void Cross(float* r, const float* a, const float* b) {
+		r[0] = a[1] * b[2] - a[2] * b[1];
+		r[1] = a[2] * b[0] - a[0] * b[2];
+		r[2] = a[0] * b[1] - a[1] * b[0];
+	}
+	static float Dot(const float* a, const float* b) {
+		return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	}
+	// Not normalized, the length is twice the area of the triangle.
+	static void TriangleNormal(float* n, const float* p0, const float* p1, const float* p2) {
+		float e1[3]{p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+		float e2[3]{p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+		Cross(n, e1, e2);
+	}
+
+	static uint64_t EdgeKey(uint32_t a, uint32_t b) {
+		return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+	}
+
+	struct Collapse {
+		uint32_t src{0};
+		uint32_t dst{0};
+		float error{0.0f};
+		// Collapsing a border edge removes 1 triangle, an interior one removes 2.
+		uint32_t removedTriangles{0};
+	};
+
+	class MeshSimplifier {
+	public:
+		MeshSimplifier(const uint32_t* indices, size_t indexCount, const float* positions, uint32_t vertexCount)
+			: indices(indices, indices + indexCount / 3 * 3), vertexCount(vertexCount),
+			  positions(static_cast<size_t>(vertexCount) * 3), quadrics(vertexCount), kinds(vertexCount, VertexKind::MANIFOLD),
+			  remap(vertexCount), collapseLocked(vertexCount, 0) {
+			NormalizePositions(positions);
+			ClassifyVertices(positions);
+			BuildQuadrics();
+		}
+
+		// Returns the error of the worst collapse that was done, in the normalized space.
+		float Simplify(size_t targetIndexCount, float maxError) {
+			float maxErrorSq = maxError * maxError;
+			float resultErrorSq{0.0f};
+			while (indices.size() > targetIndexCount) {
+				size_t triangleCount = indices.size() / 3;
+				size_t triangleGoal = (indices.size() - targetIndexCount + 2) / 3;
+
+				std::vector<Collapse> collapses;
+				RankCollapses(collapses);
+				if (collapses.empty()) {
+					break;
+				}
+				BuildVertexTriangleAdjacency(adjacency, indices.data(), indices.size(), vertexCount);
+				for (uint32_t vert = 0; vert < vertexCount; vert++) {
+					remap[vert] = vert;
+				}
+				std::fill(collapseLocked.begin(), collapseLocked.end(), 0);
+
+				// Every vertex takes part in one collapse per pass at most, so the quadrics and the
+				// flip checks of the other collapses of the pass stay valid.
+				size_t removedTriangles{0};
+				size_t collapseCount{0};
+				for (const Collapse& collapse : collapses) {
+					if (collapse.error > maxErrorSq || removedTriangles >= triangleGoal) {
+						break;
+					}
+					if (collapseLocked[collapse.src] || collapseLocked[collapse.dst]) {
+						continue;
+					}
+					if (HasTriangleFlips(collapse.src, collapse.dst)) {
+						continue;
+					}
+					QuadricAdd(quadrics[collapse.dst], quadrics[collapse.src]);
+					remap[collapse.src] = collapse.dst;
+					collapseLocked[collapse.src] = 1;
+					collapseLocked[collapse.dst] = 1;
+					removedTriangles += collapse.removedTriangles;
+					resultErrorSq = std::max(resultErrorSq, collapse.error);
+					collapseCount++;
+				}
+				if (collapseCount == 0) {
+					break;
+				}
+				ApplyRemap();
+				if (indices.size() / 3 == triangleCount) {
+					break;
+				}
+			}
+			return std::sqrt(resultErrorSq);
+		}
+
+		const std::vector<uint32_t>& GetIndices() const {
+			return indices;
+		}
+		float GetScale() const {
+			return scale;
+		}
+
+	private:
+		// Moves the positions into the unit cube, keeps the quadrics well conditioned for floats.
+		void NormalizePositions(const float* srcPositions) {
+			float min[3]{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+			float max[3]{std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+			for (size_t idx = 0; idx < indices.size(); idx++) {
+				const float* p = srcPositions + static_cast<size_t>(indices[idx]) * 3;
+				for (uint32_t axis = 0; axis < 3; axis++) {
+					min[axis] = std::min(min[axis], p[axis]);
+					max[axis] = std::max(max[axis], p[axis]);
+				}
+			}
+			float extent = std::max(max[0] - min[0], std::max(max[1] - min[1], max[2] - min[2]));
+			scale = extent > 0.0f ? extent : 1.0f;
+			for (uint32_t vert = 0; vert < vertexCount; vert++) {
+				for (uint32_t axis = 0; axis < 3; axis++) {
+					positions[vert * 3 + axis] = (srcPositions[vert * 3 + axis] - min[axis]) / scale;
+				}
+			}
+		}
+
+		void ClassifyVertices(const float* srcPositions) {
+			// Vertices that share a position with another one are split by an attribute seam.
+			// Collapsing them one by one would tear the seam apart.
+			std::vector<uint32_t> positionRemap;
+			std::vector<VertexWeldStream> weldStreams{VertexWeldStream{VertexAttribStream{srcPositions, 3}, 0.0f}};
+			uint32_t uniquePositionCount = GenerateVertexWeldRemap(positionRemap, weldStreams, vertexCount);
+			std::vector<uint32_t> positionUseCount(uniquePositionCount, 0);
+			std::vector<uint8_t> referenced(vertexCount, 0);
+			for (uint32_t index : indices) {
+				if (!referenced[index]) {
+					referenced[index] = 1;
+					positionUseCount[positionRemap[index]]++;
+				}
+			}
+			for (uint32_t vert = 0; vert < vertexCount; vert++) {
+				if (referenced[vert] && positionUseCount[positionRemap[vert]] > 1) {
+					kinds[vert] = VertexKind::LOCKED;
+				}
+			}
+
+			std::vector<uint64_t> edges;
+			CollectEdges(edges);
+			for (size_t first = 0; first < edges.size();) {
+				size_t last = first;
+				while (last < edges.size() && edges[last] == edges[first]) {
+					last++;
+				}
+				uint32_t v0 = static_cast<uint32_t>(edges[first] >> 32);
+				uint32_t v1 = static_cast<uint32_t>(edges[first]);
+				if (last - first == 1) {
+					for (uint32_t vert : {v0, v1}) {
+						if (kinds[vert] == VertexKind::MANIFOLD) {
+							kinds[vert] = VertexKind::BORDER;
+						}
+					}
+				} else if (last - first > 2) {
+					kinds[v0] = VertexKind::LOCKED;
+					kinds[v1] = VertexKind::LOCKED;
+				}
+				first = last;
+			}
+		}
+
+		void BuildQuadrics() {
+			std::vector<uint64_t> edges;
+			CollectEdges(edges);
+			for (size_t tri = 0; tri < indices.size() / 3; tri++) {
+				const uint32_t* triangle = indices.data() + tri * 3;
+				float n[3];
+				TriangleNormal(n, P(triangle[0]), P(triangle[1]), P(triangle[2]));
+				float length = std::sqrt(Dot(n, n));
+				if (length == 0.0f) {
+					continue;
+				}
+				n[0] /= length;
+				n[1] /= length;
+				n[2] /= length;
+				// Weighted by the area, big triangles matter more.
+				Quadric q = QuadricFromPlane(n, -Dot(n, P(triangle[0])), length * 0.5f);
+				for (uint32_t corner = 0; corner < 3; corner++) {
+					QuadricAdd(quadrics[triangle[corner]], q);
+				}
+
+				// A plane through every border edge, perpendicular to the triangle, keeps the border in place.
+				for (uint32_t corner = 0; corner < 3; corner++) {
+					uint32_t v0 = triangle[corner];
+					uint32_t v1 = triangle[(corner + 1) % 3];
+					uint64_t key = EdgeKey(v0, v1);
+					auto range = std::equal_range(edges.begin(), edges.end(), key);
+					if (range.second - range.first != 1) {
+						continue;
+					}
+					float edge[3]{P(v1)[0] - P(v0)[0], P(v1)[1] - P(v0)[1], P(v1)[2] - P(v0)[2]};
+					float edgeLengthSq = Dot(edge, edge);
+					float m[3];
+					Cross(m, edge, n);
+					float mLength = std::sqrt(Dot(m, m));
+					if (mLength == 0.0f) {
+						continue;
+					}
+					m[0] /= mLength;
+					m[1] /= mLength;
+					m[2] /= mLength;
+					Quadric border = QuadricFromPlane(m, -Dot(m, P(v0)), edgeLengthSq * borderWeight);
+					QuadricAdd(quadrics[v0], border);
+					QuadricAdd(quadrics[v1], border);
+				}
+			}
+		}
+
+		// Sorted undirected edges, an edge shared by 2 triangles is in there twice.
+		void CollectEdges(std::vector<uint64_t>& edges) const {
+			edges.clear();
+			edges.reserve(indices.size());
+			for (size_t idx = 0; idx < indices.size(); idx += 3) {
+				for (uint32_t corner = 0; corner < 3; corner++) {
+					edges.push_back(EdgeKey(indices[idx + corner], indices[idx + (corner + 1) % 3]));
+				}
+			}
+			std::sort(edges.begin(), edges.end());
+		}
+
+		bool CanCollapse(uint32_t src, uint32_t dst, bool borderEdge) const {
+			switch (kinds[src]) {
+				case VertexKind::MANIFOLD:
+					return !borderEdge;
+				case VertexKind::BORDER:
+					return borderEdge && kinds[dst] != VertexKind::MANIFOLD;
+				default:
+					return false;
+			}
+		}
+
+		float CollapseError(uint32_t src, uint32_t dst) const {
+			Quadric q = quadrics[src];
+			QuadricAdd(q, quadrics[dst]);
+			return q.w > 0.0f ? QuadricError(q, P(dst)) / q.w : 0.0f;
+		}
+
+		// The cheapest allowed direction of every edge, sorted by the error.
+		void RankCollapses(std::vector<Collapse>& collapses) const {
+			std::vector<uint64_t> edges;
+			CollectEdges(edges);
+			for (size_t first = 0; first < edges.size();) {
+				size_t last = first;
+				while (last < edges.size() && edges[last] == edges[first]) {
+					last++;
+				}
+				size_t edgeUseCount = last - first;
+				first = last;
+				uint32_t v0 = static_cast<uint32_t>(edges[last - 1] >> 32);
+				uint32_t v1 = static_cast<uint32_t>(edges[last - 1]);
+				if (v0 == v1 || edgeUseCount > 2) {
+					continue;
+				}
+				bool borderEdge = edgeUseCount == 1;
+				Collapse collapse{};
+				collapse.error = std::numeric_limits<float>::max();
+				collapse.removedTriangles = borderEdge ? 1 : 2;
+				if (CanCollapse(v0, v1, borderEdge)) {
+					collapse.src = v0;
+					collapse.dst = v1;
+					collapse.error = CollapseError(v0, v1);
+				}
+				if (CanCollapse(v1, v0, borderEdge)) {
+					float error = CollapseError(v1, v0);
+					if (error < collapse.error) {
+						collapse.src = v1;
+						collapse.dst = v0;
+						collapse.error = error;
+					}
+				}
+				if (collapse.error != std::numeric_limits<float>::max()) {
+					collapses.push_back(collapse);
+				}
+			}
+			std::stable_sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+				return a.error < b.error;
+			});
+		}
+
+		// Moving 'src' to 'dst' must not turn any of the remaining triangles of 'src' around (or into slivers).
+		bool HasTriangleFlips(uint32_t src, uint32_t dst) const {
+			const uint32_t* vertexTriangles = adjacency.triangles.data() + adjacency.offsets[src];
+			for (uint32_t adjIdx = 0; adjIdx < adjacency.counts[src]; adjIdx++) {
+				const uint32_t* triangle = indices.data() + static_cast<size_t>(vertexTriangles[adjIdx]) * 3;
+				uint32_t v[3]{remap[triangle[0]], remap[triangle[1]], remap[triangle[2]]};
+				if (v[0] == dst || v[1] == dst || v[2] == dst) {
+					// Collapses into a degenerate triangle, which is removed.
+					continue;
+				}
+				float before[3];
+				TriangleNormal(before, P(v[0]), P(v[1]), P(v[2]));
+				for (uint32_t& vert : v) {
+					vert = vert == src ? dst : vert;
+				}
+				float after[3];
+				TriangleNormal(after, P(v[0]), P(v[1]), P(v[2]));
+				float dot = Dot(before, after);
+				if (dot <= 0.25f * std::sqrt(Dot(before, before) * Dot(after, after))) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void ApplyRemap() {
+			size_t writeIdx{0};
+			for (size_t idx = 0; idx < indices.size(); idx += 3) {
+				uint32_t v0 = remap[indices[idx + 0]];
+				uint32_t v1 = remap[indices[idx + 1]];
+				uint32_t v2 = remap[indices[idx + 2]];
+				if (v0 == v1 || v1 == v2 || v2 == v0) {
+					continue;
+				}
+				indices[writeIdx++] = v0;
+				indices[writeIdx++] = v1;
+				indices[writeIdx++] = v2;
+			}
+			indices.resize(writeIdx);
+		}
+
+		const float* P(uint32_t vert) const {
+			return positions.data() + static_cast<size_t>(vert) * 3;
+		}
+
+		std::vector<uint32_t> indices;
+		uint32_t vertexCount{0};
+		std::vector<float> positions;
+		float scale{1.0f};
+
+		std::vector<Quadric> quadrics;
+		std::vector<VertexKind> kinds;
+
+		VertexTriangleAdjacency adjacency{};
+		std::vector<uint32_t> remap;
+		std::vector<uint8_t> collapseLocked;
+	};
+
+	size_t SimplifyMesh(uint32_t* dst, const uint32_t* indices, size_t indexCount,
+	                    const float* positions, uint32_t vertexCount,
+	                    size_t targetIndexCount, float maxError, float* resultError) {
+		if (resultError) {
+			*resultError = 0.0f;
+		}
+		if (indexCount < 3) {
+			return 0;
+		}
+		MeshSimplifier simplifier{indices, indexCount, positions, vertexCount};
+		float error = simplifier.Simplify(targetIndexCount, maxError / simplifier.GetScale());
+		if (resultError) {
+			*resultError = error * simplifier.GetScale();
+		}
+		const std::vector<uint32_t>& simplified = simplifier.GetIndices();
+		std::copy(simplified.begin(), simplified.end(), dst);
+		return simplified.size();
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,288 @@
+#include "Framework/Asset/MeshTangentSpace.h"
+
+#include "Core/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ember {
+
+	// Big enough for the thread start up cost not to matter.
+	static constexpr size_t tangentSpaceChunkSize{16384};
+	// The incremental updates recompute every triangle of a vertex on the fly, a vertex is more work there.
+	static constexpr size_t tangentSpaceUpdateChunkSize{2048};
+
+	static float Dot(const float* a, const float* b) {
+		return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	}
+	static float Normalize(float* v) {
+		float length = std::sqrt(Dot(v, v));
+		if (length > 0.0f) {
+			v[0] /= length;
+			v[1] /= length;
+			v[2] /= length;
+		}
+		return length;
+	}
+	// Removes the part of 'v' along the unit vector 'n'.
+	static void ProjectOntoPlane(float* v, const float* n) {
+		float d = Dot(v, n);
+		v[0] -= n[0] * d;
+		v[1] -= n[1] * d;
+		v[2] -= n[2] * d;
+	}
+	static float GetAngle(const float* unitA, const float* unitB) {
+		return std::acos(std::clamp(Dot(unitA, unitB), -1.0f, 1.0f));
+	}
+
+	static const float* GetPosition(const float* positions, uint32_t vertex) {
+		return positions + static_cast<size_t>(vertex) * 3;
+	}
+	static uint32_t GetCorner(const uint32_t* triangle, uint32_t vertex) {
+		return triangle[0] == vertex ? 0 : (triangle[1] == vertex ? 1 : 2);
+	}
+
+	// The unit normal of a triangle and its weight at every corner, the weights are zero for a degenerate triangle.
+	struct TriangleNormal {
+		float normal[3]{};
+		float cornerWeights[3]{};
+	};
+
+	static TriangleNormal ComputeTriangleNormal(const uint32_t* triangle, const float* positions, NormalWeighting weighting) {
+		TriangleNormal result{};
+		const float* p[3]{
+			GetPosition(positions, triangle[0]), GetPosition(positions, triangle[1]), GetPosition(positions, triangle[2])
+		};
+		float e1[3]{p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2]};
+		float e2[3]{p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2]};
+		result.normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		result.normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		result.normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+		float area = Normalize(result.normal) * 0.5f;
+		if (!(area > 0.0f) || !std::isfinite(area)) {
+			return TriangleNormal{};
+		}
+		for (uint32_t corner = 0; corner < 3; corner++) {
+			float weight{area};
+			if (weighting != NormalWeighting::AREA) {
+				const float* origin = p[corner];
+				const float* next = p[(corner + 1) % 3];
+				const float* prev = p[(corner + 2) % 3];
+				float toNext[3]{next[0] - origin[0], next[1] - origin[1], next[2] - origin[2]};
+				float toPrev[3]{prev[0] - origin[0], prev[1] - origin[1], prev[2] - origin[2]};
+				Normalize(toNext);
+				Normalize(toPrev);
+				float angle = GetAngle(toNext, toPrev);
+				weight = weighting == NormalWeighting::ANGLE ? angle : angle * area;
+			}
+			result.cornerWeights[corner] = weight;
+		}
+		return result;
+	}
+
+	// The triangles of the vertex are summed in the adjacency order, whatever 'getTriangleNormal' does.
+	// A triangle that uses the vertex twice is degenerate, so its zero weight can be added twice.
+	template <typename GetTriangleNormal>
+	static void GatherVertexNormal(float* normal, uint32_t vertex, const uint32_t* indices,
+	                               const VertexTriangleAdjacency& adjacency, GetTriangleNormal&& getTriangleNormal) {
+		float sum[3]{};
+		for (uint32_t adjIdx = adjacency.offsets[vertex]; adjIdx < adjacency.offsets[vertex + 1]; adjIdx++) {
+			uint32_t tri = adjacency.triangles[adjIdx];
+			TriangleNormal triangleNormal = getTriangleNormal(tri);
+			float weight = triangleNormal.cornerWeights[GetCorner(indices + static_cast<size_t>(tri) * 3, vertex)];
+			sum[0] += triangleNormal.normal[0] * weight;
+			sum[1] += triangleNormal.normal[1] * weight;
+			sum[2] += triangleNormal.normal[2] * weight;
+		}
+		Normalize(sum);
+		std::copy_n(sum, 3, normal);
+	}
+
+	void GenerateVertexNormals(float* normals, const uint32_t* indices, size_t indexCount,
+	                           const float* positions, uint32_t vertexCount,
+	                           const VertexTriangleAdjacency& adjacency, NormalWeighting weighting) {
+		size_t triangleCount = indexCount / 3;
+		std::vector<TriangleNormal> triangleNormals(triangleCount);
+		ParallelFor(triangleCount, tangentSpaceChunkSize,
+		            [&triangleNormals, indices, positions, weighting](size_t, size_t begin, size_t end) {
+			for (size_t tri = begin; tri < end; tri++) {
+				triangleNormals[tri] = ComputeTriangleNormal(indices + tri * 3, positions, weighting);
+			}
+		});
+		ParallelFor(vertexCount, tangentSpaceChunkSize,
+		            [normals, indices, &adjacency, &triangleNormals](size_t, size_t begin, size_t end) {
+			for (size_t vert = begin; vert < end; vert++) {
+				GatherVertexNormal(normals + vert * 3, static_cast<uint32_t>(vert), indices, adjacency,
+				                   [&triangleNormals](uint32_t tri) { return triangleNormals[tri]; });
+			}
+		});
+	}
+
+	// The direction of the growing 's' texture coordinate on a triangle, zero if it has no area in the UV space.
+	// Same as MikkTSpace's 'vOs', flipped for the triangles with mirrored UVs. The 4th component is the orientation
+	// of the UVs, 1 if they keep the winding of the triangle, -1 if they're mirrored (0 if the tangent is zero).
+	static void ComputeTriangleTangent(float* tangent, const uint32_t* triangle, const float* positions, const float* uvs) {
+		std::fill_n(tangent, 4, 0.0f);
+		const float* p0 = GetPosition(positions, triangle[0]);
+		const float* p1 = GetPosition(positions, triangle[1]);
+		const float* p2 = GetPosition(positions, triangle[2]);
+		const float* uv0 = uvs + static_cast<size_t>(triangle[0]) * 2;
+		const float* uv1 = uvs + static_cast<size_t>(triangle[1]) * 2;
+		const float* uv2 = uvs + static_cast<size_t>(triangle[2]) * 2;
+		float t21x = uv1[0] - uv0[0];
+		float t21y = uv1[1] - uv0[1];
+		float t31x = uv2[0] - uv0[0];
+		float t31y = uv2[1] - uv0[1];
+		float signedAreaUv = t21x * t31y - t21y * t31x;
+		if (signedAreaUv == 0.0f || !std::isfinite(signedAreaUv)) {
+			return;
+		}
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			tangent[axis] = t31y * (p1[axis] - p0[axis]) - t21y * (p2[axis] - p0[axis]);
+		}
+		float length = Normalize(tangent);
+		if (!(length > 0.0f) || !std::isfinite(length)) {
+			std::fill_n(tangent, 3, 0.0f);
+			return;
+		}
+		if (signedAreaUv < 0.0f) {
+			tangent[0] = -tangent[0];
+			tangent[1] = -tangent[1];
+			tangent[2] = -tangent[2];
+		}
+		tangent[3] = signedAreaUv < 0.0f ? -1.0f : 1.0f;
+	}
+
+	static void GetOrthogonalVector(float* v, const float* n) {
+		// The axis that's the furthest from 'n' is projected, it can't end up being zero.
+		float axis[3]{0.0f, 0.0f, 0.0f};
+		axis[std::abs(n[0]) < 0.5f ? 0 : (std::abs(n[1]) < 0.5f ? 1 : 2)] = 1.0f;
+		std::copy_n(axis, 3, v);
+		ProjectOntoPlane(v, n);
+		if (Normalize(v) == 0.0f) {
+			std::copy_n(axis, 3, v);
+		}
+	}
+
+	template <typename GetTriangleTangent>
+	static void GatherVertexTangent(float* tangent, uint32_t vertex, const uint32_t* indices, const float* positions,
+	                                const float* normals, const VertexTriangleAdjacency& adjacency,
+	                                GetTriangleTangent&& getTriangleTangent) {
+		const float* n = normals + static_cast<size_t>(vertex) * 3;
+		const float* origin = GetPosition(positions, vertex);
+		// MikkTSpace splits a vertex whose triangles have mirrored UVs into one vertex per orientation.
+		// The vertex can't be split here, it keeps the orientation with the bigger weight and only its triangles.
+		// Indexed by the orientation, [0] is 1 (the UVs keep the winding), [1] is -1 (mirrored).
+		float sums[2][3]{};
+		float weights[2]{};
+		for (uint32_t adjIdx = adjacency.offsets[vertex]; adjIdx < adjacency.offsets[vertex + 1]; adjIdx++) {
+			uint32_t tri = adjacency.triangles[adjIdx];
+			const uint32_t* triangle = indices + static_cast<size_t>(tri) * 3;
+			float triangleTangent[4];
+			getTriangleTangent(triangleTangent, tri);
+			ProjectOntoPlane(triangleTangent, n);
+			if (Normalize(triangleTangent) == 0.0f) {
+				continue;
+			}
+			// The angle at the corner, between the edges projected onto the plane of the vertex normal.
+			uint32_t corner = GetCorner(triangle, vertex);
+			const float* next = GetPosition(positions, triangle[(corner + 1) % 3]);
+			const float* prev = GetPosition(positions, triangle[(corner + 2) % 3]);
+			float toNext[3]{next[0] - origin[0], next[1] - origin[1], next[2] - origin[2]};
+			float toPrev[3]{prev[0] - origin[0], prev[1] - origin[1], prev[2] - origin[2]};
+			ProjectOntoPlane(toNext, n);
+			ProjectOntoPlane(toPrev, n);
+			if (Normalize(toNext) == 0.0f || Normalize(toPrev) == 0.0f) {
+				continue;
+			}
+			float angle = GetAngle(toNext, toPrev);
+			uint32_t orientation = triangleTangent[3] < 0.0f ? 1 : 0;
+			float* sum = sums[orientation];
+			sum[0] += triangleTangent[0] * angle;
+			sum[1] += triangleTangent[1] * angle;
+			sum[2] += triangleTangent[2] * angle;
+			weights[orientation] += angle;
+		}
+		uint32_t orientation = weights[1] > weights[0] ? 1 : 0;
+		float* sum = sums[orientation];
+		if (Normalize(sum) == 0.0f) {
+			GetOrthogonalVector(sum, n);
+		}
+		std::copy_n(sum, 3, tangent);
+		tangent[3] = orientation == 1 ? -1.0f : 1.0f;
+	}
+
+	void GenerateVertexTangents(float* tangents, const uint32_t* indices, size_t indexCount,
+	                            const float* positions, const float* normals, const float* uvs, uint32_t vertexCount,
+	                            const VertexTriangleAdjacency& adjacency) {
+		size_t triangleCount = indexCount / 3;
+		std::vector<float> triangleTangents(triangleCount * 4);
+		ParallelFor(triangleCount, tangentSpaceChunkSize,
+		            [&triangleTangents, indices, positions, uvs](size_t, size_t begin, size_t end) {
+			for (size_t tri = begin; tri < end; tri++) {
+				ComputeTriangleTangent(triangleTangents.data() + tri * 4, indices + tri * 3, positions, uvs);
+			}
+		});
+		ParallelFor(vertexCount, tangentSpaceChunkSize,
+		            [tangents, indices, positions, normals, &adjacency, &triangleTangents](size_t, size_t begin, size_t end) {
+			for (size_t vert = begin; vert < end; vert++) {
+				GatherVertexTangent(tangents + vert * 4, static_cast<uint32_t>(vert), indices, positions, normals, adjacency,
+				                    [&triangleTangents](float* tangent, uint32_t tri) {
+					std::copy_n(triangleTangents.data() + static_cast<size_t>(tri) * 4, 4, tangent);
+				});
+			}
+		});
+	}
+
+	void GatherTangentSpaceVertices(std::vector<uint32_t>& vertices, const uint32_t* indices,
+	                                const VertexTriangleAdjacency& adjacency,
+	                                const uint32_t* dirtyVertices, size_t dirtyVertexCount) {
+		vertices.clear();
+		uint32_t vertexCount = static_cast<uint32_t>(adjacency.counts.size());
+		for (size_t dirtyIdx = 0; dirtyIdx < dirtyVertexCount; dirtyIdx++) {
+			uint32_t vertex = dirtyVertices[dirtyIdx];
+			if (vertex >= vertexCount) {
+				continue;
+			}
+			// An unreferenced vertex still gets its (zero) normal.
+			vertices.push_back(vertex);
+			for (uint32_t adjIdx = adjacency.offsets[vertex]; adjIdx < adjacency.offsets[vertex + 1]; adjIdx++) {
+				const uint32_t* triangle = indices + static_cast<size_t>(adjacency.triangles[adjIdx]) * 3;
+				vertices.insert(vertices.end(), triangle, triangle + 3);
+			}
+		}
+		std::sort(vertices.begin(), vertices.end());
+		vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+	}
+
+	void UpdateVertexNormals(float* normals, const uint32_t* indices, const float* positions,
+	                         const VertexTriangleAdjacency& adjacency, NormalWeighting weighting,
+	                         const uint32_t* vertices, size_t count) {
+		ParallelFor(count, tangentSpaceUpdateChunkSize,
+		            [normals, indices, positions, &adjacency, weighting, vertices](size_t, size_t begin, size_t end) {
+			for (size_t vertIdx = begin; vertIdx < end; vertIdx++) {
+				uint32_t vertex = vertices[vertIdx];
+				GatherVertexNormal(normals + static_cast<size_t>(vertex) * 3, vertex, indices, adjacency,
+				                   [indices, positions, weighting](uint32_t tri) {
+					return ComputeTriangleNormal(indices + static_cast<size_t>(tri) * 3, positions, weighting);
+				});
+			}
+		});
+	}
+
+	void UpdateVertexTangents(float* tangents, const uint32_t* indices,
+	                          const float* positions, const float* normals, const float* uvs,
+	                          const VertexTriangleAdjacency& adjacency, const uint32_t* vertices, size_t count) {
+		ParallelFor(count, tangentSpaceUpdateChunkSize,
+		            [tangents, indices, positions, normals, uvs, &adjacency, vertices](size_t, size_t begin, size_t end) {
+			for (size_t vertIdx = begin; vertIdx < end; vertIdx++) {
+				uint32_t vertex = vertices[vertIdx];
+				GatherVertexTangent(tangents + static_cast<size_t>(vertex) * 4, vertex, indices, positions, normals, adjacency,
+				                    [indices, positions, uvs](float* tangent, uint32_t tri) {
+					ComputeTriangleTangent(tangent, indices + static_cast<size_t>(tri) * 3, positions, uvs);
+				});
+			}
+		});
+	}
+
+}
\ No newline at end of file
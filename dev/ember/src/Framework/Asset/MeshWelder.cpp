@@ -0,0 +1,169 @@
+#include "Framework/Asset/MeshWelder.h"
+
+#include "Core/Parallel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace ember {
+
+	// Big enough for the thread start up cost not to matter.
+	static constexpr size_t weldChunkSize{16384};
+	static constexpr uint32_t emptySlot{0};
+
+	static uint64_t GetComponentKey(float value, float epsilon) {
+		if (epsilon > 0.0f && std::isfinite(value)) {
+			double cell = std::floor(static_cast<double>(value) / static_cast<double>(epsilon));
+			cell = std::clamp(cell, -9.0e18, 9.0e18);
+			return static_cast<uint64_t>(static_cast<int64_t>(cell));
+		}
+		if (value == 0.0f) {
+			// +0.0f and -0.0f are the same vertex
+			return 0;
+		}
+		uint32_t bits{0};
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	static uint64_t HashCombine(uint64_t hash, uint64_t key) {
+		return hash ^ (key + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2));
+	}
+	// MurmurHash3 finalizer, spreads the bits so that both the shard (top bits)
+	// and the slot in the shard's table (bottom bits) can be taken from the same hash.
+	static uint64_t HashFinalize(uint64_t hash) {
+		hash ^= hash >> 33;
+		hash *= 0xFF51AFD7ED558CCDull;
+		hash ^= hash >> 33;
+		hash *= 0xC4CEB9FE1A85EC53ull;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	static uint64_t HashVertex(const std::vector<VertexWeldStream>& weldStreams, uint32_t vertex) {
+		uint64_t hash{0};
+		for (const VertexWeldStream& weldStream : weldStreams) {
+			const float* components = weldStream.stream.data + static_cast<size_t>(vertex) * weldStream.stream.components;
+			for (uint32_t componentIdx = 0; componentIdx < weldStream.stream.components; componentIdx++) {
+				hash = HashCombine(hash, GetComponentKey(components[componentIdx], weldStream.epsilon));
+			}
+		}
+		return HashFinalize(hash);
+	}
+
+	static bool VerticesEqual(const std::vector<VertexWeldStream>& weldStreams, uint32_t a, uint32_t b) {
+		for (const VertexWeldStream& weldStream : weldStreams) {
+			uint32_t components = weldStream.stream.components;
+			const float* componentsA = weldStream.stream.data + static_cast<size_t>(a) * components;
+			const float* componentsB = weldStream.stream.data + static_cast<size_t>(b) * components;
+			for (uint32_t componentIdx = 0; componentIdx < components; componentIdx++) {
+				if (GetComponentKey(componentsA[componentIdx], weldStream.epsilon) !=
+				    GetComponentKey(componentsB[componentIdx], weldStream.epsilon)) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	static uint32_t GetShardBitCount() {
+		// A few shards per worker, so that an unlucky big shard doesn't keep everybody else waiting.
+		uint32_t shardBits{0};
+		while ((1u << shardBits) < GetParallelWorkerCount() * 4) {
+			shardBits++;
+		}
+		return shardBits;
+	}
+
+	uint32_t GenerateVertexWeldRemap(std::vector<uint32_t>& remap,
+	                                 const std::vector<VertexWeldStream>& weldStreams, uint32_t vertexCount) {
+		remap.resize(vertexCount);
+		if (vertexCount == 0) {
+			return 0;
+		}
+		const uint32_t shardBits = GetShardBitCount();
+		const size_t shardCount = size_t{1} << shardBits;
+		auto getShard = [shardBits](uint64_t hash) -> size_t {
+			return shardBits == 0 ? 0 : static_cast<size_t>(hash >> (64 - shardBits));
+		};
+
+		// 1. Hash every vertex and count how many of them go to each shard (per chunk).
+		std::vector<uint64_t> hashes(vertexCount);
+		const size_t chunkCount = GetParallelChunkCount(vertexCount, weldChunkSize);
+		std::vector<uint32_t> chunkShardOffsets(chunkCount * shardCount, 0);
+		ParallelFor(vertexCount, weldChunkSize, [&](size_t chunkIdx, size_t begin, size_t end) {
+			uint32_t* shardCounts = chunkShardOffsets.data() + chunkIdx * shardCount;
+			for (size_t vert = begin; vert < end; vert++) {
+				hashes[vert] = HashVertex(weldStreams, static_cast<uint32_t>(vert));
+				shardCounts[getShard(hashes[vert])]++;
+			}
+		});
+
+		// 2. Counting sort of the vertices by shard. Chunks are visited in order inside every shard,
+		//    so the vertices of a shard stay sorted by their index.
+		std::vector<uint32_t> shardOffsets(shardCount + 1, 0);
+		uint32_t offset{0};
+		for (size_t shard = 0; shard < shardCount; shard++) {
+			shardOffsets[shard] = offset;
+			for (size_t chunkIdx = 0; chunkIdx < chunkCount; chunkIdx++) {
+				uint32_t count = chunkShardOffsets[chunkIdx * shardCount + shard];
+				chunkShardOffsets[chunkIdx * shardCount + shard] = offset;
+				offset += count;
+			}
+		}
+		shardOffsets[shardCount] = offset;
+		std::vector<uint32_t> shardVertices(vertexCount);
+		ParallelFor(vertexCount, weldChunkSize, [&](size_t chunkIdx, size_t begin, size_t end) {
+			uint32_t* shardWriteOffsets = chunkShardOffsets.data() + chunkIdx * shardCount;
+			for (size_t vert = begin; vert < end; vert++) {
+				shardVertices[shardWriteOffsets[getShard(hashes[vert])]++] = static_cast<uint32_t>(vert);
+			}
+		});
+
+		// 3. Deduplicate every shard with its own open addressing table. 'remap' temporarily
+		//    holds the first occurrence of every vertex (which is always the vertex with the smallest index).
+		ParallelFor(shardCount, 1, [&](size_t, size_t shardBegin, size_t shardEnd) {
+			std::vector<uint32_t> table;
+			for (size_t shard = shardBegin; shard < shardEnd; shard++) {
+				uint32_t shardSize = shardOffsets[shard + 1] - shardOffsets[shard];
+				size_t capacity{16};
+				while (capacity < static_cast<size_t>(shardSize) * 2) {
+					capacity *= 2;
+				}
+				const size_t mask = capacity - 1;
+				// Slots store 'vertex + 1', so that 0 can mark an empty one.
+				table.assign(capacity, emptySlot);
+				for (uint32_t idx = shardOffsets[shard]; idx < shardOffsets[shard + 1]; idx++) {
+					uint32_t vert = shardVertices[idx];
+					uint64_t hash = hashes[vert];
+					size_t slot = static_cast<size_t>(hash) & mask;
+					while (true) {
+						if (table[slot] == emptySlot) {
+							table[slot] = vert + 1;
+							remap[vert] = vert;
+							break;
+						}
+						uint32_t other = table[slot] - 1;
+						if (hashes[other] == hash && VerticesEqual(weldStreams, other, vert)) {
+							remap[vert] = other;
+							break;
+						}
+						slot = (slot + 1) & mask;
+					}
+				}
+			}
+		});
+
+		// 4. Number the unique vertices in the order of their first occurrence.
+		//    The first occurrence always comes before the duplicates, so it's already numbered when we get to them.
+		uint32_t uniqueVertexCount{0};
+		for (uint32_t vert = 0; vert < vertexCount; vert++) {
+			uint32_t firstOccurrence = remap[vert];
+			remap[vert] = firstOccurrence == vert ? uniqueVertexCount++ : remap[firstOccurrence];
+		}
+		return uniqueVertexCount;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,291 @@
+#include "Framework/Asset/MeshletBuilder.h"
+
+#include "Core/Parallel.h"
+#include "Framework/Asset/MeshOptimizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace ember {
+
+	static constexpr uint32_t invalidTriangle{std::numeric_limits<uint32_t>::max()};
+	static constexpr uint32_t noMeshlet{std::numeric_limits<uint32_t>::max()};
+
+	static float Dot(const float* a, const float* b) {
+		return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	}
+	static float Normalize(float* v) {
+		float length = std::sqrt(Dot(v, v));
+		if (length > 0.0f) {
+			v[0] /= length;
+			v[1] /= length;
+			v[2] /= length;
+		}
+		return length;
+	}
+
+	// Returns 'false' for degenerate (zero area) triangles, 'normal' is zero in that case.
+	static bool ComputeTriangleNormal(float normal[3], const uint32_t* triangle, const float* positions) {
+		const float* p0 = positions + static_cast<size_t>(triangle[0]) * 3;
+		const float* p1 = positions + static_cast<size_t>(triangle[1]) * 3;
+		const float* p2 = positions + static_cast<size_t>(triangle[2]) * 3;
+		float e1[3]{p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+		float e2[3]{p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+		normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+		return Normalize(normal) > 0.0f;
+	}
+
+	// Grows one cluster at a time. Emitted triangles are removed from the adjacency lists ('counts' is the
+	// number of the remaining ones), so the candidate search only ever looks at unclustered triangles.
+	class MeshletBuilder {
+	public:
+		MeshletBuilder(const uint32_t* indices, size_t triangleCount, const float* positions, uint32_t vertexCount,
+		               const MeshletSettings& settings)
+			: indices(indices), triangleCount(triangleCount), settings(settings),
+			  triangleNormals(triangleCount * 3), emitted(triangleCount, 0), vertexMeshlet(vertexCount, noMeshlet) {
+			BuildVertexTriangleAdjacency(adjacency, indices, triangleCount * 3, vertexCount);
+			for (size_t tri = 0; tri < triangleCount; tri++) {
+				ComputeTriangleNormal(triangleNormals.data() + tri * 3, indices + tri * 3, positions);
+			}
+			reordered.reserve(triangleCount * 3);
+			meshletVertices.reserve(settings.maxVertices);
+		}
+
+		void Build(std::vector<Meshlet>& meshlets) {
+			// Every triangle before the cursor is already in a cluster.
+			size_t seedCursor{0};
+			size_t emittedCount{0};
+			while (emittedCount < triangleCount) {
+				meshletIdx = static_cast<uint32_t>(meshlets.size());
+				meshletVertices.clear();
+				std::fill(std::begin(normalSum), std::end(normalSum), 0.0f);
+
+				Meshlet meshlet{};
+				meshlet.indexOffset = static_cast<uint32_t>(reordered.size());
+				while (emitted[seedCursor]) {
+					seedCursor++;
+				}
+				AddTriangle(static_cast<uint32_t>(seedCursor));
+				meshlet.triangleCount++;
+				emittedCount++;
+				while (meshlet.triangleCount < settings.maxTriangles) {
+					uint32_t next = FindNextTriangle();
+					if (next == invalidTriangle) {
+						// Nothing adjacent fits, continue with the next one in the index order if it does.
+						// Keeps triangle soups (no shared vertices) from ending up as one triangle clusters.
+						while (seedCursor < triangleCount && emitted[seedCursor]) {
+							seedCursor++;
+						}
+						if (seedCursor == triangleCount || !Fits(static_cast<uint32_t>(seedCursor))) {
+							break;
+						}
+						next = static_cast<uint32_t>(seedCursor);
+					}
+					AddTriangle(next);
+					meshlet.triangleCount++;
+					emittedCount++;
+				}
+				meshlet.vertexCount = static_cast<uint32_t>(meshletVertices.size());
+				meshlets.push_back(meshlet);
+			}
+		}
+
+		const std::vector<uint32_t>& GetReorderedIndices() const {
+			return reordered;
+		}
+
+	private:
+		uint32_t CountNewVertices(uint32_t tri) const {
+			const uint32_t* triangle = indices + static_cast<size_t>(tri) * 3;
+			return static_cast<uint32_t>(vertexMeshlet[triangle[0]] != meshletIdx) +
+			       static_cast<uint32_t>(vertexMeshlet[triangle[1]] != meshletIdx) +
+			       static_cast<uint32_t>(vertexMeshlet[triangle[2]] != meshletIdx);
+		}
+		bool Fits(uint32_t tri) const {
+			return meshletVertices.size() + CountNewVertices(tri) <= settings.maxVertices;
+		}
+
+		uint32_t FindNextTriangle() const {
+			float averageNormal[3]{normalSum[0], normalSum[1], normalSum[2]};
+			Normalize(averageNormal);
+
+			uint32_t bestTriangle{invalidTriangle};
+			float bestScore{std::numeric_limits<float>::max()};
+			for (uint32_t vert : meshletVertices) {
+				const uint32_t* vertexTriangles = adjacency.triangles.data() + adjacency.offsets[vert];
+				for (uint32_t adjIdx = 0; adjIdx < adjacency.counts[vert]; adjIdx++) {
+					uint32_t tri = vertexTriangles[adjIdx];
+					uint32_t newVertices = CountNewVertices(tri);
+					if (meshletVertices.size() + newVertices > settings.maxVertices) {
+						continue;
+					}
+					// 0 when the normals match, 2 when they're opposite.
+					float spread = 1.0f - Dot(triangleNormals.data() + static_cast<size_t>(tri) * 3, averageNormal);
+					float score = static_cast<float>(newVertices) + settings.coneWeight * spread;
+					// Ties go to the triangle that comes first in the index order, keeps the result deterministic.
+					if (score < bestScore || (score == bestScore && tri < bestTriangle)) {
+						bestScore = score;
+						bestTriangle = tri;
+					}
+				}
+			}
+			return bestTriangle;
+		}
+
+		void AddTriangle(uint32_t tri) {
+			emitted[tri] = 1;
+			const uint32_t* triangle = indices + static_cast<size_t>(tri) * 3;
+			for (uint32_t corner = 0; corner < 3; corner++) {
+				uint32_t vert = triangle[corner];
+				reordered.push_back(vert);
+				if (vertexMeshlet[vert] != meshletIdx) {
+					vertexMeshlet[vert] = meshletIdx;
+					meshletVertices.push_back(vert);
+				}
+				RemoveAdjacentTriangle(vert, tri);
+			}
+			const float* normal = triangleNormals.data() + static_cast<size_t>(tri) * 3;
+			normalSum[0] += normal[0];
+			normalSum[1] += normal[1];
+			normalSum[2] += normal[2];
+		}
+
+		void RemoveAdjacentTriangle(uint32_t vert, uint32_t tri) {
+			uint32_t* vertexTriangles = adjacency.triangles.data() + adjacency.offsets[vert];
+			uint32_t& count = adjacency.counts[vert];
+			for (uint32_t adjIdx = 0; adjIdx < count; adjIdx++) {
+				if (vertexTriangles[adjIdx] == tri) {
+					// Triangles with a repeated vertex are in the list more than once, removing one entry per corner is right.
+					vertexTriangles[adjIdx] = vertexTriangles[--count];
+					return;
+				}
+			}
+		}
+
+		const uint32_t* indices{nullptr};
+		size_t triangleCount{0};
+		MeshletSettings settings{};
+
+		VertexTriangleAdjacency adjacency{};
+		std::vector<float> triangleNormals;
+		std::vector<uint8_t> emitted;
+		// The last cluster every vertex was added to, tells whether the vertex is in the current one.
+		std::vector<uint32_t> vertexMeshlet;
+		std::vector<uint32_t> reordered;
+
+		uint32_t meshletIdx{0};
+		std::vector<uint32_t> meshletVertices;
+		float normalSum[3]{0.0f, 0.0f, 0.0f};
+	};
+
+	void BuildMeshlets(std::vector<Meshlet>& meshlets, uint32_t* indices, size_t indexCount,
+	                   const float* positions, uint32_t vertexCount, const MeshletSettings& settings) {
+		assert(settings.maxVertices >= 3 && settings.maxTriangles >= 1 && "A cluster must fit a triangle!");
+		meshlets.clear();
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0) {
+			return;
+		}
+		MeshletBuilder builder{indices, triangleCount, positions, vertexCount, settings};
+		builder.Build(meshlets);
+		const std::vector<uint32_t>& reordered = builder.GetReorderedIndices();
+		std::copy(reordered.begin(), reordered.end(), indices);
+
+		ParallelFor(meshlets.size(), 256, [&meshlets, indices, positions](size_t, size_t begin, size_t end) {
+			for (size_t meshletIdx = begin; meshletIdx < end; meshletIdx++) {
+				ComputeMeshletBounds(meshlets[meshletIdx], indices, positions);
+			}
+		});
+	}
+
+	void ComputeMeshletBounds(Meshlet& meshlet, const uint32_t* indices, const float* positions) {
+		const uint32_t* meshletIndices = indices + meshlet.indexOffset;
+		size_t meshletIndexCount = static_cast<size_t>(meshlet.triangleCount) * 3;
+		if (meshletIndexCount == 0) {
+			return;
+		}
+
+		float min[3]{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+		float max[3]{std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+		for (size_t idx = 0; idx < meshletIndexCount; idx++) {
+			const float* p = positions + static_cast<size_t>(meshletIndices[idx]) * 3;
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				min[axis] = std::min(min[axis], p[axis]);
+				max[axis] = std::max(max[axis], p[axis]);
+			}
+		}
+		meshlet.aabb.InitializeFromMinMax(numa::Vec3{min[0], min[1], min[2]}, numa::Vec3{max[0], max[1], max[2]});
+
+		// The sphere around the AABB center is not the smallest one, but it's close enough for culling.
+		float center[3]{(min[0] + max[0]) * 0.5f, (min[1] + max[1]) * 0.5f, (min[2] + max[2]) * 0.5f};
+		float radiusSq{0.0f};
+		for (size_t idx = 0; idx < meshletIndexCount; idx++) {
+			const float* p = positions + static_cast<size_t>(meshletIndices[idx]) * 3;
+			float d[3]{p[0] - center[0], p[1] - center[1], p[2] - center[2]};
+			radiusSq = std::max(radiusSq, Dot(d, d));
+		}
+		meshlet.sphereCenter = numa::Vec3{center[0], center[1], center[2]};
+		meshlet.sphereRadius = std::sqrt(radiusSq);
+
+		// The cone axis is the average normal, its half angle is the biggest angle between the axis and a normal.
+		float axis[3]{0.0f, 0.0f, 0.0f};
+		for (size_t idx = 0; idx < meshletIndexCount; idx += 3) {
+			float normal[3];
+			if (ComputeTriangleNormal(normal, meshletIndices + idx, positions)) {
+				axis[0] += normal[0];
+				axis[1] += normal[1];
+				axis[2] += normal[2];
+			}
+		}
+		meshlet.coneApex = meshlet.sphereCenter;
+		meshlet.coneAxis = numa::Vec3{0.0f};
+		meshlet.coneCutoff = 2.0f;
+		if (Normalize(axis) == 0.0f) {
+			return;
+		}
+		float minDot{1.0f};
+		for (size_t idx = 0; idx < meshletIndexCount; idx += 3) {
+			float normal[3];
+			if (ComputeTriangleNormal(normal, meshletIndices + idx, positions)) {
+				minDot = std::min(minDot, Dot(normal, axis));
+			}
+		}
+		// A cone wider than a hemisphere can't be behind anything.
+		if (minDot <= 0.0f) {
+			return;
+		}
+		// The apex is moved back along the axis until it is behind the plane of every triangle,
+		// then any camera inside the negative cone at the apex sees the back of every triangle.
+		float apexDistance{0.0f};
+		for (size_t idx = 0; idx < meshletIndexCount; idx += 3) {
+			float normal[3];
+			if (ComputeTriangleNormal(normal, meshletIndices + idx, positions)) {
+				const float* p = positions + static_cast<size_t>(meshletIndices[idx]) * 3;
+				float d[3]{center[0] - p[0], center[1] - p[1], center[2] - p[2]};
+				apexDistance = std::max(apexDistance, Dot(d, normal) / Dot(axis, normal));
+			}
+		}
+		meshlet.coneApex = numa::Vec3{center[0] - axis[0] * apexDistance,
+		                              center[1] - axis[1] * apexDistance,
+		                              center[2] - axis[2] * apexDistance};
+		meshlet.coneAxis = numa::Vec3{axis[0], axis[1], axis[2]};
+		// The view direction has to be within (90 degrees - half angle) of the axis: cos(90 - a) = sin(a).
+		meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+	}
+
+	bool IsMeshletBackfacing(const Meshlet& meshlet, const numa::Vec3& cameraPos) {
+		if (meshlet.coneCutoff > 1.0f) {
+			return false;
+		}
+		const float* apex = reinterpret_cast<const float*>(&meshlet.coneApex);
+		const float* axis = reinterpret_cast<const float*>(&meshlet.coneAxis);
+		const float* camera = reinterpret_cast<const float*>(&cameraPos);
+		float view[3]{apex[0] - camera[0], apex[1] - camera[1], apex[2] - camera[2]};
+		return Dot(view, axis) >= meshlet.coneCutoff * std::sqrt(Dot(view, view));
+	}
+
+}
\ No newline at end of file
@@ -4,44 +4,6 @@
 
 namespace ember {
 
-	uint32_t GetVertexAttribFormatSizeInBytes(VertexAttribFormat vertexAttribFormat) {
-		switch (vertexAttribFormat) {
-			case VertexAttribFormat::FLOAT32:
-			case VertexAttribFormat::UINT32:
-			case VertexAttribFormat::INT32: {
-				uint32_t expectedSize{4};
-				bool floatCheck = sizeof(float) == expectedSize;
-				bool uintCheck = sizeof(uint32_t) == expectedSize;
-				bool intCheck = sizeof(int32_t) == expectedSize;
-				assert(floatCheck && uintCheck && intCheck && "All types must be 4 bytes in size!");
-				return expectedSize;
-			}
-			break;
-			case VertexAttribFormat::UINT16:
-			case VertexAttribFormat::INT16: {
-				uint32_t expectedSize{2};
-				bool uintCheck = sizeof(uint16_t) == expectedSize;
-				bool intCheck = sizeof(int16_t) == expectedSize;
-				assert(uintCheck && intCheck && "All types must be 2 bytes in size!");
-				return expectedSize;
-			}
-			break;
-			case VertexAttribFormat::UINT8:
-			case VertexAttribFormat::INT8: {
-				uint32_t expectedSize{1};
-				bool uintCheck = sizeof(uint8_t) == expectedSize;
-				bool intCheck = sizeof(int8_t) == expectedSize;
-				assert(uintCheck && intCheck && "All types must be 1 byte in size!");
-				return expectedSize;
-			}
-			break;
-			default:
-				assert(true && "Unknown vertex attribute format provided!");
-				return 0;
-			break;
-		}
-	}
-
 	bool IsVertexAttribFormatInt(VertexAttribFormat vertexAttribFormat) {
 		if (vertexAttribFormat == VertexAttribFormat::INT32 ||
 			vertexAttribFormat == VertexAttribFormat::INT16 ||
@@ -59,14 +21,21 @@ namespace ember {
 		return false;
 	}
 	bool IsVertexAttribFormatFloat(VertexAttribFormat vertexAttribFormat) {
-		if (vertexAttribFormat == VertexAttribFormat::FLOAT32) {
+		if (vertexAttribFormat == VertexAttribFormat::FLOAT32 ||
+			vertexAttribFormat == VertexAttribFormat::FLOAT16) {
 			return true;
 		}
 		return false;
 	}
-    
-	uint32_t VertexAttribDescriptor::GetVertexAttribSize() const {
-		return dimension * GetVertexAttribFormatSizeInBytes(format);
+	bool IsVertexAttribFormatNormalized(VertexAttribFormat vertexAttribFormat) {
+		if (vertexAttribFormat == VertexAttribFormat::SNORM16 ||
+			vertexAttribFormat == VertexAttribFormat::SNORM8 ||
+			vertexAttribFormat == VertexAttribFormat::UNORM16 ||
+			vertexAttribFormat == VertexAttribFormat::UNORM8 ||
+			vertexAttribFormat == VertexAttribFormat::OCT_SNORM16) {
+			return true;
+		}
+		return false;
 	}
 
 	uint32_t CalculateVertexStride(const std::vector<VertexAttribDescriptor>& vertAttribLayout) {
@@ -77,49 +46,51 @@ namespace ember {
 		return stride;
 	}
 
-	const std::vector<VertexAttribDescriptor> VertexP::attributes {
-		{3, offsetof(VertexP,  vertexPosition),    VertexAttribChannel::POSITION, VertexAttribFormat::FLOAT32}
-	};
-	const std::vector<VertexAttribDescriptor> VertexPN::attributes {
-		{3, offsetof(VertexPN,  vertexPosition),   VertexAttribChannel::POSITION, VertexAttribFormat::FLOAT32},
-		{3, offsetof(VertexPN,  vertexNormal),     VertexAttribChannel::NORMAL,   VertexAttribFormat::FLOAT32}
-	};
-	const std::vector<VertexAttribDescriptor> VertexPC::attributes {
-		{3, offsetof(VertexPC,  vertexPosition),   VertexAttribChannel::POSITION, VertexAttribFormat::FLOAT32},
-		{3, offsetof(VertexPC,  vertexColor),      VertexAttribChannel::COLOR,    VertexAttribFormat::FLOAT32}
-	};
-	const std::vector<VertexAttribDescriptor> VertexPU::attributes {
-		{3, offsetof(VertexPU,  vertexPosition),   VertexAttribChannel::POSITION, VertexAttribFormat::FLOAT32},
-		{2, offsetof(VertexPU,  vertexUv),         VertexAttribChannel::UV0,      VertexAttribFormat::FLOAT32}
-	};
-	const std::vector<VertexAttribDescriptor> VertexPNT::attributes {
-		{3, offsetof(VertexPNT,  vertexPosition),  VertexAttribChannel::POSITION, VertexAttribFormat::FLOAT32},
-		{3, offsetof(VertexPNT,  vertexNormal),    VertexAttribChannel::NORMAL,   VertexAttribFormat::FLOAT32},
-		{3, offsetof(VertexPNT,  vertexTangent),   VertexAttribChannel::TANGENT,  VertexAttribFormat::FLOAT32}
-	};
-	const std::vector<VertexAttribDescriptor> VertexPNC::attributes {
-		{3, offsetof(VertexPNC,  vertexPosition),  VertexAttribChannel::POSITION, VertexAttribFormat::FLOAT32},
-		{3, offsetof(VertexPNC,  vertexNormal),    VertexAttribChannel::NORMAL,   VertexAttribFormat::FLOAT32},
-		{3, offsetof(VertexPNC,  vertexColor),     VertexAttribChannel::COLOR,    VertexAttribFormat::FLOAT32}
-	};
-	const std::vector<VertexAttribDescriptor> VertexPNU::attributes {
-		{3, offsetof(VertexPNU,  vertexPosition),  VertexAttribChannel::POSITION, VertexAttribFormat::FLOAT32},
-		{3, offsetof(VertexPNU,  vertexNormal),    VertexAttribChannel::NORMAL,   VertexAttribFormat::FLOAT32},
-		{2, offsetof(VertexPNU,  vertexUv),        VertexAttribChannel::UV0,      VertexAttribFormat::FLOAT32}
-	};
-	const std::vector<VertexAttribDescriptor> VertexPNTU::attributes {
-		{3, offsetof(VertexPNTU,  vertexPosition), VertexAttribChannel::POSITION, VertexAttribFormat::FLOAT32},
-		{3, offsetof(VertexPNTU,  vertexNormal),   VertexAttribChannel::NORMAL,   VertexAttribFormat::FLOAT32},
-		{3, offsetof(VertexPNTU,  vertexTangent),  VertexAttribChannel::TANGENT,  VertexAttribFormat::FLOAT32},
-		{2, offsetof(VertexPNTU,  vertexUv),       VertexAttribChannel::UV0,      VertexAttribFormat::FLOAT32}
-	};
-	const std::vector<VertexAttribDescriptor> VertexPNTCU::attributes {
-		{3, offsetof(VertexPNTCU, vertexPosition), VertexAttribChannel::POSITION, VertexAttribFormat::FLOAT32},
-		{3, offsetof(VertexPNTCU, vertexNormal),   VertexAttribChannel::NORMAL,   VertexAttribFormat::FLOAT32},
-		{3, offsetof(VertexPNTCU, vertexTangent),  VertexAttribChannel::TANGENT,  VertexAttribFormat::FLOAT32},
-		{3, offsetof(VertexPNTCU, vertexColor),    VertexAttribChannel::COLOR,    VertexAttribFormat::FLOAT32},
-		{2, offsetof(VertexPNTCU, vertexUv),       VertexAttribChannel::UV0,      VertexAttribFormat::FLOAT32}
-	};
+	// The compile-time layouts are packed, so they have to match the actual structs.
+	static_assert(sizeof(VertexP) == VertexP::stride, "'VertexP::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexP, vertexPosition) == VertexP::layout.attributes[0].offset, "'VertexP::layout' doesn't match the struct!");
+	static_assert(sizeof(VertexPN) == VertexPN::stride, "'VertexPN::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPN, vertexPosition) == VertexPN::layout.attributes[0].offset, "'VertexPN::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPN, vertexNormal) == VertexPN::layout.attributes[1].offset, "'VertexPN::layout' doesn't match the struct!");
+	static_assert(sizeof(VertexPC) == VertexPC::stride, "'VertexPC::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPC, vertexPosition) == VertexPC::layout.attributes[0].offset, "'VertexPC::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPC, vertexColor) == VertexPC::layout.attributes[1].offset, "'VertexPC::layout' doesn't match the struct!");
+	static_assert(sizeof(VertexPU) == VertexPU::stride, "'VertexPU::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPU, vertexPosition) == VertexPU::layout.attributes[0].offset, "'VertexPU::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPU, vertexUv) == VertexPU::layout.attributes[1].offset, "'VertexPU::layout' doesn't match the struct!");
+	static_assert(sizeof(VertexPNT) == VertexPNT::stride, "'VertexPNT::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNT, vertexPosition) == VertexPNT::layout.attributes[0].offset, "'VertexPNT::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNT, vertexNormal) == VertexPNT::layout.attributes[1].offset, "'VertexPNT::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNT, vertexTangent) == VertexPNT::layout.attributes[2].offset, "'VertexPNT::layout' doesn't match the struct!");
+	static_assert(sizeof(VertexPNC) == VertexPNC::stride, "'VertexPNC::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNC, vertexPosition) == VertexPNC::layout.attributes[0].offset, "'VertexPNC::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNC, vertexNormal) == VertexPNC::layout.attributes[1].offset, "'VertexPNC::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNC, vertexColor) == VertexPNC::layout.attributes[2].offset, "'VertexPNC::layout' doesn't match the struct!");
+	static_assert(sizeof(VertexPNU) == VertexPNU::stride, "'VertexPNU::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNU, vertexPosition) == VertexPNU::layout.attributes[0].offset, "'VertexPNU::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNU, vertexNormal) == VertexPNU::layout.attributes[1].offset, "'VertexPNU::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNU, vertexUv) == VertexPNU::layout.attributes[2].offset, "'VertexPNU::layout' doesn't match the struct!");
+	static_assert(sizeof(VertexPNTU) == VertexPNTU::stride, "'VertexPNTU::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNTU, vertexPosition) == VertexPNTU::layout.attributes[0].offset, "'VertexPNTU::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNTU, vertexNormal) == VertexPNTU::layout.attributes[1].offset, "'VertexPNTU::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNTU, vertexTangent) == VertexPNTU::layout.attributes[2].offset, "'VertexPNTU::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNTU, vertexUv) == VertexPNTU::layout.attributes[3].offset, "'VertexPNTU::layout' doesn't match the struct!");
+	static_assert(sizeof(VertexPNTCU) == VertexPNTCU::stride, "'VertexPNTCU::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNTCU, vertexPosition) == VertexPNTCU::layout.attributes[0].offset, "'VertexPNTCU::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNTCU, vertexNormal) == VertexPNTCU::layout.attributes[1].offset, "'VertexPNTCU::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNTCU, vertexTangent) == VertexPNTCU::layout.attributes[2].offset, "'VertexPNTCU::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNTCU, vertexColor) == VertexPNTCU::layout.attributes[3].offset, "'VertexPNTCU::layout' doesn't match the struct!");
+	static_assert(offsetof(VertexPNTCU, vertexUv) == VertexPNTCU::layout.attributes[4].offset, "'VertexPNTCU::layout' doesn't match the struct!");
+
+	const std::vector<VertexAttribDescriptor> VertexP::attributes{VertexP::layout.ToVector()};
+	const std::vector<VertexAttribDescriptor> VertexPN::attributes{VertexPN::layout.ToVector()};
+	const std::vector<VertexAttribDescriptor> VertexPC::attributes{VertexPC::layout.ToVector()};
+	const std::vector<VertexAttribDescriptor> VertexPU::attributes{VertexPU::layout.ToVector()};
+	const std::vector<VertexAttribDescriptor> VertexPNT::attributes{VertexPNT::layout.ToVector()};
+	const std::vector<VertexAttribDescriptor> VertexPNC::attributes{VertexPNC::layout.ToVector()};
+	const std::vector<VertexAttribDescriptor> VertexPNU::attributes{VertexPNU::layout.ToVector()};
+	const std::vector<VertexAttribDescriptor> VertexPNTU::attributes{VertexPNTU::layout.ToVector()};
+	const std::vector<VertexAttribDescriptor> VertexPNTCU::attributes{VertexPNTCU::layout.ToVector()};
 
 	uint32_t GetIndexFormatSizeInBytes(IndexFormat indexFormat) {
 		switch (indexFormat) {
@@ -0,0 +1,785 @@
+#include "Framework/Asset/VertexKernels.h"
+
+#include "Core/Simd.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace ember {
+
+	// Small enough for a block of the biggest possible vertex to stay in L1/L2
+	// while every attribute of the block is being written (or read).
+	static constexpr uint32_t interleaveBlockSize{256};
+
+	// The biggest float that can be converted to 'IntType' without overflowing.
+	// For 32-bit integers it's not the same as the maximum integer value, because floats
+	// don't have enough mantissa bits to represent it exactly (it gets rounded up).
+	template <typename IntType>
+	constexpr float GetMaxConvertibleFloat() {
+		if constexpr (sizeof(IntType) < 4) {
+			return static_cast<float>(std::numeric_limits<IntType>::max());
+		} else if constexpr (std::is_signed_v<IntType>) {
+			return 2147483520.0f;
+		} else {
+			return 4294967040.0f;
+		}
+	}
+
+	// Storage types of the formats that don't map to a plain C++ type.
+	// Both have exactly the size of the stored value, so they can be memcpy'd to and from the buffers.
+	struct Half {
+		uint16_t bits;
+	};
+	template <typename IntType>
+	struct Normalized {
+		IntType value;
+	};
+
+	template <typename Type>
+	struct IsNormalized : std::false_type {};
+	template <typename IntType>
+	struct IsNormalized<Normalized<IntType>> : std::true_type {};
+
+	// Round to nearest even, overflows to infinity, keeps denormals.
+	// The same bit tricks as in Fabian Giesen's 'float_to_half_fast3_rtne()' and 'half_to_float()'.
+	static uint16_t FloatToHalf(float value) {
+		constexpr uint32_t f32Infinity{255u << 23};
+		constexpr uint32_t f16Max{(127u + 16u) << 23};
+		constexpr uint32_t denormMagicBits{((127u - 15u) + (23u - 10u) + 1u) << 23};
+		uint32_t bits{0};
+		std::memcpy(&bits, &value, sizeof(bits));
+		uint32_t sign = bits & 0x80000000u;
+		bits ^= sign;
+		uint16_t half{0};
+		if (bits >= f16Max) {
+			// NaN stays NaN (quiet), everything else becomes infinity.
+			half = bits > f32Infinity ? 0x7E00 : 0x7C00;
+		} else if (bits < (113u << 23)) {
+			// Too small to be a normal half. Let the FPU do the rounding by adding a magic number
+			// that pushes the mantissa bits we're interested in to the bottom.
+			float denormMagic{0.0f};
+			std::memcpy(&denormMagic, &denormMagicBits, sizeof(denormMagic));
+			float shifted{0.0f};
+			std::memcpy(&shifted, &bits, sizeof(shifted));
+			shifted += denormMagic;
+			std::memcpy(&bits, &shifted, sizeof(bits));
+			half = static_cast<uint16_t>(bits - denormMagicBits);
+		} else {
+			uint32_t mantissaOdd = (bits >> 13) & 1;
+			bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xFFF;
+			bits += mantissaOdd;
+			half = static_cast<uint16_t>(bits >> 13);
+		}
+		return static_cast<uint16_t>(half | (sign >> 16));
+	}
+	static float HalfToFloat(uint16_t half) {
+		constexpr uint32_t shiftedExponent{0x7C00u << 13};
+		constexpr uint32_t magicBits{113u << 23};
+		uint32_t bits = static_cast<uint32_t>(half & 0x7FFF) << 13;
+		uint32_t exponent = bits & shiftedExponent;
+		bits += (127u - 15u) << 23;
+		if (exponent == shiftedExponent) {
+			// Infinity or NaN
+			bits += (128u - 16u) << 23;
+		} else if (exponent == 0) {
+			// Zero or denormal, renormalize
+			bits += 1u << 23;
+			float value{0.0f};
+			float magic{0.0f};
+			std::memcpy(&value, &bits, sizeof(value));
+			std::memcpy(&magic, &magicBits, sizeof(magic));
+			value -= magic;
+			std::memcpy(&bits, &value, sizeof(bits));
+		}
+		bits |= static_cast<uint32_t>(half & 0x8000) << 16;
+		float value{0.0f};
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	template <typename IntType>
+	constexpr float GetNormalizedMin() {
+		return std::is_signed_v<IntType> ? -1.0f : 0.0f;
+	}
+	template <typename IntType>
+	constexpr float GetNormalizedScale() {
+		return static_cast<float>(std::numeric_limits<IntType>::max());
+	}
+
+	template <typename DstType>
+	DstType EncodeComponent(float value) {
+		if constexpr (std::is_same_v<DstType, float>) {
+			return value;
+		} else if constexpr (std::is_same_v<DstType, Half>) {
+			return Half{FloatToHalf(value)};
+		} else if constexpr (IsNormalized<DstType>::value) {
+			using IntType = decltype(DstType::value);
+			// 'nearbyint()' rounds to nearest even, same as the SIMD conversion.
+			float clamped = std::clamp(value, GetNormalizedMin<IntType>(), 1.0f);
+			return DstType{static_cast<IntType>(std::nearbyint(clamped * GetNormalizedScale<IntType>()))};
+		} else {
+			// Out of range float to integer conversions are undefined, so we saturate first.
+			constexpr float lowest = static_cast<float>(std::numeric_limits<DstType>::lowest());
+			constexpr float highest = GetMaxConvertibleFloat<DstType>();
+			return static_cast<DstType>(std::clamp(value, lowest, highest));
+		}
+	}
+
+	template <typename SrcType>
+	float DecodeComponent(SrcType value) {
+		if constexpr (std::is_same_v<SrcType, Half>) {
+			return HalfToFloat(value.bits);
+		} else if constexpr (IsNormalized<SrcType>::value) {
+			using IntType = decltype(SrcType::value);
+			// Both -32768 and -32767 (-128 and -127) map to -1.0f, same as the GPU does.
+			constexpr float invScale = 1.0f / GetNormalizedScale<IntType>();
+			return std::max(static_cast<float>(value.value) * invScale, GetNormalizedMin<IntType>());
+		} else {
+			return static_cast<float>(value);
+		}
+	}
+
+	template <typename DstType, uint32_t SrcComponents, uint32_t DstDimension>
+	void EncodeAttribScalar(const float* src, char* dst, uint32_t dstStride, uint32_t count) {
+		constexpr uint32_t copyDim = std::min(SrcComponents, DstDimension);
+		for (uint32_t vert = 0; vert < count; vert++) {
+			DstType values[DstDimension]{};
+			for (uint32_t componentIdx = 0; componentIdx < copyDim; componentIdx++) {
+				values[componentIdx] = EncodeComponent<DstType>(src[componentIdx]);
+			}
+			std::memcpy(dst, values, sizeof(values));
+			src += SrcComponents;
+			dst += dstStride;
+		}
+	}
+
+	template <typename DstType>
+	void EncodeAttribGeneric(const float* src, uint32_t srcComponents,
+	                         char* dst, uint32_t dstStride, uint32_t dstDimension,
+	                         uint32_t count) {
+		uint32_t copyDim = std::min(srcComponents, dstDimension);
+		for (uint32_t vert = 0; vert < count; vert++) {
+			for (uint32_t componentIdx = 0; componentIdx < dstDimension; componentIdx++) {
+				DstType value = componentIdx < copyDim ? EncodeComponent<DstType>(src[componentIdx]) : DstType{0};
+				std::memcpy(dst + componentIdx * sizeof(DstType), &value, sizeof(DstType));
+			}
+			src += srcComponents;
+			dst += dstStride;
+		}
+	}
+
+	// FLOAT32 and UINT32 destinations are plain copies (or a scalar conversion
+	// that SSE can't do without AVX-512), so only the narrowing formats go through SIMD.
+	// Half floats need F16C, there's no reasonable way to convert them with plain SSE.
+	template <typename Type>
+	constexpr bool simdNarrowIntType =
+		std::is_same_v<Type, int16_t> || std::is_same_v<Type, uint16_t> ||
+		std::is_same_v<Type, int8_t>  || std::is_same_v<Type, uint8_t>;
+
+	template <typename DstType>
+	constexpr bool simdEncodingAvailable = [] {
+		if constexpr (IsNormalized<DstType>::value) {
+			return simdNarrowIntType<decltype(DstType::value)>;
+		} else if constexpr (std::is_same_v<DstType, Half>) {
+#if defined(EMBER_SIMD_F16C)
+			return true;
+#else
+			return false;
+#endif
+		} else {
+			return std::is_same_v<DstType, int32_t> || simdNarrowIntType<DstType>;
+		}
+	}();
+
+	template <typename SrcType>
+	constexpr bool simdDecodingAvailable = [] {
+		if constexpr (std::is_same_v<SrcType, Half>) {
+#if defined(EMBER_SIMD_F16C)
+			return true;
+#else
+			return false;
+#endif
+		} else {
+			return true;
+		}
+	}();
+
+#if defined(EMBER_SIMD_SSE2)
+	template <uint32_t Size>
+	void StoreEncodedLanes(char* dst, __m128i lanes) {
+		alignas(16) char encoded[16];
+		_mm_store_si128(reinterpret_cast<__m128i*>(encoded), lanes);
+		std::memcpy(dst, encoded, Size);
+	}
+
+	template <uint32_t SrcComponents>
+	__m128 GetSourceLaneMask() {
+		return _mm_castsi128_ps(_mm_set_epi32(
+			SrcComponents > 3 ? -1 : 0,
+			SrcComponents > 2 ? -1 : 0,
+			SrcComponents > 1 ? -1 : 0,
+			-1));
+	}
+
+	// Packs 4 32-bit integer lanes to the low bytes of the register. The values must already be in range of 'IntType'.
+	template <typename IntType>
+	__m128i PackLanes(__m128i ints) {
+		if constexpr (std::is_same_v<IntType, int32_t>) {
+			return ints;
+		} else if constexpr (std::is_same_v<IntType, int16_t>) {
+			return _mm_packs_epi32(ints, ints);
+		} else if constexpr (std::is_same_v<IntType, uint16_t>) {
+			// SSE2 has no unsigned 32 -> 16 pack. Bias into the signed range, pack, and flip the sign bit back.
+			__m128i biased = _mm_sub_epi32(ints, _mm_set1_epi32(32768));
+			__m128i packed = _mm_packs_epi32(biased, biased);
+			return _mm_xor_si128(packed, _mm_set1_epi16(static_cast<short>(0x8000)));
+		} else if constexpr (std::is_same_v<IntType, int8_t>) {
+			__m128i packed = _mm_packs_epi32(ints, ints);
+			return _mm_packs_epi16(packed, packed);
+		} else {
+			__m128i packed = _mm_packs_epi32(ints, ints);
+			return _mm_packus_epi16(packed, packed);
+		}
+	}
+
+	// Converts 4 float lanes and packs the results to the low bytes of the register.
+	template <typename DstType>
+	__m128i EncodeLanes(__m128 v) {
+		if constexpr (std::is_same_v<DstType, Half>) {
+#if defined(EMBER_SIMD_F16C)
+			return _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT);
+#else
+			return _mm_setzero_si128(); // never used, see 'simdEncodingAvailable'
+#endif
+		} else if constexpr (IsNormalized<DstType>::value) {
+			using IntType = decltype(DstType::value);
+			v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(GetNormalizedMin<IntType>())), _mm_set1_ps(1.0f));
+			// Rounds to nearest even (the default rounding mode).
+			__m128i ints = _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(GetNormalizedScale<IntType>())));
+			return PackLanes<IntType>(ints);
+		} else {
+			constexpr float lowest = static_cast<float>(std::numeric_limits<DstType>::lowest());
+			constexpr float highest = GetMaxConvertibleFloat<DstType>();
+			v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(lowest)), _mm_set1_ps(highest));
+			return PackLanes<DstType>(_mm_cvttps_epi32(v));
+		}
+	}
+
+#if defined(EMBER_SIMD_AVX2)
+	template <typename IntType>
+	__m256i PackLanes(__m256i ints) {
+		if constexpr (std::is_same_v<IntType, int32_t>) {
+			return ints;
+		} else if constexpr (std::is_same_v<IntType, int16_t>) {
+			return _mm256_packs_epi32(ints, ints);
+		} else if constexpr (std::is_same_v<IntType, uint16_t>) {
+			return _mm256_packus_epi32(ints, ints);
+		} else if constexpr (std::is_same_v<IntType, int8_t>) {
+			__m256i packed = _mm256_packs_epi32(ints, ints);
+			return _mm256_packs_epi16(packed, packed);
+		} else {
+			__m256i packed = _mm256_packs_epi32(ints, ints);
+			return _mm256_packus_epi16(packed, packed);
+		}
+	}
+
+	// Same as above, but for two vertices at once. AVX2 packs work on each 128-bit half separately,
+	// which is exactly what we want: the low half encodes the first vertex, the high half encodes the second one.
+	template <typename DstType>
+	__m256i EncodeLanes(__m256 v) {
+		if constexpr (std::is_same_v<DstType, Half>) {
+			// This one doesn't work per 128-bit half, all 8 halves end up in the low 128 bits.
+			__m128i halves = _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT);
+			return _mm256_set_m128i(_mm_srli_si128(halves, 8), halves);
+		} else if constexpr (IsNormalized<DstType>::value) {
+			using IntType = decltype(DstType::value);
+			v = _mm256_min_ps(_mm256_max_ps(v, _mm256_set1_ps(GetNormalizedMin<IntType>())), _mm256_set1_ps(1.0f));
+			__m256i ints = _mm256_cvtps_epi32(_mm256_mul_ps(v, _mm256_set1_ps(GetNormalizedScale<IntType>())));
+			return PackLanes<IntType>(ints);
+		} else {
+			constexpr float lowest = static_cast<float>(std::numeric_limits<DstType>::lowest());
+			constexpr float highest = GetMaxConvertibleFloat<DstType>();
+			v = _mm256_min_ps(_mm256_max_ps(v, _mm256_set1_ps(lowest)), _mm256_set1_ps(highest));
+			return PackLanes<DstType>(_mm256_cvttps_epi32(v));
+		}
+	}
+#endif
+
+	template <typename DstType, uint32_t SrcComponents, uint32_t DstDimension>
+	void EncodeAttribSimd(const float* src, char* dst, uint32_t dstStride, uint32_t count) {
+		constexpr uint32_t dstSize = DstDimension * sizeof(DstType);
+		// Every vertex is loaded as 4 floats, which reads past the end of the stream for the last few vertices.
+		// Those are handled by the scalar path.
+		constexpr uint32_t scalarTail = SrcComponents >= 4 ? 0 : (4 - SrcComponents + SrcComponents - 1) / SrcComponents;
+		const uint32_t simdCount = count > scalarTail ? count - scalarTail : 0;
+		const __m128 laneMask = GetSourceLaneMask<SrcComponents>();
+
+		uint32_t vert{0};
+#if defined(EMBER_SIMD_AVX2)
+		const __m256 laneMask2 = _mm256_set_m128(laneMask, laneMask);
+		for (; vert + 2 <= simdCount; vert += 2) {
+			__m256 v = _mm256_set_m128(_mm_loadu_ps(src + SrcComponents), _mm_loadu_ps(src));
+			__m256i encoded = EncodeLanes<DstType>(_mm256_and_ps(v, laneMask2));
+			StoreEncodedLanes<dstSize>(dst, _mm256_castsi256_si128(encoded));
+			StoreEncodedLanes<dstSize>(dst + dstStride, _mm256_extracti128_si256(encoded, 1));
+			src += 2 * SrcComponents;
+			dst += 2 * static_cast<size_t>(dstStride);
+		}
+#endif
+		for (; vert < simdCount; vert++) {
+			__m128 v = _mm_and_ps(_mm_loadu_ps(src), laneMask);
+			StoreEncodedLanes<dstSize>(dst, EncodeLanes<DstType>(v));
+			src += SrcComponents;
+			dst += dstStride;
+		}
+		EncodeAttribScalar<DstType, SrcComponents, DstDimension>(src, dst, dstStride, count - vert);
+	}
+#endif
+
+	// The signature of 'VertexAttribEncodeKernel', the component counts are the template arguments.
+	template <typename DstType, uint32_t SrcComponents, uint32_t DstDimension>
+	void EncodeAttrib(const float* src, uint32_t /*srcComponents*/,
+	                  char* dst, uint32_t dstStride, uint32_t /*dstDimension*/,
+	                  uint32_t count) {
+#if defined(EMBER_SIMD_SSE2)
+		if constexpr (simdEncodingAvailable<DstType>) {
+			EncodeAttribSimd<DstType, SrcComponents, DstDimension>(src, dst, dstStride, count);
+			return;
+		}
+#endif
+		EncodeAttribScalar<DstType, SrcComponents, DstDimension>(src, dst, dstStride, count);
+	}
+
+	// Octahedral mapping of unit vectors: "A Survey of Efficient Representations for Independent Unit Vectors"
+	// (Cigolle et al. 2014). The vector is projected onto the octahedron |x| + |y| + |z| = 1, and the lower half
+	// of the octahedron is folded over the upper one, so that the whole thing fits into a [-1, 1] square.
+	static void EncodeOctahedral(const float* src, uint32_t srcComponents,
+	                      char* dst, uint32_t dstStride, uint32_t dstDimension,
+	                      uint32_t count) {
+		assert(srcComponents >= 3 && dstDimension == 2 && "Octahedral encoding works for 3 component vectors only!");
+		for (uint32_t vert = 0; vert < count; vert++) {
+			float x = src[0];
+			float y = src[1];
+			float z = src[2];
+			float l1Norm = std::abs(x) + std::abs(y) + std::abs(z);
+			float invL1Norm = l1Norm > 0.0f ? 1.0f / l1Norm : 0.0f;
+			x *= invL1Norm;
+			y *= invL1Norm;
+			if (z < 0.0f) {
+				float foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+				float foldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+				x = foldedX;
+				y = foldedY;
+			}
+			Normalized<int16_t> values[2]{
+				EncodeComponent<Normalized<int16_t>>(x),
+				EncodeComponent<Normalized<int16_t>>(y),
+			};
+			std::memcpy(dst, values, sizeof(values));
+			src += srcComponents;
+			dst += dstStride;
+		}
+	}
+
+	template <typename DstType, uint32_t SrcComponents>
+	VertexAttribEncodeKernel PickEncodeKernel(uint32_t dstDimension) {
+		switch (dstDimension) {
+			case 1:
+				return EncodeAttrib<DstType, SrcComponents, 1>;
+			case 2:
+				return EncodeAttrib<DstType, SrcComponents, 2>;
+			case 3:
+				return EncodeAttrib<DstType, SrcComponents, 3>;
+			case 4:
+				return EncodeAttrib<DstType, SrcComponents, 4>;
+			default:
+				return EncodeAttribGeneric<DstType>;
+		}
+	}
+	template <typename DstType>
+	VertexAttribEncodeKernel PickEncodeKernel(uint32_t srcComponents, uint32_t dstDimension) {
+		switch (srcComponents) {
+			case 2:
+				return PickEncodeKernel<DstType, 2>(dstDimension);
+			case 3:
+				return PickEncodeKernel<DstType, 3>(dstDimension);
+			case 4:
+				return PickEncodeKernel<DstType, 4>(dstDimension);
+			default:
+				return EncodeAttribGeneric<DstType>;
+		}
+	}
+
+	VertexAttribEncodeKernel PickVertexAttribEncodeKernel(VertexAttribFormat dstFormat,
+	                                                      uint32_t srcComponents, uint32_t dstDimension) {
+		switch (dstFormat) {
+			case VertexAttribFormat::FLOAT32:
+				return PickEncodeKernel<float>(srcComponents, dstDimension);
+			case VertexAttribFormat::UINT32:
+				return PickEncodeKernel<uint32_t>(srcComponents, dstDimension);
+			case VertexAttribFormat::UINT16:
+				return PickEncodeKernel<uint16_t>(srcComponents, dstDimension);
+			case VertexAttribFormat::UINT8:
+				return PickEncodeKernel<uint8_t>(srcComponents, dstDimension);
+			case VertexAttribFormat::INT32:
+				return PickEncodeKernel<int32_t>(srcComponents, dstDimension);
+			case VertexAttribFormat::INT16:
+				return PickEncodeKernel<int16_t>(srcComponents, dstDimension);
+			case VertexAttribFormat::INT8:
+				return PickEncodeKernel<int8_t>(srcComponents, dstDimension);
+			case VertexAttribFormat::FLOAT16:
+				return PickEncodeKernel<Half>(srcComponents, dstDimension);
+			case VertexAttribFormat::SNORM16:
+				return PickEncodeKernel<Normalized<int16_t>>(srcComponents, dstDimension);
+			case VertexAttribFormat::SNORM8:
+				return PickEncodeKernel<Normalized<int8_t>>(srcComponents, dstDimension);
+			case VertexAttribFormat::UNORM16:
+				return PickEncodeKernel<Normalized<uint16_t>>(srcComponents, dstDimension);
+			case VertexAttribFormat::UNORM8:
+				return PickEncodeKernel<Normalized<uint8_t>>(srcComponents, dstDimension);
+			case VertexAttribFormat::OCT_SNORM16:
+				return EncodeOctahedral;
+			default:
+				assert(false && "Unknown vertex attribute format provided!");
+				return EncodeAttribGeneric<float>;
+		}
+	}
+
+	template <typename SrcType, uint32_t SrcDimension, uint32_t DstComponents>
+	void DecodeAttribScalar(const char* src, uint32_t srcStride, float* dst, uint32_t count) {
+		constexpr uint32_t copyDim = std::min(SrcDimension, DstComponents);
+		for (uint32_t vert = 0; vert < count; vert++) {
+			SrcType values[SrcDimension];
+			std::memcpy(values, src, sizeof(values));
+			for (uint32_t componentIdx = 0; componentIdx < DstComponents; componentIdx++) {
+				dst[componentIdx] = componentIdx < copyDim ? DecodeComponent(values[componentIdx]) : 0.0f;
+			}
+			src += srcStride;
+			dst += DstComponents;
+		}
+	}
+
+	template <typename SrcType>
+	void DecodeAttribGeneric(const char* src, uint32_t srcStride, uint32_t srcDimension,
+	                         float* dst, uint32_t dstComponents,
+	                         uint32_t count) {
+		uint32_t copyDim = std::min(srcDimension, dstComponents);
+		for (uint32_t vert = 0; vert < count; vert++) {
+			for (uint32_t componentIdx = 0; componentIdx < dstComponents; componentIdx++) {
+				float value{0.0f};
+				if (componentIdx < copyDim) {
+					SrcType encoded{};
+					std::memcpy(&encoded, src + componentIdx * sizeof(SrcType), sizeof(SrcType));
+					value = DecodeComponent(encoded);
+				}
+				dst[componentIdx] = value;
+			}
+			src += srcStride;
+			dst += dstComponents;
+		}
+	}
+
+#if defined(EMBER_SIMD_SSE2)
+	// Widens the low lanes of the register to 4 floats.
+	template <typename SrcType>
+	__m128 DecodeLanes(__m128i v) {
+		if constexpr (std::is_same_v<SrcType, Half>) {
+#if defined(EMBER_SIMD_F16C)
+			return _mm_cvtph_ps(v);
+#else
+			return _mm_setzero_ps(); // never used, see 'simdDecodingAvailable'
+#endif
+		} else if constexpr (IsNormalized<SrcType>::value) {
+			using IntType = decltype(SrcType::value);
+			constexpr float invScale = 1.0f / GetNormalizedScale<IntType>();
+			__m128 values = _mm_mul_ps(DecodeLanes<IntType>(v), _mm_set1_ps(invScale));
+			return _mm_max_ps(values, _mm_set1_ps(GetNormalizedMin<IntType>()));
+		} else if constexpr (std::is_same_v<SrcType, float>) {
+			return _mm_castsi128_ps(v);
+		} else if constexpr (std::is_same_v<SrcType, int32_t>) {
+			return _mm_cvtepi32_ps(v);
+		} else if constexpr (std::is_same_v<SrcType, uint32_t>) {
+			// There's no unsigned conversion before AVX-512. Convert both 16-bit halves separately,
+			// each one is exact, so the final addition rounds only once (same as a scalar cast).
+			__m128 hi = _mm_cvtepi32_ps(_mm_srli_epi32(v, 16));
+			__m128 lo = _mm_cvtepi32_ps(_mm_and_si128(v, _mm_set1_epi32(0xFFFF)));
+			return _mm_add_ps(_mm_mul_ps(hi, _mm_set1_ps(65536.0f)), lo);
+		} else if constexpr (std::is_same_v<SrcType, int16_t>) {
+			return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+		} else if constexpr (std::is_same_v<SrcType, uint16_t>) {
+			return _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, _mm_setzero_si128()));
+		} else if constexpr (std::is_same_v<SrcType, int8_t>) {
+			__m128i words = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+			return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16));
+		} else {
+			__m128i words = _mm_unpacklo_epi8(v, _mm_setzero_si128());
+			return _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, _mm_setzero_si128()));
+		}
+	}
+
+	// Decodes 4 vertices and writes them to 'dst' as tightly packed floats, with full stores only.
+	template <typename SrcType, uint32_t SrcDimension, uint32_t DstComponents>
+	void DecodeVertices4(const char* src, uint32_t srcStride, float* dst) {
+		__m128 v[4];
+		for (uint32_t lane = 0; lane < 4; lane++) {
+			const char* vertexSrc = src + lane * static_cast<size_t>(srcStride);
+			v[lane] = DecodeLanes<SrcType>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(vertexSrc)));
+			if constexpr (SrcDimension < DstComponents) {
+				// The lanes past the attribute hold whatever follows it in the vertex, they have to read as 0.0f.
+				v[lane] = _mm_and_ps(v[lane], GetSourceLaneMask<SrcDimension>());
+			}
+		}
+		if constexpr (DstComponents == 4) {
+			for (uint32_t lane = 0; lane < 4; lane++) {
+				_mm_storeu_ps(dst + 4 * lane, v[lane]);
+			}
+		} else if constexpr (DstComponents == 3) {
+			// x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+			__m128 z0x1 = _mm_shuffle_ps(v[0], v[1], _MM_SHUFFLE(0, 0, 2, 2));
+			__m128 z2x3 = _mm_shuffle_ps(v[2], v[3], _MM_SHUFFLE(0, 0, 2, 2));
+			_mm_storeu_ps(dst, _mm_shuffle_ps(v[0], z0x1, _MM_SHUFFLE(2, 0, 1, 0)));
+			_mm_storeu_ps(dst + 4, _mm_shuffle_ps(v[1], v[2], _MM_SHUFFLE(1, 0, 2, 1)));
+			_mm_storeu_ps(dst + 8, _mm_shuffle_ps(z2x3, v[3], _MM_SHUFFLE(2, 1, 2, 0)));
+		} else {
+			// x0 y0 x1 y1 | x2 y2 x3 y3
+			_mm_storeu_ps(dst, _mm_movelh_ps(v[0], v[1]));
+			_mm_storeu_ps(dst + 4, _mm_movelh_ps(v[2], v[3]));
+		}
+	}
+
+	template <typename SrcType, uint32_t SrcDimension, uint32_t DstComponents>
+	void DecodeAttribSimd(const char* src, uint32_t srcStride, float* dst, uint32_t count) {
+		// Every vertex is loaded as 16 bytes, which reads past the attribute for the narrow ones.
+		// The last few vertices, where that would read past the end of the buffer, go through the scalar path.
+		constexpr uint32_t srcSize = SrcDimension * sizeof(SrcType);
+		const uint32_t scalarTail = srcSize >= 16 || srcStride == 0 ? 0 : (16 - srcSize + srcStride - 1) / srcStride;
+		const uint32_t simdCount = count > scalarTail ? count - scalarTail : 0;
+
+		uint32_t vert{0};
+		for (; vert + 4 <= simdCount; vert += 4) {
+			DecodeVertices4<SrcType, SrcDimension, DstComponents>(src, srcStride, dst);
+			src += 4 * static_cast<size_t>(srcStride);
+			dst += 4 * DstComponents;
+		}
+		DecodeAttribScalar<SrcType, SrcDimension, DstComponents>(src, srcStride, dst, count - vert);
+	}
+#endif
+
+	// The signature of 'VertexAttribDecodeKernel', the component counts are the template arguments.
+	template <typename SrcType, uint32_t SrcDimension, uint32_t DstComponents>
+	void DecodeAttrib(const char* src, uint32_t srcStride, uint32_t /*srcDimension*/,
+	                  float* dst, uint32_t /*dstComponents*/,
+	                  uint32_t count) {
+#if defined(EMBER_SIMD_SSE2)
+		if constexpr (simdDecodingAvailable<SrcType>) {
+			DecodeAttribSimd<SrcType, SrcDimension, DstComponents>(src, srcStride, dst, count);
+			return;
+		}
+#endif
+		DecodeAttribScalar<SrcType, SrcDimension, DstComponents>(src, srcStride, dst, count);
+	}
+
+	static void DecodeOctahedral(const char* src, uint32_t srcStride, uint32_t srcDimension,
+	                      float* dst, uint32_t dstComponents,
+	                      uint32_t count) {
+		assert(srcDimension == 2 && "Octahedral encoding must have 2 components!");
+		uint32_t copyDim = std::min(dstComponents, 3u);
+		for (uint32_t vert = 0; vert < count; vert++) {
+			Normalized<int16_t> values[2];
+			std::memcpy(values, src, sizeof(values));
+			float x = DecodeComponent(values[0]);
+			float y = DecodeComponent(values[1]);
+			float z = 1.0f - std::abs(x) - std::abs(y);
+			// Unfold the lower half of the octahedron.
+			float t = std::max(-z, 0.0f);
+			x += x >= 0.0f ? -t : t;
+			y += y >= 0.0f ? -t : t;
+			float length = std::sqrt(x * x + y * y + z * z);
+			float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+			float decoded[3]{x * invLength, y * invLength, z * invLength};
+			for (uint32_t componentIdx = 0; componentIdx < dstComponents; componentIdx++) {
+				dst[componentIdx] = componentIdx < copyDim ? decoded[componentIdx] : 0.0f;
+			}
+			src += srcStride;
+			dst += dstComponents;
+		}
+	}
+
+	template <typename SrcType, uint32_t DstComponents>
+	VertexAttribDecodeKernel PickDecodeKernel(uint32_t srcDimension) {
+		switch (srcDimension) {
+			case 1:
+				return DecodeAttrib<SrcType, 1, DstComponents>;
+			case 2:
+				return DecodeAttrib<SrcType, 2, DstComponents>;
+			case 3:
+				return DecodeAttrib<SrcType, 3, DstComponents>;
+			case 4:
+				return DecodeAttrib<SrcType, 4, DstComponents>;
+			default:
+				return DecodeAttribGeneric<SrcType>;
+		}
+	}
+	template <typename SrcType>
+	VertexAttribDecodeKernel PickDecodeKernel(uint32_t srcDimension, uint32_t dstComponents) {
+		switch (dstComponents) {
+			case 2:
+				return PickDecodeKernel<SrcType, 2>(srcDimension);
+			case 3:
+				return PickDecodeKernel<SrcType, 3>(srcDimension);
+			case 4:
+				return PickDecodeKernel<SrcType, 4>(srcDimension);
+			default:
+				return DecodeAttribGeneric<SrcType>;
+		}
+	}
+
+	VertexAttribDecodeKernel PickVertexAttribDecodeKernel(VertexAttribFormat srcFormat,
+	                                                      uint32_t srcDimension, uint32_t dstComponents) {
+		switch (srcFormat) {
+			case VertexAttribFormat::FLOAT32:
+				return PickDecodeKernel<float>(srcDimension, dstComponents);
+			case VertexAttribFormat::UINT32:
+				return PickDecodeKernel<uint32_t>(srcDimension, dstComponents);
+			case VertexAttribFormat::UINT16:
+				return PickDecodeKernel<uint16_t>(srcDimension, dstComponents);
+			case VertexAttribFormat::UINT8:
+				return PickDecodeKernel<uint8_t>(srcDimension, dstComponents);
+			case VertexAttribFormat::INT32:
+				return PickDecodeKernel<int32_t>(srcDimension, dstComponents);
+			case VertexAttribFormat::INT16:
+				return PickDecodeKernel<int16_t>(srcDimension, dstComponents);
+			case VertexAttribFormat::INT8:
+				return PickDecodeKernel<int8_t>(srcDimension, dstComponents);
+			case VertexAttribFormat::FLOAT16:
+				return PickDecodeKernel<Half>(srcDimension, dstComponents);
+			case VertexAttribFormat::SNORM16:
+				return PickDecodeKernel<Normalized<int16_t>>(srcDimension, dstComponents);
+			case VertexAttribFormat::SNORM8:
+				return PickDecodeKernel<Normalized<int8_t>>(srcDimension, dstComponents);
+			case VertexAttribFormat::UNORM16:
+				return PickDecodeKernel<Normalized<uint16_t>>(srcDimension, dstComponents);
+			case VertexAttribFormat::UNORM8:
+				return PickDecodeKernel<Normalized<uint8_t>>(srcDimension, dstComponents);
+			case VertexAttribFormat::OCT_SNORM16:
+				return DecodeOctahedral;
+			default:
+				assert(false && "Unknown vertex attribute format provided!");
+				return DecodeAttribGeneric<float>;
+		}
+	}
+
+	void VertexInterleaver::AddAttrib(const VertexAttribDescriptor& dstAttribDesc, const VertexAttribStream& srcStream) {
+		if (!srcStream.data) {
+			// Nothing to read from (the channel isn't stored on the CPU side).
+			// The destination bytes of this attribute are left untouched.
+			return;
+		}
+		EncodeOp encodeOp{};
+		encodeOp.kernel = PickVertexAttribEncodeKernel(dstAttribDesc.format, srcStream.components, dstAttribDesc.dimension);
+		encodeOp.src = srcStream.data;
+		encodeOp.srcComponents = srcStream.components;
+		encodeOp.dstOffset = dstAttribDesc.offset;
+		encodeOp.dstDimension = dstAttribDesc.dimension;
+		encodeOps.push_back(encodeOp);
+	}
+	void VertexInterleaver::AddAttrib(const VertexAttribDescriptor& dstAttribDesc, const VertexAttribStream& srcStream,
+	                                  const VertexAttribRemap& remap) {
+		assert(srcStream.components <= 4 && "Remapped streams can have 4 components at most!");
+		size_t encodeOpCount = encodeOps.size();
+		AddAttrib(dstAttribDesc, srcStream);
+		if (encodeOps.size() != encodeOpCount) {
+			encodeOps.back().remapped = true;
+			encodeOps.back().remap = remap;
+		}
+	}
+	void VertexInterleaver::SetVertexStride(uint32_t vertexStride) {
+		this->vertexStride = vertexStride;
+	}
+
+	// Writes the remapped values of a single block to 'dst'. Plain loops over a fixed number of components,
+	// the compiler vectorizes them just fine.
+	template <uint32_t Components>
+	void RemapBlock(const float* src, const VertexAttribRemap& remap, float* dst, uint32_t count) {
+		for (uint32_t vert = 0; vert < count; vert++) {
+			for (uint32_t componentIdx = 0; componentIdx < Components; componentIdx++) {
+				dst[componentIdx] = (src[componentIdx] - remap.offset[componentIdx]) * remap.scale[componentIdx];
+			}
+			src += Components;
+			dst += Components;
+		}
+	}
+	static void RemapBlock(const float* src, uint32_t components, const VertexAttribRemap& remap,
+	                       float* dst, uint32_t count) {
+		switch (components) {
+			case 1:
+				RemapBlock<1>(src, remap, dst, count);
+				break;
+			case 2:
+				RemapBlock<2>(src, remap, dst, count);
+				break;
+			case 3:
+				RemapBlock<3>(src, remap, dst, count);
+				break;
+			case 4:
+				RemapBlock<4>(src, remap, dst, count);
+				break;
+		}
+	}
+
+	void VertexInterleaver::Interleave(char* dst, uint32_t firstVertex, uint32_t vertexCount) const {
+		// Scratch space for the remapped attributes, one block at a time (4 KiB, stays in L1).
+		alignas(16) float remapBuffer[interleaveBlockSize * 4];
+		for (uint32_t blockStart = 0; blockStart < vertexCount; blockStart += interleaveBlockSize) {
+			uint32_t blockSize = std::min(interleaveBlockSize, vertexCount - blockStart);
+			size_t blockFirstVertex = static_cast<size_t>(firstVertex) + blockStart;
+			char* blockDst = dst + static_cast<size_t>(blockStart) * vertexStride;
+			for (const EncodeOp& encodeOp : encodeOps) {
+				const float* src = encodeOp.src + blockFirstVertex * encodeOp.srcComponents;
+				if (encodeOp.remapped) {
+					RemapBlock(src, encodeOp.srcComponents, encodeOp.remap, remapBuffer, blockSize);
+					src = remapBuffer;
+				}
+				encodeOp.kernel(src, encodeOp.srcComponents,
+				                blockDst + encodeOp.dstOffset, vertexStride, encodeOp.dstDimension,
+				                blockSize);
+			}
+		}
+	}
+
+	void VertexDeinterleaver::AddAttrib(const VertexAttribDescriptor& srcAttribDesc, float* dst, uint32_t dstComponents) {
+		if (!dst) {
+			return;
+		}
+		DecodeOp decodeOp{};
+		decodeOp.kernel = PickVertexAttribDecodeKernel(srcAttribDesc.format, srcAttribDesc.dimension, dstComponents);
+		decodeOp.dst = dst;
+		decodeOp.dstComponents = dstComponents;
+		decodeOp.srcOffset = srcAttribDesc.offset;
+		decodeOp.srcDimension = srcAttribDesc.dimension;
+		decodeOps.push_back(decodeOp);
+	}
+	void VertexDeinterleaver::SetVertexStride(uint32_t vertexStride) {
+		this->vertexStride = vertexStride;
+	}
+
+	void VertexDeinterleaver::Deinterleave(const char* src, uint32_t firstVertex, uint32_t vertexCount) const {
+		// Same blocks as 'Interleave()', every attribute of a block is read while the block is still in L1.
+		for (uint32_t blockStart = 0; blockStart < vertexCount; blockStart += interleaveBlockSize) {
+			uint32_t blockSize = std::min(interleaveBlockSize, vertexCount - blockStart);
+			size_t blockFirstVertex = static_cast<size_t>(firstVertex) + blockStart;
+			const char* blockSrc = src + static_cast<size_t>(blockStart) * vertexStride;
+			for (const DecodeOp& decodeOp : decodeOps) {
+				float* dst = decodeOp.dst + blockFirstVertex * decodeOp.dstComponents;
+				decodeOp.kernel(blockSrc + decodeOp.srcOffset, vertexStride, decodeOp.srcDimension,
+				                dst, decodeOp.dstComponents,
+				                blockSize);
+			}
+		}
+	}
+
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "GpuApi/GpuApiCtxOgl.h"
+#include "GpuApi/OpenGL/OpenGLVertex.h"
 
 #include "Window/Window.h"
 #include "Window/WindowGlfw.h"
@@ -9,6 +10,7 @@
 #include "Gui/ImGui/imgui_impl_glfw.h"
 #include "Gui/ImGui/imgui_impl_opengl3.h"
 
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 
@@ -17,6 +19,15 @@ namespace ember {
 	static GpuApiCtxOgl* currentGpuApiCtxOgl{nullptr};
 	static bool openglFunctionsLoaded{false};
 
+	static bool IsSameVertexAttribLayout(const std::vector<VertexAttribDescriptor>& lhs,
+	                                     const std::vector<VertexAttribDescriptor>& rhs) {
+		return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+			[](const VertexAttribDescriptor& lhsAttrib, const VertexAttribDescriptor& rhsAttrib) {
+				return lhsAttrib.dimension == rhsAttrib.dimension && lhsAttrib.offset == rhsAttrib.offset &&
+				       lhsAttrib.channel == rhsAttrib.channel && lhsAttrib.format == rhsAttrib.format;
+			});
+	}
+
 	GpuApiCtxOgl::GpuApiCtxOgl(const SettingsOgl& settings)
 		: settings(settings) {
 	}
@@ -40,6 +51,10 @@ namespace ember {
 		imGuiCtx->Initialize();
 	}
 	void GlfwOglCtx::Terminate() {
+		for (auto& [mesh, meshRes] : meshGpuResources) {
+			DestroyMeshGpuResource(meshRes);
+		}
+		meshGpuResources.clear();
 		window->DestroyWindow();
 	}
 	void GlfwOglCtx::TerminateGuiContext() {
@@ -110,19 +125,116 @@ namespace ember {
 	}
 
 	void GlfwOglCtx::CreateMeshGpuResource(const Mesh* mesh) {
-		// TODO
+		if (meshGpuResources.count(mesh) > 0) {
+			return;
+		}
+		OpenGLMeshGpuResource& meshRes = meshGpuResources[mesh];
+		glCreateVertexArrays(1, &meshRes.vertexArray);
+		glCreateBuffers(1, &meshRes.vertexBuffer);
+		glCreateBuffers(1, &meshRes.indexBuffer);
+		glVertexArrayElementBuffer(meshRes.vertexArray, meshRes.indexBuffer);
+		UploadMeshVertices(*mesh, meshRes);
+		UploadMeshIndices(*mesh, meshRes);
 	}
 	void GlfwOglCtx::DeleteMeshGpuResource(const Mesh* mesh) {
-		// TODO
+		auto searchResult = meshGpuResources.find(mesh);
+		if (searchResult == meshGpuResources.end()) {
+			return;
+		}
+		DestroyMeshGpuResource(searchResult->second);
+		meshGpuResources.erase(searchResult);
 	}
 	void GlfwOglCtx::OnMeshSettingsChange(const Mesh* mesh) {
-		// TODO
+		auto searchResult = meshGpuResources.find(mesh);
+		if (searchResult == meshGpuResources.end()) {
+			return;
+		}
+		// The settings decide the vertex layout (e.g. the quantized positions) and the index format.
+		UploadMeshVertices(*mesh, searchResult->second);
+		UploadMeshIndices(*mesh, searchResult->second);
 	}
 	void GlfwOglCtx::OnMeshVertexBufferUpdate(const Mesh* mesh) {
-		// TODO
+		auto searchResult = meshGpuResources.find(mesh);
+		if (searchResult != meshGpuResources.end()) {
+			UploadMeshVertices(*mesh, searchResult->second);
+		}
 	}
 	void GlfwOglCtx::OnMeshIndexBufferUpdate(const Mesh* mesh) {
-		// TODO
+		auto searchResult = meshGpuResources.find(mesh);
+		if (searchResult != meshGpuResources.end()) {
+			UploadMeshIndices(*mesh, searchResult->second);
+		}
+	}
+	void GlfwOglCtx::OnMeshVertexBufferRangeUpdate(const Mesh* mesh, uint32_t firstVertex, uint32_t vertexCount) {
+		auto searchResult = meshGpuResources.find(mesh);
+		if (searchResult == meshGpuResources.end()) {
+			return;
+		}
+		OpenGLMeshGpuResource& meshRes = searchResult->second;
+		// The buffer is replaced whole if it doesn't hold the same vertices anymore.
+		if (mesh->GetVertexCount() != meshRes.vertexCount ||
+		    !IsSameVertexAttribLayout(mesh->GetVertexAttribLayout(), meshRes.vertexAttribLayout)) {
+			UploadMeshVertices(*mesh, meshRes);
+			return;
+		}
+		uint32_t lastVertex = std::min(firstVertex + vertexCount, meshRes.vertexCount);
+		if (firstVertex >= lastVertex) {
+			return;
+		}
+		std::vector<char> vertexBuffer = mesh->ConstructMeshVertexBuffer(firstVertex, lastVertex - firstVertex);
+		glNamedBufferSubData(meshRes.vertexBuffer, static_cast<GLintptr>(firstVertex) * meshRes.vertexStride,
+		                     static_cast<GLsizeiptr>(vertexBuffer.size()), vertexBuffer.data());
+	}
+	void GlfwOglCtx::OnMeshIndexBufferRangeUpdate(const Mesh* mesh, uint32_t firstIndex, uint32_t indexCount) {
+		auto searchResult = meshGpuResources.find(mesh);
+		if (searchResult == meshGpuResources.end()) {
+			return;
+		}
+		OpenGLMeshGpuResource& meshRes = searchResult->second;
+		uint32_t totalIndexCount = static_cast<uint32_t>(mesh->GetIndexCount() + mesh->GetLodIndices().size());
+		if (totalIndexCount != meshRes.indexCount || mesh->GetIndexFormat() != meshRes.indexFormat) {
+			UploadMeshIndices(*mesh, meshRes);
+			return;
+		}
+		uint32_t lastIndex = std::min(firstIndex + indexCount, meshRes.indexCount);
+		if (firstIndex >= lastIndex) {
+			return;
+		}
+		std::vector<char> indexBuffer = mesh->ConstructMeshIndexBuffer(firstIndex, lastIndex - firstIndex);
+		glNamedBufferSubData(meshRes.indexBuffer,
+		                     static_cast<GLintptr>(firstIndex) * GetIndexFormatSizeInBytes(meshRes.indexFormat),
+		                     static_cast<GLsizeiptr>(indexBuffer.size()), indexBuffer.data());
+	}
+
+	void GlfwOglCtx::UploadMeshVertices(const Mesh& mesh, OpenGLMeshGpuResource& meshRes) {
+		std::vector<VertexAttribDescriptor> layout = mesh.GetVertexAttribLayout();
+		uint32_t vertexStride = CalculateVertexStride(layout);
+		std::vector<char> vertexBuffer = mesh.ConstructMeshVertexBuffer();
+		glNamedBufferData(meshRes.vertexBuffer, static_cast<GLsizeiptr>(vertexBuffer.size()), vertexBuffer.data(),
+		                  GL_STATIC_DRAW);
+		// The channels that the new layout doesn't have would still read the buffer.
+		for (const VertexAttribDescriptor& attrib : meshRes.vertexAttribLayout) {
+			glDisableVertexArrayAttrib(meshRes.vertexArray, static_cast<GLuint>(attrib.channel));
+		}
+		SetOpenGLVertexAttribLayout(meshRes.vertexArray, 0, layout);
+		glVertexArrayVertexBuffer(meshRes.vertexArray, 0, meshRes.vertexBuffer, 0, static_cast<GLsizei>(vertexStride));
+		meshRes.vertexAttribLayout = std::move(layout);
+		meshRes.vertexStride = vertexStride;
+		meshRes.vertexCount = static_cast<uint32_t>(mesh.GetVertexCount());
+	}
+	void GlfwOglCtx::UploadMeshIndices(const Mesh& mesh, OpenGLMeshGpuResource& meshRes) {
+		// OpenGL takes every index format, the UINT8 one included.
+		std::vector<char> indexBuffer = mesh.ConstructMeshIndexBuffer();
+		glNamedBufferData(meshRes.indexBuffer, static_cast<GLsizeiptr>(indexBuffer.size()), indexBuffer.data(),
+		                  GL_STATIC_DRAW);
+		meshRes.indexFormat = mesh.GetIndexFormat();
+		meshRes.indexCount = static_cast<uint32_t>(mesh.GetIndexCount() + mesh.GetLodIndices().size());
+	}
+	void GlfwOglCtx::DestroyMeshGpuResource(OpenGLMeshGpuResource& meshRes) {
+		glDeleteVertexArrays(1, &meshRes.vertexArray);
+		glDeleteBuffers(1, &meshRes.vertexBuffer);
+		glDeleteBuffers(1, &meshRes.indexBuffer);
+		meshRes = OpenGLMeshGpuResource{};
 	}
 
 	void GlfwOglCtx::OnMakeCurrent() {
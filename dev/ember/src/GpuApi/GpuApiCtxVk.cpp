@@ -1,4 +1,6 @@
 #include "GpuApi/GpuApiCtxVk.h"
+#include "GpuApi/Vulkan/VulkanVertex.h"
+#include "GpuApi/Vulkan/Memory/VulkanMemory.h"
 
 #ifdef EMBER_PLATFORM_WIN32
 #include <Windows.h>
@@ -14,6 +16,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include <limits>
 #include <stdexcept>
@@ -23,6 +26,59 @@ namespace ember {
 
 	static GpuApiCtxVk* currentGpuApiCtxVk{nullptr};
 
+	// The vertex and the index ranges of the meshes, and the uploads in the staging ring.
+	static constexpr uint32_t meshBufferAlignment{16};
+	static constexpr VkDeviceSize stagingAlignment{16};
+	// What 'VulkanRenderPass::SetDepthAttachment()' describes.
+	static constexpr VkFormat depthFormat{VK_FORMAT_D32_SFLOAT};
+
+	static bool PickVulkanPrimitiveTopology(MeshTopology meshTopology, VkPrimitiveTopology& topology) {
+		switch (meshTopology) {
+		case MeshTopology::TRIANGLES:
+			topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+			return true;
+		case MeshTopology::TRIANGLE_STRIP:
+			topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+			return true;
+		case MeshTopology::LINES:
+			topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+			return true;
+		case MeshTopology::LINE_STRIP:
+			topology = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
+			return true;
+		case MeshTopology::POINTS:
+			topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+			return true;
+		default:
+			// The patches need the tessellation shaders.
+			return false;
+		}
+	}
+	// The index format that the mesh is uploaded with.
+	static IndexFormat PickVulkanIndexFormat(IndexFormat meshIndexFormat) {
+		// VK_INDEX_TYPE_UINT8_EXT is an extension.
+		return meshIndexFormat == IndexFormat::UINT8 ? IndexFormat::UINT16 : meshIndexFormat;
+	}
+	static VkIndexType GetVulkanIndexType(IndexFormat indexFormat) {
+		assert(indexFormat != IndexFormat::UINT8 && "UINT8 indices are uploaded as UINT16!");
+		return indexFormat == IndexFormat::UINT32 ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16;
+	}
+	// The coarsest level whose error is at most 'maxError', the errors grow along the chain.
+	static uint32_t SelectMeshLod(const std::vector<IndexBufferLod>& lods, float maxError) {
+		uint32_t lodIdx{0};
+		while (lodIdx + 1 < lods.size() && lods[lodIdx + 1].error <= maxError) {
+			lodIdx++;
+		}
+		return lodIdx;
+	}
+	// The positions are in the clip space already, the projection is the identity (an orthographic one).
+	static OcclusionCullerSettings GetClipSpaceOcclusionCullerSettings() {
+		OcclusionCullerSettings cullerSettings{};
+		cullerSettings.depthRange = ClipDepthRange::ZERO_TO_ONE;
+		cullerSettings.orthographic = true;
+		return cullerSettings;
+	}
+
 #ifndef NDEBUG
 	VKAPI_ATTR VkResult VKAPI_CALL CreateDebugUtilsMessengerEXT(
 		VkInstance instance,
@@ -60,6 +116,9 @@ namespace ember {
 	bool VulkanQueueFamilyIndices::HasPresentQueueFamily() const {
 		return presentQueueFamily.has_value();
 	}
+	bool VulkanQueueFamilyIndices::HasTransferQueueFamily() const {
+		return transferQueueFamily.has_value();
+	}
 	bool VulkanQueueFamilyIndices::Complete() const {
 		return HasGraphicsQueueFamily() && HasPresentQueueFamily();
 	}
@@ -112,8 +171,26 @@ namespace ember {
 		return deviceData.presentationQueueFamily;
 	}
 
+	VulkanQueueFamily& VulkanData::GetTransferQueueFamily() {
+		return deviceData.transferQueueFamily;
+	}
+	const VulkanQueueFamily& VulkanData::GetTransferQueueFamily() const {
+		return deviceData.transferQueueFamily;
+	}
+
+	bool VulkanMeshPipelineKey::operator==(const VulkanMeshPipelineKey& other) const {
+		auto sameAttrib = [](const VertexAttribDescriptor& lhs, const VertexAttribDescriptor& rhs) {
+			return lhs.dimension == rhs.dimension && lhs.offset == rhs.offset && lhs.format == rhs.format;
+		};
+		return vertexStride == other.vertexStride &&
+		       sameAttrib(position, other.position) &&
+		       sameAttrib(color, other.color) &&
+		       topology == other.topology &&
+		       cullBackFaces == other.cullBackFaces;
+	}
+
 	GpuApiCtxVk::GpuApiCtxVk(const SettingsVk& settings, Window* window)
-		: settings(settings), window(window) {
+		: occlusionCuller(GetClipSpaceOcclusionCullerSettings()), settings(settings), window(window) {
 	}
 
 	GpuApiType GpuApiCtxVk::GetGpuApiType() const {
@@ -145,7 +222,10 @@ namespace ember {
 		AcquireSwapchainImages();
 		CreateSwapchainImageViews();
 
-		CreateGraphicsPipeline();
+		CreateRenderPass();
+		CreatePipelineLayout();
+		CreateMeshShaderModules();
+		CreateDepthBuffer();
 		CreateFramebuffers();
 
 		frameRes.resize(framesInFlight);
@@ -153,6 +233,8 @@ namespace ember {
 		CreateCommandBuffers();
 
 		CreateSynchronizationObjects();
+
+		CreateMeshBuffers();
 	}
 	void GpuApiCtxVk::InitializeGuiContext() {
 		// TODO
@@ -160,10 +242,14 @@ namespace ember {
 
 	void GpuApiCtxVk::Terminate() {
 		Synchronize();
+		// Before the command pools, the upload scheduler gives its command buffers back.
+		DestroyMeshBuffers();
 		DestroySynchronizationObjects();
 		DestroyCommandPools();
 		DestroyFramebuffers();
-		graphicsPipeline->DestroyPipeline(vulkanData.GetLogicalDevice());
+		DestroyDepthBuffer();
+		DestroyMeshPipelines();
+		DestroyMeshShaderModules();
 		renderPass->DestroyRenderPass(vulkanData.GetLogicalDevice());
 		pipelineLayout->DestroyPipelineLayout(vulkanData.GetLogicalDevice());
 		DestroySwapchainImageViews();
@@ -192,6 +278,7 @@ namespace ember {
 	}
 	void GpuApiCtxVk::DrawFrame() {
 		vkWaitForFences(vulkanData.GetLogicalDevice(), 1, &frameRes[frame].frameFinishedFence, VK_TRUE, UINT64_MAX);
+		ReleaseCompletedSubmissions(frameRes[frame].submissionIdx);
 		VkResult acquireImageResult{};
 		do {
 			acquireImageResult = vkAcquireNextImageKHR(vulkanData.GetLogicalDevice(),
@@ -210,24 +297,38 @@ namespace ember {
 			}
 		} while (acquireImageResult != VK_SUCCESS);
 
+		UploadMeshes();
 		vkResetCommandBuffer(frameRes[frame].commandBuffer, 0);
 		RecordCommandBuffer(frameRes[frame].commandBuffer, imageIdx);
 
 		// Reset the fence later, before submitting, to avoid a deadlock.
 		vkResetFences(vulkanData.GetLogicalDevice(), 1, &frameRes[frame].frameFinishedFence);
 
+		// The uploads that the draws use are done already (see 'RecordMeshDraws()'), waiting for them makes
+		// their writes visible to the graphics queue.
 		VkSemaphore waitSemaphores[]{
-			frameRes[frame].imageAvailableSemaphore
+			frameRes[frame].imageAvailableSemaphore,
+			uploadScheduler.GetTimelineSemaphore()
 		};
 		VkPipelineStageFlags waitStages[]{
-			VkPipelineStageFlagBits::VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+			VkPipelineStageFlagBits::VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			VkPipelineStageFlagBits::VK_PIPELINE_STAGE_VERTEX_INPUT_BIT
+		};
+		uint64_t waitValues[]{
+			0, // Binary semaphore, ignored.
+			uploadScheduler.GetCompletedValue()
 		};
 		VkSemaphore signalSemaphores[]{
 			swapchainImageRes[imageIdx].renderingFinishedSemaphore
 		};
+		VkTimelineSemaphoreSubmitInfo timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.waitSemaphoreValueCount = 2;
+		timelineInfo.pWaitSemaphoreValues = waitValues;
 		VkSubmitInfo submitInfo{};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.waitSemaphoreCount = 2;
 		submitInfo.pWaitSemaphores = waitSemaphores;
 		submitInfo.pWaitDstStageMask = waitStages;
 		submitInfo.commandBufferCount = 1;
@@ -238,6 +339,8 @@ namespace ember {
 						  &submitInfo, frameRes[frame].frameFinishedFence) != VK_SUCCESS) {
 			throw std::runtime_error{"Failed to submit a command buffer to the graphics queue!"};
 		}
+		frameRes[frame].submissionIdx = nextSubmissionIdx++;
+		stagingRing.CloseSubmission(frameRes[frame].submissionIdx);
 	}
 	void GpuApiCtxVk::Present() {
 		VkSemaphore signalSemaphores[]{
@@ -269,25 +372,36 @@ namespace ember {
 	}
 
 	void GpuApiCtxVk::CreateMeshGpuResource(const Mesh* mesh) {
-		// TODO
+		// Nothing is uploaded until the frame is drawn.
+		GetMeshGpuResource(mesh);
 	}
 	void GpuApiCtxVk::DeleteMeshGpuResource(const Mesh* mesh) {
-		// TODO
+		auto searchResult = meshGpuResources.find(mesh);
+		if (searchResult == meshGpuResources.end()) {
+			return;
+		}
+		// The frames in flight may still draw it.
+		FreeBufferRangeDeferred(vertexBufferArena, searchResult->second.vertexBuffer);
+		FreeBufferRangeDeferred(indexBufferArena, searchResult->second.indexBuffer);
+		meshGpuResources.erase(searchResult);
 	}
 	void GpuApiCtxVk::OnMeshSettingsChange(const Mesh* mesh) {
-		// TODO
+		GetMeshGpuResource(mesh).settingsDirty = true;
 	}
 	void GpuApiCtxVk::OnMeshVertexBufferUpdate(const Mesh* mesh) {
-		// 1. Update the vertex buffer data right away
-		std::vector<char> vertexBuffer = mesh->ConstructMeshVertexBuffer();
-		// 2. Notify about the change, but postpone the operation
-		// TODO
+		VulkanMeshGpuResource& meshRes = GetMeshGpuResource(mesh);
+		meshRes.vertexBufferDirty = true;
+		// The vertex layout, and with it the pipeline, may have changed as well.
+		meshRes.settingsDirty = true;
 	}
 	void GpuApiCtxVk::OnMeshIndexBufferUpdate(const Mesh* mesh) {
-		// 1. Update the index buffer data right away
-		std::vector<char> indexBuffer = mesh->ConstructMeshIndexBuffer();
-		// 2. Notify about the change, but postpone the operation
-		// TODO
+		GetMeshGpuResource(mesh).indexBufferDirty = true;
+	}
+	void GpuApiCtxVk::OnMeshVertexBufferRangeUpdate(const Mesh* mesh, uint32_t firstVertex, uint32_t vertexCount) {
+		GetMeshGpuResource(mesh).dirtyVertexRange.Add(firstVertex, vertexCount);
+	}
+	void GpuApiCtxVk::OnMeshIndexBufferRangeUpdate(const Mesh* mesh, uint32_t firstIndex, uint32_t indexCount) {
+		GetMeshGpuResource(mesh).dirtyIndexRange.Add(firstIndex, indexCount);
 	}
 
 	const SettingsVk& GpuApiCtxVk::GetSettingsVk() const {
@@ -623,24 +737,37 @@ namespace ember {
 	}
 #endif
 
+	// The lower the better, see 'IsPhysicalDeviceSuitable()' for the types that are accepted at all.
+	static uint32_t GetPhysicalDeviceTypeRank(VkPhysicalDeviceType deviceType) {
+		switch (deviceType) {
+			case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+				return 0;
+			case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+				return 1;
+			default:
+				return 2;
+		}
+	}
+
 	void GpuApiCtxVk::PickVulkanPhysicalDevice() {
 		// Our goal here is to pick a discrete GPU if there are any.
-		// If there are none, then we can settle with an integrated one.
+		// If there are none, then we can settle with an integrated one, and then with a CPU implementation.
 		// If we don't have that either, then we throw an exception.
 		std::vector<VulkanPhysicalDeviceInfo> supportedDevicesInfo = EnumerateSupportedVulkanPhysicalDevices();
 		LogSupportedVulkanDevices(supportedDevicesInfo);
 		
 		const VulkanPhysicalDeviceInfo* pickedDeviceInfo{nullptr};
+		uint32_t pickedDeviceRank{~0u};
 		for (const VulkanPhysicalDeviceInfo& checkDeviceInfo : supportedDevicesInfo) {
 			if (IsPhysicalDeviceSuitable(checkDeviceInfo)) {
-				VkPhysicalDeviceType checkDeviceType = checkDeviceInfo.deviceProperties.deviceType;
-				// We pick the first available discrete GPU or
-				// if there is no other choice, we settle with the first available integrated one.
-				if (!pickedDeviceInfo || checkDeviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+				uint32_t checkDeviceRank = GetPhysicalDeviceTypeRank(checkDeviceInfo.deviceProperties.deviceType);
+				// We pick the first available device of the best type.
+				if (checkDeviceRank < pickedDeviceRank) {
 					pickedDeviceInfo = &checkDeviceInfo;
-				// The check below is to make sure that the first available discrete GPU is chosen
-				// If, however, you want to choose the last available from the list, just comment the check below.
-				if (checkDeviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+					pickedDeviceRank = checkDeviceRank;
+				}
+				// There's nothing better than the first available discrete GPU.
+				if (pickedDeviceRank == 0)
 					break;
 			}
 		}
@@ -652,6 +779,15 @@ namespace ember {
 			pickedDeviceInfo->queueFamilyIds.graphicsQueueFamily.value();
 		vulkanData.deviceData.presentationQueueFamily.queueFamilyId =
 			pickedDeviceInfo->queueFamilyIds.presentQueueFamily.value();
+		// Without a dedicated transfer queue family (e.g. the CPU implementations have a single queue family),
+		// the transfer queue is the graphics one: 'CreateVulkanLogicalDevice()' creates a single queue
+		// for the family, and the buffers aren't shared between the families.
+		const VulkanQueueFamilyIndices& queueFamilyIds = pickedDeviceInfo->queueFamilyIds;
+		if (settings.useDedicatedTransferQueueFamily && queueFamilyIds.HasTransferQueueFamily()) {
+			vulkanData.deviceData.transferQueueFamily.queueFamilyId = queueFamilyIds.transferQueueFamily.value();
+		} else {
+			vulkanData.deviceData.transferQueueFamily.queueFamilyId = vulkanData.deviceData.graphicsQueueFamily.queueFamilyId;
+		}
 	}
 	void GpuApiCtxVk::LogSupportedVulkanDevices(const std::vector<VulkanPhysicalDeviceInfo>& supportedDevices) const {
 		std::cout << "\n";
@@ -668,10 +804,12 @@ namespace ember {
 	}
 
 	bool GpuApiCtxVk::IsPhysicalDeviceSuitable(const VulkanPhysicalDeviceInfo& deviceInfo) const {
-		// We only accept discrete and integrated GPUs.
+		// We accept discrete and integrated GPUs, and the CPU implementations (e.g. lavapipe, SwiftShader)
+		// as the last resort, see 'GetPhysicalDeviceTypeRank()'.
 		VkPhysicalDeviceType deviceType = deviceInfo.deviceProperties.deviceType;
 		if (deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU &&
-			deviceType != VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU) {
+			deviceType != VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU &&
+			deviceType != VK_PHYSICAL_DEVICE_TYPE_CPU) {
 			return false;
 		}
 		// All device features must be supported.
@@ -683,6 +821,9 @@ namespace ember {
 		if (!deviceInfo.queueFamilyIds.Complete()) {
 			return false;
 		}
+		if (!deviceInfo.timelineSemaphoreSupported) {
+			return false;
+		}
 		// All requested device extensions must be supported.
 		if (!RequestedVulkanDeviceExtensionsSupported(
 			deviceInfo.deviceExtensions,
@@ -717,6 +858,8 @@ namespace ember {
 			deviceQueryInfo.deviceFeatures = GetVulkanPhysicalDeviceFeatures(deviceHandle);
 			deviceQueryInfo.deviceExtensions = EnumerateSupportedDeviceExtensions(deviceHandle);
 			deviceQueryInfo.queueFamilyIds = GetVulkanPhysicalDeviceQueueFamilies(deviceHandle);
+			deviceQueryInfo.timelineSemaphoreSupported = GetVulkanPhysicalDeviceTimelineSemaphoreSupport(
+				deviceHandle, deviceQueryInfo.deviceProperties.apiVersion);
 			deviceQueryInfo.swapchainInfo = QuerySwapchainSupport(deviceHandle);
 			supportedDevicesInfo[deviceIdx] = std::move(deviceQueryInfo);
 			deviceIdx++;
@@ -760,8 +903,33 @@ namespace ember {
 				break;
 			queueFamilyId++;
 		}
+		// Any family without the graphics operations that can copy, preferably one that can't compute either.
+		for (queueFamilyId = 0; queueFamilyId < queueFamilyCount; queueFamilyId++) {
+			VkQueueFlags queueFlags = queueFamilyProperties[queueFamilyId].queueFlags;
+			if (!(queueFlags & VK_QUEUE_TRANSFER_BIT) || (queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+				continue;
+			}
+			if (!queueFamilyIds.transferQueueFamily.has_value() || !(queueFlags & VK_QUEUE_COMPUTE_BIT)) {
+				queueFamilyIds.transferQueueFamily = queueFamilyId;
+			}
+			if (!(queueFlags & VK_QUEUE_COMPUTE_BIT))
+				break;
+		}
 		return queueFamilyIds;
 	}
+	bool GpuApiCtxVk::GetVulkanPhysicalDeviceTimelineSemaphoreSupport(VkPhysicalDevice device, uint32_t apiVersion) const {
+		// Core since Vulkan 1.2, the uploads are synchronized with them.
+		if (apiVersion < VK_API_VERSION_1_2) {
+			return false;
+		}
+		VkPhysicalDeviceVulkan12Features vulkan12Features{};
+		vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		VkPhysicalDeviceFeatures2 deviceFeatures{};
+		deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		deviceFeatures.pNext = &vulkan12Features;
+		vkGetPhysicalDeviceFeatures2(device, &deviceFeatures);
+		return vulkan12Features.timelineSemaphore == VK_TRUE;
+	}
 
 	VkPhysicalDeviceFeatures GpuApiCtxVk::EnumerateRequestedDeviceFeatures() const {
 		VkPhysicalDeviceFeatures requestedFeatures{};
@@ -844,6 +1012,7 @@ namespace ember {
 		std::unordered_set<uint32_t> uniqueQueueFamilies;
 		uniqueQueueFamilies.insert(vulkanData.deviceData.graphicsQueueFamily.queueFamilyId);
 		uniqueQueueFamilies.insert(vulkanData.deviceData.presentationQueueFamily.queueFamilyId);
+		uniqueQueueFamilies.insert(vulkanData.deviceData.transferQueueFamily.queueFamilyId);
 
 		uint32_t i{0};
 		float queuePriority{1.0f};
@@ -863,6 +1032,10 @@ namespace ember {
 		deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
 
 		deviceCreateInfo.pEnabledFeatures = &vulkanData.deviceData.requestedFeatures;
+		VkPhysicalDeviceVulkan12Features vulkan12Features{};
+		vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		vulkan12Features.timelineSemaphore = VK_TRUE;
+		deviceCreateInfo.pNext = &vulkan12Features;
 		deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(vulkanData.deviceData.requestedDeviceExtensions.size());
 		deviceCreateInfo.ppEnabledExtensionNames = vulkanData.deviceData.requestedDeviceExtensions.data();
 
@@ -897,6 +1070,11 @@ namespace ember {
 			vulkanData.GetPresentationQueueFamily().queueFamilyId,
 			0,
 			&vulkanData.GetPresentationQueueFamily().queueHandle);
+		vkGetDeviceQueue(
+			vulkanData.GetLogicalDevice(),
+			vulkanData.GetTransferQueueFamily().queueFamilyId,
+			0,
+			&vulkanData.GetTransferQueueFamily().queueHandle);
 	}
 
 	void GpuApiCtxVk::PickSwapchainProperties() {
@@ -1070,6 +1248,7 @@ namespace ember {
 	void GpuApiCtxVk::ResizeSwapchain() {
 		DestroySwapchainImageResourceSynchronizationObjects();
 		DestroyFramebuffers();
+		DestroyDepthBuffer();
 		DestroySwapchainImageViews();
 		DestroySwapchain();
 
@@ -1080,6 +1259,7 @@ namespace ember {
 		swapchainImageRes.resize(vulkanData.GetSwapchainData().swapchainImageCount);
 		AcquireSwapchainImages();
 		CreateSwapchainImageViews();
+		CreateDepthBuffer();
 		CreateFramebuffers();
 		CreateSwapchainImageResourceSynchronizationObjects();
 	}
@@ -1091,33 +1271,98 @@ namespace ember {
 			ResizeSwapchain();
 	}
 
-	void GpuApiCtxVk::CreateGraphicsPipeline() {
-		graphicsPipeline = std::make_shared<VulkanGraphicsPipeline>();
-		graphicsPipeline->SetAttachmentCount(1);
+	void GpuApiCtxVk::CreateRenderPass() {
+		renderPass = std::make_shared<VulkanRenderPass>();
+		renderPass->SetAttachmentCount(2);
+		VkFormat colorAttachmentFormat = vulkanData.GetSwapchainData().swapchainSurfaceFormat.format;
+		renderPass->SetPresentRenderTargetColorAttachment(colorAttachmentFormat, 0);
+		renderPass->SetDepthAttachment(1, false);
+
+		renderPass->SetSubpassCount(1);
+		renderPass->SetSubpassColorAttachmentCount(0, 1);
+		renderPass->SetSubpassColorAttachmentReference(0, 0, 0);
+		renderPass->SetSubpassDepthStencilAttachmentReference(1, 0);
+
+		// The swapchain image is written once it's acquired (the semaphore is waited for at the color output),
+		// and the depth buffer once the previous frame is done with it.
+		VkSubpassDependency subpassDependency{};
+		subpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+		subpassDependency.dstSubpass = 0;
+		subpassDependency.srcStageMask =
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		subpassDependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		subpassDependency.dstStageMask =
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+		subpassDependency.dstAccessMask =
+			VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		renderPass->SetSubpassDependencyCount(1);
+		renderPass->SetSubpassDependency(subpassDependency, 0);
+
+		renderPass->CreateRenderPass(vulkanData.GetLogicalDevice());
+	}
+	void GpuApiCtxVk::CreatePipelineLayout() {
+		pipelineLayout = std::make_shared<VulkanPipelineLayout>();
+		VkPushConstantRange meshPushConstantRange{};
+		meshPushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		meshPushConstantRange.offset = 0;
+		meshPushConstantRange.size = sizeof(VulkanMeshPushConstants);
+		pipelineLayout->AddPushConstantRange(meshPushConstantRange);
+		pipelineLayout->CreatePipelineLayout(vulkanData.GetLogicalDevice());
+	}
 
-		VulkanShaderModule vertexShaderModule{};
-		std::filesystem::path vshaderRelPath = std::filesystem::path{ "resource/shaders/spirv/vshader.spv" }.make_preferred();
-		vertexShaderModule.shaderPath = std::filesystem::current_path() / vshaderRelPath;
-		vertexShaderModule.entryPoint = std::string{ "main" };
-		vertexShaderModule.shaderType = SHADER_TYPE::VERTEX_SHADER;
+	void GpuApiCtxVk::CreateMeshShaderModules() {
+		// Until there are transforms, the positions are in the clip space already.
+		std::filesystem::path vshaderRelPath = std::filesystem::path{ "resource/shaders/spirv/triag_vert_shader.spv" }.make_preferred();
+		meshVertexShaderModule.shaderPath = std::filesystem::current_path() / vshaderRelPath;
+		meshVertexShaderModule.entryPoint = std::string{ "main" };
+		meshVertexShaderModule.shaderType = SHADER_TYPE::VERTEX_SHADER;
 		VulkanShaderFactory::CreateShaderModule(
-			vertexShaderModule, vulkanData.deviceData.logicalDevice);
-		graphicsPipeline->SetVertexShaderModule(vertexShaderModule);
-
-		VulkanShaderModule fragmentShaderModule;
-		std::filesystem::path fshaderRelPath = std::filesystem::path{ "resource/shaders/spirv/fshader.spv" }.make_preferred();
-		fragmentShaderModule.shaderPath = std::filesystem::current_path() / fshaderRelPath;
-		fragmentShaderModule.entryPoint = std::string{ "main" };
-		fragmentShaderModule.shaderType = SHADER_TYPE::FRAGMENT_SHADER;
+			meshVertexShaderModule, vulkanData.deviceData.logicalDevice);
+
+		std::filesystem::path fshaderRelPath = std::filesystem::path{ "resource/shaders/spirv/triag_frag_shader.spv" }.make_preferred();
+		meshFragmentShaderModule.shaderPath = std::filesystem::current_path() / fshaderRelPath;
+		meshFragmentShaderModule.entryPoint = std::string{ "main" };
+		meshFragmentShaderModule.shaderType = SHADER_TYPE::FRAGMENT_SHADER;
 		VulkanShaderFactory::CreateShaderModule(
-			fragmentShaderModule, vulkanData.deviceData.logicalDevice);
-		graphicsPipeline->SetFragmentShaderModule(fragmentShaderModule);
+			meshFragmentShaderModule, vulkanData.deviceData.logicalDevice);
+	}
+	void GpuApiCtxVk::DestroyMeshShaderModules() {
+		VulkanShaderFactory::DestroyShaderModule(meshVertexShaderModule, vulkanData.deviceData.logicalDevice);
+		VulkanShaderFactory::DestroyShaderModule(meshFragmentShaderModule, vulkanData.deviceData.logicalDevice);
+	}
+	uint32_t GpuApiCtxVk::GetMeshPipeline(const VulkanMeshPipelineKey& key) {
+		// A handful of vertex layouts in practice.
+		for (uint32_t pipelineIdx = 0; pipelineIdx < meshPipelines.size(); pipelineIdx++) {
+			if (meshPipelines[pipelineIdx].key == key) {
+				return pipelineIdx;
+			}
+		}
+
+		std::shared_ptr<VulkanGraphicsPipeline> pipeline = std::make_shared<VulkanGraphicsPipeline>();
+		pipeline->SetAttachmentCount(1);
+		pipeline->SetVertexShaderModule(meshVertexShaderModule);
+		pipeline->SetFragmentShaderModule(meshFragmentShaderModule);
 
-		graphicsPipeline->AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT);
-		graphicsPipeline->AddDynamicState(VK_DYNAMIC_STATE_SCISSOR);
+		// The shader reads the position from the location 0 and the color from the location 1.
+		std::vector<VkVertexInputBindingDescription> bindings{
+			VkVertexInputBindingDescription{0, key.vertexStride, VK_VERTEX_INPUT_RATE_VERTEX}
+		};
+		std::vector<VkVertexInputAttributeDescription> attributes{
+			VkVertexInputAttributeDescription{0, 0, PickVulkanVertexAttribFormat(key.position), key.position.offset}
+		};
+		if (key.color.dimension > 0) {
+			attributes.push_back(
+				VkVertexInputAttributeDescription{1, 0, PickVulkanVertexAttribFormat(key.color), key.color.offset});
+		} else {
+			// Every vertex reads the same 'defaultColorBuffer'.
+			bindings.push_back(VkVertexInputBindingDescription{1, 0, VK_VERTEX_INPUT_RATE_VERTEX});
+			attributes.push_back(VkVertexInputAttributeDescription{1, 1, VK_FORMAT_R32G32B32_SFLOAT, 0});
+		}
+		pipeline->SetVertexInputDescription(bindings, attributes);
 
-		// TODO: vertex input layout
-		graphicsPipeline->SetPrimitiveTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+		pipeline->AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT);
+		pipeline->AddDynamicState(VK_DYNAMIC_STATE_SCISSOR);
+		pipeline->SetPrimitiveTopology(key.topology);
 
 		VkExtent2D swapchainExtent = vulkanData.GetSwapchainData().swapchainExtent;
 		VkViewport viewport{};
@@ -1127,49 +1372,101 @@ namespace ember {
 		viewport.height = static_cast<float>(swapchainExtent.height);
 		viewport.minDepth = 0.0f;
 		viewport.maxDepth = 1.0f;
-		graphicsPipeline->SetViewport(viewport);
+		pipeline->SetViewport(viewport);
 
 		VkRect2D scissors{};
 		scissors.offset = VkOffset2D{ 0, 0 };
 		scissors.extent = swapchainExtent;
-		graphicsPipeline->SetScissors(scissors);
+		pipeline->SetScissors(scissors);
 
-		VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
-		graphicsPipeline->SetPolygonMode(polygonMode);
-		VkCullModeFlagBits cullMode = VK_CULL_MODE_BACK_BIT;
-		graphicsPipeline->SetCullMode(cullMode);
-		VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-		graphicsPipeline->SetFrontFace(frontFace);
-		graphicsPipeline->SetLineWidth(1.0f);
+		pipeline->SetPolygonMode(VK_POLYGON_MODE_FILL);
+		pipeline->SetCullMode(key.cullBackFaces ? VK_CULL_MODE_BACK_BIT : VK_CULL_MODE_NONE);
+		pipeline->SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE);
+		pipeline->SetLineWidth(1.0f);
 
-		graphicsPipeline->DisableMultisampling();
-		graphicsPipeline->SetDefaultBlendingAttachmentState(false, 0);
+		pipeline->DisableMultisampling();
+		pipeline->EnableDepthTest(VK_COMPARE_OP_LESS);
+		pipeline->SetDefaultBlendingAttachmentState(false, 0);
 
-		CreateRenderPass();
-		graphicsPipeline->SetRenderPass(renderPass);
-		CreatePipelineLayout();
-		graphicsPipeline->SetPipelineLayout(pipelineLayout);
+		pipeline->SetRenderPass(renderPass);
+		pipeline->SetPipelineLayout(pipelineLayout);
 
-		graphicsPipeline->CreatePipeline(vulkanData.GetLogicalDevice());
+		pipeline->CreatePipeline(vulkanData.GetLogicalDevice());
 
-		VulkanShaderFactory::DestroyShaderModule(vertexShaderModule, vulkanData.deviceData.logicalDevice);
-		VulkanShaderFactory::DestroyShaderModule(fragmentShaderModule, vulkanData.deviceData.logicalDevice);
+		meshPipelines.push_back(VulkanMeshPipeline{key, pipeline});
+		return static_cast<uint32_t>(meshPipelines.size() - 1);
+	}
+	void GpuApiCtxVk::DestroyMeshPipelines() {
+		for (VulkanMeshPipeline& meshPipeline : meshPipelines) {
+			meshPipeline.pipeline->DestroyPipeline(vulkanData.GetLogicalDevice());
+		}
+		meshPipelines.clear();
 	}
-	void GpuApiCtxVk::CreateRenderPass() {
-		renderPass = std::make_shared<VulkanRenderPass>();
-		renderPass->SetAttachmentCount(1);
-		VkFormat colorAttachmentFormat = vulkanData.GetSwapchainData().swapchainSurfaceFormat.format;
-		renderPass->SetPresentRenderTargetColorAttachment(colorAttachmentFormat, 0);
 
-		renderPass->SetSubpassCount(1);
-		renderPass->SetSubpassColorAttachmentCount(0, 1);
-		renderPass->SetSubpassColorAttachmentReference(0, 0, 0);
+	void GpuApiCtxVk::CreateDepthBuffer() {
+		VkDevice device = vulkanData.GetLogicalDevice();
+		VkPhysicalDevice physicalDevice = vulkanData.GetPhysicalDevice();
+		VkFormatProperties formatProperties{};
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, depthFormat, &formatProperties);
+		if ((formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) == 0) {
+			throw std::runtime_error{"The depth buffer format isn't supported!"};
+		}
 
-		renderPass->CreateRenderPass(vulkanData.GetLogicalDevice());
-	}
-	void GpuApiCtxVk::CreatePipelineLayout() {
-		pipelineLayout = std::make_shared<VulkanPipelineLayout>();
-		pipelineLayout->CreatePipelineLayout(vulkanData.GetLogicalDevice());
+		const VulkanSwapchainData& swapchainData = vulkanData.GetSwapchainData();
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = depthFormat;
+		imageInfo.extent = VkExtent3D{swapchainData.swapchainExtent.width, swapchainData.swapchainExtent.height, 1};
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		if (vkCreateImage(device, &imageInfo, nullptr, &depthImage) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to create the depth buffer!"};
+		}
+
+		VkMemoryRequirements memoryRequirements{};
+		vkGetImageMemoryRequirements(device, depthImage, &memoryRequirements);
+		VkMemoryAllocateInfo allocateInfo{};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocateInfo.allocationSize = memoryRequirements.size;
+		if (!FindVulkanMemoryTypeIndex(physicalDevice, memoryRequirements.memoryTypeBits,
+		                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, allocateInfo.memoryTypeIndex)) {
+			throw std::runtime_error{"No suitable memory type for the depth buffer!"};
+		}
+		if (vkAllocateMemory(device, &allocateInfo, nullptr, &depthImageMemory) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to allocate the memory of the depth buffer!"};
+		}
+		if (vkBindImageMemory(device, depthImage, depthImageMemory, 0) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to bind the memory of the depth buffer!"};
+		}
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = depthImage;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = depthFormat;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+		if (vkCreateImageView(device, &viewInfo, nullptr, &depthImageView) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to create an image view for the depth buffer!"};
+		}
+	}
+	void GpuApiCtxVk::DestroyDepthBuffer() {
+		VkDevice device = vulkanData.GetLogicalDevice();
+		vkDestroyImageView(device, depthImageView, nullptr);
+		vkDestroyImage(device, depthImage, nullptr);
+		vkFreeMemory(device, depthImageMemory, nullptr);
+		depthImageView = VK_NULL_HANDLE;
+		depthImage = VK_NULL_HANDLE;
+		depthImageMemory = VK_NULL_HANDLE;
 	}
 
 	void GpuApiCtxVk::CreateFramebuffers() {
@@ -1180,8 +1477,9 @@ namespace ember {
 				swapchainData.swapchainExtent.width,
 				swapchainData.swapchainExtent.height);
 			imageRes.framebuffer.SetRenderPass(renderPass);
-			imageRes.framebuffer.SetAttachmentCount(1);
+			imageRes.framebuffer.SetAttachmentCount(2);
 			imageRes.framebuffer.SetAttachment(imageRes.imageView, 0);
+			imageRes.framebuffer.SetAttachment(depthImageView, 1);
 			imageRes.framebuffer.CreateFramebuffer(vulkanData.GetLogicalDevice());
 		}
 	}
@@ -1204,10 +1502,25 @@ namespace ember {
 								&graphicsQueueFamily.commandPool) != VK_SUCCESS) {
 			throw std::runtime_error{"Failed to create a graphics command pool!"};
 		}
+
+		VulkanQueueFamily& transferQueueFamily = vulkanData.GetTransferQueueFamily();
+		VkCommandPoolCreateInfo transferCommandPoolInfo{};
+		transferCommandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		transferCommandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT |
+		                                VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		transferCommandPoolInfo.queueFamilyIndex = transferQueueFamily.queueFamilyId;
+		if (vkCreateCommandPool(vulkanData.GetLogicalDevice(),
+								&transferCommandPoolInfo,
+								nullptr,
+								&transferQueueFamily.commandPool) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to create a transfer command pool!"};
+		}
 	}
 	void GpuApiCtxVk::DestroyCommandPools() {
 		VulkanQueueFamily& graphicsQueueFamily = vulkanData.GetGraphicsQueueFamily();
 		vkDestroyCommandPool(vulkanData.GetLogicalDevice(), graphicsQueueFamily.commandPool, nullptr);
+		VulkanQueueFamily& transferQueueFamily = vulkanData.GetTransferQueueFamily();
+		vkDestroyCommandPool(vulkanData.GetLogicalDevice(), transferQueueFamily.commandPool, nullptr);
 	}
 	void GpuApiCtxVk::CreateCommandBuffers() {
 		VulkanQueueFamily& graphicsQueueFamily = vulkanData.GetGraphicsQueueFamily();
@@ -1232,6 +1545,8 @@ namespace ember {
 			throw std::runtime_error{ "Failed to start a command buffer!" };
 		}
 
+		RecordUploads(commandBuffer);
+
 		VkRenderPassBeginInfo renderPassBeginInfo{};
 		renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 		renderPassBeginInfo.renderPass = renderPass->GetRenderPass();
@@ -1247,12 +1562,13 @@ namespace ember {
 			33.0f / 255.0f, // std::pow(33.0f / 255.0f, 2.2f),
 			1.0f
 		};
-		VkClearValue clearValue{clearColor};
-		renderPassBeginInfo.clearValueCount = 1;
-		renderPassBeginInfo.pClearValues = &clearValue;
+		VkClearValue clearValues[2]{};
+		clearValues[0].color = clearColor;
+		clearValues[1].depthStencil = VkClearDepthStencilValue{1.0f, 0};
+		renderPassBeginInfo.clearValueCount = 2;
+		renderPassBeginInfo.pClearValues = clearValues;
 
 		vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline->GetPipeline());
 
 		VkViewport viewport{};
 		viewport.x = 0.0f;
@@ -1267,15 +1583,7 @@ namespace ember {
 		scissors.extent = vulkanData.GetSwapchainData().swapchainExtent;
 		vkCmdSetScissor(commandBuffer, 0, 1, &scissors);
 
-		// The draw call
-		// VkBuffer vertexBuffers[] = { dynamicVertexBuffer->GetBufferHandle() };
-		// VkBuffer vertexBuffers[] = { staticVertexBuffer->GetBufferHandle() };
-		// VkDeviceSize offsets[] = { 0 };
-		// vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-		// vkCmdDraw(commandBuffer, staticVertexBuffer->GetVertexCount(), 1, 0, 0);
-		// vkCmdDraw(commandBuffer, vertexBuffer->GetVertexCount(), 1, 0, 0);
-		// vkCmdDraw(commandBuffer, static_cast<uint32_t>(vertices.size()), 1, 0, 0);
-		vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+		RecordMeshDraws(commandBuffer);
 
 		vkCmdEndRenderPass(commandBuffer);
 		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
@@ -1283,6 +1591,392 @@ namespace ember {
 		}
 	}
 
+	void GpuApiCtxVk::RecordUploads(VkCommandBuffer commandBuffer) {
+		if (pendingUploads.empty()) {
+			return;
+		}
+		// The ranges that are overwritten may still be read by the previous frames.
+		vkCmdPipelineBarrier(commandBuffer,
+		                     VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		                     0, nullptr, 0, nullptr, 0, nullptr);
+
+		RecordVulkanBufferUploads(commandBuffer, stagingRing.GetBuffer(), pendingUploads);
+		pendingUploads.clear();
+
+		VkMemoryBarrier uploadBarrier{};
+		uploadBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		uploadBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		uploadBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer,
+		                     VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0,
+		                     1, &uploadBarrier, 0, nullptr, 0, nullptr);
+	}
+	void GpuApiCtxVk::RecordMeshDraws(VkCommandBuffer commandBuffer) {
+		meshBounds.Clear();
+		meshDrawList.clear();
+		for (auto& [mesh, meshRes] : meshGpuResources) {
+			if (meshRes.pipelineIdx == ~0u || !meshRes.vertexBuffer.IsValid()) {
+				continue;
+			}
+			if (!meshRes.resident) {
+				// Not until all of it is uploaded, the rest may be waiting for room in the staging ring.
+				bool uploadStaged = !meshRes.vertexBufferDirty && meshRes.dirtyVertexRange.IsEmpty() &&
+				                    !meshRes.indexBufferDirty && meshRes.dirtyIndexRange.IsEmpty();
+				if (!uploadStaged || meshRes.uploadValue > uploadScheduler.GetCompletedValue()) {
+					continue;
+				}
+				meshRes.resident = true;
+			}
+			// The shader dequantizes the positions, a quantized mesh ends up in its object AABB as well.
+			meshBounds.Add(mesh->GetObjectAABB());
+			meshDrawList.push_back(VulkanMeshDraw{mesh, &meshRes});
+		}
+		CullAabbs(visibleMeshes, clipSpaceFrustum, meshBounds.GetStreams(), meshBounds.GetSize());
+
+		// The positions are in the clip space, so the errors of the LODs are too. Half of the viewport per unit.
+		VkExtent2D swapchainExtent = vulkanData.GetSwapchainData().swapchainExtent;
+		float pixelsPerClipUnit = 0.5f * static_cast<float>(std::max(swapchainExtent.width, swapchainExtent.height));
+		float maxLodError = settings.meshLodPixelError / pixelsPerClipUnit;
+		CullOccludedMeshes(maxLodError);
+
+		uint32_t boundPipelineIdx{~0u};
+		for (uint32_t drawIdx : visibleMeshes) {
+			const VulkanMeshGpuResource& meshRes = *meshDrawList[drawIdx].meshRes;
+			if (meshRes.pipelineIdx != boundPipelineIdx) {
+				vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+				                  meshPipelines[meshRes.pipelineIdx].pipeline->GetPipeline());
+				boundPipelineIdx = meshRes.pipelineIdx;
+			}
+			// All of the pipelines share the layout, so the constants don't have to be pushed again after a bind.
+			vkCmdPushConstants(commandBuffer, pipelineLayout->GetPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT,
+			                   0, sizeof(VulkanMeshPushConstants), &meshRes.pushConstants);
+			VkBuffer vertexBuffers[]{
+				vertexBufferArena.GetBuffer(meshRes.vertexBuffer.pageIdx),
+				vertexBufferArena.GetBuffer(defaultColorBuffer.pageIdx)
+			};
+			VkDeviceSize offsets[]{
+				meshRes.vertexBuffer.offset,
+				defaultColorBuffer.offset
+			};
+			vkCmdBindVertexBuffers(commandBuffer, 0, meshRes.hasColors ? 1 : 2, vertexBuffers, offsets);
+			if (meshRes.indexCount > 0) {
+				vkCmdBindIndexBuffer(commandBuffer, indexBufferArena.GetBuffer(meshRes.indexBuffer.pageIdx),
+				                     meshRes.indexBuffer.offset, GetVulkanIndexType(meshRes.indexFormat));
+				uint32_t firstIndex{0};
+				uint32_t indexCount{meshRes.indexCount};
+				if (!meshRes.lods.empty()) {
+					const IndexBufferLod& lod = meshRes.lods[SelectMeshLod(meshRes.lods, maxLodError)];
+					firstIndex = lod.indexOffset;
+					indexCount = lod.indexCount;
+				}
+				vkCmdDrawIndexed(commandBuffer, indexCount, 1, firstIndex, 0, 0);
+			} else {
+				vkCmdDraw(commandBuffer, meshRes.vertexCount, 1, 0, 0);
+			}
+		}
+	}
+
+	void GpuApiCtxVk::CullOccludedMeshes(float maxLodError) {
+		// The screen is 2x2 in the clip space, so the part of it that a box covers is the product of its half sizes.
+		const AabbStreams& boxes = meshBounds.GetStreams();
+		auto getScreenArea = [&](uint32_t drawIdx) {
+			return boxes.extent[0][drawIdx] * boxes.extent[1][drawIdx];
+		};
+		occluders.clear();
+		for (uint32_t drawIdx : visibleMeshes) {
+			if (getScreenArea(drawIdx) >= settings.occluderMinScreenArea) {
+				occluders.push_back(drawIdx);
+			}
+		}
+		if (occluders.empty()) {
+			return;
+		}
+		// The biggest ones first, the tiles fill up faster.
+		std::sort(occluders.begin(), occluders.end(), [&](uint32_t lhs, uint32_t rhs) {
+			return getScreenArea(lhs) > getScreenArea(rhs);
+		});
+
+		static const numa::Mat4 identity{1.0f};
+		occlusionCuller.BeginFrame(identity);
+		for (uint32_t drawIdx : occluders) {
+			// The LOD that's drawn, a coarser one could reach past what's on the screen and hide too much.
+			const VulkanMeshGpuResource& meshRes = *meshDrawList[drawIdx].meshRes;
+			uint32_t lodLevel = meshRes.lods.empty() ? 0 : SelectMeshLod(meshRes.lods, maxLodError);
+			occlusionCuller.AddOccluder(*meshDrawList[drawIdx].mesh, identity, lodLevel);
+		}
+		occlusionCuller.RasterizeOccluders();
+		// A mesh doesn't hide itself: its triangles are inside of its bounds, never in front of them.
+		occlusionCuller.CullAabbs(visibleMeshes, boxes, visibleMeshes.data(), visibleMeshes.size());
+	}
+
+	void GpuApiCtxVk::CreateMeshBuffers() {
+		VkDevice device = vulkanData.GetLogicalDevice();
+		VkPhysicalDevice physicalDevice = vulkanData.GetPhysicalDevice();
+		// Written by the transfer queue, read by the graphics one.
+		std::vector<uint32_t> queueFamilies{vulkanData.GetGraphicsQueueFamily().queueFamilyId};
+		if (vulkanData.GetTransferQueueFamily().queueFamilyId != queueFamilies[0]) {
+			queueFamilies.push_back(vulkanData.GetTransferQueueFamily().queueFamilyId);
+		}
+		vertexBufferArena.Initialize(device, physicalDevice,
+		                             VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, settings.meshVertexArenaPageSize,
+		                             queueFamilies);
+		indexBufferArena.Initialize(device, physicalDevice,
+		                            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, settings.meshIndexArenaPageSize,
+		                            queueFamilies);
+		stagingRing.Initialize(device, physicalDevice, settings.stagingRingSize);
+		const VulkanQueueFamily& transferQueueFamily = vulkanData.GetTransferQueueFamily();
+		uploadScheduler.Initialize(device, physicalDevice, transferQueueFamily.queueHandle,
+		                           transferQueueFamily.commandPool, settings.transferStagingRingSize);
+
+		const float white[3]{1.0f, 1.0f, 1.0f};
+		defaultColorBuffer = vertexBufferArena.Alloc(device, sizeof(white), meshBufferAlignment);
+		char* data = StageUpload(vertexBufferArena.GetBuffer(defaultColorBuffer.pageIdx),
+		                         defaultColorBuffer.offset, sizeof(white));
+		std::memcpy(data, white, sizeof(white));
+
+		// The frustum of the identity matrix is the clip space volume itself, Vulkan's depth is in [0, 1].
+		clipSpaceFrustum = ExtractFrustum(numa::Mat4{1.0f}, ClipDepthRange::ZERO_TO_ONE);
+	}
+	void GpuApiCtxVk::DestroyMeshBuffers() {
+		VkDevice device = vulkanData.GetLogicalDevice();
+		// The meshes that are still alive get new resources if the context is initialized again.
+		meshGpuResources.clear();
+		pendingUploads.clear();
+		deferredFrees.clear();
+		defaultColorBuffer = VulkanBufferRange{};
+		vertexBufferArena.Destroy(device);
+		indexBufferArena.Destroy(device);
+		stagingRing.Destroy(device);
+		uploadScheduler.Destroy(device);
+	}
+	VulkanMeshGpuResource& GpuApiCtxVk::GetMeshGpuResource(const Mesh* mesh) {
+		// A new resource is dirty, so everything gets uploaded.
+		return meshGpuResources[mesh];
+	}
+	void GpuApiCtxVk::UploadMeshes() {
+		for (auto& [mesh, meshRes] : meshGpuResources) {
+			// The settings first, they decide whether the data has to be uploaded whole.
+			if (meshRes.settingsDirty) {
+				UpdateMeshSettings(*mesh, meshRes);
+			}
+			if (meshRes.vertexBufferDirty || !meshRes.dirtyVertexRange.IsEmpty()) {
+				UploadMeshVertices(*mesh, meshRes);
+			}
+			if (meshRes.indexBufferDirty || !meshRes.dirtyIndexRange.IsEmpty()) {
+				UploadMeshIndices(*mesh, meshRes);
+			}
+		}
+		uploadScheduler.Submit(vulkanData.GetLogicalDevice());
+	}
+	void GpuApiCtxVk::UpdateMeshSettings(const Mesh& mesh, VulkanMeshGpuResource& meshRes) {
+		std::vector<VertexAttribDescriptor> layout = mesh.GetVertexAttribLayout();
+		VulkanMeshPipelineKey key{};
+		key.vertexStride = CalculateVertexStride(layout);
+		for (const VertexAttribDescriptor& attrib : layout) {
+			if (attrib.channel == VertexAttribChannel::POSITION) {
+				key.position = attrib;
+			} else if (attrib.channel == VertexAttribChannel::COLOR) {
+				key.color = attrib;
+			}
+		}
+		key.cullBackFaces = mesh.CullBackFaces();
+		meshRes.hasColors = key.color.dimension > 0;
+		if (key.position.dimension > 0 && PickVulkanPrimitiveTopology(mesh.GetMeshTopology(), key.topology)) {
+			meshRes.pipelineIdx = GetMeshPipeline(key);
+		} else {
+			meshRes.pipelineIdx = ~0u;
+		}
+		// The resident data doesn't match the new layout.
+		if (key.vertexStride != meshRes.vertexStride) {
+			meshRes.vertexBufferDirty = true;
+		}
+		if (PickVulkanIndexFormat(mesh.GetIndexFormat()) != meshRes.indexFormat) {
+			meshRes.indexBufferDirty = true;
+		}
+		meshRes.settingsDirty = false;
+	}
+	void GpuApiCtxVk::UploadMeshVertices(const Mesh& mesh, VulkanMeshGpuResource& meshRes) {
+		VertexBufferInfo vbInfo = mesh.GetVertexBufferInfo();
+		const std::vector<VertexAttribDescriptor>& layout = vbInfo.vertexAttribLayout;
+		uint32_t vertexStride = vbInfo.vertexStride;
+		// The whole buffer is encoded again whenever the quantization box changes.
+		meshRes.pushConstants = VulkanMeshPushConstants{
+			{vbInfo.positionScale.x, vbInfo.positionScale.y, vbInfo.positionScale.z, 0.0f},
+			{vbInfo.positionOffset.x, vbInfo.positionOffset.y, vbInfo.positionOffset.z, 0.0f},
+		};
+		uint32_t vertexCount = static_cast<uint32_t>(mesh.GetVertexCount());
+		uint32_t firstVertex{0};
+		uint32_t lastVertex{vertexCount};
+		if (meshRes.vertexBufferDirty || vertexStride != meshRes.vertexStride || vertexCount != meshRes.vertexCount) {
+			VkDeviceSize size = static_cast<VkDeviceSize>(vertexCount) * vertexStride;
+			// The range is reused if the size is the same, the barrier in 'RecordUploads()' covers it.
+			if (meshRes.vertexBuffer.size != size) {
+				FreeBufferRangeDeferred(vertexBufferArena, meshRes.vertexBuffer);
+				if (size > 0) {
+					meshRes.vertexBuffer = vertexBufferArena.Alloc(vulkanData.GetLogicalDevice(), size, meshBufferAlignment);
+				}
+			}
+			meshRes.vertexStride = vertexStride;
+			meshRes.vertexCount = vertexCount;
+		} else {
+			firstVertex = std::min(meshRes.dirtyVertexRange.begin, vertexCount);
+			lastVertex = std::min(meshRes.dirtyVertexRange.end, vertexCount);
+		}
+		meshRes.vertexBufferDirty = false;
+		meshRes.dirtyVertexRange = MeshDirtyRange{};
+		if (firstVertex >= lastVertex) {
+			return;
+		}
+
+		// A quarter of the ring at most, so that the big meshes don't flush the uploads every time.
+		VkDeviceSize ringSize = std::min(stagingRing.GetSize(), uploadScheduler.GetStagingSize());
+		uint32_t chunkVertexCount = static_cast<uint32_t>(std::max<VkDeviceSize>(ringSize / 4 / vertexStride, 1));
+		VkBuffer dstBuffer = vertexBufferArena.GetBuffer(meshRes.vertexBuffer.pageIdx);
+		for (uint32_t chunkFirst = firstVertex; chunkFirst < lastVertex; chunkFirst += chunkVertexCount) {
+			uint32_t chunkCount = std::min(chunkVertexCount, lastVertex - chunkFirst);
+			char* data = StageMeshUpload(meshRes, dstBuffer,
+			                             meshRes.vertexBuffer.offset + static_cast<VkDeviceSize>(chunkFirst) * vertexStride,
+			                             static_cast<VkDeviceSize>(chunkCount) * vertexStride);
+			if (!data) {
+				// The rest goes in the next frames.
+				meshRes.dirtyVertexRange.Add(chunkFirst, lastVertex - chunkFirst);
+				return;
+			}
+			mesh.ConstructMeshVertexBuffer(data, chunkFirst, chunkCount, layout);
+		}
+	}
+	void GpuApiCtxVk::UploadMeshIndices(const Mesh& mesh, VulkanMeshGpuResource& meshRes) {
+		IndexFormat indexFormat = PickVulkanIndexFormat(mesh.GetIndexFormat());
+		uint32_t indexSize = GetIndexFormatSizeInBytes(indexFormat);
+		// The LOD chain is uploaded along with the full detail indices.
+		uint32_t totalIndexCount = static_cast<uint32_t>(mesh.GetIndexCount() + mesh.GetLodIndices().size());
+		VkDeviceSize size = static_cast<VkDeviceSize>(totalIndexCount) * indexSize;
+		uint32_t firstIndex{0};
+		uint32_t lastIndex{totalIndexCount};
+		if (meshRes.indexBufferDirty || indexFormat != meshRes.indexFormat || size != meshRes.indexBuffer.size) {
+			if (meshRes.indexBuffer.size != size) {
+				FreeBufferRangeDeferred(indexBufferArena, meshRes.indexBuffer);
+				if (size > 0) {
+					meshRes.indexBuffer = indexBufferArena.Alloc(vulkanData.GetLogicalDevice(), size, meshBufferAlignment);
+				}
+			}
+			meshRes.indexFormat = indexFormat;
+		} else {
+			firstIndex = std::min(meshRes.dirtyIndexRange.begin, totalIndexCount);
+			lastIndex = std::min(meshRes.dirtyIndexRange.end, totalIndexCount);
+		}
+		meshRes.indexCount = static_cast<uint32_t>(mesh.GetIndexCount());
+		meshRes.lods = mesh.GetLods();
+		meshRes.indexBufferDirty = false;
+		meshRes.dirtyIndexRange = MeshDirtyRange{};
+		if (firstIndex >= lastIndex) {
+			return;
+		}
+
+		VkDeviceSize ringSize = std::min(stagingRing.GetSize(), uploadScheduler.GetStagingSize());
+		uint32_t chunkIndexCount = static_cast<uint32_t>(std::max<VkDeviceSize>(ringSize / 4 / indexSize, 1));
+		VkBuffer dstBuffer = indexBufferArena.GetBuffer(meshRes.indexBuffer.pageIdx);
+		for (uint32_t chunkFirst = firstIndex; chunkFirst < lastIndex; chunkFirst += chunkIndexCount) {
+			uint32_t chunkCount = std::min(chunkIndexCount, lastIndex - chunkFirst);
+			char* data = StageMeshUpload(meshRes, dstBuffer,
+			                             meshRes.indexBuffer.offset + static_cast<VkDeviceSize>(chunkFirst) * indexSize,
+			                             static_cast<VkDeviceSize>(chunkCount) * indexSize);
+			if (!data) {
+				meshRes.dirtyIndexRange.Add(chunkFirst, lastIndex - chunkFirst);
+				return;
+			}
+			mesh.ConstructMeshIndexBuffer(data, chunkFirst, chunkCount, indexFormat);
+		}
+	}
+	char* GpuApiCtxVk::StageUpload(VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size) {
+		VkDeviceSize stagingOffset{0};
+		char* data = stagingRing.Alloc(size, stagingAlignment, stagingOffset);
+		if (!data) {
+			FlushUploads();
+			data = stagingRing.Alloc(size, stagingAlignment, stagingOffset);
+			if (!data) {
+				throw std::runtime_error{"An upload is bigger than the staging ring!"};
+			}
+		}
+		pendingUploads.push_back(VulkanBufferUpload{dstBuffer, VkBufferCopy{stagingOffset, dstOffset, size}});
+		return data;
+	}
+	char* GpuApiCtxVk::StageMeshUpload(VulkanMeshGpuResource& meshRes, VkBuffer dstBuffer, VkDeviceSize dstOffset,
+	                                   VkDeviceSize size) {
+		if (meshRes.resident) {
+			// The frames draw it, the update can't wait.
+			return StageUpload(dstBuffer, dstOffset, size);
+		}
+		char* data = uploadScheduler.StageUpload(dstBuffer, dstOffset, size);
+		if (data) {
+			meshRes.uploadValue = uploadScheduler.GetPendingValue();
+		}
+		return data;
+	}
+	void GpuApiCtxVk::FlushUploads() {
+		VkDevice device = vulkanData.GetLogicalDevice();
+		VulkanQueueFamily& graphicsQueueFamily = vulkanData.GetGraphicsQueueFamily();
+
+		VkCommandBufferAllocateInfo commandBufferInfo{};
+		commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		commandBufferInfo.commandPool = graphicsQueueFamily.commandPool;
+		commandBufferInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		commandBufferInfo.commandBufferCount = 1;
+		VkCommandBuffer commandBuffer{VK_NULL_HANDLE};
+		if (vkAllocateCommandBuffers(device, &commandBufferInfo, &commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to allocate an upload command buffer!"};
+		}
+		VkCommandBufferBeginInfo commandBufferBeginInfo{};
+		commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		if (vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to start an upload command buffer!"};
+		}
+		RecordUploads(commandBuffer);
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to end an upload command buffer!"};
+		}
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		if (vkQueueSubmit(graphicsQueueFamily.queueHandle, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to submit an upload command buffer to the graphics queue!"};
+		}
+		uint64_t submissionIdx = nextSubmissionIdx++;
+		stagingRing.CloseSubmission(submissionIdx);
+		// A stall, but only when more is uploaded in a frame than the ring holds (e.g. while loading).
+		vkQueueWaitIdle(graphicsQueueFamily.queueHandle);
+		vkFreeCommandBuffers(device, graphicsQueueFamily.commandPool, 1, &commandBuffer);
+		ReleaseCompletedSubmissions(submissionIdx);
+	}
+	void GpuApiCtxVk::FreeBufferRangeDeferred(VulkanBufferArena& arena, VulkanBufferRange& range) {
+		if (!range.IsValid()) {
+			return;
+		}
+		// The next submission is the first one that can't use it anymore, everything up to it may.
+		deferredFrees.push_back(VulkanDeferredFree{&arena, range, nextSubmissionIdx, uploadScheduler.GetPendingValue()});
+		range = VulkanBufferRange{};
+	}
+	void GpuApiCtxVk::ReleaseCompletedSubmissions(uint64_t completedSubmissionIdx) {
+		// The submissions complete in order, a fence of an older frame says nothing new.
+		this->completedSubmissionIdx = std::max(this->completedSubmissionIdx, completedSubmissionIdx);
+		stagingRing.Release(this->completedSubmissionIdx);
+		uploadScheduler.Update(vulkanData.GetLogicalDevice());
+		auto firstPending = std::partition(deferredFrees.begin(), deferredFrees.end(),
+		                                   [this](const VulkanDeferredFree& deferredFree) {
+			return deferredFree.submissionIdx > this->completedSubmissionIdx ||
+			       deferredFree.uploadValue > uploadScheduler.GetCompletedValue();
+		});
+		for (auto it = firstPending; it != deferredFrees.end(); ++it) {
+			it->arena->Free(it->range);
+		}
+		deferredFrees.erase(firstPending, deferredFrees.end());
+	}
+
 	void GpuApiCtxVk::CreateSynchronizationObjects() {
 		CreateFrameResourceSynchronizationObjects();
 		CreateSwapchainImageResourceSynchronizationObjects();
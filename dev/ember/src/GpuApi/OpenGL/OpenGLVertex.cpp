@@ -0,0 +1,73 @@
+#include "GpuApi/OpenGL/OpenGLVertex.h"
+
+#include <cassert>
+
+namespace ember {
+
+	GLenum PickOpenGLVertexAttribType(VertexAttribFormat format) {
+		switch (format) {
+			case VertexAttribFormat::FLOAT32:
+				return GL_FLOAT;
+				break;
+			case VertexAttribFormat::FLOAT16:
+				return GL_HALF_FLOAT;
+				break;
+
+			case VertexAttribFormat::UINT32:
+				return GL_UNSIGNED_INT;
+				break;
+			case VertexAttribFormat::UINT16:
+			case VertexAttribFormat::UNORM16:
+				return GL_UNSIGNED_SHORT;
+				break;
+			case VertexAttribFormat::UINT8:
+			case VertexAttribFormat::UNORM8:
+				return GL_UNSIGNED_BYTE;
+				break;
+
+			case VertexAttribFormat::INT32:
+				return GL_INT;
+				break;
+			case VertexAttribFormat::INT16:
+			case VertexAttribFormat::SNORM16:
+			case VertexAttribFormat::OCT_SNORM16:
+				return GL_SHORT;
+				break;
+			case VertexAttribFormat::INT8:
+			case VertexAttribFormat::SNORM8:
+				return GL_BYTE;
+				break;
+
+			default:
+				assert(false && "Unknown vertex attribute format provided!");
+				return GL_FLOAT;
+				break;
+		}
+	}
+
+	bool IsOpenGLVertexAttribInteger(VertexAttribFormat format) {
+		return IsVertexAttribFormatInt(format) || IsVertexAttribFormatUint(format);
+	}
+	GLboolean IsOpenGLVertexAttribNormalized(VertexAttribFormat format) {
+		return IsVertexAttribFormatNormalized(format) ? GL_TRUE : GL_FALSE;
+	}
+
+	void SetOpenGLVertexAttribLayout(GLuint vao, GLuint bindingIndex,
+		                             const std::vector<VertexAttribDescriptor>& attribLayout) {
+		for (const VertexAttribDescriptor& attrib : attribLayout) {
+			GLuint location = static_cast<GLuint>(attrib.channel);
+			GLint size = static_cast<GLint>(attrib.dimension);
+			GLenum type = PickOpenGLVertexAttribType(attrib.format);
+			assert((attrib.format != VertexAttribFormat::OCT_SNORM16 || attrib.dimension == 2) &&
+			       "Octahedral encoding must have 2 components!");
+			glEnableVertexArrayAttrib(vao, location);
+			if (IsOpenGLVertexAttribInteger(attrib.format)) {
+				glVertexArrayAttribIFormat(vao, location, size, type, attrib.offset);
+			} else {
+				glVertexArrayAttribFormat(vao, location, size, type, IsOpenGLVertexAttribNormalized(attrib.format), attrib.offset);
+			}
+			glVertexArrayAttribBinding(vao, location, bindingIndex);
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "GpuApi/Vulkan/Memory/VulkanBufferArena.h"
+#include "GpuApi/Vulkan/Memory/VulkanMemory.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace ember {
+
+	bool VulkanBufferRange::IsValid() const {
+		return pageIdx != ~0u;
+	}
+
+	void VulkanBufferArena::Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkBufferUsageFlags usage,
+	                                   VkMemoryPropertyFlags memoryProperties, VkDeviceSize pageSize,
+	                                   const std::vector<uint32_t>& queueFamilies) {
+		assert(!initialized && "Arena is already initialized!");
+		this->physicalDevice = physicalDevice;
+		this->usage = usage;
+		this->memoryProperties = memoryProperties;
+		this->pageSize = pageSize;
+		this->queueFamilies = queueFamilies;
+		initialized = true;
+		AddPage(device, pageSize);
+	}
+	void VulkanBufferArena::Destroy(VkDevice device) {
+		assert(initialized && "Arena must be initialized first!");
+		for (Page& page : pages) {
+			vkDestroyBuffer(device, page.buffer, nullptr);
+			page.allocator.Destroy(device);
+		}
+		pages.clear();
+		initialized = false;
+	}
+
+	VulkanBufferRange VulkanBufferArena::Alloc(VkDevice device, VkDeviceSize size, uint32_t alignment) {
+		VulkanBufferRange range{};
+		range.size = size;
+		VulkanMemoryMarker marker{};
+		for (uint32_t pageIdx = 0; pageIdx < pages.size(); pageIdx++) {
+			if (pages[pageIdx].allocator.TryAlloc(size, alignment, marker)) {
+				range.pageIdx = pageIdx;
+				range.offset = marker;
+				return range;
+			}
+		}
+		range.pageIdx = AddPage(device, std::max(size, pageSize));
+		range.offset = pages[range.pageIdx].allocator.Alloc(size, alignment);
+		return range;
+	}
+	void VulkanBufferArena::Free(const VulkanBufferRange& range) {
+		assert(range.IsValid() && range.pageIdx < pages.size() && "The range isn't from this arena!");
+		pages[range.pageIdx].allocator.Free(range.offset);
+	}
+
+	VkBuffer VulkanBufferArena::GetBuffer(uint32_t pageIdx) const {
+		return pages[pageIdx].buffer;
+	}
+	uint32_t VulkanBufferArena::GetPageCount() const {
+		return static_cast<uint32_t>(pages.size());
+	}
+	VkDeviceSize VulkanBufferArena::GetPageSize() const {
+		return pageSize;
+	}
+	bool VulkanBufferArena::IsInitialized() const {
+		return initialized;
+	}
+
+	uint32_t VulkanBufferArena::AddPage(VkDevice device, VkDeviceSize size) {
+		Page page{};
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = size;
+		bufferInfo.usage = usage;
+		if (queueFamilies.size() > 1) {
+			// No ownership transfers, the ranges of a page are written and read by different queues at once.
+			bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+			bufferInfo.pQueueFamilyIndices = queueFamilies.data();
+		} else {
+			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		}
+		if (vkCreateBuffer(device, &bufferInfo, nullptr, &page.buffer) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to create an arena buffer!"};
+		}
+
+		VkMemoryRequirements memoryRequirements{};
+		vkGetBufferMemoryRequirements(device, page.buffer, &memoryRequirements);
+		uint32_t memoryTypeIndex{0};
+		if (!FindVulkanMemoryTypeIndex(physicalDevice, memoryRequirements.memoryTypeBits, memoryProperties, memoryTypeIndex)) {
+			vkDestroyBuffer(device, page.buffer, nullptr);
+			throw std::runtime_error{"No suitable memory type for an arena buffer!"};
+		}
+		page.allocator.Initialize(device, memoryRequirements.size, memoryTypeIndex);
+		if (vkBindBufferMemory(device, page.buffer, page.allocator.GetDeviceMemory(), 0) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to bind the memory of an arena buffer!"};
+		}
+		// The memory past the end of the buffer stays claimed, so that the ranges are inside of the buffer.
+		// The blocks are claimed from the start, the buffer part is taken first and given back afterwards.
+		if (memoryRequirements.size > size) {
+			VulkanMemoryMarker bufferPart = page.allocator.Alloc(size, 1);
+			page.allocator.Alloc(memoryRequirements.size - size, 1);
+			page.allocator.Free(bufferPart);
+		}
+		pages.push_back(std::move(page));
+		return static_cast<uint32_t>(pages.size() - 1);
+	}
+
+}
\ No newline at end of file
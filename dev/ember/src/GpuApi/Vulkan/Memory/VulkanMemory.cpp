@@ -1,5 +1,27 @@
 #include "GpuApi/Vulkan/Memory/VulkanMemory.h"
 
+#include <cassert>
+
 namespace ember {
 
+	bool FindVulkanMemoryTypeIndex(VkPhysicalDevice physicalDevice, uint32_t memoryTypeBits,
+	                               VkMemoryPropertyFlags properties, uint32_t& memoryTypeIndex) {
+		VkPhysicalDeviceMemoryProperties memoryProperties{};
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+		for (uint32_t typeIdx = 0; typeIdx < memoryProperties.memoryTypeCount; typeIdx++) {
+			bool allowed = (memoryTypeBits & (1u << typeIdx)) != 0;
+			bool hasProperties = (memoryProperties.memoryTypes[typeIdx].propertyFlags & properties) == properties;
+			if (allowed && hasProperties) {
+				memoryTypeIndex = typeIdx;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	VkDeviceSize AlignVulkanDeviceSize(VkDeviceSize size, VkDeviceSize alignment) {
+		assert(alignment != 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of 2!");
+		return (size + alignment - 1) & ~(alignment - 1);
+	}
+
 }
\ No newline at end of file
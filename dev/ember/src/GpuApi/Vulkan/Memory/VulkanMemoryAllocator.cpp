@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <stdexcept>
 
 namespace ember {
@@ -38,14 +39,22 @@ namespace ember {
 	}
 
 	VulkanMemoryMarker VulkanMemoryAllocator::Alloc(size_t size, uint32_t alignment) {
-		std::list<VulkanMemoryBlock>::iterator iter = FindSuitableBlock(size, alignment);
-		if (iter == memoryBlocks.end()) {
+		VulkanMemoryMarker marker{};
+		if (!TryAlloc(size, alignment, marker)) {
 			// TODO: think about different error reporting strategies.
 			// Is throwing a runtime exception really the best possible approach?
 			throw std::runtime_error{"Allocation failed: there is not enough memory!"};
 		}
+		return marker;
+	}
+	bool VulkanMemoryAllocator::TryAlloc(size_t size, uint32_t alignment, VulkanMemoryMarker& marker) {
+		std::list<VulkanMemoryBlock>::iterator iter = FindSuitableBlock(size, alignment);
+		if (iter == memoryBlocks.end()) {
+			return false;
+		}
 		std::list<VulkanMemoryBlock>::iterator newBlockIter = ClaimMemoryBlock(iter, size, alignment);
-		return newBlockIter->GetPayloadOffset();
+		marker = newBlockIter->GetPayloadOffset();
+		return true;
 	}
 	void VulkanMemoryAllocator::Free(VulkanMemoryMarker marker) {
 		// Free the memory block, potentially joining it with the nearby ones.
@@ -66,7 +75,9 @@ namespace ember {
 		std::list<VulkanMemoryBlock>::iterator rightmostFreeBlock = FindFirstFreeBlockRangeRight(memoryBlockIter);
 		newSize = (rightmostFreeBlock->offset - memoryBlockIter->offset) + rightmostFreeBlock->size;
 		memoryBlockIter->size = newSize;
-		memoryBlocks.erase(++memoryBlockIter, rightmostFreeBlock); // can potentially be [end, end), is that ok?
+		// The rightmost free block is a part of the joined one now, so it goes as well.
+		// If there's nothing to join, the range is empty.
+		memoryBlocks.erase(std::next(memoryBlockIter), std::next(rightmostFreeBlock));
 	}
 	VulkanMemoryMarker VulkanMemoryAllocator::Realloc(VulkanMemoryMarker marker, size_t newSize, uint32_t alignment) {
 		assert(false && "Not implemented!");
@@ -107,6 +118,8 @@ namespace ember {
 		// Because of the alignment requirement, the available size in the block might change.
 		// More precisely, it can only decrease when the block's offset isn't alligned properly.
 		size_t paddingRequired = AlignOffset(block.offset, alignment) - block.offset;
+		if (paddingRequired > block.size)
+			return false;
 		sizeAvailable = block.size - paddingRequired;
 		if (sizeRequested <= sizeAvailable)
 			return true;
@@ -146,6 +159,13 @@ namespace ember {
 		secondPartBlock.padding = 0;
 		secondPartBlock.free = true;
 
+		// If nothing's left of the old block, it simply becomes the new one. Otherwise an empty free block
+		// would stay in the list, at the same offset as the next allocation.
+		if (secondPartBlock.size == 0) {
+			*iter = firstPartBlock;
+			return iter;
+		}
+
 		// As an optimization we could also check how big the second part block is going to end up to be.
 		// If it's smaller than some threshold, such as smaller than the alignment requested, we could simply
 		// add the size of the second block to the size of the first one and avoid breaking the old block into parts at all.
@@ -161,7 +181,7 @@ namespace ember {
 
 	std::list<VulkanMemoryBlock>::iterator VulkanMemoryAllocator::FindBlock(VulkanMemoryMarker marker) {
 		auto pred = [marker](const VulkanMemoryBlock& memoryBlock) {
-			return marker == memoryBlock.GetPayloadOffset();
+			return !memoryBlock.free && marker == memoryBlock.GetPayloadOffset();
 		};
 		std::list<VulkanMemoryBlock>::iterator searchRes = std::find_if(memoryBlocks.begin(), memoryBlocks.end(), pred);
 		if (searchRes == memoryBlocks.end()) {
@@ -220,7 +240,7 @@ namespace ember {
 		// "Game Engine Architecture" 3rd edition, Jason Gregory
 		// https://www.amazon.com/Engine-Architecture-Third-Jason-Gregory/dp/1138035459
 		// 6.2.1.3 Aligned Allocations
-		assert(alignment == 0 && "Alignment can't be 0!");
+		assert(alignment != 0 && "Alignment can't be 0!");
 		const size_t mask = static_cast<size_t>(alignment) - 1;
 		assert((alignment & mask) == 0 && "Alignment must be a power of 2!");
 		return (offset + mask) & ~mask;
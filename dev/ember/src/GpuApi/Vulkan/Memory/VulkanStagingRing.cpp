@@ -0,0 +1,117 @@
+#include "GpuApi/Vulkan/Memory/VulkanStagingRing.h"
+#include "GpuApi/Vulkan/Memory/VulkanMemory.h"
+
+#include <cassert>
+#include <stdexcept>
+
+namespace ember {
+
+	void VulkanStagingRing::Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size) {
+		assert(!initialized && "Staging ring is already initialized!");
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = size;
+		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to create the staging buffer!"};
+		}
+
+		VkMemoryRequirements memoryRequirements{};
+		vkGetBufferMemoryRequirements(device, buffer, &memoryRequirements);
+		// Coherent, so the writes don't have to be flushed.
+		uint32_t memoryTypeIndex{0};
+		if (!FindVulkanMemoryTypeIndex(physicalDevice, memoryRequirements.memoryTypeBits,
+		                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		                               memoryTypeIndex)) {
+			throw std::runtime_error{"No host visible and coherent memory for the staging buffer!"};
+		}
+		VkMemoryAllocateInfo allocationInfo{};
+		allocationInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocationInfo.allocationSize = memoryRequirements.size;
+		allocationInfo.memoryTypeIndex = memoryTypeIndex;
+		if (vkAllocateMemory(device, &allocationInfo, nullptr, &memory) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to allocate the staging memory!"};
+		}
+		if (vkBindBufferMemory(device, buffer, memory, 0) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to bind the staging memory!"};
+		}
+		void* data{nullptr};
+		if (vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to map the staging memory!"};
+		}
+		mappedData = static_cast<char*>(data);
+		this->size = size;
+		head = 0;
+		tail = 0;
+		initialized = true;
+	}
+	void VulkanStagingRing::Destroy(VkDevice device) {
+		assert(initialized && "Staging ring must be initialized first!");
+		vkUnmapMemory(device, memory);
+		vkDestroyBuffer(device, buffer, nullptr);
+		vkFreeMemory(device, memory, nullptr);
+		buffer = VK_NULL_HANDLE;
+		memory = VK_NULL_HANDLE;
+		mappedData = nullptr;
+		submissions.clear();
+		initialized = false;
+	}
+
+	char* VulkanStagingRing::Alloc(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) {
+		assert(size > 0 && "Can't allocate 0 bytes!");
+		if (head == tail) {
+			// Empty, the whole buffer is in one piece again.
+			head = 0;
+			tail = 0;
+		}
+		VkDeviceSize start = AlignVulkanDeviceSize(head, alignment);
+		if (head >= tail) {
+			// The free space is [head, size) and [0, tail).
+			if (start <= this->size && size <= this->size - start) {
+				offset = start;
+			} else if (size < tail) {
+				// The rest of the buffer is skipped, it's given back along with the space before it.
+				offset = 0;
+			} else {
+				return nullptr;
+			}
+		} else {
+			// The free space is [head, tail), short of a byte so that 'head' doesn't reach 'tail'.
+			if (start < tail && size < tail - start) {
+				offset = start;
+			} else {
+				return nullptr;
+			}
+		}
+		head = offset + size;
+		return mappedData + offset;
+	}
+	void VulkanStagingRing::CloseSubmission(uint64_t submissionIdx) {
+		assert((submissions.empty() || submissions.back().submissionIdx < submissionIdx) &&
+		       "The submission indices must grow!");
+		VkDeviceSize openStart = submissions.empty() ? tail : submissions.back().end;
+		if (head == openStart) {
+			// Nothing was allocated.
+			return;
+		}
+		submissions.push_back(Submission{submissionIdx, head});
+	}
+	void VulkanStagingRing::Release(uint64_t completedSubmissionIdx) {
+		while (!submissions.empty() && submissions.front().submissionIdx <= completedSubmissionIdx) {
+			tail = submissions.front().end;
+			submissions.pop_front();
+		}
+	}
+
+	VkBuffer VulkanStagingRing::GetBuffer() const {
+		return buffer;
+	}
+	VkDeviceSize VulkanStagingRing::GetSize() const {
+		return size;
+	}
+	bool VulkanStagingRing::IsInitialized() const {
+		return initialized;
+	}
+
+}
\ No newline at end of file
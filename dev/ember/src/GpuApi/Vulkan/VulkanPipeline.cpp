@@ -24,6 +24,12 @@ namespace ember {
 
         vertexAttribDescs = VertexAttribLayoutToVulkanAttribDescription(VertexPC::attributes);
     }
+    void VulkanGraphicsPipeline::SetVertexInputDescription(
+        const std::vector<VkVertexInputBindingDescription>& bindingDescs,
+        const std::vector<VkVertexInputAttributeDescription>& attribDescs) {
+        vertexBindingDescs = bindingDescs;
+        vertexAttribDescs = attribDescs;
+    }
     void VulkanGraphicsPipeline::SetPrimitiveTopology(VkPrimitiveTopology topology) {
         this->topology = topology;
     }
@@ -57,6 +63,15 @@ namespace ember {
         this->multisamplingEnabled = false;
     }
 
+    void VulkanGraphicsPipeline::EnableDepthTest(VkCompareOp depthCompareOp) {
+        this->depthCompareOp = depthCompareOp;
+        this->depthTestEnabled = true;
+    }
+    void VulkanGraphicsPipeline::DisableDepthTest() {
+        this->depthCompareOp = VK_COMPARE_OP_ALWAYS;
+        this->depthTestEnabled = false;
+    }
+
     void VulkanGraphicsPipeline::SetBlendingAttachmentState(
         const VkPipelineColorBlendAttachmentState& blendingAttachmentState, uint32_t attachmentIdx) {
         blendingAttachmentStates[attachmentIdx] = blendingAttachmentState;
@@ -93,6 +108,7 @@ namespace ember {
         VkPipelineViewportStateCreateInfo viewportStateInfo = CreateVulkanViewportStateInfo();
         VkPipelineRasterizationStateCreateInfo rasterizationStateInfo = CreateVulkanRasterizationStateInfo();
         VkPipelineMultisampleStateCreateInfo multisampleStateInfo = CreateVulkanMultisampleStateInfo();
+        VkPipelineDepthStencilStateCreateInfo depthStencilStateInfo = CreateVulkanDepthStencilStateInfo();
         VkPipelineColorBlendStateCreateInfo blendingStateInfo = CreateVulkanBlendingStateInfo();
         VkPipelineDynamicStateCreateInfo dynamicStateInfo = CreateVulkanDynamicStateInfo();
 
@@ -105,7 +121,7 @@ namespace ember {
         graphicsPipelineInfo.pViewportState = &viewportStateInfo;
         graphicsPipelineInfo.pRasterizationState = &rasterizationStateInfo;
         graphicsPipelineInfo.pMultisampleState = &multisampleStateInfo;
-        graphicsPipelineInfo.pDepthStencilState = nullptr; // For now!
+        graphicsPipelineInfo.pDepthStencilState = depthTestEnabled ? &depthStencilStateInfo : nullptr;
         graphicsPipelineInfo.pColorBlendState = &blendingStateInfo;
         graphicsPipelineInfo.pDynamicState = &dynamicStateInfo;
         graphicsPipelineInfo.layout = pipelineLayout->GetPipelineLayout();
@@ -218,6 +234,19 @@ namespace ember {
 
         return multisampleStateInfo;
     }
+    VkPipelineDepthStencilStateCreateInfo VulkanGraphicsPipeline::CreateVulkanDepthStencilStateInfo() const {
+        VkPipelineDepthStencilStateCreateInfo depthStencilStateInfo{};
+        depthStencilStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depthStencilStateInfo.depthTestEnable = depthTestEnabled ? VK_TRUE : VK_FALSE;
+        depthStencilStateInfo.depthWriteEnable = depthTestEnabled ? VK_TRUE : VK_FALSE;
+        depthStencilStateInfo.depthCompareOp = depthCompareOp;
+        depthStencilStateInfo.depthBoundsTestEnable = VK_FALSE;
+        depthStencilStateInfo.stencilTestEnable = VK_FALSE;
+        depthStencilStateInfo.minDepthBounds = 0.0f;
+        depthStencilStateInfo.maxDepthBounds = 1.0f;
+
+        return depthStencilStateInfo;
+    }
     VkPipelineColorBlendStateCreateInfo VulkanGraphicsPipeline::CreateVulkanBlendingStateInfo() const {
         VkPipelineColorBlendStateCreateInfo colorBlending{};
         colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
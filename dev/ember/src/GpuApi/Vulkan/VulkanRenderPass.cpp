@@ -26,6 +26,10 @@ namespace ember {
 		const VkAttachmentDescription& attachmentDescription, uint32_t attachmentIdx) {
 		attachmentDescs[attachmentIdx] = attachmentDescription;
 	}
+	void VulkanRenderPass::SetSubpassDependency(
+		const VkSubpassDependency& subpassDependency, uint32_t subpassDependencyIdx) {
+		subpassDeps[subpassDependencyIdx] = subpassDependency;
+	}
 
 	void VulkanRenderPass::SetRenderTargetColorAttachment(VkFormat attachmentFormat, uint32_t attachmentIdx) {
 		VkAttachmentDescription colorAttachmentDesc{};
@@ -60,7 +64,9 @@ namespace ember {
 		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
+		// Not 'VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL', it needs the 'separateDepthStencilLayouts' feature.
+		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		SetAttachment(depthAttachment, attachmentIdx);
 	}
 	void VulkanRenderPass::SetDepthStencilAttachment(uint32_t attachmentIdx, bool storeDepth, bool storeStencil) {
 		VkAttachmentDescription depthStencilAttachment{};
@@ -72,6 +78,7 @@ namespace ember {
 		depthStencilAttachment.stencilStoreOp = storeStencil ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		depthStencilAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 		depthStencilAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		SetAttachment(depthStencilAttachment, attachmentIdx);
 	}
 
 	void VulkanRenderPass::SetSubpassColorAttachmentReference(uint32_t attachmentId, uint32_t refId, uint32_t subpass) {
@@ -98,6 +105,12 @@ namespace ember {
 			SetSubpassColorAttachmentReference(attachments[refId], refId, layout, subpass);
 		}
 	}
+	void VulkanRenderPass::SetSubpassDepthStencilAttachmentReference(uint32_t attachmentId, uint32_t subpass) {
+		VkAttachmentReference& attachmentRef = GetAttachmentReferences(subpass).depthStencilAttachment;
+		attachmentRef.attachment = attachmentId;
+		attachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		GetSubpassDescription(subpass).pDepthStencilAttachment = &attachmentRef;
+	}
 
 	void VulkanRenderPass::CreateRenderPass(VkDevice device) {
 		VkRenderPassCreateInfo renderPassInfo{};
@@ -106,17 +119,8 @@ namespace ember {
 		renderPassInfo.pAttachments = attachmentDescs.data();
 		renderPassInfo.subpassCount = static_cast<uint32_t>(subpassDescs.size());
 		renderPassInfo.pSubpasses = subpassDescs.data();
-
-		//VkSubpassDependency subpassDependency{};
-		//subpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		//subpassDependency.dstSubpass = 0;
-		//subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		//subpassDependency.srcAccessMask = 0;
-		//subpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		//subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-		//renderPassInfo.dependencyCount = 1;
-		//renderPassInfo.pDependencies = &subpassDependency;
+		renderPassInfo.dependencyCount = static_cast<uint32_t>(subpassDeps.size());
+		renderPassInfo.pDependencies = subpassDeps.data();
 
 		if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
 			throw std::runtime_error{ "Failed to create a Render Pass!" };
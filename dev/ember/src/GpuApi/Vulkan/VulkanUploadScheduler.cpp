@@ -0,0 +1,168 @@
+#include "GpuApi/Vulkan/VulkanUploadScheduler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <stdexcept>
+
+namespace ember {
+
+	// The uploads in the staging ring.
+	static constexpr VkDeviceSize stagingAlignment{16};
+
+	void RecordVulkanBufferUploads(VkCommandBuffer commandBuffer, VkBuffer srcBuffer,
+	                               std::vector<VulkanBufferUpload>& uploads) {
+		std::stable_sort(uploads.begin(), uploads.end(),
+		                 [](const VulkanBufferUpload& lhs, const VulkanBufferUpload& rhs) {
+			return std::less<VkBuffer>{}(lhs.dstBuffer, rhs.dstBuffer);
+		});
+		std::vector<VkBufferCopy> regions;
+		for (size_t first = 0; first < uploads.size();) {
+			VkBuffer dstBuffer = uploads[first].dstBuffer;
+			regions.clear();
+			size_t last = first;
+			for (; last < uploads.size() && uploads[last].dstBuffer == dstBuffer; last++) {
+				regions.push_back(uploads[last].region);
+			}
+			vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, static_cast<uint32_t>(regions.size()), regions.data());
+			first = last;
+		}
+	}
+
+	void VulkanUploadScheduler::Initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue queue,
+	                                       VkCommandPool commandPool, VkDeviceSize stagingSize) {
+		assert(!initialized && "Upload scheduler is already initialized!");
+		VkSemaphoreTypeCreateInfo semaphoreTypeInfo{};
+		semaphoreTypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		semaphoreTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		semaphoreTypeInfo.initialValue = 0;
+		VkSemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &semaphoreTypeInfo;
+		if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &timelineSemaphore) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to create the upload timeline semaphore!"};
+		}
+		stagingRing.Initialize(device, physicalDevice, stagingSize);
+		this->queue = queue;
+		this->commandPool = commandPool;
+		nextValue = 1;
+		completedValue = 0;
+		initialized = true;
+	}
+	void VulkanUploadScheduler::Destroy(VkDevice device) {
+		assert(initialized && "Upload scheduler must be initialized first!");
+		// The device is idle by now, every batch is done.
+		for (const Batch& batch : batches) {
+			freeCommandBuffers.push_back(batch.commandBuffer);
+		}
+		if (!freeCommandBuffers.empty()) {
+			vkFreeCommandBuffers(device, commandPool, static_cast<uint32_t>(freeCommandBuffers.size()),
+			                     freeCommandBuffers.data());
+		}
+		batches.clear();
+		freeCommandBuffers.clear();
+		pendingUploads.clear();
+		vkDestroySemaphore(device, timelineSemaphore, nullptr);
+		timelineSemaphore = VK_NULL_HANDLE;
+		stagingRing.Destroy(device);
+		initialized = false;
+	}
+
+	char* VulkanUploadScheduler::StageUpload(VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size) {
+		VkDeviceSize stagingOffset{0};
+		char* data = stagingRing.Alloc(size, stagingAlignment, stagingOffset);
+		if (data) {
+			pendingUploads.push_back(VulkanBufferUpload{dstBuffer, VkBufferCopy{stagingOffset, dstOffset, size}});
+		}
+		return data;
+	}
+	void VulkanUploadScheduler::Submit(VkDevice device) {
+		if (pendingUploads.empty()) {
+			return;
+		}
+		VkCommandBuffer commandBuffer{VK_NULL_HANDLE};
+		if (!freeCommandBuffers.empty()) {
+			commandBuffer = freeCommandBuffers.back();
+			freeCommandBuffers.pop_back();
+		} else {
+			VkCommandBufferAllocateInfo commandBufferInfo{};
+			commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			commandBufferInfo.commandPool = commandPool;
+			commandBufferInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			commandBufferInfo.commandBufferCount = 1;
+			if (vkAllocateCommandBuffers(device, &commandBufferInfo, &commandBuffer) != VK_SUCCESS) {
+				throw std::runtime_error{"Failed to allocate an upload command buffer!"};
+			}
+		}
+
+		VkCommandBufferBeginInfo commandBufferBeginInfo{};
+		commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		if (vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to start an upload command buffer!"};
+		}
+		// The batches can overlap on the queue, and an earlier one may write the same range (e.g. a mesh that
+		// changed again before its first upload was done).
+		VkMemoryBarrier batchBarrier{};
+		batchBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		batchBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		batchBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer,
+		                     VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		                     1, &batchBarrier, 0, nullptr, 0, nullptr);
+		RecordVulkanBufferUploads(commandBuffer, stagingRing.GetBuffer(), pendingUploads);
+		pendingUploads.clear();
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to end an upload command buffer!"};
+		}
+
+		uint64_t value = nextValue;
+		VkTimelineSemaphoreSubmitInfo timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = &value;
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &timelineSemaphore;
+		if (vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to submit an upload batch!"};
+		}
+		nextValue++;
+		stagingRing.CloseSubmission(value);
+		batches.push_back(Batch{commandBuffer, value});
+	}
+	void VulkanUploadScheduler::Update(VkDevice device) {
+		uint64_t value{0};
+		if (vkGetSemaphoreCounterValue(device, timelineSemaphore, &value) != VK_SUCCESS) {
+			throw std::runtime_error{"Failed to read the upload timeline semaphore!"};
+		}
+		completedValue = std::max(completedValue, value);
+		stagingRing.Release(completedValue);
+		while (!batches.empty() && batches.front().value <= completedValue) {
+			vkResetCommandBuffer(batches.front().commandBuffer, 0);
+			freeCommandBuffers.push_back(batches.front().commandBuffer);
+			batches.pop_front();
+		}
+	}
+
+	uint64_t VulkanUploadScheduler::GetPendingValue() const {
+		return pendingUploads.empty() ? nextValue - 1 : nextValue;
+	}
+	uint64_t VulkanUploadScheduler::GetCompletedValue() const {
+		return completedValue;
+	}
+	VkSemaphore VulkanUploadScheduler::GetTimelineSemaphore() const {
+		return timelineSemaphore;
+	}
+	VkDeviceSize VulkanUploadScheduler::GetStagingSize() const {
+		return stagingRing.GetSize();
+	}
+	bool VulkanUploadScheduler::IsInitialized() const {
+		return initialized;
+	}
+
+}
\ No newline at end of file
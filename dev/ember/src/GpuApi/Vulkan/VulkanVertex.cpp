@@ -34,6 +34,29 @@ namespace ember {
 				return PickInt8VulkanVertexAttribFormat(dimension);
 				break;
 
+			case VertexAttribFormat::FLOAT16:
+				return PickFloat16VulkanVertexAttribFormat(dimension);
+				break;
+
+			case VertexAttribFormat::SNORM16:
+				return PickSnorm16VulkanVertexAttribFormat(dimension);
+				break;
+			case VertexAttribFormat::SNORM8:
+				return PickSnorm8VulkanVertexAttribFormat(dimension);
+				break;
+			case VertexAttribFormat::UNORM16:
+				return PickUnorm16VulkanVertexAttribFormat(dimension);
+				break;
+			case VertexAttribFormat::UNORM8:
+				return PickUnorm8VulkanVertexAttribFormat(dimension);
+				break;
+
+			case VertexAttribFormat::OCT_SNORM16:
+				// The shader decodes the octahedral mapping itself, the vertex input only sees 2 SNORM16 components.
+				assert(dimension == 2 && "Octahedral encoding must have 2 components!");
+				return PickSnorm16VulkanVertexAttribFormat(dimension);
+				break;
+
 			default:
 				assert(true && "Unknown vertex attribute format provided!");
 				return VkFormat{};
@@ -62,6 +85,27 @@ namespace ember {
 		}
 	}
 
+	VkFormat PickFloat16VulkanVertexAttribFormat(uint32_t dimension) {
+		switch (dimension) {
+			case 1:
+				return VkFormat::VK_FORMAT_R16_SFLOAT;
+				break;
+			case 2:
+				return VkFormat::VK_FORMAT_R16G16_SFLOAT;
+				break;
+			case 3:
+				return VkFormat::VK_FORMAT_R16G16B16_SFLOAT;
+				break;
+			case 4:
+				return VkFormat::VK_FORMAT_R16G16B16A16_SFLOAT;
+				break;
+			default:
+				assert(true && "Vertex attribute dimension is not supported!");
+				return VkFormat{};
+				break;
+		}
+	}
+
 	VkFormat PickUint32VulkanVertexAttribFormat(uint32_t dimension) {
 		switch (dimension) {
 			case 1:
@@ -184,6 +228,87 @@ namespace ember {
 		}
 	}
 
+	VkFormat PickSnorm16VulkanVertexAttribFormat(uint32_t dimension) {
+		switch (dimension) {
+			case 1:
+				return VkFormat::VK_FORMAT_R16_SNORM;
+				break;
+			case 2:
+				return VkFormat::VK_FORMAT_R16G16_SNORM;
+				break;
+			case 3:
+				return VkFormat::VK_FORMAT_R16G16B16_SNORM;
+				break;
+			case 4:
+				return VkFormat::VK_FORMAT_R16G16B16A16_SNORM;
+				break;
+			default:
+				assert(true && "Vertex attribute dimension is not supported!");
+				return VkFormat{};
+				break;
+		}
+	}
+	VkFormat PickSnorm8VulkanVertexAttribFormat(uint32_t dimension) {
+		switch (dimension) {
+			case 1:
+				return VkFormat::VK_FORMAT_R8_SNORM;
+				break;
+			case 2:
+				return VkFormat::VK_FORMAT_R8G8_SNORM;
+				break;
+			case 3:
+				return VkFormat::VK_FORMAT_R8G8B8_SNORM;
+				break;
+			case 4:
+				return VkFormat::VK_FORMAT_R8G8B8A8_SNORM;
+				break;
+			default:
+				assert(true && "Vertex attribute dimension is not supported!");
+				return VkFormat{};
+				break;
+		}
+	}
+	VkFormat PickUnorm16VulkanVertexAttribFormat(uint32_t dimension) {
+		switch (dimension) {
+			case 1:
+				return VkFormat::VK_FORMAT_R16_UNORM;
+				break;
+			case 2:
+				return VkFormat::VK_FORMAT_R16G16_UNORM;
+				break;
+			case 3:
+				return VkFormat::VK_FORMAT_R16G16B16_UNORM;
+				break;
+			case 4:
+				return VkFormat::VK_FORMAT_R16G16B16A16_UNORM;
+				break;
+			default:
+				assert(true && "Vertex attribute dimension is not supported!");
+				return VkFormat{};
+				break;
+		}
+	}
+	VkFormat PickUnorm8VulkanVertexAttribFormat(uint32_t dimension) {
+		switch (dimension) {
+			case 1:
+				return VkFormat::VK_FORMAT_R8_UNORM;
+				break;
+			case 2:
+				return VkFormat::VK_FORMAT_R8G8_UNORM;
+				break;
+			case 3:
+				return VkFormat::VK_FORMAT_R8G8B8_UNORM;
+				break;
+			case 4:
+				return VkFormat::VK_FORMAT_R8G8B8A8_UNORM;
+				break;
+			default:
+				assert(true && "Vertex attribute dimension is not supported!");
+				return VkFormat{};
+				break;
+		}
+	}
+
 	VertexAttribFormat InferVertexAttribFormat(VkFormat vkFormat) {
 		switch (vkFormat) {
 			case VkFormat::VK_FORMAT_R32_SFLOAT:
@@ -235,6 +360,42 @@ namespace ember {
 				return VertexAttribFormat::UINT8;
 				break;
 
+			case VkFormat::VK_FORMAT_R16_SFLOAT:
+			case VkFormat::VK_FORMAT_R16G16_SFLOAT:
+			case VkFormat::VK_FORMAT_R16G16B16_SFLOAT:
+			case VkFormat::VK_FORMAT_R16G16B16A16_SFLOAT:
+				return VertexAttribFormat::FLOAT16;
+				break;
+
+			// An OCT_SNORM16 attribute can't be told apart from a 2 component SNORM16 one by its format alone.
+			case VkFormat::VK_FORMAT_R16_SNORM:
+			case VkFormat::VK_FORMAT_R16G16_SNORM:
+			case VkFormat::VK_FORMAT_R16G16B16_SNORM:
+			case VkFormat::VK_FORMAT_R16G16B16A16_SNORM:
+				return VertexAttribFormat::SNORM16;
+				break;
+
+			case VkFormat::VK_FORMAT_R8_SNORM:
+			case VkFormat::VK_FORMAT_R8G8_SNORM:
+			case VkFormat::VK_FORMAT_R8G8B8_SNORM:
+			case VkFormat::VK_FORMAT_R8G8B8A8_SNORM:
+				return VertexAttribFormat::SNORM8;
+				break;
+
+			case VkFormat::VK_FORMAT_R16_UNORM:
+			case VkFormat::VK_FORMAT_R16G16_UNORM:
+			case VkFormat::VK_FORMAT_R16G16B16_UNORM:
+			case VkFormat::VK_FORMAT_R16G16B16A16_UNORM:
+				return VertexAttribFormat::UNORM16;
+				break;
+
+			case VkFormat::VK_FORMAT_R8_UNORM:
+			case VkFormat::VK_FORMAT_R8G8_UNORM:
+			case VkFormat::VK_FORMAT_R8G8B8_UNORM:
+			case VkFormat::VK_FORMAT_R8G8B8A8_UNORM:
+				return VertexAttribFormat::UNORM8;
+				break;
+
 			default:
 				assert(true && "Vulkan format is not supported!");
 				return VertexAttribFormat{};
@@ -250,6 +411,11 @@ namespace ember {
 			case VkFormat::VK_FORMAT_R32_SINT:
 			case VkFormat::VK_FORMAT_R16_SINT:
 			case VkFormat::VK_FORMAT_R8_SINT:
+			case VkFormat::VK_FORMAT_R16_SFLOAT:
+			case VkFormat::VK_FORMAT_R16_SNORM:
+			case VkFormat::VK_FORMAT_R8_SNORM:
+			case VkFormat::VK_FORMAT_R16_UNORM:
+			case VkFormat::VK_FORMAT_R8_UNORM:
 				return 1;
 				break;
 			case VkFormat::VK_FORMAT_R32G32_SFLOAT:
@@ -259,6 +425,11 @@ namespace ember {
 			case VkFormat::VK_FORMAT_R32G32_SINT:
 			case VkFormat::VK_FORMAT_R16G16_SINT:
 			case VkFormat::VK_FORMAT_R8G8_SINT:
+			case VkFormat::VK_FORMAT_R16G16_SFLOAT:
+			case VkFormat::VK_FORMAT_R16G16_SNORM:
+			case VkFormat::VK_FORMAT_R8G8_SNORM:
+			case VkFormat::VK_FORMAT_R16G16_UNORM:
+			case VkFormat::VK_FORMAT_R8G8_UNORM:
 				return 2;
 				break;
 			case VkFormat::VK_FORMAT_R32G32B32_SFLOAT:
@@ -268,6 +439,11 @@ namespace ember {
 			case VkFormat::VK_FORMAT_R32G32B32_SINT:
 			case VkFormat::VK_FORMAT_R16G16B16_SINT:
 			case VkFormat::VK_FORMAT_R8G8B8_SINT:
+			case VkFormat::VK_FORMAT_R16G16B16_SFLOAT:
+			case VkFormat::VK_FORMAT_R16G16B16_SNORM:
+			case VkFormat::VK_FORMAT_R8G8B8_SNORM:
+			case VkFormat::VK_FORMAT_R16G16B16_UNORM:
+			case VkFormat::VK_FORMAT_R8G8B8_UNORM:
 				return 3;
 				break;
 			case VkFormat::VK_FORMAT_R32G32B32A32_SFLOAT:
@@ -277,6 +453,11 @@ namespace ember {
 			case VkFormat::VK_FORMAT_R32G32B32A32_SINT:
 			case VkFormat::VK_FORMAT_R16G16B16A16_SINT:
 			case VkFormat::VK_FORMAT_R8G8B8A8_SINT:
+			case VkFormat::VK_FORMAT_R16G16B16A16_SFLOAT:
+			case VkFormat::VK_FORMAT_R16G16B16A16_SNORM:
+			case VkFormat::VK_FORMAT_R8G8B8A8_SNORM:
+			case VkFormat::VK_FORMAT_R16G16B16A16_UNORM:
+			case VkFormat::VK_FORMAT_R8G8B8A8_UNORM:
 				return 4;
 				break;
 			default:
@@ -0,0 +1,361 @@
+#include "Math/BoundsKernels.h"
+
+#include "Core/Parallel.h"
+#include "Core/Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace ember {
+
+	// Big enough for a thread to be worth it, a chunk is ~768 KiB of positions.
+	static constexpr size_t boundsChunkSize{65536};
+	// A box is 24 bytes in, 24 bytes out, and a transform is 48 bytes.
+	static constexpr size_t aabbChunkSize{16384};
+
+	static void ResetBounds(float min[3], float max[3]) {
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			min[axis] = std::numeric_limits<float>::infinity();
+			max[axis] = -std::numeric_limits<float>::infinity();
+		}
+	}
+
+	static void ReducePositionBoundsScalar(const float* positions, size_t count, float min[3], float max[3]) {
+		for (size_t vert = 0; vert < count; vert++) {
+			const float* p = positions + vert * 3;
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				min[axis] = std::min(min[axis], p[axis]);
+				max[axis] = std::max(max[axis], p[axis]);
+			}
+		}
+	}
+
+	static void ReduceTransformedPositionBoundsScalar(const float* positions, size_t count, const float affine[12],
+	                                                  float min[3], float max[3]) {
+		for (size_t vert = 0; vert < count; vert++) {
+			const float* p = positions + vert * 3;
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				float t = affine[axis] * p[0] + affine[3 + axis] * p[1] + affine[6 + axis] * p[2] + affine[9 + axis];
+				min[axis] = std::min(min[axis], t);
+				max[axis] = std::max(max[axis], t);
+			}
+		}
+	}
+
+#if defined(EMBER_SIMD_SSE2)
+	// 'lanes' floats of interleaved xyz data, the first one being an x.
+	static void MergeInterleavedBounds(const float* laneMins, const float* laneMaxs, uint32_t lanes,
+	                                   float min[3], float max[3]) {
+		for (uint32_t lane = 0; lane < lanes; lane++) {
+			min[lane % 3] = std::min(min[lane % 3], laneMins[lane]);
+			max[lane % 3] = std::max(max[lane % 3], laneMaxs[lane]);
+		}
+	}
+#endif
+
+	// Positions are reduced straight from the interleaved data. 3 registers always hold a whole number
+	// of positions, and every lane always sees the same component, so the lanes are only sorted
+	// out once at the end. Returns the number of positions done, the rest is left for the scalar path.
+#if defined(EMBER_SIMD_AVX2)
+	static size_t ReducePositionBoundsSimd(const float* positions, size_t count, float min[3], float max[3]) {
+		__m256 min0 = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+		__m256 min1 = min0;
+		__m256 min2 = min0;
+		__m256 max0 = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+		__m256 max1 = max0;
+		__m256 max2 = max0;
+		size_t vert{0};
+		for (; vert + 8 <= count; vert += 8) {
+			const float* p = positions + vert * 3;
+			__m256 a = _mm256_loadu_ps(p);
+			__m256 b = _mm256_loadu_ps(p + 8);
+			__m256 c = _mm256_loadu_ps(p + 16);
+			min0 = _mm256_min_ps(min0, a);
+			min1 = _mm256_min_ps(min1, b);
+			min2 = _mm256_min_ps(min2, c);
+			max0 = _mm256_max_ps(max0, a);
+			max1 = _mm256_max_ps(max1, b);
+			max2 = _mm256_max_ps(max2, c);
+		}
+		alignas(32) float laneMins[24];
+		alignas(32) float laneMaxs[24];
+		_mm256_store_ps(laneMins, min0);
+		_mm256_store_ps(laneMins + 8, min1);
+		_mm256_store_ps(laneMins + 16, min2);
+		_mm256_store_ps(laneMaxs, max0);
+		_mm256_store_ps(laneMaxs + 8, max1);
+		_mm256_store_ps(laneMaxs + 16, max2);
+		MergeInterleavedBounds(laneMins, laneMaxs, 24, min, max);
+		return vert;
+	}
+#elif defined(EMBER_SIMD_SSE2)
+	static size_t ReducePositionBoundsSimd(const float* positions, size_t count, float min[3], float max[3]) {
+		__m128 min0 = _mm_set1_ps(std::numeric_limits<float>::infinity());
+		__m128 min1 = min0;
+		__m128 min2 = min0;
+		__m128 max0 = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+		__m128 max1 = max0;
+		__m128 max2 = max0;
+		size_t vert{0};
+		for (; vert + 4 <= count; vert += 4) {
+			const float* p = positions + vert * 3;
+			__m128 a = _mm_loadu_ps(p);
+			__m128 b = _mm_loadu_ps(p + 4);
+			__m128 c = _mm_loadu_ps(p + 8);
+			min0 = _mm_min_ps(min0, a);
+			min1 = _mm_min_ps(min1, b);
+			min2 = _mm_min_ps(min2, c);
+			max0 = _mm_max_ps(max0, a);
+			max1 = _mm_max_ps(max1, b);
+			max2 = _mm_max_ps(max2, c);
+		}
+		alignas(16) float laneMins[12];
+		alignas(16) float laneMaxs[12];
+		_mm_store_ps(laneMins, min0);
+		_mm_store_ps(laneMins + 4, min1);
+		_mm_store_ps(laneMins + 8, min2);
+		_mm_store_ps(laneMaxs, max0);
+		_mm_store_ps(laneMaxs + 4, max1);
+		_mm_store_ps(laneMaxs + 8, max2);
+		MergeInterleavedBounds(laneMins, laneMaxs, 12, min, max);
+		return vert;
+	}
+#endif
+
+#if defined(EMBER_SIMD_SSE2)
+	// [x0 y0 z0 x1] [y1 z1 x2 y2] [z2 x3 y3 z3] -> [x0 x1 x2 x3] [y0 y1 y2 y3] [z0 z1 z2 z3]
+	static void DeinterleaveXyz(const float* p, __m128& x, __m128& y, __m128& z) {
+		__m128 a = _mm_loadu_ps(p);
+		__m128 b = _mm_loadu_ps(p + 4);
+		__m128 c = _mm_loadu_ps(p + 8);
+		__m128 x2y2x3y3 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+		__m128 y0z0y1y1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 2, 1));
+		__m128 z0z0z1z1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+		x = _mm_shuffle_ps(a, x2y2x3y3, _MM_SHUFFLE(2, 0, 3, 0));
+		y = _mm_shuffle_ps(y0z0y1y1, x2y2x3y3, _MM_SHUFFLE(3, 1, 2, 0));
+		z = _mm_shuffle_ps(z0z0z1z1, c, _MM_SHUFFLE(3, 0, 2, 0));
+	}
+#endif
+
+	// The positions are deinterleaved in registers and transformed 4 (8) at a time, then every component has
+	// its own min/max accumulator, so there's no horizontal work until the very end.
+#if defined(EMBER_SIMD_AVX2)
+	static __m256 MulAdd(__m256 a, __m256 b, __m256 c) {
+#if defined(EMBER_SIMD_FMA)
+		return _mm256_fmadd_ps(a, b, c);
+#else
+		return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+	}
+
+	static size_t ReduceTransformedPositionBoundsSimd(const float* positions, size_t count, const float affine[12],
+	                                                  float min[3], float max[3]) {
+		__m256 columns[12];
+		for (uint32_t element = 0; element < 12; element++) {
+			columns[element] = _mm256_set1_ps(affine[element]);
+		}
+		__m256 mins[3];
+		__m256 maxs[3];
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			mins[axis] = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+			maxs[axis] = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+		}
+		size_t vert{0};
+		for (; vert + 8 <= count; vert += 8) {
+			__m128 xLo, yLo, zLo, xHi, yHi, zHi;
+			DeinterleaveXyz(positions + vert * 3, xLo, yLo, zLo);
+			DeinterleaveXyz(positions + vert * 3 + 12, xHi, yHi, zHi);
+			__m256 x = _mm256_insertf128_ps(_mm256_castps128_ps256(xLo), xHi, 1);
+			__m256 y = _mm256_insertf128_ps(_mm256_castps128_ps256(yLo), yHi, 1);
+			__m256 z = _mm256_insertf128_ps(_mm256_castps128_ps256(zLo), zHi, 1);
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				__m256 t = MulAdd(columns[axis], x, columns[9 + axis]);
+				t = MulAdd(columns[3 + axis], y, t);
+				t = MulAdd(columns[6 + axis], z, t);
+				mins[axis] = _mm256_min_ps(mins[axis], t);
+				maxs[axis] = _mm256_max_ps(maxs[axis], t);
+			}
+		}
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			alignas(32) float laneMins[8];
+			alignas(32) float laneMaxs[8];
+			_mm256_store_ps(laneMins, mins[axis]);
+			_mm256_store_ps(laneMaxs, maxs[axis]);
+			min[axis] = std::min(min[axis], *std::min_element(laneMins, laneMins + 8));
+			max[axis] = std::max(max[axis], *std::max_element(laneMaxs, laneMaxs + 8));
+		}
+		return vert;
+	}
+#elif defined(EMBER_SIMD_SSE2)
+	static size_t ReduceTransformedPositionBoundsSimd(const float* positions, size_t count, const float affine[12],
+	                                                  float min[3], float max[3]) {
+		__m128 columns[12];
+		for (uint32_t element = 0; element < 12; element++) {
+			columns[element] = _mm_set1_ps(affine[element]);
+		}
+		__m128 mins[3];
+		__m128 maxs[3];
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			mins[axis] = _mm_set1_ps(std::numeric_limits<float>::infinity());
+			maxs[axis] = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+		}
+		size_t vert{0};
+		for (; vert + 4 <= count; vert += 4) {
+			__m128 x, y, z;
+			DeinterleaveXyz(positions + vert * 3, x, y, z);
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				__m128 t = _mm_add_ps(_mm_mul_ps(columns[axis], x), columns[9 + axis]);
+				t = _mm_add_ps(_mm_mul_ps(columns[3 + axis], y), t);
+				t = _mm_add_ps(_mm_mul_ps(columns[6 + axis], z), t);
+				mins[axis] = _mm_min_ps(mins[axis], t);
+				maxs[axis] = _mm_max_ps(maxs[axis], t);
+			}
+		}
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			alignas(16) float laneMins[4];
+			alignas(16) float laneMaxs[4];
+			_mm_store_ps(laneMins, mins[axis]);
+			_mm_store_ps(laneMaxs, maxs[axis]);
+			min[axis] = std::min(min[axis], *std::min_element(laneMins, laneMins + 4));
+			max[axis] = std::max(max[axis], *std::max_element(laneMaxs, laneMaxs + 4));
+		}
+		return vert;
+	}
+#endif
+
+	// Every chunk is reduced on its own, and the chunk bounds are merged in order at the end.
+	template <typename ReduceChunk>
+	static void ReduceBoundsInParallel(size_t count, float min[3], float max[3], ReduceChunk&& reduceChunk) {
+		size_t chunkCount = GetParallelChunkCount(count, boundsChunkSize);
+		std::vector<float> chunkBounds(chunkCount * 6);
+		for (size_t chunkIdx = 0; chunkIdx < chunkCount; chunkIdx++) {
+			ResetBounds(chunkBounds.data() + chunkIdx * 6, chunkBounds.data() + chunkIdx * 6 + 3);
+		}
+		ParallelFor(count, boundsChunkSize, [&chunkBounds, &reduceChunk](size_t chunkIdx, size_t begin, size_t end) {
+			reduceChunk(begin, end, chunkBounds.data() + chunkIdx * 6, chunkBounds.data() + chunkIdx * 6 + 3);
+		});
+		ResetBounds(min, max);
+		for (size_t chunkIdx = 0; chunkIdx < chunkCount; chunkIdx++) {
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				min[axis] = std::min(min[axis], chunkBounds[chunkIdx * 6 + axis]);
+				max[axis] = std::max(max[axis], chunkBounds[chunkIdx * 6 + 3 + axis]);
+			}
+		}
+	}
+
+	void ComputePositionBounds(const float* positions, size_t count, float min[3], float max[3]) {
+		ReduceBoundsInParallel(count, min, max, [positions](size_t begin, size_t end, float* chunkMin, float* chunkMax) {
+			const float* chunkPositions = positions + begin * 3;
+			size_t chunkCount = end - begin;
+			size_t vert{0};
+#if defined(EMBER_SIMD_SSE2)
+			vert = ReducePositionBoundsSimd(chunkPositions, chunkCount, chunkMin, chunkMax);
+#endif
+			ReducePositionBoundsScalar(chunkPositions + vert * 3, chunkCount - vert, chunkMin, chunkMax);
+		});
+	}
+
+	void ComputeTransformedPositionBounds(const float* positions, size_t count, const float affine[12],
+	                                      float min[3], float max[3]) {
+		ReduceBoundsInParallel(count, min, max, [positions, affine](size_t begin, size_t end, float* chunkMin, float* chunkMax) {
+			const float* chunkPositions = positions + begin * 3;
+			size_t chunkCount = end - begin;
+			size_t vert{0};
+#if defined(EMBER_SIMD_SSE2)
+			vert = ReduceTransformedPositionBoundsSimd(chunkPositions, chunkCount, affine, chunkMin, chunkMax);
+#endif
+			ReduceTransformedPositionBoundsScalar(chunkPositions + vert * 3, chunkCount - vert, affine, chunkMin, chunkMax);
+		});
+	}
+
+	static void TransformAabbsScalar(const AabbOutputStreams& dst, const AabbStreams& src,
+	                                 const AffineTransformStreams& transforms, size_t begin, size_t end) {
+		for (size_t box = begin; box < end; box++) {
+			float center[3]{src.center[0][box], src.center[1][box], src.center[2][box]};
+			float extent[3]{src.extent[0][box], src.extent[1][box], src.extent[2][box]};
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				const float* const* m = transforms.elements;
+				dst.center[axis][box] = m[axis][box] * center[0] + m[3 + axis][box] * center[1] +
+				                        m[6 + axis][box] * center[2] + m[9 + axis][box];
+				dst.extent[axis][box] = std::fabs(m[axis][box]) * extent[0] + std::fabs(m[3 + axis][box]) * extent[1] +
+				                        std::fabs(m[6 + axis][box]) * extent[2];
+			}
+		}
+	}
+
+	// The SoA layout makes this a plain vertical computation, every lane is a different box.
+	// All of the inputs are loaded before any output is stored, so 'dst' can alias 'src'.
+#if defined(EMBER_SIMD_AVX2)
+	static size_t TransformAabbsSimd(const AabbOutputStreams& dst, const AabbStreams& src,
+	                                 const AffineTransformStreams& transforms, size_t begin, size_t end) {
+		const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+		size_t box{begin};
+		for (; box + 8 <= end; box += 8) {
+			__m256 center[3];
+			__m256 extent[3];
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				center[axis] = _mm256_loadu_ps(src.center[axis] + box);
+				extent[axis] = _mm256_loadu_ps(src.extent[axis] + box);
+			}
+			__m256 m[12];
+			for (uint32_t element = 0; element < 12; element++) {
+				m[element] = _mm256_loadu_ps(transforms.elements[element] + box);
+			}
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				__m256 newCenter = MulAdd(m[axis], center[0], m[9 + axis]);
+				newCenter = MulAdd(m[3 + axis], center[1], newCenter);
+				newCenter = MulAdd(m[6 + axis], center[2], newCenter);
+				__m256 newExtent = _mm256_mul_ps(_mm256_and_ps(m[axis], absMask), extent[0]);
+				newExtent = MulAdd(_mm256_and_ps(m[3 + axis], absMask), extent[1], newExtent);
+				newExtent = MulAdd(_mm256_and_ps(m[6 + axis], absMask), extent[2], newExtent);
+				_mm256_storeu_ps(dst.center[axis] + box, newCenter);
+				_mm256_storeu_ps(dst.extent[axis] + box, newExtent);
+			}
+		}
+		return box;
+	}
+#elif defined(EMBER_SIMD_SSE2)
+	static size_t TransformAabbsSimd(const AabbOutputStreams& dst, const AabbStreams& src,
+	                                 const AffineTransformStreams& transforms, size_t begin, size_t end) {
+		const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+		size_t box{begin};
+		for (; box + 4 <= end; box += 4) {
+			__m128 center[3];
+			__m128 extent[3];
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				center[axis] = _mm_loadu_ps(src.center[axis] + box);
+				extent[axis] = _mm_loadu_ps(src.extent[axis] + box);
+			}
+			__m128 m[12];
+			for (uint32_t element = 0; element < 12; element++) {
+				m[element] = _mm_loadu_ps(transforms.elements[element] + box);
+			}
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				__m128 newCenter = _mm_add_ps(_mm_mul_ps(m[axis], center[0]), m[9 + axis]);
+				newCenter = _mm_add_ps(_mm_mul_ps(m[3 + axis], center[1]), newCenter);
+				newCenter = _mm_add_ps(_mm_mul_ps(m[6 + axis], center[2]), newCenter);
+				__m128 newExtent = _mm_mul_ps(_mm_and_ps(m[axis], absMask), extent[0]);
+				newExtent = _mm_add_ps(_mm_mul_ps(_mm_and_ps(m[3 + axis], absMask), extent[1]), newExtent);
+				newExtent = _mm_add_ps(_mm_mul_ps(_mm_and_ps(m[6 + axis], absMask), extent[2]), newExtent);
+				_mm_storeu_ps(dst.center[axis] + box, newCenter);
+				_mm_storeu_ps(dst.extent[axis] + box, newExtent);
+			}
+		}
+		return box;
+	}
+#endif
+
+	void TransformAabbs(const AabbOutputStreams& dst, const AabbStreams& src,
+	                    const AffineTransformStreams& transforms, size_t count) {
+		ParallelFor(count, aabbChunkSize, [&dst, &src, &transforms](size_t, size_t begin, size_t end) {
+			size_t box{begin};
+#if defined(EMBER_SIMD_SSE2)
+			box = TransformAabbsSimd(dst, src, transforms, begin, end);
+#endif
+			TransformAabbsScalar(dst, src, transforms, box, end);
+		});
+	}
+
+}
\ No newline at end of file
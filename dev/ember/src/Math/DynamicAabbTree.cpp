@@ -0,0 +1,408 @@
+#include "Math/DynamicAabbTree.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace ember {
+
+	static numa::Vec3 ComponentMin(const numa::Vec3& a, const numa::Vec3& b) {
+		return numa::Vec3{std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z)};
+	}
+
+	static numa::Vec3 ComponentMax(const numa::Vec3& a, const numa::Vec3& b) {
+		return numa::Vec3{std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z)};
+	}
+
+	// Half of the surface area, the SAH only compares them.
+	static float GetHalfArea(const numa::Vec3& min, const numa::Vec3& max) {
+		float x = max.x - min.x;
+		float y = max.y - min.y;
+		float z = max.z - min.z;
+		return x * y + y * z + z * x;
+	}
+
+	static bool ContainsBox(const numa::Vec3& outerMin, const numa::Vec3& outerMax,
+	                        const numa::Vec3& innerMin, const numa::Vec3& innerMax) {
+		return outerMin.x <= innerMin.x && outerMin.y <= innerMin.y && outerMin.z <= innerMin.z &&
+		       innerMax.x <= outerMax.x && innerMax.y <= outerMax.y && innerMax.z <= outerMax.z;
+	}
+
+	static bool Overlaps(const numa::Vec3& minA, const numa::Vec3& maxA, const numa::Vec3& minB, const numa::Vec3& maxB) {
+		return minA.x <= maxB.x && minB.x <= maxA.x && minA.y <= maxB.y && minB.y <= maxA.y &&
+		       minA.z <= maxB.z && minB.z <= maxA.z;
+	}
+
+	bool DynamicAabbTree::Node::IsLeaf() const {
+		return children[0] == nullNode;
+	}
+
+	DynamicAabbTree::DynamicAabbTree(const DynamicAabbTreeSettings& settings) : settings{settings} {}
+
+	bool DynamicAabbTree::Insert(uint32_t handle, const numa::AABB& aabb) {
+		if (leaves.count(handle) != 0) {
+			return false;
+		}
+		uint32_t leaf = AllocateNode();
+		nodes[leaf].handle = handle;
+		SetFatBounds(nodes[leaf], aabb);
+		InsertLeaf(leaf);
+		leaves.emplace(handle, leaf);
+		return true;
+	}
+
+	bool DynamicAabbTree::Update(uint32_t handle, const numa::AABB& aabb) {
+		auto it = leaves.find(handle);
+		if (it == leaves.end()) {
+			return false;
+		}
+		uint32_t leaf = it->second;
+		if (ContainsBox(nodes[leaf].min, nodes[leaf].max, aabb.MinPoint(), aabb.MaxPoint())) {
+			return false;
+		}
+		RemoveLeaf(leaf);
+		SetFatBounds(nodes[leaf], aabb);
+		InsertLeaf(leaf);
+		return true;
+	}
+
+	bool DynamicAabbTree::Remove(uint32_t handle) {
+		auto it = leaves.find(handle);
+		if (it == leaves.end()) {
+			return false;
+		}
+		RemoveLeaf(it->second);
+		FreeNode(it->second);
+		leaves.erase(it);
+		return true;
+	}
+
+	void DynamicAabbTree::Clear() {
+		nodes.clear();
+		leaves.clear();
+		root = nullNode;
+		freeList = nullNode;
+	}
+
+	bool DynamicAabbTree::Contains(uint32_t handle) const {
+		return leaves.count(handle) != 0;
+	}
+
+	size_t DynamicAabbTree::GetSize() const {
+		return leaves.size();
+	}
+
+	uint32_t DynamicAabbTree::GetHeight() const {
+		return root == nullNode ? 0 : nodes[root].height + 1;
+	}
+
+	bool DynamicAabbTree::GetFatAabb(uint32_t handle, numa::AABB& aabb) const {
+		auto it = leaves.find(handle);
+		if (it == leaves.end()) {
+			return false;
+		}
+		aabb.InitializeFromMinMax(nodes[it->second].min, nodes[it->second].max);
+		return true;
+	}
+
+	void DynamicAabbTree::QueryBox(const numa::AABB& box, std::vector<uint32_t>& handles) const {
+		numa::Vec3 boxMin = box.MinPoint();
+		numa::Vec3 boxMax = box.MaxPoint();
+		Query(handles, [&](const Node& node) {
+			return Overlaps(node.min, node.max, boxMin, boxMax) ? FrustumTestResult::INTERSECTING : FrustumTestResult::OUTSIDE;
+		});
+	}
+
+	void DynamicAabbTree::QuerySphere(const numa::Vec3& center, float radius, std::vector<uint32_t>& handles) const {
+		float radiusSquared = radius * radius;
+		Query(handles, [&](const Node& node) {
+			// The squared distance from the center to the closest point of the box.
+			float dx = std::max({node.min.x - center.x, 0.0f, center.x - node.max.x});
+			float dy = std::max({node.min.y - center.y, 0.0f, center.y - node.max.y});
+			float dz = std::max({node.min.z - center.z, 0.0f, center.z - node.max.z});
+			return dx * dx + dy * dy + dz * dz <= radiusSquared ? FrustumTestResult::INTERSECTING : FrustumTestResult::OUTSIDE;
+		});
+	}
+
+	void DynamicAabbTree::QueryFrustum(const Frustum& frustum, std::vector<uint32_t>& handles) const {
+		Query(handles, [&](const Node& node) {
+			return TestFrustumAabb(frustum, node.min, node.max);
+		});
+	}
+
+	void DynamicAabbTree::QueryRay(const numa::Vec3& origin, const numa::Vec3& direction, std::vector<AabbTreeRayHit>& hits,
+	                               float tMax) const {
+		if (root == nullNode) {
+			return;
+		}
+		const float rayOrigin[3]{origin.x, origin.y, origin.z};
+		// A zero component gives an infinite reciprocal, the slab test then works out
+		// (unless the origin is exactly on a slab, which is counted as a miss or a hit depending on the sign).
+		const float inverseDirection[3]{1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z};
+		size_t firstHit = hits.size();
+		std::vector<uint32_t> stack;
+		stack.push_back(root);
+		while (!stack.empty()) {
+			const Node& node = nodes[stack.back()];
+			stack.pop_back();
+			const float nodeMin[3]{node.min.x, node.min.y, node.min.z};
+			const float nodeMax[3]{node.max.x, node.max.y, node.max.z};
+			float tEnter = 0.0f;
+			float tExit = tMax;
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				float t0 = (nodeMin[axis] - rayOrigin[axis]) * inverseDirection[axis];
+				float t1 = (nodeMax[axis] - rayOrigin[axis]) * inverseDirection[axis];
+				// Written so that a NaN (0 * inf) doesn't narrow the interval.
+				float tNear = t0 < t1 ? t0 : t1;
+				float tFar = t0 < t1 ? t1 : t0;
+				tEnter = tNear > tEnter ? tNear : tEnter;
+				tExit = tFar < tExit ? tFar : tExit;
+			}
+			if (tEnter > tExit) {
+				continue;
+			}
+			if (node.IsLeaf()) {
+				hits.push_back(AabbTreeRayHit{node.handle, tEnter});
+			} else {
+				stack.push_back(node.children[0]);
+				stack.push_back(node.children[1]);
+			}
+		}
+		std::sort(hits.begin() + firstHit, hits.end(), [](const AabbTreeRayHit& a, const AabbTreeRayHit& b) {
+			return a.t < b.t;
+		});
+	}
+
+	uint32_t DynamicAabbTree::AllocateNode() {
+		uint32_t nodeIdx;
+		if (freeList != nullNode) {
+			nodeIdx = freeList;
+			freeList = nodes[nodeIdx].parent;
+			nodes[nodeIdx] = Node{};
+		} else {
+			nodeIdx = static_cast<uint32_t>(nodes.size());
+			nodes.emplace_back();
+		}
+		return nodeIdx;
+	}
+
+	void DynamicAabbTree::FreeNode(uint32_t nodeIdx) {
+		nodes[nodeIdx].parent = freeList;
+		nodes[nodeIdx].height = 0;
+		freeList = nodeIdx;
+	}
+
+	void DynamicAabbTree::InsertLeaf(uint32_t leaf) {
+		if (root == nullNode) {
+			root = leaf;
+			nodes[leaf].parent = nullNode;
+			return;
+		}
+		const numa::Vec3 leafMin = nodes[leaf].min;
+		const numa::Vec3 leafMax = nodes[leaf].max;
+		// Going down, the cost of putting the leaf next to a node is the area of the new parent plus how much
+		// every ancestor grows ('inheritedCost'). Stops when the children can't do better than the current node.
+		uint32_t sibling = root;
+		float inheritedCost = 0.0f;
+		while (!nodes[sibling].IsLeaf()) {
+			const Node& node = nodes[sibling];
+			float area = GetHalfArea(node.min, node.max);
+			float combinedArea = GetHalfArea(ComponentMin(node.min, leafMin), ComponentMax(node.max, leafMax));
+			float cost = combinedArea + inheritedCost;
+			float childInheritedCost = inheritedCost + combinedArea - area;
+
+			float childCosts[2];
+			for (uint32_t childIdx = 0; childIdx < 2; childIdx++) {
+				const Node& child = nodes[node.children[childIdx]];
+				float childCombinedArea = GetHalfArea(ComponentMin(child.min, leafMin), ComponentMax(child.max, leafMax));
+				// A new parent next to a leaf, or the growth of an inner node (its own descent would add at least that).
+				childCosts[childIdx] = child.IsLeaf() ? childCombinedArea + childInheritedCost
+				                                      : childCombinedArea - GetHalfArea(child.min, child.max) + childInheritedCost;
+			}
+			if (cost <= childCosts[0] && cost <= childCosts[1]) {
+				break;
+			}
+			inheritedCost = childInheritedCost;
+			sibling = childCosts[0] <= childCosts[1] ? node.children[0] : node.children[1];
+		}
+
+		uint32_t oldParent = nodes[sibling].parent;
+		uint32_t newParent = AllocateNode();
+		nodes[newParent].parent = oldParent;
+		nodes[newParent].children[0] = sibling;
+		nodes[newParent].children[1] = leaf;
+		nodes[sibling].parent = newParent;
+		nodes[leaf].parent = newParent;
+		if (oldParent == nullNode) {
+			root = newParent;
+		} else {
+			Node& parent = nodes[oldParent];
+			parent.children[parent.children[0] == sibling ? 0 : 1] = newParent;
+		}
+		RefitAncestors(newParent);
+	}
+
+	void DynamicAabbTree::RemoveLeaf(uint32_t leaf) {
+		if (leaf == root) {
+			root = nullNode;
+			return;
+		}
+		uint32_t parent = nodes[leaf].parent;
+		uint32_t grandParent = nodes[parent].parent;
+		uint32_t sibling = nodes[parent].children[nodes[parent].children[0] == leaf ? 1 : 0];
+		nodes[sibling].parent = grandParent;
+		if (grandParent == nullNode) {
+			root = sibling;
+		} else {
+			Node& node = nodes[grandParent];
+			node.children[node.children[0] == parent ? 0 : 1] = sibling;
+		}
+		FreeNode(parent);
+		nodes[leaf].parent = nullNode;
+		if (grandParent != nullNode) {
+			RefitAncestors(grandParent);
+		}
+	}
+
+	void DynamicAabbTree::RefitAncestors(uint32_t nodeIdx) {
+		while (nodeIdx != nullNode) {
+			RefitNode(nodeIdx);
+			RotateNode(nodeIdx);
+			nodeIdx = nodes[nodeIdx].parent;
+		}
+	}
+
+	void DynamicAabbTree::RefitNode(uint32_t nodeIdx) {
+		Node& node = nodes[nodeIdx];
+		const Node& first = nodes[node.children[0]];
+		const Node& second = nodes[node.children[1]];
+		node.min = ComponentMin(first.min, second.min);
+		node.max = ComponentMax(first.max, second.max);
+		node.height = std::max(first.height, second.height) + 1;
+	}
+
+	void DynamicAabbTree::RotateNode(uint32_t nodeIdx) {
+		// A node with the children B and C, and the grandchildren D, E (of B) and F, G (of C).
+		// A grandchild can be swapped with the other child (B with F or G, C with D or E), or with a grandchild
+		// on the other side (D with F or G). Only the areas of B and C change, the one with the smallest sum wins.
+		const Node& node = nodes[nodeIdx];
+		if (node.height < 2) {
+			return;
+		}
+		uint32_t b = node.children[0];
+		uint32_t c = node.children[1];
+		const Node& nodeB = nodes[b];
+		const Node& nodeC = nodes[c];
+		float areaB = GetHalfArea(nodeB.min, nodeB.max);
+		float areaC = GetHalfArea(nodeC.min, nodeC.max);
+		float bestCost = areaB + areaC;
+		uint32_t bestFirst = nullNode;
+		uint32_t bestSecond = nullNode;
+		auto consider = [&](uint32_t first, uint32_t second, float cost) {
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestFirst = first;
+				bestSecond = second;
+			}
+		};
+		auto unionArea = [&](uint32_t first, uint32_t second) {
+			return GetHalfArea(ComponentMin(nodes[first].min, nodes[second].min), ComponentMax(nodes[first].max, nodes[second].max));
+		};
+		if (!nodeC.IsLeaf()) {
+			uint32_t f = nodeC.children[0];
+			uint32_t g = nodeC.children[1];
+			consider(b, f, areaB + unionArea(b, g));
+			consider(b, g, areaB + unionArea(b, f));
+		}
+		if (!nodeB.IsLeaf()) {
+			uint32_t d = nodeB.children[0];
+			uint32_t e = nodeB.children[1];
+			consider(c, d, unionArea(c, e) + areaC);
+			consider(c, e, unionArea(c, d) + areaC);
+			if (!nodeC.IsLeaf()) {
+				uint32_t f = nodeC.children[0];
+				uint32_t g = nodeC.children[1];
+				consider(d, f, unionArea(f, e) + unionArea(d, g));
+				consider(d, g, unionArea(g, e) + unionArea(f, d));
+			}
+		}
+		if (bestFirst == nullNode) {
+			return;
+		}
+		uint32_t firstParent = nodes[bestFirst].parent;
+		uint32_t secondParent = nodes[bestSecond].parent;
+		SwapSubtrees(bestFirst, bestSecond);
+		// The parents are B/C or the node itself, the children first.
+		if (firstParent != nodeIdx) {
+			RefitNode(firstParent);
+		}
+		if (secondParent != nodeIdx) {
+			RefitNode(secondParent);
+		}
+		RefitNode(nodeIdx);
+	}
+
+	void DynamicAabbTree::SwapSubtrees(uint32_t first, uint32_t second) {
+		uint32_t firstParent = nodes[first].parent;
+		uint32_t secondParent = nodes[second].parent;
+		assert(firstParent != secondParent && "Swapping siblings doesn't change anything");
+		Node& nodeA = nodes[firstParent];
+		nodeA.children[nodeA.children[0] == first ? 0 : 1] = second;
+		Node& nodeB = nodes[secondParent];
+		nodeB.children[nodeB.children[0] == second ? 0 : 1] = first;
+		nodes[first].parent = secondParent;
+		nodes[second].parent = firstParent;
+	}
+
+	void DynamicAabbTree::SetFatBounds(Node& leaf, const numa::AABB& aabb) const {
+		numa::Vec3 margin{
+			settings.margin + settings.relativeMargin * std::abs(aabb.radius.x),
+			settings.margin + settings.relativeMargin * std::abs(aabb.radius.y),
+			settings.margin + settings.relativeMargin * std::abs(aabb.radius.z),
+		};
+		leaf.min = aabb.MinPoint() - margin;
+		leaf.max = aabb.MaxPoint() + margin;
+	}
+
+	template <typename NodeTest>
+	void DynamicAabbTree::Query(std::vector<uint32_t>& handles, NodeTest&& nodeTest) const {
+		if (root == nullNode) {
+			return;
+		}
+		std::vector<uint32_t> stack;
+		std::vector<uint32_t> subtreeStack;
+		stack.push_back(root);
+		while (!stack.empty()) {
+			uint32_t nodeIdx = stack.back();
+			stack.pop_back();
+			const Node& node = nodes[nodeIdx];
+			FrustumTestResult result = nodeTest(node);
+			if (result == FrustumTestResult::OUTSIDE) {
+				continue;
+			}
+			if (node.IsLeaf()) {
+				handles.push_back(node.handle);
+			} else if (result == FrustumTestResult::INSIDE) {
+				AppendSubtree(nodeIdx, handles, subtreeStack);
+			} else {
+				stack.push_back(node.children[0]);
+				stack.push_back(node.children[1]);
+			}
+		}
+	}
+
+	void DynamicAabbTree::AppendSubtree(uint32_t nodeIdx, std::vector<uint32_t>& handles, std::vector<uint32_t>& stack) const {
+		stack.push_back(nodeIdx);
+		while (!stack.empty()) {
+			const Node& node = nodes[stack.back()];
+			stack.pop_back();
+			if (node.IsLeaf()) {
+				handles.push_back(node.handle);
+			} else {
+				stack.push_back(node.children[0]);
+				stack.push_back(node.children[1]);
+			}
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "Math/Frustum.h"
+
+#include <cmath>
+
+namespace ember {
+
+	Frustum ExtractFrustum(const numa::Mat4& viewProjection, ClipDepthRange depthRange) {
+		// The rows of the matrix, taken without assuming anything about its memory layout
+		// (same as the affine columns of the mesh bounds).
+		float rows[4][4];
+		for (uint32_t column = 0; column < 4; column++) {
+			numa::Vec4 basis{0.0f};
+			reinterpret_cast<float*>(&basis)[column] = 1.0f;
+			numa::Vec4 matrixColumn = viewProjection * basis;
+			const float* elements = reinterpret_cast<const float*>(&matrixColumn);
+			for (uint32_t row = 0; row < 4; row++) {
+				rows[row][column] = elements[row];
+			}
+		}
+		// '-w <= x <= w' gives the left and the right plane (w + x >= 0, w - x >= 0), and so on.
+		// The near plane is 'z >= 0' or 'z >= -w' depending on the depth range.
+		float planes[Frustum::planeCount][4];
+		for (uint32_t element = 0; element < 4; element++) {
+			planes[0][element] = rows[3][element] + rows[0][element];
+			planes[1][element] = rows[3][element] - rows[0][element];
+			planes[2][element] = rows[3][element] + rows[1][element];
+			planes[3][element] = rows[3][element] - rows[1][element];
+			planes[4][element] = depthRange == ClipDepthRange::ZERO_TO_ONE ? rows[2][element] : rows[3][element] + rows[2][element];
+			planes[5][element] = rows[3][element] - rows[2][element];
+		}
+		Frustum frustum{};
+		for (uint32_t planeIdx = 0; planeIdx < Frustum::planeCount; planeIdx++) {
+			float* plane = planes[planeIdx];
+			float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+			if (length > 0.0f) {
+				frustum.planes[planeIdx] = numa::Vec4{plane[0] / length, plane[1] / length, plane[2] / length, plane[3] / length};
+			} else {
+				// The far plane of an infinite projection.
+				frustum.planes[planeIdx] = numa::Vec4{0.0f, 0.0f, 0.0f, 1.0f};
+			}
+		}
+		return frustum;
+	}
+
+	FrustumTestResult TestFrustumAabb(const Frustum& frustum, const numa::Vec3& min, const numa::Vec3& max) {
+		float center[3]{(min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f};
+		float extent[3]{(max.x - min.x) * 0.5f, (max.y - min.y) * 0.5f, (max.z - min.z) * 0.5f};
+		FrustumTestResult result{FrustumTestResult::INSIDE};
+		for (const numa::Vec4& plane : frustum.planes) {
+			// The distance of the center, and how far the box reaches along the normal (the corner closest to it).
+			float distance = plane.x * center[0] + plane.y * center[1] + plane.z * center[2] + plane.w;
+			float reach = std::abs(plane.x) * extent[0] + std::abs(plane.y) * extent[1] + std::abs(plane.z) * extent[2];
+			if (distance + reach < 0.0f) {
+				return FrustumTestResult::OUTSIDE;
+			}
+			if (distance - reach < 0.0f) {
+				result = FrustumTestResult::INTERSECTING;
+			}
+		}
+		return result;
+	}
+
+	FrustumTestResult TestFrustumSphere(const Frustum& frustum, const numa::Vec3& center, float radius) {
+		FrustumTestResult result{FrustumTestResult::INSIDE};
+		for (const numa::Vec4& plane : frustum.planes) {
+			float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+			if (distance < -radius) {
+				return FrustumTestResult::OUTSIDE;
+			}
+			if (distance < radius) {
+				result = FrustumTestResult::INTERSECTING;
+			}
+		}
+		return result;
+	}
+
+}
\ No newline at end of file
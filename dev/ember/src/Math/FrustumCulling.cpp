@@ -0,0 +1,371 @@
+#include "Math/FrustumCulling.h"
+
+#include "Core/Parallel.h"
+#include "Core/Simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ember {
+
+	// A box is 24 bytes (60 for an OBB) and 6 planes, a chunk is a few hundred microseconds of work.
+	static constexpr size_t cullingChunkSize{16384};
+
+	// The planes as separate components, and the absolute values of the normals for the extents.
+	struct CullingPlanes {
+		float normal[Frustum::planeCount][3];
+		float absNormal[Frustum::planeCount][3];
+		float distance[Frustum::planeCount];
+	};
+
+	static CullingPlanes GetCullingPlanes(const Frustum& frustum) {
+		CullingPlanes planes{};
+		for (uint32_t planeIdx = 0; planeIdx < Frustum::planeCount; planeIdx++) {
+			const numa::Vec4& plane = frustum.planes[planeIdx];
+			planes.normal[planeIdx][0] = plane.x;
+			planes.normal[planeIdx][1] = plane.y;
+			planes.normal[planeIdx][2] = plane.z;
+			planes.absNormal[planeIdx][0] = std::fabs(plane.x);
+			planes.absNormal[planeIdx][1] = std::fabs(plane.y);
+			planes.absNormal[planeIdx][2] = std::fabs(plane.z);
+			planes.distance[planeIdx] = plane.w;
+		}
+		return planes;
+	}
+
+	// Every lane is written, but the count only moves past the visible ones, so there's no branch per box.
+	// 'visible' has room for every box of the chunk, and the count never gets ahead of the box.
+	static void AppendVisibleLanes(uint32_t* visible, size_t& visibleCount, size_t firstBox, uint32_t visibleMask,
+	                               uint32_t laneCount) {
+		for (uint32_t lane = 0; lane < laneCount; lane++) {
+			visible[visibleCount] = static_cast<uint32_t>(firstBox + lane);
+			visibleCount += (visibleMask >> lane) & 1u;
+		}
+	}
+
+	static void CullAabbsScalar(uint32_t* visible, size_t& visibleCount, const CullingPlanes& planes,
+	                            const AabbStreams& boxes, size_t begin, size_t end) {
+		for (size_t box = begin; box < end; box++) {
+			float center[3]{boxes.center[0][box], boxes.center[1][box], boxes.center[2][box]};
+			float extent[3]{boxes.extent[0][box], boxes.extent[1][box], boxes.extent[2][box]};
+			bool outside{false};
+			for (uint32_t planeIdx = 0; planeIdx < Frustum::planeCount; planeIdx++) {
+				const float* n = planes.normal[planeIdx];
+				const float* a = planes.absNormal[planeIdx];
+				float distance = n[0] * center[0] + n[1] * center[1] + n[2] * center[2] + planes.distance[planeIdx];
+				float reach = a[0] * extent[0] + a[1] * extent[1] + a[2] * extent[2];
+				outside |= distance + reach < 0.0f;
+			}
+			AppendVisibleLanes(visible, visibleCount, box, outside ? 0u : 1u, 1);
+		}
+	}
+
+	static void CullObbsScalar(uint32_t* visible, size_t& visibleCount, const CullingPlanes& planes,
+	                           const ObbStreams& boxes, size_t begin, size_t end) {
+		for (size_t box = begin; box < end; box++) {
+			float center[3]{boxes.center[0][box], boxes.center[1][box], boxes.center[2][box]};
+			float extent[3]{boxes.extent[0][box], boxes.extent[1][box], boxes.extent[2][box]};
+			float axes[9];
+			for (uint32_t element = 0; element < 9; element++) {
+				axes[element] = boxes.axes[element][box];
+			}
+			bool outside{false};
+			for (uint32_t planeIdx = 0; planeIdx < Frustum::planeCount; planeIdx++) {
+				const float* n = planes.normal[planeIdx];
+				float distance = n[0] * center[0] + n[1] * center[1] + n[2] * center[2] + planes.distance[planeIdx];
+				// How far the box reaches along the normal: the extents times the projected axes.
+				float reach{0.0f};
+				for (uint32_t axis = 0; axis < 3; axis++) {
+					const float* a = axes + axis * 3;
+					reach += std::fabs(n[0] * a[0] + n[1] * a[1] + n[2] * a[2]) * extent[axis];
+				}
+				outside |= distance + reach < 0.0f;
+			}
+			AppendVisibleLanes(visible, visibleCount, box, outside ? 0u : 1u, 1);
+		}
+	}
+
+	// Every lane is a different box and the planes are broadcast, so the tests are plain vertical math.
+	// A box is culled when it's completely behind one of the planes, the lanes are OR-ed over the planes
+	// and compacted at the end. NaNs compare as "not outside", the box is kept.
+#if defined(EMBER_SIMD_AVX2)
+	static size_t CullAabbsSimd(uint32_t* visible, size_t& visibleCount, const CullingPlanes& planes,
+	                            const AabbStreams& boxes, size_t begin, size_t end) {
+		const __m256 zero = _mm256_setzero_ps();
+		size_t box{begin};
+		for (; box + 8 <= end; box += 8) {
+			__m256 center[3];
+			__m256 extent[3];
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				center[axis] = _mm256_loadu_ps(boxes.center[axis] + box);
+				extent[axis] = _mm256_loadu_ps(boxes.extent[axis] + box);
+			}
+			__m256 outside = zero;
+			for (uint32_t planeIdx = 0; planeIdx < Frustum::planeCount; planeIdx++) {
+				const float* n = planes.normal[planeIdx];
+				const float* a = planes.absNormal[planeIdx];
+				__m256 distance = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(n[0]), center[0]),
+				                                _mm256_mul_ps(_mm256_set1_ps(n[1]), center[1]));
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(n[2]), center[2]));
+				distance = _mm256_add_ps(distance, _mm256_set1_ps(planes.distance[planeIdx]));
+				__m256 reach = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(a[0]), extent[0]),
+				                             _mm256_mul_ps(_mm256_set1_ps(a[1]), extent[1]));
+				reach = _mm256_add_ps(reach, _mm256_mul_ps(_mm256_set1_ps(a[2]), extent[2]));
+				outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, reach), zero, _CMP_LT_OQ));
+			}
+			uint32_t visibleMask = ~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & 0xFFu;
+			AppendVisibleLanes(visible, visibleCount, box, visibleMask, 8);
+		}
+		return box;
+	}
+
+	static size_t CullObbsSimd(uint32_t* visible, size_t& visibleCount, const CullingPlanes& planes,
+	                           const ObbStreams& boxes, size_t begin, size_t end) {
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+		size_t box{begin};
+		for (; box + 8 <= end; box += 8) {
+			__m256 center[3];
+			__m256 extent[3];
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				center[axis] = _mm256_loadu_ps(boxes.center[axis] + box);
+				extent[axis] = _mm256_loadu_ps(boxes.extent[axis] + box);
+			}
+			__m256 axes[9];
+			for (uint32_t element = 0; element < 9; element++) {
+				axes[element] = _mm256_loadu_ps(boxes.axes[element] + box);
+			}
+			__m256 outside = zero;
+			for (uint32_t planeIdx = 0; planeIdx < Frustum::planeCount; planeIdx++) {
+				__m256 n[3];
+				for (uint32_t component = 0; component < 3; component++) {
+					n[component] = _mm256_set1_ps(planes.normal[planeIdx][component]);
+				}
+				__m256 distance = _mm256_add_ps(_mm256_mul_ps(n[0], center[0]), _mm256_mul_ps(n[1], center[1]));
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(n[2], center[2]));
+				distance = _mm256_add_ps(distance, _mm256_set1_ps(planes.distance[planeIdx]));
+				__m256 reach = zero;
+				for (uint32_t axis = 0; axis < 3; axis++) {
+					const __m256* a = axes + axis * 3;
+					__m256 projected = _mm256_add_ps(_mm256_mul_ps(n[0], a[0]), _mm256_mul_ps(n[1], a[1]));
+					projected = _mm256_add_ps(projected, _mm256_mul_ps(n[2], a[2]));
+					reach = _mm256_add_ps(reach, _mm256_mul_ps(_mm256_and_ps(projected, absMask), extent[axis]));
+				}
+				outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, reach), zero, _CMP_LT_OQ));
+			}
+			uint32_t visibleMask = ~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & 0xFFu;
+			AppendVisibleLanes(visible, visibleCount, box, visibleMask, 8);
+		}
+		return box;
+	}
+#elif defined(EMBER_SIMD_SSE2)
+	static size_t CullAabbsSimd(uint32_t* visible, size_t& visibleCount, const CullingPlanes& planes,
+	                            const AabbStreams& boxes, size_t begin, size_t end) {
+		const __m128 zero = _mm_setzero_ps();
+		size_t box{begin};
+		for (; box + 4 <= end; box += 4) {
+			__m128 center[3];
+			__m128 extent[3];
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				center[axis] = _mm_loadu_ps(boxes.center[axis] + box);
+				extent[axis] = _mm_loadu_ps(boxes.extent[axis] + box);
+			}
+			__m128 outside = zero;
+			for (uint32_t planeIdx = 0; planeIdx < Frustum::planeCount; planeIdx++) {
+				const float* n = planes.normal[planeIdx];
+				const float* a = planes.absNormal[planeIdx];
+				__m128 distance = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(n[0]), center[0]), _mm_mul_ps(_mm_set1_ps(n[1]), center[1]));
+				distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(n[2]), center[2]));
+				distance = _mm_add_ps(distance, _mm_set1_ps(planes.distance[planeIdx]));
+				__m128 reach = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[0]), extent[0]), _mm_mul_ps(_mm_set1_ps(a[1]), extent[1]));
+				reach = _mm_add_ps(reach, _mm_mul_ps(_mm_set1_ps(a[2]), extent[2]));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, reach), zero));
+			}
+			uint32_t visibleMask = ~static_cast<uint32_t>(_mm_movemask_ps(outside)) & 0xFu;
+			AppendVisibleLanes(visible, visibleCount, box, visibleMask, 4);
+		}
+		return box;
+	}
+
+	static size_t CullObbsSimd(uint32_t* visible, size_t& visibleCount, const CullingPlanes& planes,
+	                           const ObbStreams& boxes, size_t begin, size_t end) {
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+		size_t box{begin};
+		for (; box + 4 <= end; box += 4) {
+			__m128 center[3];
+			__m128 extent[3];
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				center[axis] = _mm_loadu_ps(boxes.center[axis] + box);
+				extent[axis] = _mm_loadu_ps(boxes.extent[axis] + box);
+			}
+			__m128 axes[9];
+			for (uint32_t element = 0; element < 9; element++) {
+				axes[element] = _mm_loadu_ps(boxes.axes[element] + box);
+			}
+			__m128 outside = zero;
+			for (uint32_t planeIdx = 0; planeIdx < Frustum::planeCount; planeIdx++) {
+				__m128 n[3];
+				for (uint32_t component = 0; component < 3; component++) {
+					n[component] = _mm_set1_ps(planes.normal[planeIdx][component]);
+				}
+				__m128 distance = _mm_add_ps(_mm_mul_ps(n[0], center[0]), _mm_mul_ps(n[1], center[1]));
+				distance = _mm_add_ps(distance, _mm_mul_ps(n[2], center[2]));
+				distance = _mm_add_ps(distance, _mm_set1_ps(planes.distance[planeIdx]));
+				__m128 reach = zero;
+				for (uint32_t axis = 0; axis < 3; axis++) {
+					const __m128* a = axes + axis * 3;
+					__m128 projected = _mm_add_ps(_mm_mul_ps(n[0], a[0]), _mm_mul_ps(n[1], a[1]));
+					projected = _mm_add_ps(projected, _mm_mul_ps(n[2], a[2]));
+					reach = _mm_add_ps(reach, _mm_mul_ps(_mm_and_ps(projected, absMask), extent[axis]));
+				}
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, reach), zero));
+			}
+			uint32_t visibleMask = ~static_cast<uint32_t>(_mm_movemask_ps(outside)) & 0xFu;
+			AppendVisibleLanes(visible, visibleCount, box, visibleMask, 4);
+		}
+		return box;
+	}
+#endif
+
+	// Every chunk compacts its visible boxes to the start of its own range of 'visible',
+	// then the ranges are moved together in order (always to the left, so in place).
+	template <typename CullChunk>
+	static void CullInParallel(std::vector<uint32_t>& visible, size_t count, CullChunk&& cullChunk) {
+		visible.resize(count);
+		size_t chunkCount = GetParallelChunkCount(count, cullingChunkSize);
+		std::vector<size_t> chunkBegins(chunkCount, 0);
+		std::vector<size_t> chunkVisibleCounts(chunkCount, 0);
+		ParallelFor(count, cullingChunkSize, [&](size_t chunkIdx, size_t begin, size_t end) {
+			chunkBegins[chunkIdx] = begin;
+			chunkVisibleCounts[chunkIdx] = cullChunk(visible.data() + begin, begin, end);
+		});
+		size_t visibleCount{0};
+		for (size_t chunkIdx = 0; chunkIdx < chunkCount; chunkIdx++) {
+			auto chunkVisible = visible.begin() + chunkBegins[chunkIdx];
+			std::copy(chunkVisible, chunkVisible + chunkVisibleCounts[chunkIdx], visible.begin() + visibleCount);
+			visibleCount += chunkVisibleCounts[chunkIdx];
+		}
+		visible.resize(visibleCount);
+	}
+
+	void CullAabbs(std::vector<uint32_t>& visible, const Frustum& frustum, const AabbStreams& boxes, size_t count) {
+		CullingPlanes planes = GetCullingPlanes(frustum);
+		CullInParallel(visible, count, [&planes, &boxes](uint32_t* chunkVisible, size_t begin, size_t end) {
+			size_t visibleCount{0};
+			size_t box{begin};
+#if defined(EMBER_SIMD_SSE2)
+			box = CullAabbsSimd(chunkVisible, visibleCount, planes, boxes, begin, end);
+#endif
+			CullAabbsScalar(chunkVisible, visibleCount, planes, boxes, box, end);
+			return visibleCount;
+		});
+	}
+
+	void CullObbs(std::vector<uint32_t>& visible, const Frustum& frustum, const ObbStreams& boxes, size_t count) {
+		CullingPlanes planes = GetCullingPlanes(frustum);
+		CullInParallel(visible, count, [&planes, &boxes](uint32_t* chunkVisible, size_t begin, size_t end) {
+			size_t visibleCount{0};
+			size_t box{begin};
+#if defined(EMBER_SIMD_SSE2)
+			box = CullObbsSimd(chunkVisible, visibleCount, planes, boxes, begin, end);
+#endif
+			CullObbsScalar(chunkVisible, visibleCount, planes, boxes, box, end);
+			return visibleCount;
+		});
+	}
+
+	void AabbBatch::Clear() {
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			center[axis].clear();
+			extent[axis].clear();
+		}
+	}
+
+	void AabbBatch::Reserve(size_t count) {
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			center[axis].reserve(count);
+			extent[axis].reserve(count);
+		}
+	}
+
+	void AabbBatch::Add(const numa::AABB& aabb) {
+		center[0].push_back(aabb.center.x);
+		center[1].push_back(aabb.center.y);
+		center[2].push_back(aabb.center.z);
+		extent[0].push_back(aabb.radius.x);
+		extent[1].push_back(aabb.radius.y);
+		extent[2].push_back(aabb.radius.z);
+	}
+
+	size_t AabbBatch::GetSize() const {
+		return center[0].size();
+	}
+
+	AabbStreams AabbBatch::GetStreams() const {
+		AabbStreams streams{};
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			streams.center[axis] = center[axis].data();
+			streams.extent[axis] = extent[axis].data();
+		}
+		return streams;
+	}
+
+	void ObbBatch::Clear() {
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			center[axis].clear();
+			extent[axis].clear();
+		}
+		for (std::vector<float>& element : axes) {
+			element.clear();
+		}
+	}
+
+	void ObbBatch::Reserve(size_t count) {
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			center[axis].reserve(count);
+			extent[axis].reserve(count);
+		}
+		for (std::vector<float>& element : axes) {
+			element.reserve(count);
+		}
+	}
+
+	void ObbBatch::Add(const numa::OBB& obb) {
+		center[0].push_back(obb.center.x);
+		center[1].push_back(obb.center.y);
+		center[2].push_back(obb.center.z);
+		extent[0].push_back(obb.radius.x);
+		extent[1].push_back(obb.radius.y);
+		extent[2].push_back(obb.radius.z);
+		// The columns of the linear part, taken without assuming anything about the memory layout of the matrix.
+		const numa::Vec4 basis[3]{
+			numa::Vec4{1.0f, 0.0f, 0.0f, 0.0f},
+			numa::Vec4{0.0f, 1.0f, 0.0f, 0.0f},
+			numa::Vec4{0.0f, 0.0f, 1.0f, 0.0f},
+		};
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			numa::Vec4 column = obb.rotMat * basis[axis];
+			axes[axis * 3 + 0].push_back(column.x);
+			axes[axis * 3 + 1].push_back(column.y);
+			axes[axis * 3 + 2].push_back(column.z);
+		}
+	}
+
+	size_t ObbBatch::GetSize() const {
+		return center[0].size();
+	}
+
+	ObbStreams ObbBatch::GetStreams() const {
+		ObbStreams streams{};
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			streams.center[axis] = center[axis].data();
+			streams.extent[axis] = extent[axis].data();
+		}
+		for (uint32_t element = 0; element < 9; element++) {
+			streams.axes[element] = axes[element].data();
+		}
+		return streams;
+	}
+
+}
\ No newline at end of file
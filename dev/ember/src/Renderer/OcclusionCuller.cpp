@@ -0,0 +1,647 @@
+#include "Renderer/OcclusionCuller.h"
+
+#include "Core/Parallel.h"
+#include "Core/Simd.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace ember {
+
+	static constexpr size_t occluderVertexChunkSize{16384};
+	static constexpr size_t occluderTriangleChunkSize{8192};
+	// A band of tile rows per thread at least, there are only a few dozen rows.
+	static constexpr size_t rasterTileRowChunkSize{2};
+	// A box test is 8 transformed corners and a few tiles.
+	static constexpr size_t occlusionTestChunkSize{4096};
+
+	static constexpr uint32_t edgeLeft{0};
+	static constexpr uint32_t edgeRight{1};
+	static constexpr uint32_t edgeHorizontal{2};
+
+	// The rows of the matrix, taken without assuming anything about its memory layout.
+	static void GetMatrixRows(const numa::Mat4& matrix, float rows[4][4]) {
+		for (uint32_t column = 0; column < 4; column++) {
+			numa::Vec4 basis{0.0f};
+			reinterpret_cast<float*>(&basis)[column] = 1.0f;
+			numa::Vec4 matrixColumn = matrix * basis;
+			const float* elements = reinterpret_cast<const float*>(&matrixColumn);
+			for (uint32_t row = 0; row < 4; row++) {
+				rows[row][column] = elements[row];
+			}
+		}
+	}
+
+	// The GPU clips the depth with the near side plane (z >= 0 or z >= -w) and the far side one (z <= w),
+	// whichever of them is the near plane (the reversed depth).
+	static float GetDepthPlaneDistance(const float* v, uint32_t plane, ClipDepthRange depthRange) {
+		if (plane == 0) {
+			return depthRange == ClipDepthRange::ZERO_TO_ONE ? v[2] : v[2] + v[3];
+		}
+		return v[3] - v[2];
+	}
+	// Bigger is nearer: 1/w, or the distance to the far side plane for the orthographic projections (w is 1).
+	static float GetVertexDepth(const float* v, bool orthographic) {
+		return orthographic ? v[3] - v[2] : 1.0f / v[3];
+	}
+
+	static void UpdateTileMasks(uint32_t* tileMask, float& depth0, float& depth1, const uint32_t mask[8], float depth) {
+		if (depth <= depth0) {
+			// Behind the layer that covers the whole tile.
+			return;
+		}
+		// The working layer is dropped when the new triangle is much nearer than it (farther from it than it's from
+		// the complete layer), it would only hold the new triangle back from forming a better layer.
+		if (depth - depth1 > depth1 - depth0) {
+			std::fill(tileMask, tileMask + 8, 0u);
+			depth1 = std::numeric_limits<float>::max();
+		}
+		depth1 = std::min(depth1, depth);
+		uint32_t covered{~0u};
+		for (uint32_t row = 0; row < 8; row++) {
+			tileMask[row] |= mask[row];
+			covered &= tileMask[row];
+		}
+		if (covered == ~0u) {
+			depth0 = std::max(depth0, depth1);
+			std::fill(tileMask, tileMask + 8, 0u);
+			depth1 = std::numeric_limits<float>::max();
+		}
+	}
+
+#if defined(EMBER_SIMD_AVX2)
+	void OcclusionCuller::ComputeRowSpans(const TriangleEdge edges[3], uint32_t firstRow, uint32_t width,
+	                                      int32_t starts[8], int32_t ends[8]) {
+		const __m256 rowY = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(firstRow) + 0.5f),
+		                                  _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f));
+		const __m256 infinity = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+		__m256 left = _mm256_sub_ps(_mm256_setzero_ps(), infinity);
+		__m256 right = infinity;
+		for (uint32_t edgeIdx = 0; edgeIdx < 3; edgeIdx++) {
+			const TriangleEdge& edge = edges[edgeIdx];
+			__m256 offset = _mm256_mul_ps(_mm256_set1_ps(edge.slope), _mm256_sub_ps(rowY, _mm256_set1_ps(edge.y)));
+			if (edge.kind == edgeLeft) {
+				left = _mm256_max_ps(left, _mm256_add_ps(_mm256_set1_ps(edge.x), offset));
+			} else if (edge.kind == edgeRight) {
+				right = _mm256_min_ps(right, _mm256_add_ps(_mm256_set1_ps(edge.x), offset));
+			} else {
+				__m256 outside = _mm256_cmp_ps(offset, _mm256_setzero_ps(), _CMP_LT_OQ);
+				left = _mm256_blendv_ps(left, infinity, outside);
+			}
+		}
+		// Clamped to just outside of the screen first, so that the conversion can't overflow.
+		const __m256 lowest = _mm256_set1_ps(-1.0f);
+		const __m256 highest = _mm256_set1_ps(static_cast<float>(width) + 1.0f);
+		const __m256 half = _mm256_set1_ps(0.5f);
+		__m256 first = _mm256_ceil_ps(_mm256_min_ps(_mm256_max_ps(_mm256_sub_ps(left, half), lowest), highest));
+		__m256 last = _mm256_floor_ps(_mm256_min_ps(_mm256_max_ps(_mm256_sub_ps(right, half), lowest), highest));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(starts), _mm256_cvttps_epi32(first));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(ends),
+		                    _mm256_add_epi32(_mm256_cvttps_epi32(last), _mm256_set1_epi32(1)));
+	}
+#elif defined(EMBER_SIMD_SSE2)
+	// 'v' is in [-1, width + 1].
+	static __m128i FloorToInt(__m128 v) {
+#if defined(EMBER_SIMD_SSE41)
+		return _mm_cvttps_epi32(_mm_floor_ps(v));
+#else
+		// Truncation is the floor for the positive numbers.
+		return _mm_sub_epi32(_mm_cvttps_epi32(_mm_add_ps(v, _mm_set1_ps(2.0f))), _mm_set1_epi32(2));
+#endif
+	}
+
+	static __m128i CeilToInt(__m128 v) {
+		// The floor, plus one where it's below the value.
+		__m128i floor = FloorToInt(v);
+		__m128 below = _mm_cmplt_ps(_mm_cvtepi32_ps(floor), v);
+		return _mm_sub_epi32(floor, _mm_castps_si128(below));
+	}
+
+	void OcclusionCuller::ComputeRowSpans(const TriangleEdge edges[3], uint32_t firstRow, uint32_t width,
+	                                      int32_t starts[8], int32_t ends[8]) {
+		const __m128 infinity = _mm_set1_ps(std::numeric_limits<float>::infinity());
+		const __m128 lowest = _mm_set1_ps(-1.0f);
+		const __m128 highest = _mm_set1_ps(static_cast<float>(width) + 1.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		for (uint32_t quad = 0; quad < 2; quad++) {
+			float quadY = static_cast<float>(firstRow + quad * 4) + 0.5f;
+			__m128 rowY = _mm_add_ps(_mm_set1_ps(quadY), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+			__m128 left = _mm_sub_ps(_mm_setzero_ps(), infinity);
+			__m128 right = infinity;
+			for (uint32_t edgeIdx = 0; edgeIdx < 3; edgeIdx++) {
+				const TriangleEdge& edge = edges[edgeIdx];
+				__m128 offset = _mm_mul_ps(_mm_set1_ps(edge.slope), _mm_sub_ps(rowY, _mm_set1_ps(edge.y)));
+				if (edge.kind == edgeLeft) {
+					left = _mm_max_ps(left, _mm_add_ps(_mm_set1_ps(edge.x), offset));
+				} else if (edge.kind == edgeRight) {
+					right = _mm_min_ps(right, _mm_add_ps(_mm_set1_ps(edge.x), offset));
+				} else {
+					__m128 outside = _mm_cmplt_ps(offset, _mm_setzero_ps());
+					left = _mm_or_ps(_mm_and_ps(outside, infinity), _mm_andnot_ps(outside, left));
+				}
+			}
+			__m128 first = _mm_min_ps(_mm_max_ps(_mm_sub_ps(left, half), lowest), highest);
+			__m128 last = _mm_min_ps(_mm_max_ps(_mm_sub_ps(right, half), lowest), highest);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(starts + quad * 4), CeilToInt(first));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(ends + quad * 4), _mm_add_epi32(FloorToInt(last), _mm_set1_epi32(1)));
+		}
+	}
+#else
+	void OcclusionCuller::ComputeRowSpans(const TriangleEdge edges[3], uint32_t firstRow, uint32_t width,
+	                                      int32_t starts[8], int32_t ends[8]) {
+		for (uint32_t row = 0; row < 8; row++) {
+			float rowY = static_cast<float>(firstRow + row) + 0.5f;
+			float left = -std::numeric_limits<float>::infinity();
+			float right = std::numeric_limits<float>::infinity();
+			for (uint32_t edgeIdx = 0; edgeIdx < 3; edgeIdx++) {
+				const TriangleEdge& edge = edges[edgeIdx];
+				float offset = edge.slope * (rowY - edge.y);
+				if (edge.kind == edgeLeft) {
+					left = std::max(left, edge.x + offset);
+				} else if (edge.kind == edgeRight) {
+					right = std::min(right, edge.x + offset);
+				} else if (offset < 0.0f) {
+					left = std::numeric_limits<float>::infinity();
+				}
+			}
+			float highest = static_cast<float>(width) + 1.0f;
+			starts[row] = static_cast<int32_t>(std::ceil(std::min(std::max(left - 0.5f, -1.0f), highest)));
+			ends[row] = static_cast<int32_t>(std::floor(std::min(std::max(right - 0.5f, -1.0f), highest))) + 1;
+		}
+	}
+#endif
+
+	// The coverage masks of a tile from the spans, the bits [start, end) relative to the tile.
+	// Returns 'false' if nothing is covered.
+	static bool BuildRowMasks(const int32_t starts[8], const int32_t ends[8], int32_t tileX, uint32_t masks[8]) {
+#if defined(EMBER_SIMD_AVX2)
+		// A shift by 32 or more gives 0, so the full rows need no special case.
+		const __m256i tileStart = _mm256_set1_epi32(tileX);
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i width = _mm256_set1_epi32(32);
+		__m256i start = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(starts));
+		__m256i end = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ends));
+		start = _mm256_min_epi32(_mm256_max_epi32(_mm256_sub_epi32(start, tileStart), zero), width);
+		end = _mm256_min_epi32(_mm256_max_epi32(_mm256_sub_epi32(end, tileStart), zero), width);
+		const __m256i ones = _mm256_set1_epi32(-1);
+		__m256i mask = _mm256_andnot_si256(_mm256_sllv_epi32(ones, end), _mm256_sllv_epi32(ones, start));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(masks), mask);
+		return !_mm256_testz_si256(mask, mask);
+#else
+		uint32_t any{0};
+		for (uint32_t row = 0; row < 8; row++) {
+			int32_t start = std::min(std::max(starts[row] - tileX, 0), 32);
+			int32_t end = std::min(std::max(ends[row] - tileX, 0), 32);
+			uint64_t bits = end > start ? (uint64_t{1} << end) - (uint64_t{1} << start) : 0;
+			masks[row] = static_cast<uint32_t>(bits);
+			any |= masks[row];
+		}
+		return any != 0;
+#endif
+	}
+
+	OcclusionCuller::OcclusionCuller(const OcclusionCullerSettings& settings) : settings{settings} {
+		tileCountX = std::max((settings.width + tileWidth - 1) / tileWidth, 1u);
+		tileCountY = std::max((settings.height + tileHeight - 1) / tileHeight, 1u);
+		this->settings.width = tileCountX * tileWidth;
+		this->settings.height = tileCountY * tileHeight;
+		tiles.resize(static_cast<size_t>(tileCountX) * tileCountY);
+		uint32_t levelWidth = tileCountX;
+		uint32_t levelHeight = tileCountY;
+		while (true) {
+			pyramidWidths.push_back(levelWidth);
+			pyramidHeights.push_back(levelHeight);
+			depthPyramid.emplace_back(static_cast<size_t>(levelWidth) * levelHeight, 0.0f);
+			if (levelWidth == 1 && levelHeight == 1) {
+				break;
+			}
+			levelWidth = (levelWidth + 1) / 2;
+			levelHeight = (levelHeight + 1) / 2;
+		}
+		BeginFrame(numa::Mat4{});
+	}
+
+	void OcclusionCuller::BeginFrame(const numa::Mat4& viewProjection) {
+		GetMatrixRows(viewProjection, this->viewProjection);
+		triangles.clear();
+		for (Tile& tile : tiles) {
+			std::fill(tile.mask, tile.mask + tileHeight, 0u);
+			tile.depth0 = 0.0f;
+			tile.depth1 = std::numeric_limits<float>::max();
+		}
+		BuildDepthPyramid();
+	}
+
+	void OcclusionCuller::AddOccluder(const float* positions, uint32_t vertexCount, const uint32_t* indices, size_t indexCount,
+	                                  const numa::Mat4& world, bool cullBackFaces) {
+		// Straight to the clip space with the view-projection times the world matrix.
+		float worldRows[4][4];
+		GetMatrixRows(world, worldRows);
+		float clipRows[4][4];
+		for (uint32_t row = 0; row < 4; row++) {
+			for (uint32_t column = 0; column < 4; column++) {
+				clipRows[row][column] = viewProjection[row][0] * worldRows[0][column] + viewProjection[row][1] * worldRows[1][column] +
+				                        viewProjection[row][2] * worldRows[2][column] + viewProjection[row][3] * worldRows[3][column];
+			}
+		}
+		clipPositions.resize(static_cast<size_t>(vertexCount) * 4);
+		float* clip = clipPositions.data();
+		ParallelFor(vertexCount, occluderVertexChunkSize, [positions, clip, &clipRows](size_t, size_t begin, size_t end) {
+			for (size_t vert = begin; vert < end; vert++) {
+				const float* p = positions + vert * 3;
+				for (uint32_t row = 0; row < 4; row++) {
+					clip[vert * 4 + row] = clipRows[row][0] * p[0] + clipRows[row][1] * p[1] + clipRows[row][2] * p[2] + clipRows[row][3];
+				}
+			}
+		});
+
+		// Every chunk sets up its own triangles, they're appended in the order of the chunks.
+		size_t triangleCount = indexCount / 3;
+		size_t chunkCount = GetParallelChunkCount(triangleCount, occluderTriangleChunkSize);
+		std::vector<std::vector<Triangle>> chunkTriangles(chunkCount);
+		ParallelFor(triangleCount, occluderTriangleChunkSize,
+		            [this, indices, clip, cullBackFaces, &chunkTriangles](size_t chunkIdx, size_t begin, size_t end) {
+			for (size_t tri = begin; tri < end; tri++) {
+				size_t corners[3];
+				for (uint32_t corner = 0; corner < 3; corner++) {
+					corners[corner] = indices != nullptr ? indices[tri * 3 + corner] : tri * 3 + corner;
+				}
+				SetupTriangle(chunkTriangles[chunkIdx], clip + corners[0] * 4, clip + corners[1] * 4, clip + corners[2] * 4,
+				              cullBackFaces);
+			}
+		});
+		for (const std::vector<Triangle>& chunk : chunkTriangles) {
+			triangles.insert(triangles.end(), chunk.begin(), chunk.end());
+		}
+	}
+
+	bool OcclusionCuller::AddOccluder(const Mesh& mesh, const numa::Mat4& world, uint32_t lodLevel) {
+		if (mesh.GetMeshTopology() != MeshTopology::TRIANGLES) {
+			return false;
+		}
+		MeshDataView dataView = mesh.GetDataView();
+		const uint32_t* indices = dataView.indices.empty() ? nullptr : dataView.indices.data();
+		size_t indexCount = indices != nullptr ? dataView.indices.size() : dataView.positions.size();
+		const std::vector<IndexBufferLod>& lods = mesh.GetLods();
+		if (lodLevel > 0 && lods.size() > 1) {
+			// The levels after the full detail one live in their own array, right after the indices.
+			const IndexBufferLod& lod = lods[std::min<size_t>(lodLevel, lods.size() - 1)];
+			indices = mesh.GetLodIndices().data() + (lod.indexOffset - dataView.indices.size());
+			indexCount = lod.indexCount;
+		}
+		AddOccluder(reinterpret_cast<const float*>(dataView.positions.data()), static_cast<uint32_t>(dataView.positions.size()),
+		            indices, indexCount, world, mesh.CullBackFaces());
+		return true;
+	}
+
+	void OcclusionCuller::RasterizeOccluders() {
+		// Every tile row is rasterized by a single thread, in the order the occluders were added, so the result
+		// doesn't depend on the thread count. The rows are interleaved between the threads, the occluders
+		// tend to be in the lower half of the screen.
+		size_t chunkCount = std::max(GetParallelChunkCount(tileCountY, rasterTileRowChunkSize), size_t{1});
+		std::vector<uint32_t> rowOrder;
+		rowOrder.reserve(tileCountY);
+		for (size_t firstRow = 0; firstRow < chunkCount; firstRow++) {
+			for (size_t tileY = firstRow; tileY < tileCountY; tileY += chunkCount) {
+				rowOrder.push_back(static_cast<uint32_t>(tileY));
+			}
+		}
+		ParallelFor(rowOrder.size(), rasterTileRowChunkSize, [this, &rowOrder](size_t, size_t begin, size_t end) {
+			for (size_t rowIdx = begin; rowIdx < end; rowIdx++) {
+				RasterizeTileRow(rowOrder[rowIdx]);
+			}
+		});
+		BuildDepthPyramid();
+	}
+
+	bool OcclusionCuller::IsAabbVisible(const numa::Vec3& min, const numa::Vec3& max) const {
+		float minX = std::numeric_limits<float>::infinity();
+		float minY = std::numeric_limits<float>::infinity();
+		float maxX = -std::numeric_limits<float>::infinity();
+		float maxY = -std::numeric_limits<float>::infinity();
+		float nearestDepth{0.0f};
+		for (uint32_t corner = 0; corner < 8; corner++) {
+			float p[3]{corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y, corner & 4 ? max.z : min.z};
+			float clip[4];
+			for (uint32_t row = 0; row < 4; row++) {
+				clip[row] = viewProjection[row][0] * p[0] + viewProjection[row][1] * p[1] + viewProjection[row][2] * p[2] + viewProjection[row][3];
+			}
+			if (!(clip[3] > 0.0f)) {
+				return true;
+			}
+			float invW = 1.0f / clip[3];
+			float x = (clip[0] * invW * 0.5f + 0.5f) * static_cast<float>(settings.width);
+			float y = (clip[1] * invW * 0.5f + 0.5f) * static_cast<float>(settings.height);
+			minX = std::min(minX, x);
+			minY = std::min(minY, y);
+			maxX = std::max(maxX, x);
+			maxY = std::max(maxY, y);
+			nearestDepth = std::max(nearestDepth, GetVertexDepth(clip, settings.orthographic));
+		}
+		float width = static_cast<float>(settings.width);
+		float height = static_cast<float>(settings.height);
+		if (!(maxX > 0.0f && minX < width && maxY > 0.0f && minY < height)) {
+			return true;
+		}
+		uint32_t firstX = static_cast<uint32_t>(std::max(minX, 0.0f)) / tileWidth;
+		uint32_t lastX = static_cast<uint32_t>(std::min(maxX, width - 1.0f)) / tileWidth;
+		uint32_t firstY = static_cast<uint32_t>(std::max(minY, 0.0f)) / tileHeight;
+		uint32_t lastY = static_cast<uint32_t>(std::min(maxY, height - 1.0f)) / tileHeight;
+		// The coarsest test is the level where the box covers 2x2 nodes at most. It's weaker (the nodes are
+		// the farthest depth of their tiles), when it fails the tiles themselves decide.
+		uint32_t level{0};
+		while (level + 1 < depthPyramid.size() && ((lastX >> level) - (firstX >> level) > 1 || (lastY >> level) - (firstY >> level) > 1)) {
+			level++;
+		}
+		if (IsTileRangeOccluded(level, firstX >> level, lastX >> level, firstY >> level, lastY >> level, nearestDepth)) {
+			return false;
+		}
+		if (level == 0) {
+			return true;
+		}
+		return !IsTileRangeOccluded(0, firstX, lastX, firstY, lastY, nearestDepth);
+	}
+
+	void OcclusionCuller::CullAabbs(std::vector<uint32_t>& visible, const AabbStreams& boxes, const uint32_t* candidates,
+	                                size_t candidateCount) const {
+		if (candidates != visible.data()) {
+			visible.resize(candidateCount);
+		}
+		assert(candidateCount <= visible.size() && "The candidates can only alias the whole output");
+		// Every chunk compacts its visible boxes to the start of its own range of 'visible' (never past what it
+		// has read, so the candidates can be the output), then the ranges are moved together in order.
+		size_t chunkCount = GetParallelChunkCount(candidateCount, occlusionTestChunkSize);
+		std::vector<size_t> chunkBegins(chunkCount, 0);
+		std::vector<size_t> chunkVisibleCounts(chunkCount, 0);
+		uint32_t* output = visible.data();
+		ParallelFor(candidateCount, occlusionTestChunkSize, [&](size_t chunkIdx, size_t begin, size_t end) {
+			size_t visibleCount{0};
+			for (size_t candidateIdx = begin; candidateIdx < end; candidateIdx++) {
+				uint32_t box = candidates[candidateIdx];
+				numa::Vec3 center{boxes.center[0][box], boxes.center[1][box], boxes.center[2][box]};
+				numa::Vec3 extent{boxes.extent[0][box], boxes.extent[1][box], boxes.extent[2][box]};
+				if (IsAabbVisible(center - extent, center + extent)) {
+					output[begin + visibleCount++] = box;
+				}
+			}
+			chunkBegins[chunkIdx] = begin;
+			chunkVisibleCounts[chunkIdx] = visibleCount;
+		});
+		size_t visibleCount{0};
+		for (size_t chunkIdx = 0; chunkIdx < chunkCount; chunkIdx++) {
+			const uint32_t* chunkVisible = output + chunkBegins[chunkIdx];
+			std::copy(chunkVisible, chunkVisible + chunkVisibleCounts[chunkIdx], output + visibleCount);
+			visibleCount += chunkVisibleCounts[chunkIdx];
+		}
+		visible.resize(visibleCount);
+	}
+
+	uint32_t OcclusionCuller::GetWidth() const {
+		return settings.width;
+	}
+
+	uint32_t OcclusionCuller::GetHeight() const {
+		return settings.height;
+	}
+
+	size_t OcclusionCuller::GetOccluderTriangleCount() const {
+		return triangles.size();
+	}
+
+	float OcclusionCuller::GetTileDepth(uint32_t tileX, uint32_t tileY) const {
+		assert(tileX < tileCountX && tileY < tileCountY && "Tile out of bounds");
+		return tiles[static_cast<size_t>(tileY) * tileCountX + tileX].depth0;
+	}
+
+	void OcclusionCuller::SetupTriangle(std::vector<Triangle>& triangles, const float* v0, const float* v1, const float* v2,
+	                                    bool cullBackFaces) const {
+		const float* vertices[3]{v0, v1, v2};
+		float distances[2][3];
+		bool anyOutside{false};
+		for (uint32_t plane = 0; plane < 2; plane++) {
+			uint32_t outsideCount{0};
+			for (uint32_t vert = 0; vert < 3; vert++) {
+				distances[plane][vert] = GetDepthPlaneDistance(vertices[vert], plane, settings.depthRange);
+				outsideCount += distances[plane][vert] < 0.0f ? 1 : 0;
+			}
+			if (outsideCount == 3) {
+				return;
+			}
+			anyOutside |= outsideCount != 0;
+		}
+		if (!anyOutside) {
+			SetupProjectedTriangle(triangles, v0, v1, v2, cullBackFaces);
+			return;
+		}
+		// Sutherland-Hodgman against the two planes, a triangle becomes a convex polygon of 5 vertices at most.
+		float polygons[2][5][4];
+		uint32_t polygonSize{3};
+		for (uint32_t vert = 0; vert < 3; vert++) {
+			std::copy(vertices[vert], vertices[vert] + 4, polygons[0][vert]);
+		}
+		for (uint32_t plane = 0; plane < 2; plane++) {
+			const float (*src)[4] = polygons[plane];
+			float (*dst)[4] = polygons[plane ^ 1];
+			uint32_t dstSize{0};
+			for (uint32_t vert = 0; vert < polygonSize; vert++) {
+				const float* current = src[vert];
+				const float* next = src[(vert + 1) % polygonSize];
+				float currentDistance = GetDepthPlaneDistance(current, plane, settings.depthRange);
+				float nextDistance = GetDepthPlaneDistance(next, plane, settings.depthRange);
+				if (currentDistance >= 0.0f) {
+					std::copy(current, current + 4, dst[dstSize++]);
+				}
+				if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f)) {
+					float t = currentDistance / (currentDistance - nextDistance);
+					for (uint32_t component = 0; component < 4; component++) {
+						dst[dstSize][component] = current[component] + (next[component] - current[component]) * t;
+					}
+					dstSize++;
+				}
+			}
+			polygonSize = dstSize;
+			if (polygonSize < 3) {
+				return;
+			}
+		}
+		// Back in 'polygons[0]' after the two planes, a fan keeps the winding.
+		for (uint32_t vert = 1; vert + 1 < polygonSize; vert++) {
+			SetupProjectedTriangle(triangles, polygons[0][0], polygons[0][vert], polygons[0][vert + 1], cullBackFaces);
+		}
+	}
+
+	void OcclusionCuller::SetupProjectedTriangle(std::vector<Triangle>& triangles, const float* v0, const float* v1, const float* v2,
+	                                             bool cullBackFaces) const {
+		const float* vertices[3]{v0, v1, v2};
+		float x[3];
+		float y[3];
+		float depth[3];
+		for (uint32_t vert = 0; vert < 3; vert++) {
+			const float* v = vertices[vert];
+			if (!(v[3] > 0.0f)) {
+				return;
+			}
+			float invW = 1.0f / v[3];
+			depth[vert] = GetVertexDepth(v, settings.orthographic);
+			x[vert] = (v[0] * invW * 0.5f + 0.5f) * static_cast<float>(settings.width);
+			y[vert] = (v[1] * invW * 0.5f + 0.5f) * static_cast<float>(settings.height);
+			if (!std::isfinite(x[vert]) || !std::isfinite(y[vert]) || !std::isfinite(depth[vert])) {
+				return;
+			}
+		}
+		// Twice the signed area, negative for the counter-clockwise triangles in the framebuffer space (y down).
+		float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if (!(std::abs(area) > 0.0f) || !std::isfinite(area)) {
+			return;
+		}
+		if (cullBackFaces && (settings.counterClockwiseFrontFaces ? area > 0.0f : area < 0.0f)) {
+			return;
+		}
+		// From here on the area is positive, the inside of every edge is on its left.
+		if (area < 0.0f) {
+			std::swap(x[1], x[2]);
+			std::swap(y[1], y[2]);
+			std::swap(depth[1], depth[2]);
+			area = -area;
+		}
+
+		// The pixels whose centers can be inside.
+		float firstPixelX = std::max(std::ceil(std::min({x[0], x[1], x[2]}) - 0.5f), 0.0f);
+		float lastPixelX = std::min(std::floor(std::max({x[0], x[1], x[2]}) - 0.5f), static_cast<float>(settings.width - 1));
+		float firstPixelY = std::max(std::ceil(std::min({y[0], y[1], y[2]}) - 0.5f), 0.0f);
+		float lastPixelY = std::min(std::floor(std::max({y[0], y[1], y[2]}) - 0.5f), static_cast<float>(settings.height - 1));
+		if (!(firstPixelX <= lastPixelX && firstPixelY <= lastPixelY)) {
+			return;
+		}
+
+		Triangle triangle{};
+		triangle.firstTileX = static_cast<uint32_t>(firstPixelX) / tileWidth;
+		triangle.lastTileX = static_cast<uint32_t>(lastPixelX) / tileWidth;
+		triangle.firstTileY = static_cast<uint32_t>(firstPixelY) / tileHeight;
+		triangle.lastTileY = static_cast<uint32_t>(lastPixelY) / tileHeight;
+		// The edge from 'i' to 'j' has the inside where '(yi - yj) * (x - xi) + (xj - xi) * (y - yi) >= 0',
+		// solved for x it's a bound on the left or on the right depending on the sign of 'yi - yj'.
+		for (uint32_t edgeIdx = 0; edgeIdx < 3; edgeIdx++) {
+			uint32_t i = edgeIdx;
+			uint32_t j = (edgeIdx + 1) % 3;
+			float a = y[i] - y[j];
+			float b = x[j] - x[i];
+			TriangleEdge& edge = triangle.edges[edgeIdx];
+			edge.x = x[i];
+			edge.y = y[i];
+			edge.slope = -b / a;
+			if (a != 0.0f && std::isfinite(edge.slope)) {
+				edge.kind = a > 0.0f ? edgeLeft : edgeRight;
+			} else {
+				edge.kind = edgeHorizontal;
+				edge.slope = b > 0.0f ? 1.0f : -1.0f;
+			}
+		}
+		float dx1 = x[1] - x[0];
+		float dy1 = y[1] - y[0];
+		float dx2 = x[2] - x[0];
+		float dy2 = y[2] - y[0];
+		float dz1 = depth[1] - depth[0];
+		float dz2 = depth[2] - depth[0];
+		triangle.depthX = (dz1 * dy2 - dz2 * dy1) / area;
+		triangle.depthY = (dx1 * dz2 - dx2 * dz1) / area;
+		triangle.depthOffset = depth[0] - triangle.depthX * x[0] - triangle.depthY * y[0];
+		triangle.minDepth = std::min({depth[0], depth[1], depth[2]});
+		triangles.push_back(triangle);
+	}
+
+	void OcclusionCuller::RasterizeTileRow(uint32_t tileY) {
+		uint32_t firstRow = tileY * tileHeight;
+		Tile* rowTiles = tiles.data() + static_cast<size_t>(tileY) * tileCountX;
+		for (const Triangle& triangle : triangles) {
+			if (tileY < triangle.firstTileY || tileY > triangle.lastTileY) {
+				continue;
+			}
+			int32_t starts[8];
+			int32_t ends[8];
+			ComputeRowSpans(triangle.edges, firstRow, settings.width, starts, ends);
+			// Only the tiles that the spans of this tile row reach.
+			int32_t spanStart{std::numeric_limits<int32_t>::max()};
+			int32_t spanEnd{std::numeric_limits<int32_t>::min()};
+			for (uint32_t row = 0; row < 8; row++) {
+				if (starts[row] < ends[row]) {
+					spanStart = std::min(spanStart, starts[row]);
+					spanEnd = std::max(spanEnd, ends[row]);
+				}
+			}
+			if (spanStart >= spanEnd) {
+				continue;
+			}
+			uint32_t firstTileX = std::max(static_cast<uint32_t>(std::max(spanStart, 0)) / tileWidth, triangle.firstTileX);
+			uint32_t lastTileX = std::min(static_cast<uint32_t>(std::max(spanEnd - 1, 0)) / tileWidth, triangle.lastTileX);
+			for (uint32_t tileX = firstTileX; tileX <= lastTileX; tileX++) {
+				uint32_t masks[8];
+				if (!BuildRowMasks(starts, ends, static_cast<int32_t>(tileX * tileWidth), masks)) {
+					continue;
+				}
+				// The farthest depth of the plane over the tile is at one of its corners, and never farther than
+				// the farthest vertex.
+				float tileLeft = static_cast<float>(tileX * tileWidth);
+				float tileTop = static_cast<float>(firstRow);
+				float cornerX = triangle.depthX > 0.0f ? tileLeft : tileLeft + static_cast<float>(tileWidth);
+				float cornerY = triangle.depthY > 0.0f ? tileTop : tileTop + static_cast<float>(tileHeight);
+				float depth = std::max(triangle.depthOffset + triangle.depthX * cornerX + triangle.depthY * cornerY, triangle.minDepth);
+				Tile& tile = rowTiles[tileX];
+				UpdateTileMasks(tile.mask, tile.depth0, tile.depth1, masks, depth);
+			}
+		}
+	}
+
+	void OcclusionCuller::BuildDepthPyramid() {
+		std::vector<float>& base = depthPyramid[0];
+		for (size_t tileIdx = 0; tileIdx < tiles.size(); tileIdx++) {
+			base[tileIdx] = tiles[tileIdx].depth0;
+		}
+		for (size_t level = 1; level < depthPyramid.size(); level++) {
+			const std::vector<float>& src = depthPyramid[level - 1];
+			std::vector<float>& dst = depthPyramid[level];
+			uint32_t srcWidth = pyramidWidths[level - 1];
+			uint32_t srcHeight = pyramidHeights[level - 1];
+			for (uint32_t y = 0; y < pyramidHeights[level]; y++) {
+				for (uint32_t x = 0; x < pyramidWidths[level]; x++) {
+					// The odd edges have a single node on that side.
+					uint32_t x0 = x * 2;
+					uint32_t y0 = y * 2;
+					uint32_t x1 = std::min(x0 + 1, srcWidth - 1);
+					uint32_t y1 = std::min(y0 + 1, srcHeight - 1);
+					dst[static_cast<size_t>(y) * pyramidWidths[level] + x] = std::min({
+						src[static_cast<size_t>(y0) * srcWidth + x0], src[static_cast<size_t>(y0) * srcWidth + x1],
+						src[static_cast<size_t>(y1) * srcWidth + x0], src[static_cast<size_t>(y1) * srcWidth + x1]});
+				}
+			}
+		}
+	}
+
+	bool OcclusionCuller::IsTileRangeOccluded(uint32_t level, uint32_t firstX, uint32_t lastX, uint32_t firstY, uint32_t lastY,
+	                                          float depth) const {
+		// Occluded when the box is farther than the complete layer of every tile.
+		const std::vector<float>& levelDepths = depthPyramid[level];
+		uint32_t levelWidth = pyramidWidths[level];
+		for (uint32_t y = firstY; y <= lastY; y++) {
+			const float* row = levelDepths.data() + static_cast<size_t>(y) * levelWidth;
+			uint32_t x{firstX};
+#if defined(EMBER_SIMD_SSE2)
+			const __m128 boxDepth = _mm_set1_ps(depth);
+			for (; x + 4 <= lastX + 1; x += 4) {
+				if (_mm_movemask_ps(_mm_cmpge_ps(boxDepth, _mm_loadu_ps(row + x))) != 0) {
+					return false;
+				}
+			}
+#endif
+			for (; x <= lastX; x++) {
+				if (depth >= row[x]) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+}
\ No newline at end of file
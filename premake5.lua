@@ -4,6 +4,17 @@ newoption {
    description = "Provide Vulkan SDK path (Windows-only). If empty, the default 'C:\\Vulkan\\SDK' is used.",
    default     = "C:\\Vulkan\\SDK"
 }
+newoption {
+   trigger     = "simd",
+   value       = "ISA",
+   description = "Instruction set the engine's SIMD kernels are compiled for. Scalar fallbacks are always built.",
+   default     = "sse2",
+   allowed     = {
+      {"sse2",   "SSE2 (any x86_64 CPU)"},
+      {"sse4.1", "SSE4.1"},
+      {"avx2",   "AVX2 + F16C + FMA (Haswell and newer)"},
+   }
+}
 
 include("dependencies.lua")
 
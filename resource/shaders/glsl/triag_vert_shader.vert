@@ -5,6 +5,12 @@ layout(location = 1) in vec3 vertCol;
 
 layout(location = 0) out vec3 fragColor;
 
+// Same as 'VulkanMeshPushConstants'. The quantized positions are in the [0, 1] range of the object's AABB.
+layout(push_constant) uniform MeshConstants {
+    vec4 positionScale;
+    vec4 positionOffset;
+} meshConstants;
+
 // Clockwise order
 /*
 vec2 positions[3] = vec2[](
@@ -33,6 +39,6 @@ void main() {
     // gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
     // fragColor = colors[gl_VertexIndex];
 
-    gl_Position = vec4(vertPos, 1.0);
+    gl_Position = vec4(vertPos * meshConstants.positionScale.xyz + meshConstants.positionOffset.xyz, 1.0);
     fragColor = vertCol;
 }
\ No newline at end of file